@@ -0,0 +1,8 @@
+#! /usr/bin/env python3
+
+# Programs that are runnable.
+ns3_runnable_programs = ['build/scratch/ns3-dev-myfirst-hw1-debug', 'build/scratch/ns3-dev-mythird-hw1-debug', 'build/scratch/ns3-dev-first-mon-debug', 'build/scratch/ns3-dev-mysecond-hw1-debug', 'build/scratch/ns3-dev-random-propagation-loss-distance-expt-debug', 'build/scratch/subdir/ns3-dev-subdir-debug', 'build/scratch/ns3-dev-mysecond-debug', 'build/scratch/ns3-dev-scratch-simulator-debug']
+
+# Scripts that are runnable.
+ns3_runnable_scripts = []
+
@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "nstime.h"
+#include "singleton.h"
+
+#include <stdint.h>
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ * \ingroup debugging
+ *
+ * \brief Attribute the wall-clock time of a simulation to its events.
+ *
+ * When enabled, DefaultSimulatorImpl measures the wall-clock time spent
+ * in each event it invokes and hands it to the profiler, which
+ * aggregates the time and the number of events
+ *
+ *  - by function: the function or method invoked by the events
+ *    created with MakeEvent, for example
+ *    <tt>ns3::YansWifiPhy::EndReceive(ns3::Ptr<ns3::Event>)</tt>,
+ *    after resolution of virtual methods on the bound object;
+ *  - by context, that is by node id for the events scheduled
+ *    with Simulator::ScheduleWithContext;
+ *  - by simulated-time bucket.
+ *
+ * The aggregates can be written as a text report, and as folded stacks
+ * (one <tt>frame;frame;... weight</tt> line per function, the weight
+ * being the wall-clock time in nanoseconds) which can be rendered
+ * directly by flamegraph.pl or speedscope.  The first frame is the class
+ * of the object the event is bound to, so that all the events of, say,
+ * a Wi-Fi PHY or a TCP socket are grouped together, and the second
+ * frame is the type of the bound method.
+ *
+ * The functions are named after their symbol, looked up with dladdr().
+ * The functions without a dynamic symbol, such as static functions, are
+ * named after their type and their offset in their shared library, which
+ * can be resolved with addr2line; the events which are not created by
+ * MakeEvent are named after their EventImpl subclass.
+ *
+ * The profiler can be enabled from the program:
+ *
+ * \code
+ *   EventProfiler::Get ()->Enable (Seconds (10));
+ *   Simulator::Run ();
+ *   EventProfiler::Get ()->WriteReport (std::cout);
+ *   std::ofstream folded ("profile.folded");
+ *   EventProfiler::Get ()->WriteFoldedStacks (folded);
+ *   Simulator::Destroy ();
+ * \endcode
+ *
+ * or, without modifying the program, from the command line of any
+ * program which uses CommandLine:
+ *
+ * \verbatim
+   $ ./waf --run "my-program --EventProfilerPrefix=prof --EventProfilerBucket=10s" \endverbatim
+ *
+ * which writes \c prof.txt and \c prof.folded when the simulation is
+ * destroyed.
+ *
+ * Only the time spent in EventImpl::Invoke is measured; the time spent
+ * in the scheduler itself is reported as the difference between the
+ * profiled time and the run time.  When the profiler is disabled, the
+ * cost for DefaultSimulatorImpl is one test per event.
+ */
+class EventProfiler : public Singleton<EventProfiler>
+{
+public:
+  /** Constructor. */
+  EventProfiler ();
+
+  /**
+   * Start collecting event statistics.
+   *
+   * The profiler is only looked up by Simulator::Run, so the profiler
+   * must be enabled before Simulator::Run is called.
+   *
+   * \param [in] bucket The width of the simulated-time buckets.
+   */
+  void Enable (Time bucket = Seconds (1.0));
+  /** Stop collecting event statistics.  The statistics are kept. */
+  void Disable (void);
+  /**
+   * Check if the profiler is collecting statistics.
+   * \returns \c true if the profiler is enabled.
+   */
+  bool IsEnabled (void) const;
+  /** Discard all the statistics collected so far. */
+  void Reset (void);
+
+  /**
+   * Get the profiler to use for a simulation run.
+   *
+   * Enables the profiler if the \c EventProfilerPrefix global value
+   * is set.
+   *
+   * \returns The profiler if it is enabled, and null otherwise.
+   */
+  static EventProfiler * Start (void);
+  /**
+   * Write the report and folded stacks files, and reset the
+   * statistics, if the \c EventProfilerPrefix global value is set.
+   */
+  void Finish (void);
+
+  /**
+   * Account for one event.
+   *
+   * \param [in] event The event.
+   * \param [in] context The context of the event.
+   * \param [in] ts The timestamp of the event, in time steps.
+   * \param [in] wallNs The wall-clock time spent in the event, in nanoseconds.
+   */
+  void Record (const EventImpl *event, uint32_t context, uint64_t ts, uint64_t wallNs);
+
+  /**
+   * Get the total number of events profiled.
+   * \returns The number of events.
+   */
+  uint64_t GetEventCount (void) const;
+  /**
+   * Get the number of events profiled for a context.
+   * \param [in] context The context.
+   * \returns The number of events.
+   */
+  uint64_t GetContextEventCount (uint32_t context) const;
+  /**
+   * Get the number of events profiled for a function.
+   * \param [in] name The function name, as printed by WriteReport.
+   * \returns The number of events.
+   */
+  uint64_t GetTypeEventCount (std::string name) const;
+
+  /**
+   * Print the statistics by function, context and time bucket, each
+   * sorted by decreasing wall-clock time.
+   * \param [in,out] os The output stream.
+   */
+  void WriteReport (std::ostream &os) const;
+  /**
+   * Print the statistics by function as folded stacks.
+   * \param [in,out] os The output stream.
+   */
+  void WriteFoldedStacks (std::ostream &os) const;
+
+  /**
+   * Get a readable name for the type of an event.
+   *
+   * For the events created by MakeEvent, this is the type of the bound
+   * function or method; otherwise, this is the demangled name of the
+   * EventImpl subclass.
+   *
+   * \param [in] type The type of the event.
+   * \returns The event type name.
+   */
+  static std::string GetEventTypeName (const std::type_info &type);
+  /**
+   * Get a readable name for the function invoked by an event.
+   *
+   * \param [in] type The type of the event.
+   * \param [in] function The function, as returned by EventImpl::GetFunction.
+   * \returns The symbol of the function if it can be found, and the event
+   *          type name, followed by the location of the function if
+   *          known, otherwise.
+   */
+  static std::string GetEventName (const std::type_info &type, const void *function);
+  /**
+   * Get the class of the object an event type is bound to.
+   * \param [in] name The event type name, as returned by GetEventTypeName.
+   * \returns The object class, or an empty string for functions.
+   */
+  static std::string GetEventClassName (std::string name);
+
+private:
+  /** Event count and wall-clock time. */
+  struct Stats
+  {
+    Stats () : count (0), wallNs (0) {}
+    uint64_t count;   /**< The number of events. */
+    uint64_t wallNs;  /**< The wall-clock time, in nanoseconds. */
+  };
+  /** An EventImpl type and the function its events invoke. */
+  typedef std::pair<const std::type_info *, const void *> EventKey;
+  /** Statistics for each type of EventImpl and function. */
+  typedef std::map<EventKey, Stats> TypeStats;
+  /** Statistics merged by function name. */
+  typedef std::map<std::string, Stats> NamedStats;
+
+  /**
+   * Merge the statistics of the functions with the same name.
+   * \param [out] types If not null, the event type name of each function.
+   * \returns The statistics by function name.
+   */
+  NamedStats GetNamedStats (std::map<std::string, std::string> *types = 0) const;
+  /**
+   * Print a table of statistics, sorted by decreasing wall-clock time.
+   * \param [in,out] os The output stream.
+   * \param [in] title The title of the table.
+   * \param [in] stats The rows of the table, by label.
+   */
+  void WriteTable (std::ostream &os, std::string title,
+                   const std::vector<std::pair<std::string, Stats> > &stats) const;
+
+  /** Flag \c true if enabled. */
+  bool m_enabled;
+  /** The width of the time buckets, in time steps. */
+  uint64_t m_bucket;
+  /** The totals. */
+  Stats m_total;
+  /** The last event key seen, to avoid a map lookup for bursts. */
+  EventKey m_lastType;
+  /** The statistics of m_lastType, or null. */
+  Stats *m_lastTypeStats;
+  /** The statistics by EventImpl type and function. */
+  TypeStats m_types;
+  /** The statistics by context. */
+  std::unordered_map<uint32_t, Stats> m_contexts;
+  /** The index of the last time bucket seen. */
+  uint64_t m_lastBucket;
+  /** The statistics of m_lastBucket. */
+  Stats *m_lastBucketStats;
+  /** The statistics by time bucket index. */
+  std::map<uint64_t, Stats> m_buckets;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
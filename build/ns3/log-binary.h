@@ -0,0 +1,774 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_LOG_BINARY_H
+#define NS3_LOG_BINARY_H
+
+#include <stdint.h>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup logging
+ * Binary log sink declarations.
+ */
+
+namespace ns3 {
+
+class LogComponent;
+class Time;
+template <typename T>
+class Ptr;
+
+/**
+ * \ingroup logging
+ * \defgroup logbinary Binary logging
+ *
+ * \brief Record the NS_LOG messages in a binary file.
+ *
+ * Formatting the messages with \c std::clog is by far the largest cost
+ * of the logging macros.  When the binary log is enabled, the enabled
+ * NS_LOG, NS_LOG_FUNCTION and NS_LOG_FUNCTION_NOARGS statements do not
+ * format anything: each one appends to a per-thread ring buffer the id
+ * of the statement (registered the first time the statement runs), the
+ * simulation time and context, and the raw bytes of its arguments.
+ * String literals are interned, so only their id is recorded.  A
+ * background thread writes the ring buffers to the file.
+ *
+ * The integer, floating point, character, string, pointer, Ptr and
+ * Time arguments are recorded in binary.  The first argument of any
+ * other type (and any stream manipulator) switches the rest of the
+ * message to formatting, with the \c operator<< of the argument, and
+ * the resulting text is recorded.
+ *
+ * The file is rendered offline, in the same text format as \c std::clog
+ * logging, by the \c decode-binary-log program or LogBinaryDecode:
+ *
+ * \verbatim
+   $ NS_LOG="OlsrAgent=level_all|prefix_all" NS_LOG_BINARY=olsr.blog ./waf --run ...
+   $ ./waf --run "decode-binary-log --input=olsr.blog" > olsr.log \endverbatim
+ *
+ * NS_LOG_UNCOND is not affected and still writes to \c std::clog.  The
+ * messages of different threads are written in batches, so they are
+ * only ordered within each thread.  The file uses the byte order of the
+ * host which recorded it.
+ */
+
+/**
+ * \ingroup logbinary
+ * Record the enabled log messages in a binary file, instead of
+ * writing them on \c std::clog.
+ *
+ * Same as running your program with the \c NS_LOG_BINARY environment
+ * variable set to \p filename.  If the binary log is already enabled,
+ * the current file is closed first.
+ *
+ * \param [in] filename The binary log file name.
+ * \param [in] ringSize The size of the ring buffer of each thread,
+ *             in bytes.
+ */
+void LogBinaryEnable (const std::string & filename,
+                      uint32_t ringSize = 1 << 20);
+/**
+ * \ingroup logbinary
+ * Write the pending messages, close the binary log file and log
+ * again on \c std::clog.
+ *
+ * Must not be called while other threads are logging.
+ */
+void LogBinaryDisable (void);
+/**
+ * \ingroup logbinary
+ * Check if the log messages are recorded in a binary file.
+ * \returns \c true if the binary log is enabled.
+ */
+bool LogBinaryIsEnabled (void);
+/**
+ * \ingroup logbinary
+ * Write to the binary log file the messages logged so far.
+ */
+void LogBinaryFlush (void);
+/**
+ * \ingroup logbinary
+ * Render a binary log in the text format of the \c std::clog logging.
+ *
+ * The simulation times are printed with the time resolution of the
+ * recorded simulation, which becomes the current Time resolution.
+ *
+ * \param [in,out] is The binary log.
+ * \param [in,out] os The stream to write the messages on.
+ * \returns \c false if the binary log is not valid.
+ */
+bool LogBinaryDecode (std::istream & is, std::ostream & os);
+
+
+/**
+ * \ingroup logbinary
+ * A logging statement, registered with the binary log the first time
+ * it runs.
+ *
+ * \internal
+ * Logging implementation class; should not be used directly.
+ */
+class LogBinarySite
+{
+public:
+  /** The logging macro of a statement. */
+  enum Kind
+  {
+    MESSAGE = 0,         //!< NS_LOG (level, msg)
+    FUNCTION = 1,        //!< NS_LOG_FUNCTION (parameters)
+    FUNCTION_NOARGS = 2  //!< NS_LOG_FUNCTION_NOARGS ()
+  };
+  /**
+   * Register a logging statement.
+   *
+   * \param [in] log The LogComponent of the statement.
+   * \param [in] function The name of the function.
+   * \param [in] file The source file.
+   * \param [in] line The source line.
+   * \param [in] level The LogLevel of the statement.
+   * \param [in] kind The logging macro of the statement.
+   */
+  LogBinarySite (const LogComponent & log, const char * function,
+                 const char * file, uint32_t line, uint32_t level, Kind kind);
+  /** \returns The id of this statement in the binary log. */
+  uint32_t GetId (void) const;
+  /** \returns The logging macro of this statement. */
+  Kind GetKind (void) const;
+
+private:
+  uint32_t m_id;  //!< The statement id.
+  Kind m_kind;    //!< The logging macro.
+};
+
+class LogBinaryRecord;
+
+/**
+ * \ingroup logbinary
+ * Record an argument of a log message.
+ *
+ * The arguments of the types which have no specialization are formatted.
+ *
+ * \tparam T \explicit The argument type.
+ * \internal
+ * Logging implementation class; should not be used directly.
+ */
+template <typename T>
+struct LogBinaryItem
+{
+  /**
+   * Record an argument.
+   *
+   * The argument is forwarded as is to its \c operator<<, which may
+   * take a non-const reference.
+   *
+   * \param [in,out] record The log record.
+   * \param [in] value The argument.
+   */
+  template <typename U>
+  static void Put (LogBinaryRecord & record, U && value);
+};
+
+/**
+ * \ingroup logbinary
+ * A log message being recorded.
+ *
+ * The record is built in a buffer of the thread, and is moved to the
+ * ring buffer of the thread when it is destroyed.
+ *
+ * \internal
+ * Logging implementation class; should not be used directly.
+ */
+class LogBinaryRecord
+{
+public:
+  /** The type tags of the recorded arguments. */
+  enum Tag
+  {
+    TEXT = 0,         //!< Formatted text, never quoted.
+    STRING = 1,       //!< A string.
+    LITERAL = 2,      //!< An interned string literal.
+    CHAR = 3,         //!< A character.
+    BOOL = 4,         //!< A bool.
+    INT16 = 5,        //!< A 16-bit signed integer.
+    UINT16 = 6,       //!< A 16-bit unsigned integer.
+    INT32 = 7,        //!< A 32-bit signed integer.
+    UINT32 = 8,       //!< A 32-bit unsigned integer.
+    INT64 = 9,        //!< A 64-bit signed integer.
+    UINT64 = 10,      //!< A 64-bit unsigned integer.
+    FLOAT = 11,       //!< A float.
+    DOUBLE = 12,      //!< A double.
+    LONG_DOUBLE = 13, //!< A long double.
+    POINTER = 14,     //!< A pointer.
+    TIME = 15         //!< A Time, in time steps.
+  };
+  /** The prefixes of a record. */
+  enum Flags
+  {
+    PREFIX_TIME = 0x01,   //!< The time prefix is a time step.
+    PREFIX_NODE = 0x02,   //!< The node prefix is a context.
+    PREFIX_FUNC = 0x04,   //!< Prefix the message with the function name.
+    PREFIX_LEVEL = 0x08,  //!< Prefix the message with the log level.
+    TEXT_TIME = 0x10,     //!< The time prefix is a TEXT argument.
+    TEXT_NODE = 0x20,     //!< The node prefix is a TEXT argument.
+    TEXT_CONTEXT = 0x40   //!< The NS_LOG_APPEND_CONTEXT text is a TEXT argument.
+  };
+
+  /**
+   * Start a log record.
+   * \param [in] site The logging statement.
+   * \param [in] log The LogComponent of the statement.
+   */
+  LogBinaryRecord (const LogBinarySite & site, const LogComponent & log);
+  /** Move the record to the ring buffer of the thread. */
+  ~LogBinaryRecord ();
+
+  /**
+   * Record an argument.
+   * \param [in] value The argument.
+   * \returns This record, so it's chainable.
+   */
+  template <typename T>
+  LogBinaryRecord & operator<< (T && value);
+  /**
+   * Apply a stream manipulator, such as \c std::endl.
+   * \param [in] manipulator The manipulator.
+   * \returns This record, so it's chainable.
+   */
+  LogBinaryRecord & operator<< (std::ostream & (*manipulator)(std::ostream &));
+  /**
+   * Apply a stream manipulator, such as \c std::hex.
+   * \param [in] manipulator The manipulator.
+   * \returns This record, so it's chainable.
+   */
+  LogBinaryRecord & operator<< (std::ios_base & (*manipulator)(std::ios_base &));
+
+  /**
+   * Check if the arguments are function parameters.
+   * \returns \c true for an NS_LOG_FUNCTION record.
+   */
+  bool IsParameters (void) const;
+  /**
+   * Record a number or a character.
+   * \param [in] tag The type tag.
+   * \param [in] value The value.
+   */
+  template <typename T>
+  void PutValue (enum Tag tag, T value);
+  /**
+   * Record a pointer.
+   * \param [in] value The pointer.
+   */
+  void PutPointer (const void * value);
+  /**
+   * Record a string.
+   * \param [in] value The string.
+   * \param [in] size The string length.
+   */
+  void PutString (const char * value, std::size_t size);
+  /**
+   * Record a character array, interned if it is a string literal.
+   * \param [in] value The array.
+   * \param [in] capacity The array size.
+   */
+  void PutLiteral (const char * value, std::size_t capacity);
+  /**
+   * Record a Time.
+   * \param [in] value The time.
+   */
+  void PutTime (const Time & value);
+  /**
+   * Record the text of an argument with no binary representation.
+   * \param [in] value The argument.
+   */
+  template <typename T>
+  void Format (T && value);
+  /** End a function parameter. */
+  void EndParameter (void);
+  /**
+   * Start capturing the text written by NS_LOG_APPEND_CONTEXT.
+   * \returns The stream to use as \c std::clog.
+   */
+  std::streambuf * BeginContext (void);
+  /** Record the text written by NS_LOG_APPEND_CONTEXT. */
+  void EndContext (void);
+
+  /** Per-thread record buffer. */
+  struct Buffer
+  {
+    /** Constructor. */
+    Buffer ();
+    std::vector<uint8_t> bytes;  //!< The record.
+    std::ostream *text;          //!< The formatted text.
+  };
+
+private:
+  /**
+   * Switch the rest of the record to formatting.
+   * \returns The stream to format the arguments on.
+   */
+  std::ostream & StartFormatting (void);
+  /** Record the text formatted so far. */
+  void FlushText (void);
+  /**
+   * Append a type tag and a value.
+   * \param [in] tag The type tag.
+   * \param [in] value The value.
+   * \param [in] size The value size.
+   */
+  void Append (uint8_t tag, const void * value, std::size_t size);
+
+  Buffer *m_buffer;    //!< The buffer of the record, 0 to discard.
+  bool m_parameters;   //!< The arguments are function parameters.
+  bool m_formatting;   //!< The rest of the record is formatted.
+  std::size_t m_flagsOffset;  //!< The offset of the flags.
+};
+
+/**
+ * \ingroup logbinary
+ * Record the parameters of an NS_LOG_FUNCTION statement, as
+ * ParameterLogger prints them.
+ *
+ * \internal
+ * Logging implementation class; should not be used directly.
+ */
+class LogBinaryParameters
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] record The log record.
+   */
+  LogBinaryParameters (LogBinaryRecord & record);
+  /**
+   * Record a function parameter.
+   * \param [in] param The function parameter.
+   * \returns This LogBinaryParameters, so it's chainable.
+   */
+  template <typename T>
+  LogBinaryParameters & operator<< (T && param);
+
+private:
+  /**
+   * Record a function parameter.
+   * \param [in] param The function parameter.
+   */
+  template <typename T>
+  void Put (T && param, std::false_type);
+  /**
+   * Record each element of a vector as a parameter.
+   * \param [in] vector The vector of parameters.
+   */
+  template <typename T>
+  void Put (const T & vector, std::true_type);
+
+  LogBinaryRecord & m_record;  //!< The log record.
+};
+
+/**
+ * \ingroup logbinary
+ * Redirect \c std::clog to a log record while NS_LOG_APPEND_CONTEXT runs.
+ *
+ * \internal
+ * Logging implementation class; should not be used directly.
+ */
+class LogBinaryContext
+{
+public:
+  /**
+   * Start capturing \c std::clog.
+   * \param [in] record The log record.
+   */
+  LogBinaryContext (LogBinaryRecord & record);
+  /** Restore \c std::clog and record the captured text. */
+  ~LogBinaryContext ();
+
+private:
+  LogBinaryRecord & m_record;   //!< The log record.
+  std::streambuf *m_previous;   //!< The \c std::clog buffer.
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+template <typename U>
+void
+LogBinaryItem<T>::Put (LogBinaryRecord & record, U && value)
+{
+  record.Format (std::forward<U> (value));
+}
+
+/**
+ * \ingroup logbinary
+ * Define the LogBinaryItem of a number type.
+ * \param [in] type The number type.
+ * \param [in] stored The recorded type.
+ * \param [in] tag The LogBinaryRecord::Tag of \p stored.
+ */
+#define NS_LOG_BINARY_NUMBER(type, stored, tag)                         \
+  template <>                                                           \
+  struct LogBinaryItem<type>                                            \
+  {                                                                     \
+    static void Put (LogBinaryRecord & record, const type & value)      \
+    {                                                                   \
+      record.PutValue<stored> (LogBinaryRecord::tag,                    \
+                               static_cast<stored> (value));            \
+    }                                                                   \
+  }
+
+NS_LOG_BINARY_NUMBER (bool, bool, BOOL);
+NS_LOG_BINARY_NUMBER (char, char, CHAR);
+NS_LOG_BINARY_NUMBER (short, int16_t, INT16);
+NS_LOG_BINARY_NUMBER (unsigned short, uint16_t, UINT16);
+NS_LOG_BINARY_NUMBER (int, int32_t, INT32);
+NS_LOG_BINARY_NUMBER (unsigned int, uint32_t, UINT32);
+NS_LOG_BINARY_NUMBER (long, int64_t, INT64);
+NS_LOG_BINARY_NUMBER (unsigned long, uint64_t, UINT64);
+NS_LOG_BINARY_NUMBER (long long, int64_t, INT64);
+NS_LOG_BINARY_NUMBER (unsigned long long, uint64_t, UINT64);
+NS_LOG_BINARY_NUMBER (float, float, FLOAT);
+NS_LOG_BINARY_NUMBER (double, double, DOUBLE);
+NS_LOG_BINARY_NUMBER (long double, long double, LONG_DOUBLE);
+
+#undef NS_LOG_BINARY_NUMBER
+
+/**
+ * \ingroup logbinary
+ * A signed char is printed as a character in a message, and as a
+ * number in the parameters, like ParameterLogger does.
+ */
+template <>
+struct LogBinaryItem<signed char>
+{
+  /**
+   * Record an argument.
+   * \param [in,out] record The log record.
+   * \param [in] value The argument.
+   */
+  static void Put (LogBinaryRecord & record, const signed char & value)
+  {
+    if (record.IsParameters ())
+      {
+        record.PutValue<int16_t> (LogBinaryRecord::INT16, value);
+      }
+    else
+      {
+        record.PutValue<char> (LogBinaryRecord::CHAR, static_cast<char> (value));
+      }
+  }
+};
+
+/**
+ * \ingroup logbinary
+ * An unsigned char is printed as a character in a message, and as a
+ * number in the parameters, like ParameterLogger does.
+ */
+template <>
+struct LogBinaryItem<unsigned char>
+{
+  /**
+   * Record an argument.
+   * \param [in,out] record The log record.
+   * \param [in] value The argument.
+   */
+  static void Put (LogBinaryRecord & record, const unsigned char & value)
+  {
+    if (record.IsParameters ())
+      {
+        record.PutValue<uint16_t> (LogBinaryRecord::UINT16, value);
+      }
+    else
+      {
+        record.PutValue<char> (LogBinaryRecord::CHAR, static_cast<char> (value));
+      }
+  }
+};
+
+/**
+ * \ingroup logbinary
+ * Character arrays, usually string literals.
+ */
+template <std::size_t N>
+struct LogBinaryItem<char[N]>
+{
+  /**
+   * Record an argument.
+   * \param [in,out] record The log record.
+   * \param [in] value The argument.
+   */
+  static void Put (LogBinaryRecord & record, const char (&value)[N])
+  {
+    record.PutLiteral (value, N);
+  }
+};
+
+/** \ingroup logbinary C strings. */
+template <>
+struct LogBinaryItem<const char *>
+{
+  /**
+   * Record an argument.
+   * \param [in,out] record The log record.
+   * \param [in] value The argument.
+   */
+  static void Put (LogBinaryRecord & record, const char * const & value)
+  {
+    record.PutString (value, std::strlen (value));
+  }
+};
+
+/** \ingroup logbinary C strings. */
+template <>
+struct LogBinaryItem<char *>
+{
+  /**
+   * Record an argument.
+   * \param [in,out] record The log record.
+   * \param [in] value The argument.
+   */
+  static void Put (LogBinaryRecord & record, char * const & value)
+  {
+    record.PutString (value, std::strlen (value));
+  }
+};
+
+/** \ingroup logbinary Strings. */
+template <>
+struct LogBinaryItem<std::string>
+{
+  /**
+   * Record an argument.
+   * \param [in,out] record The log record.
+   * \param [in] value The argument.
+   */
+  static void Put (LogBinaryRecord & record, const std::string & value)
+  {
+    record.PutString (value.data (), value.size ());
+  }
+};
+
+/**
+ * \ingroup logbinary
+ * Pointers.  The streams print the pointers to functions and to
+ * (un)signed characters differently, so those are formatted.
+ */
+template <typename T>
+struct LogBinaryItem<T *>
+{
+  /**
+   * Record an argument.
+   * \param [in,out] record The log record.
+   * \param [in] value The argument.
+   */
+  static void Put (LogBinaryRecord & record, T * const & value)
+  {
+    Put (record, value, std::integral_constant<bool,
+                                               std::is_function<T>::value
+                                               || std::is_same<typename std::remove_cv<T>::type, signed char>::value
+                                               || std::is_same<typename std::remove_cv<T>::type, unsigned char>::value> ());
+  }
+  /**
+   * Record a pointer.
+   * \param [in,out] record The log record.
+   * \param [in] value The argument.
+   */
+  static void Put (LogBinaryRecord & record, T * const & value, std::false_type)
+  {
+    record.PutPointer (value);
+  }
+  /**
+   * Format a pointer.
+   * \param [in,out] record The log record.
+   * \param [in] value The argument.
+   */
+  static void Put (LogBinaryRecord & record, T * const & value, std::true_type)
+  {
+    record.Format (value);
+  }
+};
+
+/** \ingroup logbinary Smart pointers, printed as their raw pointer. */
+template <typename T>
+struct LogBinaryItem<Ptr<T> >
+{
+  /**
+   * Record an argument.
+   * \param [in,out] record The log record.
+   * \param [in] value The argument.
+   */
+  static void Put (LogBinaryRecord & record, const Ptr<T> & value)
+  {
+    record.PutPointer (PeekPointer (value));
+  }
+};
+
+/** \ingroup logbinary Times. */
+template <>
+struct LogBinaryItem<Time>
+{
+  /**
+   * Record an argument.
+   * \param [in,out] record The log record.
+   * \param [in] value The argument.
+   */
+  static void Put (LogBinaryRecord & record, const Time & value)
+  {
+    record.PutTime (value);
+  }
+};
+
+
+/**
+ * \ingroup logbinary
+ * The LogBinaryItem of an argument type.
+ * \tparam T \explicit The argument type, as deduced for a forwarding
+ *         reference.
+ */
+template <typename T>
+struct LogBinaryItemOf
+{
+  /** The LogBinaryItem. */
+  typedef LogBinaryItem<typename std::remove_cv<typename std::remove_reference<T>::type>::type> Type;
+};
+
+template <typename T>
+LogBinaryRecord &
+LogBinaryRecord::operator<< (T && value)
+{
+  LogBinaryItemOf<T>::Type::Put (*this, std::forward<T> (value));
+  return *this;
+}
+
+template <typename T>
+void
+LogBinaryRecord::PutValue (enum Tag tag, T value)
+{
+  if (m_formatting)
+    {
+      *m_buffer->text << value;
+      return;
+    }
+  Append (tag, &value, sizeof (value));
+}
+
+inline void
+LogBinaryRecord::PutPointer (const void * value)
+{
+  if (m_formatting)
+    {
+      *m_buffer->text << value;
+      return;
+    }
+  uint64_t address = reinterpret_cast<uintptr_t> (value);
+  Append (POINTER, &address, sizeof (address));
+}
+
+template <typename T>
+void
+LogBinaryRecord::Format (T && value)
+{
+  if (m_buffer != 0)
+    {
+      StartFormatting () << std::forward<T> (value);
+    }
+}
+
+inline void
+LogBinaryRecord::Append (uint8_t tag, const void * value, std::size_t size)
+{
+  if (m_buffer == 0)
+    {
+      return;
+    }
+  std::vector<uint8_t> &bytes = m_buffer->bytes;
+  std::size_t offset = bytes.size ();
+  bytes.resize (offset + 1 + size);
+  bytes[offset] = tag;
+  std::memcpy (&bytes[offset + 1], value, size);
+}
+
+inline bool
+LogBinaryRecord::IsParameters (void) const
+{
+  return m_parameters;
+}
+
+
+/**
+ * \ingroup logbinary
+ * Check if a parameter is a vector, whose elements are logged as
+ * separate parameters.
+ * \tparam T \explicit The parameter type.
+ */
+template <typename T>
+struct LogBinaryIsVector : public std::false_type
+{
+};
+
+/**
+ * \ingroup logbinary
+ * Vectors.
+ * \tparam T \explicit The element type.
+ */
+template <typename T>
+struct LogBinaryIsVector<std::vector<T> > : public std::true_type
+{
+};
+
+template <typename T>
+LogBinaryParameters &
+LogBinaryParameters::operator<< (T && param)
+{
+  Put (std::forward<T> (param),
+       LogBinaryIsVector<typename std::remove_cv<typename std::remove_reference<T>::type>::type> ());
+  return *this;
+}
+
+template <typename T>
+void
+LogBinaryParameters::Put (T && param, std::false_type)
+{
+  LogBinaryItemOf<T>::Type::Put (m_record, std::forward<T> (param));
+  m_record.EndParameter ();
+}
+
+template <typename T>
+void
+LogBinaryParameters::Put (const T & vector, std::true_type)
+{
+  for (typename T::const_iterator i = vector.begin (); i != vector.end (); ++i)
+    {
+      *this << *i;
+    }
+}
+
+} // namespace ns3
+
+#endif /* NS3_LOG_BINARY_H */
@@ -0,0 +1,288 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *  Copyright 2013. Lawrence Livermore National Security, LLC.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Steven Smith <smith84@llnl.gov>
+ *
+ */
+
+#ifndef NULLMESSAGE_SIMULATOR_IMPL_H
+#define NULLMESSAGE_SIMULATOR_IMPL_H
+
+#include <ns3/simulator-impl.h>
+#include <ns3/scheduler.h>
+#include <ns3/event-impl.h>
+#include <ns3/ptr.h>
+
+#include <list>
+#include <iostream>
+#include <fstream>
+
+namespace ns3 {
+
+class NullMessageEvent;
+class NullMessageMpiInterface;
+class RemoteChannelBundle;
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Simulator implementation using MPI and a Null Message algorithm.
+ *
+ * The packets and Null Messages sent to a remote task while the
+ * simulation time does not advance are batched in a single MPI
+ * message, which carries the guarantee time calculated when it is
+ * sent.
+ *
+ * With the AdaptiveLookahead attribute, the Null Message event of a
+ * bundle is not scheduled at a fixed fraction of the channel delay, but
+ * deferred to the next local event when it is further away: nothing can
+ * raise the guarantee time before then.  The Null Messages which would
+ * not raise the guarantee time of the remote task are dropped.
+ */
+class NullMessageSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  NullMessageSimulatorImpl ();
+
+  ~NullMessageSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual void RunOneEvent (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /**
+   * \return singleton instance
+   *
+   * Singleton accessor.
+   */
+  static NullMessageSimulatorImpl * GetInstance (void);
+
+  /**
+   * Statistics of the synchronization of this MPI task.
+   */
+  struct Statistics
+  {
+    Statistics ();
+    /** Number of packets sent to remote tasks. */
+    uint64_t packetsSent;
+    /** Number of MPI messages sent, with packets or not. */
+    uint64_t mpiMessagesSent;
+    /** Number of MPI messages received. */
+    uint64_t mpiMessagesReceived;
+    /** Number of MPI messages sent without packets. */
+    uint64_t nullMessagesSent;
+    /** Number of Null Messages dropped as they would not raise the guarantee time. */
+    uint64_t nullMessagesSuppressed;
+    /** Number of times the task blocked waiting for remote tasks. */
+    uint64_t blockCount;
+    /** Wall-clock time spent blocked waiting for remote tasks. */
+    Time blockedTime;
+    /** Sum over the MPI messages sent of the guarantee time minus the send time. */
+    Time grantedLookahead;
+    /** Sum over the MPI messages sent of the minimum delay of the bundle. */
+    Time channelLookahead;
+
+    /**
+     * Get the lookahead utilization: the lookahead granted to the remote
+     * tasks relative to the channel delays.  This is 1 for a task which
+     * grants no more than the static lookahead, and more when the
+     * remote tasks are allowed to run further ahead.
+     * \return The lookahead utilization.
+     */
+    double GetLookaheadUtilization (void) const;
+  };
+
+  /**
+   * \return The statistics of this MPI task.
+   */
+  const Statistics & GetStatistics (void) const;
+
+  /**
+   * Print the statistics of this MPI task.
+   * \param [in,out] os The output stream.
+   */
+  void PrintStatistics (std::ostream &os) const;
+
+private:
+  friend class NullMessageEvent;
+  friend class NullMessageMpiInterface;
+  friend class RemoteChannelBundleManager;
+
+  /**
+   * Non blocking receive of pending messages.  
+   */
+  void HandleArrivingMessagesNonBlocking (void);
+
+  /**
+   * Blocking receive of arriving messages.
+   */
+  void HandleArrivingMessagesBlocking (void);
+
+  virtual void DoDispose (void);
+
+  /**
+   * Calculate the look ahead allowable for this MPI task.   Basically
+   * the minimum latency on links to neighbor MPI tasks.
+   */
+  void CalculateLookAhead (void);
+
+  /**
+   * Process the next event on the queue.
+   */
+  void ProcessOneEvent (void);
+
+  /**
+   * \return next local event time.
+   */
+  Time Next (void) const;
+
+  /**
+   * Calculate the SafeTime. Should be called after message receives.
+   */
+  void CalculateSafeTime (void);
+
+  /**
+   * Get the current SafeTime; the maximum time that events can
+   * be processed based on information received from neighboring
+   * MPI tasks.
+   */
+  Time GetSafeTime (void);
+
+  /**
+   * \param bundle Bundle to schedule Null Message event for
+   *
+   * Schedule Null Message event for the specified RemoteChannelBundle.
+   */
+  void ScheduleNullMessageEvent (Ptr<RemoteChannelBundle> bundle);
+
+  /**
+   * \param bundle Bundle to schedule Null Message event for
+   * \return The delay until the next Null Message event for the bundle.
+   */
+  Time GetNullMessageDelay (Ptr<RemoteChannelBundle> bundle) const;
+
+  /**
+   * \param bundle Bundle to reschedule Null Message event for
+   *
+   * Reschedule Null Message event for the specified
+   * RemoteChannelBundel.  Existing event will be canceled.
+   */
+  void RescheduleNullMessageEvent (Ptr<RemoteChannelBundle> bundle);
+
+  /**
+   * \param nodeSysId SystemID to reschedule null event for
+   *
+   * Reschedule Null Message event for the RemoteChannelBundel to the
+   * task nodeSysId.  Existing event will be canceled.
+   */
+  void RescheduleNullMessageEvent (uint32_t nodeSysId);
+
+  /**
+   * \param systemId SystemID to compute guarantee time for
+   *
+   * \return Guarantee time
+   *
+   * Calculate the guarantee time for incoming RemoteChannelBundel
+   * from task nodeSysId.  No message should arrive from task
+   * nodeSysId with a receive time less than the guarantee time.
+   */
+  Time CalculateGuaranteeTime (uint32_t systemId);
+
+  /**
+   * \param bundle remote channel bundle to schedule an event for.
+   *
+   * Null message event handler.   Scheduled to send a null message
+   * for the specified bundle at regular intervals.   Will canceled
+   * and rescheduled when packets are sent.
+   */
+  void NullMessageEventHandler(RemoteChannelBundle* bundle);
+
+  typedef std::list<EventId> DestroyEvents;
+
+  DestroyEvents m_destroyEvents;
+  bool m_stop;
+  Ptr<Scheduler> m_events;
+  uint32_t m_uid;
+  uint32_t m_currentUid;
+  uint64_t m_currentTs;
+  uint32_t m_currentContext;
+  /** The event count. */
+  uint64_t m_eventCount;
+  // number of events that have been inserted but not yet scheduled,
+  // not counting the "destroy" events; this is used for validation
+  int m_unscheduledEvents;
+
+  uint32_t     m_myId;        // MPI Rank
+  uint32_t     m_systemCount; // MPI Size
+
+  /*
+   * The time for which it is safe for this task to execute events
+   * without danger of out-of-order events.
+   */
+  Time m_safeTime;
+
+  /*
+   * Null Message performance tuning parameter.  Controls when Null
+   * messages are sent.  When value is 1 the minimum number of Null
+   * messages are sent conserving bandwidth.  The delay in arrival of
+   * lookahead information is the greatest resulting in maximum
+   * unnecessary blocking of the receiver.  When the value is near 0
+   * Null Messages are sent with high frequency, costing more
+   * bandwidth and Null Message processing time, but there is minimum
+   * unnecessary block of the receiver.
+   */
+  double m_schedulerTune;
+
+  /*
+   * Defer the Null Message events to the next local event.
+   */
+  bool m_adaptiveLookahead;
+
+  /*
+   * Synchronization statistics.
+   */
+  Statistics m_statistics;
+
+  /*
+   * Singleton instance.
+   */
+  static NullMessageSimulatorImpl* g_instance;
+};
+
+} // namespace ns3
+
+#endif /* NULLMESSAGE_SIMULATOR_IMPL_H */
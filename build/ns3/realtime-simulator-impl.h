@@ -0,0 +1,333 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2008 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef REALTIME_SIMULATOR_IMPL_H
+#define REALTIME_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "system-thread.h"
+
+#include "scheduler.h"
+#include "synchronizer.h"
+#include "event-impl.h"
+
+#include "ptr.h"
+#include "assert.h"
+#include "log.h"
+#include "system-mutex.h"
+#include "nstime.h"
+#include "traced-callback.h"
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup realtime
+ * ns3::RealtimeSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \defgroup realtime Realtime Simulator
+ *
+ * Realtime simulator implementation.
+ */
+  
+/**
+ * \ingroup realtime
+ *
+ * Realtime version of SimulatorImpl.
+ *
+ * The events scheduled with ScheduleWithContext() or
+ * ScheduleRealtime*WithContext() from a thread other than the simulator
+ * thread, such as the reader thread of an FdNetDevice, do not take the
+ * simulator mutex: they are pushed on a lock-free inbox, which the
+ * simulator thread moves to the event list before each wait.
+ *
+ * The lateness of each event, the real time elapsed between its
+ * timestamp and the time it is started, is reported by the Lateness
+ * trace source, and accumulated in a histogram reported every
+ * LatenessInterval by the LatenessHistogram trace source.  Bucket 0 of
+ * the histogram counts the events started on time, and bucket \f$i > 0\f$
+ * the events started between \f$2^{i-1}\f$ and \f$2^i\f$ ns late.
+ * The last bucket also counts the later events.
+ */
+class RealtimeSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   * Get the registered TypeId for this class.
+   * \returns The TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * What to do when we can't maintain real time synchrony.
+   */
+  enum SynchronizationMode {
+    /**
+     * Make a best effort to keep synced to real-time.
+     *
+     * If we fall behind, keep going.
+     */
+    SYNC_BEST_EFFORT, 
+    /**
+     * Keep to real time within the hard limit tolerance configured
+     * with SetHardLimit, or die trying.
+     *
+     * Falling behind by more than the hard limit tolerance triggers
+     * a fatal error.
+     * \see SetHardLimit
+     */
+    SYNC_HARD_LIMIT,  
+  };
+
+  /** Number of buckets of the lateness histogram. */
+  static const uint32_t LATENESS_BUCKETS = 40;
+
+  /**
+   * TracedCallback signature for the lateness histogram.
+   * \param [in] histogram The number of events in each bucket.
+   */
+  typedef void (* LatenessHistogramCallback)(const std::vector<uint64_t> &histogram);
+
+  /** Constructor. */
+  RealtimeSimulatorImpl ();
+  /** Destructor. */
+  ~RealtimeSimulatorImpl ();
+
+  // Inherited from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &ev);
+  virtual void Cancel (const EventId &ev);
+  virtual bool IsExpired (const EventId &ev) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /** \copydoc ScheduleWithContext(uint32_t,const Time&,EventImpl*) */
+  void ScheduleRealtimeWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  /** \copydoc Schedule(const Time&,EventImpl*) */
+  void ScheduleRealtime (const Time &delay, EventImpl *event);
+  /**
+   * \copybrief ScheduleNow(EventImpl*)
+   *
+   * \param [in] context Event context.
+   * \param [in] event The event to schedule.
+   */
+  void ScheduleRealtimeNowWithContext (uint32_t context, EventImpl *event);
+  /** \copydoc ScheduleNow(EventImpl*) */
+  void ScheduleRealtimeNow (EventImpl *event);
+  /**
+   * Get the current real time from the synchronizer.
+   * \returns The current real time.
+   */
+  Time RealtimeNow (void) const;
+
+  /**
+   * Set the SynchronizationMode.
+   *
+   * \param [in] mode The new SynchronizationMode.
+   */
+  void SetSynchronizationMode (RealtimeSimulatorImpl::SynchronizationMode mode);
+  /**
+   * Get the SynchronizationMode.
+   * \returns The current SynchronizationMode.
+   */
+  RealtimeSimulatorImpl::SynchronizationMode GetSynchronizationMode (void) const;
+
+  /**
+   * Set the fatal error threshold for SynchronizationMode SYNC_HARD_LIMIT.
+   *
+   * \param [in] limit The maximum amount of real time we are allowed to fall
+   *     behind before we trigger a fatal error.
+   */
+  void SetHardLimit (Time limit);
+  /**
+   * Get the current fatal error threshold for SynchronizationMode
+   * SYNC_HARD_LIMIT.
+   *
+   * \returns The hard limit threshold.
+   */
+  Time GetHardLimit (void) const;
+
+private:
+  /**
+   * Is the simulator running?
+   * \returns \c true if we are running.
+   */
+  bool Running (void) const;
+  /**
+   * Check that the Synchronizer is locked to the real time clock.
+   * \return \c true if the Synchronizer is locked.
+   */
+  bool Realtime (void) const;
+  /**
+   * Get the timestep of the next event.
+   * \returns The timestep of the next event.
+   */
+  uint64_t NextTs (void) const;
+  /** Process the next event. */
+  void ProcessOneEvent (void);
+  /**
+   * Record the lateness of the event about to run.
+   * \param [in] lateness The real time elapsed since the event timestamp,
+   *     in ns.
+   */
+  void RecordLateness (int64_t lateness);
+  /** Fire the LatenessHistogram trace source, and reset the histogram. */
+  void ReportLateness (void);
+
+  /** An event scheduled from another thread, waiting in the inbox. */
+  struct InboxEvent
+  {
+    std::atomic<InboxEvent *> next;     //!< The next event in the inbox.
+    EventImpl *impl;                    //!< The event.
+    uint64_t ts;                        //!< The event timestamp.
+    uint32_t context;                   //!< The event context.
+  };
+  /**
+   * Push an event on the inbox, and wake the simulator thread up.
+   * This is safe to call from any thread, without locking.
+   * \param [in] ts The event timestamp.
+   * \param [in] context The event context.
+   * \param [in] impl The event.
+   */
+  void ScheduleInbox (uint64_t ts, uint32_t context, EventImpl *impl);
+  /**
+   * Link an event at the head of the inbox.
+   * \param [in] event The event.
+   */
+  void PushInbox (InboxEvent *event);
+  /**
+   * Unlink the event at the tail of the inbox.
+   * Must be called with #m_mutex held.
+   * \returns The event, or 0 if the inbox is empty.
+   */
+  InboxEvent * PopInbox (void);
+  /**
+   * Move the events of the inbox to the event list.
+   * Must be called with #m_mutex held.
+   */
+  void DrainInbox (void);
+  /**
+   * Check if the inbox is empty.
+   * Must be called with #m_mutex held.
+   * \returns \c true if the inbox is empty.
+   */
+  bool IsInboxEmpty (void) const;
+  /** Destructor implementation. */
+  virtual void DoDispose (void);
+
+  /** Container type for events to be run at destroy time. */
+  typedef std::list<EventId> DestroyEvents;
+  /** Container for events to be run at destroy time. */
+  DestroyEvents m_destroyEvents;
+  /** Has the stopping condition been reached? */
+  bool m_stop;
+  /**
+   * Is the simulator currently running.
+   *
+   * Atomic, since the threads which schedule events in the inbox read it
+   * without holding #m_mutex.
+   */
+  std::atomic<bool> m_running;
+
+  /**
+   * \name Mutex-protected variables.
+   *
+   * These variables are protected by #m_mutex.
+   */
+  /**@{*/
+  /** The event list. */
+  Ptr<Scheduler> m_events;
+  /**< Number of events in the event list. */
+  int m_unscheduledEvents;
+  /**< Unique id for the next event to be scheduled. */
+  uint32_t m_uid;
+  /**< Unique id of the current event. */
+  uint32_t m_currentUid;
+  /**
+   * Timestep of the current event.
+   *
+   * Written with #m_mutex held, but atomic since the threads which
+   * schedule events in the inbox read it without holding #m_mutex.
+   */
+  std::atomic<uint64_t> m_currentTs;
+  /**< Execution context. */
+  uint32_t m_currentContext;  
+  /** The event count. */
+  uint64_t m_eventCount;
+  /** The consumer end of the inbox. */
+  InboxEvent *m_inboxTail;
+  /**@}*/
+
+  /**
+   * The producer end of the inbox, a Vyukov multiple-producer
+   * single-consumer intrusive list.
+   */
+  std::atomic<InboxEvent *> m_inboxHead;
+  /** The inbox placeholder, linked when the inbox is drained. */
+  InboxEvent m_inboxStub;
+
+  /** Mutex to control access to key state. */  
+  mutable SystemMutex m_mutex;  
+
+  /** The synchronizer in use to track real time. */
+  Ptr<Synchronizer> m_synchronizer;
+
+  /** SynchronizationMode policy. */
+  SynchronizationMode m_synchronizationMode;
+
+  /** The maximum allowable drift from real-time in SYNC_HARD_LIMIT mode. */
+  Time m_hardLimit;
+
+  /** Main SystemThread. */
+  SystemThread::ThreadId m_main;
+
+  /** The lateness histogram since the last report. */
+  std::vector<uint64_t> m_lateness;
+  /** The interval between the reports of the lateness histogram. */
+  Time m_latenessInterval;
+  /** The timestamp of the next report of the lateness histogram. */
+  uint64_t m_nextLatenessReport;
+  /** Trace of the lateness of each event. */
+  TracedCallback<Time> m_latenessTrace;
+  /** Trace of the lateness histogram. */
+  TracedCallback<const std::vector<uint64_t> &> m_latenessHistogramTrace;
+};
+
+} // namespace ns3
+
+#endif /* REALTIME_SIMULATOR_IMPL_H */
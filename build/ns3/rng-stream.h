@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+//  Copyright (C) 2001  Pierre L'Ecuyer (lecuyer@iro.umontreal.ca)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+// Modified for ns-3 by: Rajib Bhattacharjea<raj.b@gatech.edu>
+
+#ifndef RNGSTREAM_H
+#define RNGSTREAM_H
+#include <string>
+#include <stdint.h>
+#include <cstddef>
+
+/**
+ * \file
+ * \ingroup rngimpl
+ * ns3::RngStream declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup randomvariable
+ * \defgroup rngimpl RNG Implementation
+ */
+  
+/**
+ * \ingroup rngimpl
+ *
+ * \brief Combined Multiple-Recursive Generator MRG32k3a, or
+ * counter-based generator Philox4x64-10.
+ *
+ * By default this class is the combined multiple-recursive random number
+ * generator called MRG32k3a.  The ns3::RandomVariableBase class
+ * holds a static instance of this class.  The details of this
+ * class are explained in:
+ * http://www.iro.umontreal.ca/~lecuyer/myftp/papers/streams00.pdf
+ *
+ * The streams and substreams of MRG32k3a are reached by sequential
+ * jumps from the seed, so the stream of a random variable depends on
+ * the number of streams allocated before it.  The alternative PHILOX
+ * type is the counter-based generator Philox4x64-10 from:
+ * J. K. Salmon, M. A. Moraes, R. O. Dror and D. E. Shaw, "Parallel
+ * random numbers: as easy as 1, 2, 3", SC'11.
+ * Its n-th random is a bijection of n, keyed by the seed, run and
+ * context, and the stream index, so any stream is available without
+ * any jump, and Advance() is O(1).
+ */
+class RngStream
+{
+public:
+  /** The generator algorithms. */
+  enum Type
+  {
+    MRG32K3A,  //!< Combined multiple-recursive generator MRG32k3a.
+    PHILOX     //!< Counter-based generator Philox4x64-10.
+  };
+  /** The size of the state vector, see GetState(). */
+  static const int STATE_SIZE = 6;
+
+  /**
+   * Construct a MRG32k3a generator from explicit seed, stream and
+   * substream values.
+   *
+   * \param [in] seed The starting seed.
+   * \param [in] stream The stream number.
+   * \param [in] substream The sub-stream number.
+   */
+  RngStream (uint32_t seed, uint64_t stream, uint64_t substream);
+  /**
+   * Construct a Philox4x64-10 generator from its key.
+   *
+   * Each distinct key is an independent stream.
+   *
+   * \param [in] seed The seed.
+   * \param [in] run The run number.
+   * \param [in] stream The stream number.
+   * \param [in] context The context of the stream.
+   */
+  RngStream (uint32_t seed, uint64_t run, uint64_t stream, uint32_t context);
+  /**
+   * Copy constructor.
+   *
+   * \param [in] r The RngStream to copy.
+   */
+  RngStream (const RngStream & r);
+  /**
+   * Get the generator algorithm.
+   *
+   * \returns The generator type.
+   */
+  Type GetType (void) const;
+  /**
+   * Generate the next random number for this stream.
+   * Uniformly distributed between 0 and 1.
+   *
+   * \returns The next random.
+   */
+  double RandU01 (void);
+  /**
+   * Generate the next \p n random numbers for this stream.
+   *
+   * This is the same sequence as \p n calls to RandU01(void),
+   * but the state is kept in registers for the whole batch.
+   *
+   * \param [out] u The array to fill with the randoms.
+   * \param [in] n The number of randoms to generate.
+   */
+  void RandU01 (double *u, std::size_t n);
+  /**
+   * Skip the next \p n random numbers of this stream.
+   *
+   * This is O(1) for PHILOX and O(log n) matrix products for
+   * MRG32K3A.
+   *
+   * \param [in] n The number of randoms to skip.
+   */
+  void Advance (uint64_t n);
+  /**
+   * Get the current state of the generator.
+   *
+   * The MRG32K3A state is the six components of the recursion.  The
+   * PHILOX state is the two words of the key, the stream number and
+   * the number of randoms generated, followed by two zeros.
+   *
+   * \param [out] state The state vector.
+   */
+  void GetState (uint64_t state[STATE_SIZE]) const;
+  /**
+   * Set the current state of the generator.
+   *
+   * \param [in] state A state vector previously returned by GetState()
+   * for a generator of the same type.
+   */
+  void SetState (const uint64_t state[STATE_SIZE]);
+
+private:
+  /**
+   * Advance \p state of the RNG by leaps and bounds.
+   *
+   * \param [in] nth The stream or substream index.
+   * \param [in] by The log2 base of \p nth.
+   * \param [in] state The state vector to advance.
+   */
+  void AdvanceNthBy (uint64_t nth, int by, double state[6]);
+  /**
+   * Generate the next Philox4x64-10 random.
+   *
+   * \returns The next random.
+   */
+  double PhiloxRandU01 (void);
+  /** Compute the Philox4x64-10 block of m_position. */
+  void PhiloxBlock (void);
+
+  /** The generator algorithm. */
+  Type m_type;
+
+  /** The MRG32k3a state vector. */
+  double m_currentState[6];
+
+  /** The Philox key: the seed and context, and the run. */
+  uint64_t m_key[2];
+  /** The Philox stream number, the second word of the counter. */
+  uint64_t m_stream;
+  /**
+   * The number of randoms generated by Philox; the first word of the
+   * counter is m_position / 4.
+   */
+  uint64_t m_position;
+  /** The Philox block containing the random m_position, if valid. */
+  uint64_t m_block[4];
+  /** Whether m_block is the block of m_position. */
+  bool m_blockValid;
+};
+
+} // namespace ns3
+
+#endif
+ 
+
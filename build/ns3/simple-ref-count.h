@@ -0,0 +1,251 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2007 Georgia Tech Research Corporation, INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: George Riley <riley@ece.gatech.edu>
+ *          Gustavo Carneiro <gjcarneiro@gmail.com>,
+ *          Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
+ */
+#ifndef SIMPLE_REF_COUNT_H
+#define SIMPLE_REF_COUNT_H
+
+#include "ns3/core-config.h"
+#include "empty.h"
+#include "default-deleter.h"
+#include "assert.h"
+#include "unused.h"
+#include <stdint.h>
+#include <limits>
+#include <atomic>
+
+/**
+ * \file
+ * \ingroup ptr
+ * ns3::SimpleRefCount declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup ptr
+ * \brief Reference count policy of SimpleRefCount for objects used by
+ * a single thread at a time.
+ */
+struct NonAtomicRefCountPolicy
+{
+  /** The type of the reference count. */
+  typedef uint32_t Counter;
+  /**
+   * Increment a reference count.
+   * \param [in,out] count The reference count.
+   */
+  static inline void Increment (Counter &count)
+  {
+    count++;
+  }
+  /**
+   * Decrement a reference count.
+   * \param [in,out] count The reference count.
+   * \returns \c true if this removed the last reference.
+   */
+  static inline bool Decrement (Counter &count)
+  {
+    return --count == 0;
+  }
+  /**
+   * Read a reference count.
+   * \param [in] count The reference count.
+   * \returns The reference count.
+   */
+  static inline uint32_t Get (const Counter &count)
+  {
+    return count;
+  }
+};
+
+/**
+ * \ingroup ptr
+ * \brief Reference count policy of SimpleRefCount for objects whose Ptr
+ * are copied and released from several threads.
+ *
+ * Increments are relaxed.  The decrement which removes the last
+ * reference synchronizes with the other decrements, so that the
+ * deleter sees every write made through the released references.
+ */
+struct AtomicRefCountPolicy
+{
+  /** The type of the reference count. */
+  typedef std::atomic<uint32_t> Counter;
+  /**
+   * Increment a reference count.
+   * \param [in,out] count The reference count.
+   */
+  static inline void Increment (Counter &count)
+  {
+    count.fetch_add (1, std::memory_order_relaxed);
+  }
+  /**
+   * Decrement a reference count.
+   * \param [in,out] count The reference count.
+   * \returns \c true if this removed the last reference.
+   */
+  static inline bool Decrement (Counter &count)
+  {
+    if (count.fetch_sub (1, std::memory_order_release) == 1)
+      {
+        std::atomic_thread_fence (std::memory_order_acquire);
+        return true;
+      }
+    return false;
+  }
+  /**
+   * Read a reference count.
+   * \param [in] count The reference count.
+   * \returns The reference count.
+   */
+  static inline uint32_t Get (const Counter &count)
+  {
+    return count.load (std::memory_order_relaxed);
+  }
+};
+
+/**
+ * \ingroup ptr
+ * The reference count policy of SimpleRefCount, and so of Object and
+ * Packet: AtomicRefCountPolicy when configured with
+ * \c --enable-atomic-refcount, NonAtomicRefCountPolicy otherwise.
+ */
+#ifdef NS3_ATOMIC_REFCOUNT
+typedef AtomicRefCountPolicy DefaultRefCountPolicy;
+#else
+typedef NonAtomicRefCountPolicy DefaultRefCountPolicy;
+#endif
+
+/**
+ * \ingroup ptr
+ * \brief A template-based reference counting class
+ *
+ * This template can be used to give reference-counting powers
+ * to a class. This template does not require this class to
+ * have a virtual destructor or a specific (or any) parent class.
+ * 
+ * \note If you are moving to this template from the RefCountBase class,
+ * you need to be careful to mark appropriately your destructor virtual
+ * if needed. i.e., if your class has subclasses, _do_ mark your destructor
+ * virtual.
+ *
+ *
+ * This template takes 4 arguments but only the first argument is
+ * mandatory:
+ *
+ * \tparam T \explicit The typename of the subclass which derives
+ *      from this template class. Yes, this is weird but it's a
+ *      common C++ template pattern whose name is CRTP (Curiously
+ *      Recursive Template Pattern)
+ * \tparam PARENT \explicit The typename of the parent of this template.
+ *      By default, this typename is "'ns3::empty'" which is an empty
+ *      class: compilers which implement the RBCO optimization (empty
+ *      base class optimization) will make this a no-op
+ * \tparam DELETER \explicit The typename of a class which implements
+ *      a public static method named 'Delete'. This method will be called
+ *      whenever the SimpleRefCount template detects that no references
+ *      to the object it manages exist anymore.
+ * \tparam POLICY \explicit The reference count policy,
+ *      NonAtomicRefCountPolicy or AtomicRefCountPolicy.  By default,
+ *      DefaultRefCountPolicy, chosen at configure time.  The atomic
+ *      policy makes copying and releasing Ptr thread-safe; it does not
+ *      make the object itself thread-safe.
+ *
+ * Interesting users of this class include ns3::Object as well as ns3::Packet.
+ */
+template <typename T, typename PARENT = empty, typename DELETER = DefaultDeleter<T>,
+          typename POLICY = DefaultRefCountPolicy>
+class SimpleRefCount : public PARENT
+{
+public:
+  /** Default constructor.  */
+  SimpleRefCount ()
+    : m_count (1)
+  {}
+  /**
+   * Copy constructor
+   * \param [in] o The object to copy into this one.
+   */
+  SimpleRefCount (const SimpleRefCount &o)
+    : m_count (1)
+  {
+    NS_UNUSED (o);
+  }
+  /**
+   * Assignment operator
+   * \param [in] o The object to copy
+   * \returns The copy of \p o
+   */
+  SimpleRefCount &operator = (const SimpleRefCount &o)
+  {
+    NS_UNUSED (o);
+    return *this;
+  }
+  /**
+   * Increment the reference count. This method should not be called
+   * by user code. SimpleRefCount instances are expected to be used in
+   * conjunction with the Ptr template which would make calling Ref
+   * unnecessary and dangerous.
+   */
+  inline void Ref (void) const
+  {
+    NS_ASSERT (POLICY::Get (m_count) < std::numeric_limits<uint32_t>::max());
+    POLICY::Increment (m_count);
+  }
+  /**
+   * Decrement the reference count. This method should not be called
+   * by user code. SimpleRefCount instances are expected to be used in 
+   * conjunction with the Ptr template which would make calling Ref
+   * unnecessary and dangerous.
+   */
+  inline void Unref (void) const
+  {
+    if (POLICY::Decrement (m_count))
+      {
+        DELETER::Delete (static_cast<T*> (const_cast<SimpleRefCount *> (this)));
+      }
+  }
+
+  /**
+   * Get the reference count of the object.
+   * Normally not needed; for language bindings.
+   *
+   * \return The reference count.
+   */
+  inline uint32_t GetReferenceCount (void) const
+  {
+    return POLICY::Get (m_count);
+  }
+
+private:
+  /**
+   * The reference count.
+   *
+   * \internal
+   * Note we make this mutable so that the const methods can still
+   * change it.
+   */
+  mutable typename POLICY::Counter m_count;
+};
+
+} // namespace ns3
+
+#endif /* SIMPLE_REF_COUNT_H */
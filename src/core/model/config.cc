@@ -24,8 +24,12 @@
 #include "object-ptr-container.h"
 #include "names.h"
 #include "pointer.h"
+#include "simple-ref-count.h"
 #include "log.h"
 
+#include <algorithm>
+#include <atomic>
+#include <map>
 #include <sstream>
 
 /**
@@ -150,6 +154,8 @@ MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &
 /**
  * \ingroup config-impl
  * Helper to test if an array entry matches a config path specification.
+ *
+ * The specification is parsed once, into a set of index ranges.
  */
 class ArrayMatcher
 {
@@ -167,7 +173,22 @@ public:
    * \returns \c true if the index matches the Config Path.
    */
   bool Matches (std::size_t i) const;
+  /**
+   * Get the matching indices of an array.
+   *
+   * \param [in] n The size of the array.
+   * \param [out] indices The matching indices lower than \p n, in
+   *              increasing order.
+   * \returns \c false if every index matches.
+   */
+  bool GetIndices (std::size_t n, std::vector<std::size_t> &indices) const;
 private:
+  /**
+   * Parse a Config path specification.
+   *
+   * \param [in] element The Config path specification.
+   */
+  void Parse (std::string element);
   /**
    * Convert a string to an \c uint32_t.
    *
@@ -178,79 +199,106 @@ private:
   bool StringToUint32 (std::string str, uint32_t *value) const;
   /** The Config path element. */
   std::string m_element;
+  /** Does every index match? */
+  bool m_all;
+  /** The matching index ranges, bounds included. */
+  std::vector<std::pair<uint32_t, uint32_t> > m_ranges;
 
 };  // class ArrayMatcher
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_element (element),
+    m_all (false)
 {
   NS_LOG_FUNCTION (this << element);
+  Parse (element);
 }
-bool
-ArrayMatcher::Matches (std::size_t i) const
+void
+ArrayMatcher::Parse (std::string element)
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      m_all = true;
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      Parse (element.substr (0, tmp-0));
+      Parse (element.substr (tmp+1, element.size () - (tmp + 1)));
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min) && 
           StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
-        }
-      else
+          min <= max)
         {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          m_ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (StringToUint32 (element, &value))
+    {
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (std::size_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_all)
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+      NS_LOG_DEBUG ("Array "<<i<<" matches *");
       return true;
     }
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator r = m_ranges.begin ();
+       r != m_ranges.end (); ++r)
+    {
+      if (i >= r->first && i <= r->second)
+        {
+          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+          return true;
+        }
+    }
   NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
   return false;
 }
 
+bool
+ArrayMatcher::GetIndices (std::size_t n, std::vector<std::size_t> &indices) const
+{
+  NS_LOG_FUNCTION (this << n << &indices);
+  indices.clear ();
+  if (m_all)
+    {
+      return false;
+    }
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator r = m_ranges.begin ();
+       r != m_ranges.end (); ++r)
+    {
+      for (std::size_t i = r->first; i <= r->second && i < n; ++i)
+        {
+          indices.push_back (i);
+        }
+    }
+  std::sort (indices.begin (), indices.end ());
+  indices.erase (std::unique (indices.begin (), indices.end ()), indices.end ());
+  return true;
+}
+
 bool
 ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
 {
@@ -261,6 +309,123 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
   return !iss.bad () && !iss.fail ();
 }
 
+/**
+ * \ingroup config-impl
+ * An attribute of an object which a Config path can follow.
+ */
+struct PathAttribute
+{
+  /** The attribute name. */
+  std::string name;
+  /** The attribute accessor. */
+  Ptr<const AttributeAccessor> accessor;
+  /** The container accessor, if the attribute is a container. */
+  const ObjectPtrContainerAccessor *container;
+  /** Is the attribute a container, rather than a pointer? */
+  bool isContainer;
+};
+
+/**
+ * \ingroup config-impl
+ * A Config path element, parsed once.
+ */
+struct PathToken
+{
+  /**
+   * Parse a path element.
+   *
+   * \param [in] element The path element.
+   */
+  PathToken (std::string element);
+
+  /** The path element. */
+  std::string item;
+  /** Is the element a GetObject (\c $TypeId) call? */
+  bool isGetObject;
+  /** Was the TypeId of a GetObject element found? */
+  bool hasTid;
+  /** The TypeId of a GetObject element. */
+  TypeId tid;
+  /** The element, when it follows a container. */
+  ArrayMatcher matcher;
+  /** The attributes matching the element, indexed by instance TypeId uid. */
+  std::map<uint16_t, std::vector<PathAttribute> > attributes;
+};
+
+PathToken::PathToken (std::string element)
+  : item (element),
+    isGetObject (element.find ("$") == 0),
+    hasTid (false),
+    matcher (element)
+{
+  if (isGetObject)
+    {
+      hasTid = TypeId::LookupByNameFailSafe (element.substr (1, element.size () - 1), &tid);
+    }
+}
+
+/**
+ * \ingroup config-impl
+ * A compiled Config path, and the cache of its matches.
+ */
+class PathImpl : public SimpleRefCount<PathImpl>
+{
+public:
+  /**
+   * Compile a path.
+   *
+   * \param [in] path The Config path.
+   */
+  PathImpl (std::string path);
+
+  /** The Config path. */
+  std::string m_path;
+  /** The path elements. */
+  std::vector<PathToken> m_tokens;
+  /** The objects matching the whole path. */
+  MatchContainer m_matches;
+  /** The generation of #m_matches, or zero if it is not valid. */
+  uint64_t m_matchesGeneration;
+  /** The objects matching the path, but its last element. */
+  MatchContainer m_parents;
+  /** The generation of #m_parents, or zero if it is not valid. */
+  uint64_t m_parentsGeneration;
+};
+
+PathImpl::PathImpl (std::string path)
+  : m_path (path),
+    m_matchesGeneration (0),
+    m_parentsGeneration (0)
+{
+  NS_LOG_FUNCTION (this << path);
+
+  // ensure that we start and end with a '/', then split between them.
+  std::string canonical = path;
+  if (canonical.find ("/") != 0)
+    {
+      canonical = "/" + canonical;
+    }
+  if (canonical.find_last_of ("/") != (canonical.size () - 1))
+    {
+      canonical = canonical + "/";
+    }
+  std::string::size_type start = 1;
+  std::string::size_type next;
+  while ((next = canonical.find ("/", start)) != std::string::npos)
+    {
+      m_tokens.push_back (PathToken (canonical.substr (start, next - start)));
+      start = next + 1;
+    }
+}
+
+/**
+ * The generation of the object graph, for the Path caches.
+ *
+ * Atomic, since objects can be disposed by the partition threads of
+ * a parallel simulator.
+ */
+static std::atomic<uint64_t> g_pathGeneration (1);
+
 /**
  * \ingroup config-impl
  * Abstract class to parse Config paths into object references.
@@ -269,11 +434,12 @@ class Resolver
 {
 public:
   /**
-   * Construct from a base Config path.
+   * Construct from a compiled Config path.
    *
-   * \param [in] path The Config path.
+   * \param [in] tokens The Config path elements.
+   * \param [in] count The number of elements to resolve.
    */
-  Resolver (std::string path);
+  Resolver (std::vector<PathToken> &tokens, std::size_t count);
   /** Destructor. */
   virtual ~Resolver ();
 
@@ -287,23 +453,30 @@ public:
   void Resolve (Ptr<Object> root);
   
 private:
-  /** Ensure the Config path starts and ends with a '/'. */
-  void Canonicalize (void);
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] i The index of the next path element.
    * \param [in] root The object corresponding to the current position
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (std::size_t i, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
-   * \param [in,out] vector The resulting list of matching objects.
+   * \param [in] i The index of the next path element.
+   * \param [in] root The object holding the container.
+   * \param [in] attribute The container attribute.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (std::size_t i, Ptr<Object> root, const PathAttribute &attribute);
+  /**
+   * Get the attributes of an object matching a path element.
+   *
+   * \param [in] token The path element.
+   * \param [in] tid The instance TypeId of the object.
+   * \returns The pointer and container attributes matching the element.
+   */
+  const std::vector<PathAttribute> & GetAttributes (PathToken &token, TypeId tid);
   /**
    * Handle one object found on the path.
    *
@@ -326,47 +499,30 @@ private:
 
   /** Current list of path tokens. */
   std::vector<std::string> m_workStack;
-  /** The Config path. */
-  std::string m_path;
+  /** The Config path elements. */
+  std::vector<PathToken> &m_tokens;
+  /** The number of elements to resolve. */
+  std::size_t m_count;
 
 };  // class Resolver
 
-Resolver::Resolver (std::string path)
-  : m_path (path)
+Resolver::Resolver (std::vector<PathToken> &tokens, std::size_t count)
+  : m_tokens (tokens),
+    m_count (count)
 {
-  NS_LOG_FUNCTION (this << path);
-  Canonicalize ();
+  NS_LOG_FUNCTION (this << &tokens << count);
 }
 Resolver::~Resolver ()
 {
   NS_LOG_FUNCTION (this);
 }
-void
-Resolver::Canonicalize (void)
-{
-  NS_LOG_FUNCTION (this);
-
-  // ensure that we start and end with a '/'
-  std::string::size_type tmp = m_path.find ("/");
-  if (tmp != 0)
-    {
-      // no slash at start
-      m_path = "/" + m_path;
-    }
-  tmp = m_path.find_last_of ("/");
-  if (tmp != (m_path.size () - 1))
-    {
-      // no slash at end
-      m_path = m_path + "/";
-    }
-}
 
 void 
 Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -391,14 +547,62 @@ Resolver::DoResolveOne (Ptr<Object> object)
   DoOne (object, GetResolvedPath ());
 }
 
-void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+const std::vector<PathAttribute> &
+Resolver::GetAttributes (PathToken &token, TypeId tid)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << token.item << tid);
+
+  std::map<uint16_t, std::vector<PathAttribute> >::const_iterator found =
+    token.attributes.find (tid.GetUid ());
+  if (found != token.attributes.end ())
+    {
+      return found->second;
+    }
+
+  std::vector<PathAttribute> &attributes = token.attributes[tid.GetUid ()];
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info;
+          info = tid.GetAttribute (i);
+          if (info.name != token.item && token.item != "*")
+            {
+              continue;
+            }
+          PathAttribute attribute;
+          attribute.name = info.name;
+          attribute.accessor = info.accessor;
+          attribute.container = 0;
+          // attempt to cast to a pointer checker.
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.isContainer = false;
+              attributes.push_back (attribute);
+            }
+          // attempt to cast to an object vector.
+          else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.isContainer = true;
+              attribute.container =
+                dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (info.accessor));
+              attributes.push_back (attribute);
+            }
+          // this could be anything else and we don't know what to do with it.
+          // So, we just ignore it.
+        }
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return attributes;
+}
 
-  if (next == std::string::npos)
+void
+Resolver::DoResolve (std::size_t i, Ptr<Object> root)
+{
+  NS_LOG_FUNCTION (this << i << root);
+  if (i == m_count)
     {
       //
       // If root is zero, we're beginning to see if we can use the object name 
@@ -414,8 +618,8 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  PathToken &token = m_tokens[i];
+  const std::string &item = token.item;
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -426,11 +630,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      if (item.compare (0, 5, "Names") == 0)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (i + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -447,7 +650,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (i + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -463,83 +666,63 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       return;
     }
-  std::string::size_type dollarPos = item.find ("$");
-  if (dollarPos == 0)
+  if (token.isGetObject)
     {
       // This is a call to GetObject
-      std::string tidString = item.substr (1, item.size () - 1);
-      NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
-      Ptr<Object> object = root->GetObject<Object> (tid);
+      NS_LOG_DEBUG ("GetObject="<<item<<" on path="<<GetResolvedPath ());
+      if (!token.hasTid)
+        {
+          // fails with the usual error.
+          TypeId::LookupByName (item.substr (1, item.size () - 1));
+        }
+      Ptr<Object> object = root->GetObject<Object> (token.tid);
       if (object == 0)
         {
-          NS_LOG_DEBUG ("GetObject ("<<tidString<<") failed on path="<<GetResolvedPath ());
+          NS_LOG_DEBUG ("GetObject ("<<item<<") failed on path="<<GetResolvedPath ());
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (i + 1, object);
       m_workStack.pop_back ();
     }
   else 
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
-      bool foundMatch = false;
-      
-      do
+      const std::vector<PathAttribute> &attributes =
+        GetAttributes (token, root->GetInstanceTypeId ());
+      for (std::vector<PathAttribute>::const_iterator j = attributes.begin ();
+           j != attributes.end (); ++j)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          if (!j->isContainer)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
-                {
-                  continue;
-                }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *pChecker = dynamic_cast<const PointerChecker *> (PeekPointer(info.checker));
-              if (pChecker != 0)
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<j->name<<" on path="<<GetResolvedPath ());
+              PointerValue pValue;
+              if (!j->accessor->HasGetter () || !j->accessor->Get (PeekPointer (root), pValue))
                 {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue pValue;
-                  root->GetAttribute (info.name, pValue);
-                  Ptr<Object> object = pValue.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
+                  root->GetAttribute (j->name, pValue);
                 }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
+              Ptr<Object> object = pValue.Get<Object> ();
+              if (object == 0)
                 {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
+                  NS_LOG_ERROR ("Requested object name=\""<<item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
+                  continue;
                 }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              m_workStack.push_back (j->name);
+              DoResolve (i + 1, object);
+              m_workStack.pop_back ();
             }
-
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<j->name<<" on path="<<GetResolvedPath ());
+              m_workStack.push_back (j->name);
+              DoArrayResolve (i + 1, root, *j);
+              m_workStack.pop_back ();
+            }
+        }
       
-      if (!foundMatch)
+      if (attributes.empty ())
         {
           NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
           return;
@@ -548,32 +731,75 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (std::size_t i, Ptr<Object> root, const PathAttribute &attribute)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION(this << i << root << attribute.name);
+  if (i == m_count)
     {
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const ArrayMatcher &matcher = m_tokens[i].matcher;
 
-  ArrayMatcher matcher = ArrayMatcher (item);
-  ObjectPtrContainerValue::Iterator it;
-  for (it = container.Begin (); it != container.End (); ++it)
+  //
+  // The matching objects are visited in increasing index order.  When the
+  // path selects some indices, and the container returns its objects by
+  // index, pick them directly rather than walking the whole container.
+  //
+  std::map<std::size_t, Ptr<Object> > matches;
+  std::size_t n;
+  if (attribute.container != 0 && attribute.container->GetN (PeekPointer (root), &n))
     {
-      if (matcher.Matches ((*it).first))
+      std::vector<std::size_t> indices;
+      bool direct = matcher.GetIndices (n, indices);
+      for (std::vector<std::size_t>::const_iterator k = indices.begin ();
+           direct && k != indices.end (); ++k)
         {
-          std::ostringstream oss;
-          oss << (*it).first;
-          m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
-          m_workStack.pop_back ();
+          std::size_t index;
+          Ptr<Object> object = attribute.container->GetItem (PeekPointer (root), *k, &index);
+          if (index != *k)
+            {
+              // The container is not indexed by position.
+              direct = false;
+              matches.clear ();
+              break;
+            }
+          matches[index] = object;
+        }
+      if (!direct)
+        {
+          for (std::size_t k = 0; k < n; k++)
+            {
+              std::size_t index;
+              Ptr<Object> object = attribute.container->GetItem (PeekPointer (root), k, &index);
+              if (matcher.Matches (index))
+                {
+                  matches[index] = object;
+                }
+            }
+        }
+    }
+  else
+    {
+      ObjectPtrContainerValue container;
+      root->GetAttribute (attribute.name, container);
+      for (ObjectPtrContainerValue::Iterator it = container.Begin (); it != container.End (); ++it)
+        {
+          if (matcher.Matches ((*it).first))
+            {
+              matches[(*it).first] = (*it).second;
+            }
         }
     }
+
+  for (std::map<std::size_t, Ptr<Object> >::const_iterator it = matches.begin ();
+       it != matches.end (); ++it)
+    {
+      std::ostringstream oss;
+      oss << (*it).first;
+      m_workStack.push_back (oss.str ());
+      DoResolve (i + 1, (*it).second);
+      m_workStack.pop_back ();
+    }
 }
 
 /**
@@ -595,6 +821,15 @@ public:
   void Disconnect (std::string path, const CallbackBase &cb);
   /** \copydoc Config::LookupMatches() */
   MatchContainer LookupMatches (std::string path);
+  /**
+   * Get the objects matching the first elements of a compiled path.
+   * \param [in] tokens The path elements.
+   * \param [in] count The number of elements to match.
+   * \param [in] path The path, for the MatchContainer.
+   * \returns The matching objects.
+   */
+  MatchContainer LookupMatches (std::vector<PathToken> &tokens, std::size_t count,
+                                std::string path);
 
   /** \copydoc Config::RegisterRootNamespaceObject() */
   void RegisterRootNamespaceObject (Ptr<Object> obj);
@@ -717,11 +952,19 @@ MatchContainer
 ConfigImpl::LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
+  PathImpl compiled (path);
+  return LookupMatches (compiled.m_tokens, compiled.m_tokens.size (), path);
+}
+
+MatchContainer 
+ConfigImpl::LookupMatches (std::vector<PathToken> &tokens, std::size_t count, std::string path)
+{
+  NS_LOG_FUNCTION (this << &tokens << count << path);
   class LookupMatchesResolver : public Resolver 
   {
   public:
-    LookupMatchesResolver (std::string path)
-      : Resolver (path)
+    LookupMatchesResolver (std::vector<PathToken> &tokens, std::size_t count)
+      : Resolver (tokens, count)
     {}
     virtual void DoOne (Ptr<Object> object, std::string path)
     {
@@ -730,7 +973,7 @@ ConfigImpl::LookupMatches (std::string path)
     }
     std::vector<Ptr<Object> > m_objects;
     std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+  } resolver = LookupMatchesResolver (tokens, count);
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
@@ -751,6 +994,7 @@ ConfigImpl::RegisterRootNamespaceObject (Ptr<Object> obj)
 {
   NS_LOG_FUNCTION (this << obj);
   m_roots.push_back (obj);
+  InvalidatePathCache ();
 }
 
 void 
@@ -763,6 +1007,7 @@ ConfigImpl::UnregisterRootNamespaceObject (Ptr<Object> obj)
       if (*i == obj)
         {
           m_roots.erase (i);
+          InvalidatePathCache ();
           return;
         }
     }
@@ -782,6 +1027,113 @@ ConfigImpl::GetRootNamespaceObject (std::size_t i) const
 }
 
 
+Path::Path (std::string path)
+  : m_impl (Create<PathImpl> (path))
+{
+  NS_LOG_FUNCTION (this << path);
+}
+Path::Path (const Path &o)
+  : m_impl (o.m_impl)
+{
+  NS_LOG_FUNCTION (this << &o);
+}
+Path &
+Path::operator = (const Path &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  m_impl = o.m_impl;
+  return *this;
+}
+Path::~Path ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+Path::GetPath (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_impl->m_path;
+}
+
+MatchContainer
+Path::LookupMatches (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_impl->m_matchesGeneration != g_pathGeneration)
+    {
+      m_impl->m_matches = ConfigImpl::Get ()->LookupMatches (m_impl->m_tokens,
+                                                             m_impl->m_tokens.size (),
+                                                             m_impl->m_path);
+      m_impl->m_matchesGeneration = g_pathGeneration;
+    }
+  return m_impl->m_matches;
+}
+
+MatchContainer &
+Path::LookupParents (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (!m_impl->m_tokens.empty (), "Config path " << m_impl->m_path << " has no leaf");
+  if (m_impl->m_parentsGeneration != g_pathGeneration)
+    {
+      std::string path = m_impl->m_path;
+      path = path.substr (0, path.find_last_of ("/"));
+      m_impl->m_parents = ConfigImpl::Get ()->LookupMatches (m_impl->m_tokens,
+                                                             m_impl->m_tokens.size () - 1,
+                                                             path);
+      m_impl->m_parentsGeneration = g_pathGeneration;
+      if (m_impl->m_parents.GetN () == 0)
+        {
+          NS_LOG_WARN ("No object matches the Config path " << m_impl->m_path);
+        }
+    }
+  return m_impl->m_parents;
+}
+
+void
+Path::Set (const AttributeValue &value)
+{
+  NS_LOG_FUNCTION (this << &value);
+  MatchContainer &parents = LookupParents ();
+  parents.Set (m_impl->m_tokens.back ().item, value);
+}
+void
+Path::Connect (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  MatchContainer &parents = LookupParents ();
+  parents.Connect (m_impl->m_tokens.back ().item, cb);
+}
+void
+Path::ConnectWithoutContext (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  MatchContainer &parents = LookupParents ();
+  parents.ConnectWithoutContext (m_impl->m_tokens.back ().item, cb);
+}
+void
+Path::Disconnect (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  MatchContainer &parents = LookupParents ();
+  parents.Disconnect (m_impl->m_tokens.back ().item, cb);
+}
+void
+Path::DisconnectWithoutContext (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  MatchContainer &parents = LookupParents ();
+  parents.DisconnectWithoutContext (m_impl->m_tokens.back ().item, cb);
+}
+
+void InvalidatePathCache (void)
+{
+  // Not logged: this is called for every aggregation and disposal,
+  // and at exit.
+  g_pathGeneration.fetch_add (1, std::memory_order_relaxed);
+}
+
 void Reset (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
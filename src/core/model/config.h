@@ -36,6 +36,10 @@ class AttributeValue;
 class Object;
 class CallbackBase;
 
+namespace Config {
+class PathImpl;
+} // namespace Config
+
 /**
  * \ingroup core
  * \defgroup config Configuration
@@ -250,6 +254,101 @@ private:
   std::string m_path;
 };
 
+/**
+ * \ingroup config
+ * \brief A Config path, parsed once, with a cache of the matching objects.
+ *
+ * Config::Set, Config::Connect and Config::LookupMatches parse their
+ * path and walk the object graph on every call.  A Path parses its
+ * path once: the wildcards and the array matchers are compiled, and the
+ * attributes matching each path element are indexed by TypeId.  The
+ * set of objects matched by the path is cached, and reused by the
+ * following operations, until Config::InvalidatePathCache is called.
+ * This happens when a node or a channel is created, when a device or an
+ * application is added to a node, when objects are aggregated or
+ * disposed, and when the root namespace objects or the object names
+ * change.  Other changes of the object graph, such as the addition of
+ * an interface to an IP stack, are not tracked: call
+ * Config::InvalidatePathCache after them.
+ *
+ * The last element of the path names the attribute or the trace source
+ * for Set and Connect, and is part of the match for LookupMatches:
+ *
+ * \code
+ *   Config::Path mtu ("/NodeList/[0-99]/DeviceList/0/Mtu");
+ *   mtu.Set (UintegerValue (1400));
+ * \endcode
+ */
+class Path
+{
+public:
+  /**
+   * Compile a path.
+   * \param [in] path The Config path.
+   */
+  Path (std::string path);
+  /**
+   * Copy constructor.  The copies share the cache.
+   * \param [in] o The path to copy.
+   */
+  Path (const Path &o);
+  /**
+   * Assignment operator.  The copies share the cache.
+   * \param [in] o The path to copy.
+   * \returns This path.
+   */
+  Path & operator = (const Path &o);
+  /** Destructor. */
+  ~Path ();
+
+  /**
+   * \returns The path.
+   */
+  std::string GetPath (void) const;
+  /**
+   * \returns A container which contains all the objects which match the
+   *          path.
+   * \sa ns3::Config::LookupMatches
+   */
+  MatchContainer LookupMatches (void);
+  /**
+   * \param [in] value The value to set in all matching attributes.
+   * \sa ns3::Config::Set
+   */
+  void Set (const AttributeValue &value);
+  /**
+   * \param [in] cb The callback to connect to the matching trace sources.
+   * \sa ns3::Config::Connect
+   */
+  void Connect (const CallbackBase &cb);
+  /**
+   * \param [in] cb The callback to connect to the matching trace sources.
+   * \sa ns3::Config::ConnectWithoutContext
+   */
+  void ConnectWithoutContext (const CallbackBase &cb);
+  /**
+   * \param [in] cb The callback to disconnect from the matching trace
+   *             sources.
+   * \sa ns3::Config::Disconnect
+   */
+  void Disconnect (const CallbackBase &cb);
+  /**
+   * \param [in] cb The callback to disconnect from the matching trace
+   *             sources.
+   * \sa ns3::Config::DisconnectWithoutContext
+   */
+  void DisconnectWithoutContext (const CallbackBase &cb);
+
+private:
+  /**
+   * Get the objects which match the path, but its last element.
+   * \returns The matching objects, cached.
+   */
+  MatchContainer & LookupParents (void);
+  /** The compiled path, and its cache. */
+  Ptr<PathImpl> m_impl;
+};
+
 /**
  * \ingroup config
  * \param [in] path The path to perform a match against
@@ -258,6 +357,16 @@ private:
  */
 MatchContainer LookupMatches (std::string path);
 
+/**
+ * \ingroup config
+ * Invalidate the sets of objects cached by every Config::Path.
+ *
+ * This is called by the NodeList, the ChannelList, the Node, the object
+ * aggregation and disposal, and the object name service when the object
+ * graph changes.
+ */
+void InvalidatePathCache (void);
+
 /**
  * \ingroup config
  * \param [in] obj A new root object
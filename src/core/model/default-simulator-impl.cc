@@ -22,12 +22,14 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 
 #include "ptr.h"
 #include "pointer.h"
 #include "assert.h"
 #include "log.h"
 
+#include <chrono>
 #include <cmath>
 
 
@@ -74,6 +76,7 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_eventCount = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  m_profiler = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
@@ -99,6 +102,11 @@ void
 DefaultSimulatorImpl::Destroy ()
 {
   NS_LOG_FUNCTION (this);
+  if (m_profiler != 0)
+    {
+      m_profiler->Finish ();
+      m_profiler = 0;
+    }
   while (!m_destroyEvents.empty ()) 
     {
       Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
@@ -148,7 +156,17 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler == 0)
+    {
+      next.impl->Invoke ();
+    }
+  else
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      next.impl->Invoke ();
+      std::chrono::nanoseconds wall = std::chrono::steady_clock::now () - start;
+      m_profiler->Record (next.impl, next.key.m_context, next.key.m_ts, wall.count ());
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -198,6 +216,7 @@ DefaultSimulatorImpl::Run (void)
   m_main = SystemThread::Self();
   ProcessEventsWithContext ();
   m_stop = false;
+  m_profiler = EventProfiler::Start ();
 
   while (!m_events->IsEmpty () && !m_stop) 
     {
@@ -278,6 +297,47 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
     }
 }
 
+void
+DefaultSimulatorImpl::ScheduleWithContextBatch (const Simulator::ContextEvents &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+
+  if (SystemThread::Equals (m_main))
+    {
+      m_batch.clear ();
+      for (Simulator::ContextEvents::const_iterator i = events.begin (); i != events.end (); ++i)
+        {
+          Time tAbsolute = i->delay + TimeStep (m_currentTs);
+          Scheduler::Event ev;
+          ev.impl = i->event;
+          ev.key.m_ts = (uint64_t) tAbsolute.GetTimeStep ();
+          ev.key.m_context = i->context;
+          ev.key.m_uid = m_uid;
+          m_uid++;
+          m_batch.push_back (ev);
+        }
+      m_unscheduledEvents += m_batch.size ();
+      m_events->InsertBatch (m_batch);
+    }
+  else
+    {
+      CriticalSection cs (m_eventsWithContextMutex);
+      for (Simulator::ContextEvents::const_iterator i = events.begin (); i != events.end (); ++i)
+        {
+          EventWithContext ev;
+          ev.context = i->context;
+          // Current time added in ProcessEventsWithContext()
+          ev.timestamp = i->delay.GetTimeStep ();
+          ev.event = i->event;
+          m_eventsWithContext.push_back (ev);
+        }
+      if (!events.empty ())
+        {
+          m_eventsWithContextEmpty = false;
+        }
+    }
+}
+
 EventId
 DefaultSimulatorImpl::ScheduleNow (EventImpl *event)
 {
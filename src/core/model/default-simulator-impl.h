@@ -30,6 +30,7 @@
 #include "ptr.h"
 
 #include <list>
+#include <vector>
 
 /**
  * \file
@@ -39,10 +40,15 @@
 
 namespace ns3 {
 
+class EventProfiler;
+
 /**
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * When the EventProfiler is enabled at the start of Run(), the
+ * wall-clock time spent in each event is reported to it.
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -65,6 +71,7 @@ public:
   virtual void Stop (const Time &delay);
   virtual EventId Schedule (const Time &delay, EventImpl *event);
   virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContextBatch (const Simulator::ContextEvents &events);
   virtual EventId ScheduleNow (EventImpl *event);
   virtual EventId ScheduleDestroy (EventImpl *event);
   virtual void Remove (const EventId &id);
@@ -116,6 +123,8 @@ private:
   bool m_stop;
   /** The event priority queue. */
   Ptr<Scheduler> m_events;
+  /** Scratch space for ScheduleWithContextBatch. */
+  std::vector<Scheduler::Event> m_batch;
 
   /** Next event unique id. */
   uint32_t m_uid;
@@ -135,6 +144,9 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** The event profiler, or null if profiling is disabled. */
+  EventProfiler *m_profiler;
 };
 
 } // namespace ns3
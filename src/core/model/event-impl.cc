@@ -21,6 +21,9 @@
 #include "event-impl.h"
 #include "log.h"
 
+#include <cstring>
+#include <new>
+
 /**
  * \file
  * \ingroup events
@@ -31,6 +34,107 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** Granularity of the event sizes, in bytes. */
+const std::size_t EVENT_SIZE_GRANULARITY = 16;
+/** Number of size classes: events up to 128 bytes are pooled. */
+const std::size_t EVENT_SIZE_CLASSES = 8;
+/** Maximum number of free events kept per size class and thread. */
+const std::size_t EVENT_POOL_LIMIT = 4096;
+
+/** A free event block, linked in a free list. */
+struct EventFreeBlock
+{
+  EventFreeBlock *next;  //!< The next free block.
+};
+
+/** The free lists of one thread. */
+struct EventPool
+{
+  EventPool ();
+  ~EventPool ();
+  EventFreeBlock *head[EVENT_SIZE_CLASSES];  //!< The free lists.
+  std::size_t count[EVENT_SIZE_CLASSES];     //!< The free list lengths.
+};
+
+/**
+ * Flag set once the pool of the thread has been destroyed, for the
+ * events released during the thread (or program) termination.
+ */
+thread_local bool g_eventPoolDestroyed = false;
+/** The pool of the thread. */
+thread_local EventPool g_eventPool;
+
+EventPool::EventPool ()
+{
+  for (std::size_t i = 0; i < EVENT_SIZE_CLASSES; i++)
+    {
+      head[i] = 0;
+      count[i] = 0;
+    }
+}
+
+EventPool::~EventPool ()
+{
+  for (std::size_t i = 0; i < EVENT_SIZE_CLASSES; i++)
+    {
+      while (head[i] != 0)
+        {
+          EventFreeBlock *block = head[i];
+          head[i] = block->next;
+          ::operator delete (block);
+        }
+    }
+  g_eventPoolDestroyed = true;
+}
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  // Do not add function logging here: this is called for every
+  // scheduled event.
+  std::size_t sizeClass = (size - 1) / EVENT_SIZE_GRANULARITY;
+  if (sizeClass >= EVENT_SIZE_CLASSES || g_eventPoolDestroyed)
+    {
+      return ::operator new (size);
+    }
+  EventPool &pool = g_eventPool;
+  EventFreeBlock *block = pool.head[sizeClass];
+  if (block != 0)
+    {
+      pool.head[sizeClass] = block->next;
+      pool.count[sizeClass]--;
+      return block;
+    }
+  // All the blocks of a size class have the same size, so that
+  // they can be reused for any event of the class.
+  return ::operator new ((sizeClass + 1) * EVENT_SIZE_GRANULARITY);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  std::size_t sizeClass = (size - 1) / EVENT_SIZE_GRANULARITY;
+  if (sizeClass >= EVENT_SIZE_CLASSES || g_eventPoolDestroyed)
+    {
+      ::operator delete (p);
+      return;
+    }
+  EventPool &pool = g_eventPool;
+  if (pool.count[sizeClass] >= EVENT_POOL_LIMIT)
+    {
+      ::operator delete (p);
+      return;
+    }
+  EventFreeBlock *block = static_cast<EventFreeBlock *> (p);
+  block->next = pool.head[sizeClass];
+  pool.head[sizeClass] = block;
+  pool.count[sizeClass]++;
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -66,4 +170,62 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+const void *
+EventImpl::GetFunction (void) const
+{
+  return 0;
+}
+
+const void *
+EventImpl::GetFunctionAddress (const void *function, std::size_t size)
+{
+  const void *address = 0;
+  if (size == sizeof (address))
+    {
+      std::memcpy (&address, function, size);
+    }
+  return address;
+}
+
+const void *
+EventImpl::GetMethodAddress (const void *method, std::size_t size,
+                             const void *object)
+{
+#if defined (__GNUC__) && !defined (_WIN32)
+  // A pointer to member function is a {ptr, adj} pair: adj is added to
+  // the object address to get the 'this' pointer, and ptr is either the
+  // function address or, for virtual methods, one plus the offset of
+  // the method in the vtable.  The ARM variant flags virtual methods in
+  // the lowest bit of adj (shifted left by one) instead.
+  struct
+  {
+    uintptr_t ptr;
+    ptrdiff_t adj;
+  } rep;
+  if (size != sizeof (rep))
+    {
+      return 0;
+    }
+  std::memcpy (&rep, method, size);
+#if defined (__arm__) || defined (__aarch64__)
+  bool isVirtual = (rep.adj & 1) != 0;
+  ptrdiff_t adj = rep.adj >> 1;
+  uintptr_t offset = rep.ptr;
+#else
+  bool isVirtual = (rep.ptr & 1) != 0;
+  ptrdiff_t adj = rep.adj;
+  uintptr_t offset = rep.ptr - 1;
+#endif
+  if (!isVirtual)
+    {
+      return reinterpret_cast<const void *> (rep.ptr);
+    }
+  const char *self = static_cast<const char *> (object) + adj;
+  const char *vtable = *reinterpret_cast<const char * const *> (self);
+  return *reinterpret_cast<const void * const *> (vtable + offset);
+#else
+  return 0;
+#endif
+}
+
 } // namespace ns3
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +41,13 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Events are allocated and released at a very high rate, so EventImpl
+ * provides its own allocation functions: small events (up to
+ * 128 bytes, which covers all the MakeEvent() events with word-sized
+ * arguments) are recycled through per-thread free lists sorted by size,
+ * and scheduling an event does not reach the system allocator once the
+ * simulation has reached its steady state.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -65,6 +73,32 @@ public:
    * Checked by the simulation engine before calling Invoke().
    */
   bool IsCancelled (void);
+  /**
+   * Get the code invoked by the event, for profiling.
+   *
+   * The events created by MakeEvent() return the address of the bound
+   * function, or of the method which is called on the bound object,
+   * after resolution of virtual methods.
+   *
+   * \returns The address of the function, or null if unknown.
+   */
+  virtual const void * GetFunction (void) const;
+
+  /**
+   * Allocate an event, from the free list of the calling thread
+   * when the event is small enough.
+   *
+   * \param [in] size The size of the event.
+   * \returns The event storage.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release an event to the free list of the calling thread.
+   *
+   * \param [in] p The event storage.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size);
 
 protected:
   /**
@@ -75,6 +109,28 @@ protected:
    */
   virtual void Notify (void) = 0;
 
+  /**
+   * Get the address of a function from a function pointer.
+   *
+   * \param [in] function A pointer to the function pointer.
+   * \param [in] size The size of the function pointer.
+   * \returns The address of the function, or null if unknown.
+   */
+  static const void * GetFunctionAddress (const void *function, std::size_t size);
+  /**
+   * Get the address of the method invoked through a pointer to member
+   * function, resolving virtual methods with the object.
+   *
+   * Only the Itanium C++ ABI representation (GCC and clang) is decoded.
+   *
+   * \param [in] method A pointer to the pointer to member function.
+   * \param [in] size The size of the pointer to member function.
+   * \param [in] object The object the method is invoked on.
+   * \returns The address of the method, or null if unknown.
+   */
+  static const void * GetMethodAddress (const void *method, std::size_t size,
+                                        const void *object);
+
 private:
   bool m_cancel;  /**< Has this event been cancelled. */
 };
@@ -0,0 +1,485 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "global-value.h"
+#include "simulator.h"
+#include "string.h"
+#include "log.h"
+#include "ns3/core-config.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+#ifdef HAVE_DLFCN_H
+#include <dlfcn.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+/**
+ * \ingroup simulator
+ * \anchor GlobalValueEventProfilerPrefix
+ * The prefix of the event profiler output files.
+ */
+static GlobalValue g_eventProfilerPrefix = GlobalValue
+  ("EventProfilerPrefix",
+   "If not empty, profile the events and write <prefix>.txt and "
+   "<prefix>.folded when the simulation is destroyed",
+   StringValue (""),
+   MakeStringChecker ());
+
+/**
+ * \ingroup simulator
+ * \anchor GlobalValueEventProfilerBucket
+ * The width of the simulated-time buckets of the event profiler.
+ */
+static GlobalValue g_eventProfilerBucket = GlobalValue
+  ("EventProfilerBucket",
+   "The width of the simulated-time buckets of the event profiler, "
+   "when enabled with EventProfilerPrefix",
+   TimeValue (Seconds (1.0)),
+   MakeTimeChecker (Time (1)));
+
+namespace {
+
+/**
+ * Order the rows of a table by decreasing wall-clock time, then by label.
+ * \param [in] a The first row.
+ * \param [in] b The second row.
+ * \returns \c true if \p a comes first.
+ */
+template <typename T>
+bool
+ByWallTime (const std::pair<std::string, T> &a,
+            const std::pair<std::string, T> &b)
+{
+  if (a.second.wallNs != b.second.wallNs)
+    {
+      return a.second.wallNs > b.second.wallNs;
+    }
+  return a.first < b.first;
+}
+
+/**
+ * Find the end of a template argument list or of a parameter list.
+ * \param [in] s The string.
+ * \param [in] start The index just after the opening bracket.
+ * \param [in] stopAtComma Stop at the first comma at the outer level.
+ * \returns The index of the closing bracket, or of the comma.
+ */
+std::size_t
+FindClosing (const std::string &s, std::size_t start, bool stopAtComma)
+{
+  int depth = 0;
+  for (std::size_t i = start; i < s.size (); i++)
+    {
+      char c = s[i];
+      if (c == '<' || c == '(' || c == '[')
+        {
+          depth++;
+        }
+      else if (c == '>' || c == ')' || c == ']')
+        {
+          if (depth == 0)
+            {
+              return i;
+            }
+          depth--;
+        }
+      else if (c == ',' && depth == 0 && stopAtComma)
+        {
+          return i;
+        }
+    }
+  return std::string::npos;
+}
+
+/**
+ * Demangle a C++ symbol or type name.
+ * \param [in] name The mangled name.
+ * \returns The demangled name, or \p name if it cannot be demangled.
+ */
+std::string
+Demangle (std::string name)
+{
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (name.c_str (), NULL, NULL, &status);
+  if (status == 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+  return name;
+}
+
+} // unnamed namespace
+
+EventProfiler::EventProfiler ()
+  : m_enabled (false),
+    m_bucket (1),
+    m_lastType (0, 0),
+    m_lastTypeStats (0),
+    m_lastBucket (0),
+    m_lastBucketStats (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EventProfiler::Enable (Time bucket)
+{
+  NS_LOG_FUNCTION (this << bucket);
+  NS_ASSERT_MSG (bucket.IsStrictlyPositive (), "Invalid bucket width " << bucket);
+  uint64_t width = bucket.GetTimeStep ();
+  if (width != m_bucket && !m_buckets.empty ())
+    {
+      NS_LOG_WARN ("Bucket width changed, discarding the time buckets");
+      m_lastBucketStats = 0;
+      m_buckets.clear ();
+    }
+  m_bucket = width;
+  m_enabled = true;
+}
+
+void
+EventProfiler::Disable (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_enabled = false;
+}
+
+bool
+EventProfiler::IsEnabled (void) const
+{
+  return m_enabled;
+}
+
+void
+EventProfiler::Reset (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_total = Stats ();
+  m_lastTypeStats = 0;
+  m_types.clear ();
+  m_contexts.clear ();
+  m_lastBucketStats = 0;
+  m_buckets.clear ();
+}
+
+EventProfiler *
+EventProfiler::Start (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  EventProfiler *profiler = Get ();
+  StringValue prefix;
+  g_eventProfilerPrefix.GetValue (prefix);
+  if (!profiler->IsEnabled () && prefix.Get () != "")
+    {
+      TimeValue bucket;
+      g_eventProfilerBucket.GetValue (bucket);
+      profiler->Enable (bucket.Get ());
+    }
+  return profiler->IsEnabled () ? profiler : 0;
+}
+
+void
+EventProfiler::Finish (void)
+{
+  NS_LOG_FUNCTION (this);
+  StringValue prefix;
+  g_eventProfilerPrefix.GetValue (prefix);
+  if (prefix.Get () == "" || m_total.count == 0)
+    {
+      return;
+    }
+  std::ofstream report ((prefix.Get () + ".txt").c_str ());
+  WriteReport (report);
+  std::ofstream folded ((prefix.Get () + ".folded").c_str ());
+  WriteFoldedStacks (folded);
+  Reset ();
+}
+
+void
+EventProfiler::Record (const EventImpl *event, uint32_t context,
+                       uint64_t ts, uint64_t wallNs)
+{
+  m_total.count++;
+  m_total.wallNs += wallNs;
+
+  EventKey key (&typeid (*event), event->GetFunction ());
+  if (key != m_lastType || m_lastTypeStats == 0)
+    {
+      m_lastType = key;
+      m_lastTypeStats = &m_types[key];
+    }
+  m_lastTypeStats->count++;
+  m_lastTypeStats->wallNs += wallNs;
+
+  Stats &contextStats = m_contexts[context];
+  contextStats.count++;
+  contextStats.wallNs += wallNs;
+
+  uint64_t bucket = ts / m_bucket;
+  if (bucket != m_lastBucket || m_lastBucketStats == 0)
+    {
+      m_lastBucket = bucket;
+      m_lastBucketStats = &m_buckets[bucket];
+    }
+  m_lastBucketStats->count++;
+  m_lastBucketStats->wallNs += wallNs;
+}
+
+uint64_t
+EventProfiler::GetEventCount (void) const
+{
+  return m_total.count;
+}
+
+uint64_t
+EventProfiler::GetContextEventCount (uint32_t context) const
+{
+  std::unordered_map<uint32_t, Stats>::const_iterator i = m_contexts.find (context);
+  return i == m_contexts.end () ? 0 : i->second.count;
+}
+
+uint64_t
+EventProfiler::GetTypeEventCount (std::string name) const
+{
+  NamedStats stats = GetNamedStats ();
+  NamedStats::const_iterator i = stats.find (name);
+  return i == stats.end () ? 0 : i->second.count;
+}
+
+EventProfiler::NamedStats
+EventProfiler::GetNamedStats (std::map<std::string, std::string> *types) const
+{
+  // Several type_info objects may exist for the same type when
+  // it is instantiated in several shared libraries.
+  NamedStats named;
+  for (TypeStats::const_iterator i = m_types.begin (); i != m_types.end (); ++i)
+    {
+      std::string name = GetEventName (*i->first.first, i->first.second);
+      Stats &stats = named[name];
+      stats.count += i->second.count;
+      stats.wallNs += i->second.wallNs;
+      if (types != 0)
+        {
+          (*types)[name] = GetEventTypeName (*i->first.first);
+        }
+    }
+  return named;
+}
+
+void
+EventProfiler::WriteTable (std::ostream &os, std::string title,
+                           const std::vector<std::pair<std::string, Stats> > &stats) const
+{
+  std::vector<std::pair<std::string, Stats> > rows = stats;
+  std::sort (rows.begin (), rows.end (), ByWallTime<Stats>);
+
+  os << title << std::endl;
+  os << std::setw (12) << "events"
+     << std::setw (14) << "wall (s)"
+     << std::setw (8) << "%"
+     << std::setw (12) << "mean (us)"
+     << "  " << "name" << std::endl;
+  std::ios_base::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << std::fixed;
+  for (std::vector<std::pair<std::string, Stats> >::const_iterator i = rows.begin ();
+       i != rows.end (); ++i)
+    {
+      const Stats &s = i->second;
+      double percent = m_total.wallNs == 0 ? 0 : 100.0 * s.wallNs / m_total.wallNs;
+      double mean = s.count == 0 ? 0 : s.wallNs / 1e3 / s.count;
+      os << std::setw (12) << s.count
+         << std::setw (14) << std::setprecision (6) << s.wallNs / 1e9
+         << std::setw (8) << std::setprecision (2) << percent
+         << std::setw (12) << std::setprecision (3) << mean
+         << "  " << i->first << std::endl;
+    }
+  os << std::endl;
+  os.flags (flags);
+  os.precision (precision);
+}
+
+void
+EventProfiler::WriteReport (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "Event profile: " << m_total.count << " events, "
+     << m_total.wallNs / 1e9 << " s in events" << std::endl << std::endl;
+
+  NamedStats named = GetNamedStats ();
+  std::vector<std::pair<std::string, Stats> > rows (named.begin (), named.end ());
+  WriteTable (os, "By function:", rows);
+
+  rows.clear ();
+  for (std::unordered_map<uint32_t, Stats>::const_iterator i = m_contexts.begin ();
+       i != m_contexts.end (); ++i)
+    {
+      std::ostringstream label;
+      if (i->first == Simulator::NO_CONTEXT)
+        {
+          label << "none";
+        }
+      else
+        {
+          label << i->first;
+        }
+      rows.push_back (std::make_pair (label.str (), i->second));
+    }
+  WriteTable (os, "By context:", rows);
+
+  rows.clear ();
+  for (std::map<uint64_t, Stats>::const_iterator i = m_buckets.begin ();
+       i != m_buckets.end (); ++i)
+    {
+      std::ostringstream label;
+      label << "[" << TimeStep (m_bucket * i->first).As (Time::S) << ", "
+            << TimeStep (m_bucket * (i->first + 1)).As (Time::S) << ")";
+      rows.push_back (std::make_pair (label.str (), i->second));
+    }
+  WriteTable (os, "By simulated time:", rows);
+}
+
+void
+EventProfiler::WriteFoldedStacks (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  std::map<std::string, std::string> types;
+  NamedStats named = GetNamedStats (&types);
+  for (NamedStats::const_iterator i = named.begin (); i != named.end (); ++i)
+    {
+      // flamegraph.pl splits the frames on ';' and the weight on the
+      // last space, so the spaces in the type names are harmless.
+      std::string type = types[i->first];
+      std::string className = GetEventClassName (type);
+      os << (className == "" ? "(function)" : className) << ";";
+      // The functions without a symbol are named after their type.
+      if (i->first.compare (0, type.size (), type) != 0)
+        {
+          os << type << ";";
+        }
+      os << i->first << " " << i->second.wallNs << std::endl;
+    }
+}
+
+std::string
+EventProfiler::GetEventTypeName (const std::type_info &type)
+{
+  std::string name = Demangle (type.name ());
+
+  // The events created by MakeEvent are local classes of the MakeEvent
+  // function templates, whose first parameter is the bound function.
+  std::string makeEvent = "ns3::MakeEvent";
+  if (name.compare (0, makeEvent.size (), makeEvent) != 0)
+    {
+      return name;
+    }
+  std::size_t start = makeEvent.size ();
+  if (start < name.size () && name[start] == '<')
+    {
+      start = FindClosing (name, start + 1, false);
+      if (start == std::string::npos)
+        {
+          return name;
+        }
+      start++;
+    }
+  if (start >= name.size () || name[start] != '(')
+    {
+      return name;
+    }
+  start++;
+  std::size_t end = FindClosing (name, start, true);
+  if (end == std::string::npos)
+    {
+      return name;
+    }
+  return name.substr (start, end - start);
+}
+
+std::string
+EventProfiler::GetEventName (const std::type_info &type, const void *function)
+{
+  std::string name = GetEventTypeName (type);
+  if (function == 0)
+    {
+      return name;
+    }
+  std::ostringstream oss;
+  oss << name << " at ";
+#ifdef HAVE_DLFCN_H
+  Dl_info info;
+  if (dladdr (function, &info) != 0)
+    {
+      // dladdr returns the closest symbol below the address, which is
+      // not the function when the function has no dynamic symbol.
+      if (info.dli_sname != 0 && info.dli_saddr == function)
+        {
+          return Demangle (info.dli_sname);
+        }
+      if (info.dli_fname != 0)
+        {
+          std::string file = info.dli_fname;
+          oss << file.substr (file.rfind ('/') + 1) << "+0x" << std::hex
+              << static_cast<const char *> (function)
+               - static_cast<const char *> (info.dli_fbase);
+          return oss.str ();
+        }
+    }
+#endif
+  oss << function;
+  return oss.str ();
+}
+
+std::string
+EventProfiler::GetEventClassName (std::string name)
+{
+  // A pointer to member function type reads "R (C::*)(Args)".
+  std::size_t end = name.find ("::*)");
+  if (end == std::string::npos)
+    {
+      return "";
+    }
+  std::size_t start = name.rfind ('(', end);
+  if (start == std::string::npos)
+    {
+      return "";
+    }
+  return name.substr (start + 1, end - start - 1);
+}
+
+} // namespace ns3
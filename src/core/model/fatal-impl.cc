@@ -32,7 +32,8 @@
  * \file
  * \ingroup fatalimpl
  * \brief ns3::FatalImpl::RegisterStream(), ns3::FatalImpl::UnregisterStream(),
- * and ns3::FatalImpl::FlushStreams() implementations;
+ * ns3::FatalImpl::FlushStreams() and ns3::FatalImpl::FlushRegisteredStreams()
+ * implementations;
  * see Implementation note!
  *
  * \note Implementation.
@@ -190,6 +191,24 @@ FlushStreams (void)
   *pl = 0;
 }
 
+void
+FlushRegisteredStreams (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::list<std::ostream*> **pl = PeekStreamList ();
+  if (*pl != 0)
+    {
+      for (std::list<std::ostream*>::iterator i = (*pl)->begin (); i != (*pl)->end (); ++i)
+        {
+          (*i)->flush ();
+        }
+    }
+  std::fflush (0);
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::clog.flush ();
+}
+
 } // namespace FatalImpl
   
 } // namespace ns3
@@ -93,6 +93,19 @@ void UnregisterStream (std::ostream* stream);
  */
 void FlushStreams (void);
 
+/**
+ * \ingroup fatalimpl
+ *
+ * \brief Flush all currently registered streams, and keep them
+ * registered.
+ *
+ * Unlike FlushStreams(), this can be called at any time, for example
+ * before forking the process, so that the buffered output is not
+ * written by both processes.  \c std::cout, \c std::cerr, \c std::clog
+ * and the \c FILE* streams are flushed too.
+ */
+void FlushRegisteredStreams (void);
+
 } //FatalImpl
 } //ns3
 
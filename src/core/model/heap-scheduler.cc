@@ -150,10 +150,10 @@ HeapScheduler::IsEmpty (void) const
 }
 
 void
-HeapScheduler::BottomUp (void)
+HeapScheduler::BottomUp (std::size_t start)
 {
-  NS_LOG_FUNCTION (this);
-  std::size_t index = Last ();
+  NS_LOG_FUNCTION (this << start);
+  std::size_t index = start;
   while (!IsRoot (index)
          && IsLessStrictly (index, Parent (index)))
     {
@@ -203,7 +203,31 @@ HeapScheduler::Insert (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
   m_heap.push_back (ev);
-  BottomUp ();
+  BottomUp (Last ());
+}
+
+void
+HeapScheduler::InsertBatch (const std::vector<Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  std::size_t first = m_heap.size ();
+  m_heap.insert (m_heap.end (), events.begin (), events.end ());
+  if (events.size () < first - 1)
+    {
+      // Few new events: sift each of them up, in O(k log(n)).
+      for (std::size_t i = first; i <= Last (); i++)
+        {
+          BottomUp (i);
+        }
+    }
+  else
+    {
+      // Many new events: rebuild the whole heap bottom-up, in O(n).
+      for (std::size_t i = Last () / 2; i >= Root (); i--)
+        {
+          TopDown (i);
+        }
+    }
 }
 
 Scheduler::Event
@@ -236,7 +260,12 @@ HeapScheduler::Remove (const Event &ev)
           NS_ASSERT (m_heap[i].impl == ev.impl);
           Exch (i, Last ());
           m_heap.pop_back ();
-          TopDown (i);
+          // The former last item can belong above or below i.
+          if (!IsBottom (i))
+            {
+              BottomUp (i);
+              TopDown (i);
+            }
           return;
         }
     }
@@ -66,6 +66,7 @@ public:
 
   // Inherited
   virtual void Insert (const Scheduler::Event &ev);
+  virtual void InsertBatch (const std::vector<Scheduler::Event> &events);
   virtual bool IsEmpty (void) const;
   virtual Scheduler::Event PeekNext (void) const;
   virtual Scheduler::Event RemoveNext (void);
@@ -151,8 +152,12 @@ private:
    * \param [in] b The second item.
    */
   inline void Exch (std::size_t a, std::size_t b);
-  /** Percolate a newly inserted Last item to its proper position. */ 
-  void BottomUp (void);
+  /**
+   * Percolate an item up to its proper position.
+   *
+   * \param [in] start Starting entry, usually the newly inserted Last item.
+   */
+  void BottomUp (std::size_t start);
   /**
    * Percolate a deletion bubble down the heap.
    *
@@ -70,6 +70,15 @@ ListScheduler::Insert (const Event &ev)
     }
   m_events.push_back (ev);
 }
+void
+ListScheduler::InsertBatch (const std::vector<Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  // Sort the new events, then merge them in a single pass over the list.
+  Events batch (events.begin (), events.end ());
+  batch.sort ();
+  m_events.merge (batch);
+}
 bool
 ListScheduler::IsEmpty (void) const
 {
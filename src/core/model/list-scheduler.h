@@ -59,6 +59,7 @@ public:
 
   // Inherited
   virtual void Insert (const Scheduler::Event &ev);
+  virtual void InsertBatch (const std::vector<Scheduler::Event> &events);
   virtual bool IsEmpty (void) const;
   virtual Scheduler::Event PeekNext (void) const;
   virtual Scheduler::Event RemoveNext (void);
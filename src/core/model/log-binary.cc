@@ -0,0 +1,1354 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "log-binary.h"
+#include "log.h"
+#include "nstime.h"
+#include "simulator.h"
+#include "time-printer.h"
+#include "node-printer.h"
+#include "fatal-error.h"
+#include "ns3/core-config.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#ifdef HAVE_PTHREAD_H
+#include <thread>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <cstdlib>
+#endif
+
+/**
+ * \file
+ * \ingroup logbinary
+ * Binary log sink implementation.
+ */
+
+namespace ns3 {
+
+// Do not log in this file: it implements the logging macros.
+
+namespace {
+
+/** The magic number at the start of a binary log file. */
+const char LOG_BINARY_MAGIC[8] = { 'N', 'S', '3', 'B', 'L', 'O', 'G', '\0' };
+/** The binary log file format version. */
+const uint32_t LOG_BINARY_VERSION = 1;
+/** The smallest ring buffer size. */
+const uint32_t LOG_BINARY_MIN_RING = 4096;
+
+/** The chunks of a binary log file. */
+enum Chunk
+{
+  CHUNK_SITE = 'S',        //!< A logging statement.
+  CHUNK_LITERAL = 'L',     //!< An interned string literal.
+  CHUNK_RESOLUTION = 'R',  //!< The Time resolution.
+  CHUNK_DATA = 'D'         //!< The records of a thread.
+};
+
+/**
+ * Append a value to a byte buffer.
+ * \param [in,out] buffer The buffer.
+ * \param [in] value The value.
+ */
+template <typename T>
+void
+AppendBytes (std::vector<uint8_t> & buffer, T value)
+{
+  std::size_t offset = buffer.size ();
+  buffer.resize (offset + sizeof (value));
+  std::memcpy (&buffer[offset], &value, sizeof (value));
+}
+
+/**
+ * Append a string, preceded by its length, to a byte buffer.
+ * \param [in,out] buffer The buffer.
+ * \param [in] value The string.
+ * \param [in] size The string length.
+ */
+void
+AppendString (std::vector<uint8_t> & buffer, const char * value, std::size_t size)
+{
+  AppendBytes<uint32_t> (buffer, static_cast<uint32_t> (size));
+  buffer.insert (buffer.end (), value, value + size);
+}
+
+/**
+ * The single-producer single-consumer byte ring of a thread.
+ *
+ * The records are copied in the ring by the thread, and written to
+ * the file by the writer.  A record larger than the free space is
+ * copied in several steps, so the writer may write part of a record;
+ * the decoder reassembles the records of each ring.
+ */
+struct Ring
+{
+  /**
+   * Constructor.
+   * \param [in] id The ring id.
+   * \param [in] size The ring size, a power of two.
+   */
+  Ring (uint32_t id, uint32_t size);
+  uint32_t id;                  //!< The ring id.
+  std::vector<uint8_t> data;    //!< The ring storage.
+  uint64_t mask;                //!< The index mask.
+  std::atomic<uint64_t> head;   //!< The write position, set by the thread.
+  std::atomic<uint64_t> tail;   //!< The read position, set by the writer.
+  std::atomic<bool> closed;     //!< The thread has exited.
+};
+
+Ring::Ring (uint32_t ringId, uint32_t size)
+  : id (ringId),
+    data (size),
+    mask (size - 1),
+    head (0),
+    tail (0),
+    closed (false)
+{
+}
+
+/**
+ * The binary log sink: the file, the registered statements and
+ * literals, the rings and the writer thread.
+ */
+class Sink
+{
+public:
+  Sink ();
+  /**
+   * Open the file and start the writer.
+   * \param [in] filename The file name.
+   * \param [in] ringSize The ring size of the new threads.
+   */
+  void Enable (const std::string & filename, uint32_t ringSize);
+  /** Stop the writer, write the pending records and close the file. */
+  void Disable (void);
+  /** Write the pending records. */
+  void Flush (void);
+  /**
+   * Register a logging statement.
+   * \param [in] name The component name.
+   * \param [in] function The function name.
+   * \param [in] file The source file.
+   * \param [in] line The source line.
+   * \param [in] level The log level.
+   * \param [in] kind The logging macro.
+   * \returns The statement id.
+   */
+  uint32_t AddSite (const char * name, const char * function, const char * file,
+                    uint32_t line, uint32_t level, LogBinarySite::Kind kind);
+  /**
+   * Register a string literal.
+   * \param [in] value The literal.
+   * \param [in] size The literal length.
+   * \returns The literal id.
+   */
+  uint32_t AddLiteral (const char * value, std::size_t size);
+  /** \returns A new ring for the calling thread. */
+  Ring * AddRing (void);
+  /**
+   * Copy a record in a ring, waiting for the writer if the ring is full.
+   * \param [in,out] ring The ring of the calling thread.
+   * \param [in] data The record.
+   * \param [in] size The record size.
+   */
+  void Push (Ring * ring, const uint8_t * data, std::size_t size);
+
+  std::atomic<bool> enabled;  //!< The binary log is enabled.
+
+private:
+  /** The writer thread. */
+  void Writer (void);
+  /**
+   * Write the pending definitions and records.
+   * \returns \c true if something was written.
+   */
+  bool Drain (void);
+
+  /** Protects the definitions, the ring list and the writer state. */
+  std::mutex m_mutex;
+  /** Serializes the writes to the file. */
+  std::mutex m_drainMutex;
+  /** Wakes up the writer. */
+  std::condition_variable m_wakeup;
+  std::ofstream m_file;                   //!< The binary log file.
+  std::vector<uint8_t> m_definitions;     //!< All the definitions.
+  std::size_t m_written;                  //!< The definitions written to the file.
+  std::vector<Ring *> m_rings;            //!< The rings of the threads.
+  uint32_t m_ringSize;                    //!< The ring size of the new threads.
+  uint32_t m_sites;                       //!< The number of statements.
+  uint32_t m_literals;                    //!< The number of literals.
+  uint32_t m_ringIds;                     //!< The number of rings.
+  int m_resolution;                       //!< The last Time resolution written.
+  bool m_stop;                            //!< Stop the writer.
+#ifdef HAVE_PTHREAD_H
+  std::thread m_writer;                   //!< The writer thread.
+#endif
+};
+
+Sink::Sink ()
+  : enabled (false),
+    m_written (0),
+    m_ringSize (1 << 20),
+    m_sites (0),
+    m_literals (0),
+    m_ringIds (0),
+    m_resolution (-1),
+    m_stop (false)
+{
+}
+
+/**
+ * Get the sink.
+ *
+ * The sink is never destroyed, so that the threads which exit after
+ * the static destructors can still release their ring.
+ *
+ * \returns The sink.
+ */
+Sink &
+GetSink (void)
+{
+  static Sink *sink = new Sink ();
+  return *sink;
+}
+
+void
+Sink::Enable (const std::string & filename, uint32_t ringSize)
+{
+  Disable ();
+  std::lock_guard<std::mutex> drainLock (m_drainMutex);
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file.is_open ())
+    {
+      NS_FATAL_ERROR ("Can not open binary log file " << filename);
+    }
+  m_file.write (LOG_BINARY_MAGIC, sizeof (LOG_BINARY_MAGIC));
+  m_file.write (reinterpret_cast<const char *> (&LOG_BINARY_VERSION),
+                sizeof (LOG_BINARY_VERSION));
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    // The statements and literals registered with a previous file are
+    // written again to this one.
+    m_written = 0;
+    m_resolution = -1;
+    m_stop = false;
+    uint32_t size = LOG_BINARY_MIN_RING;
+    while (size < ringSize && size < (1U << 31))
+      {
+        size <<= 1;
+      }
+    m_ringSize = size;
+  }
+  enabled.store (true, std::memory_order_release);
+#ifdef HAVE_PTHREAD_H
+  m_writer = std::thread (&Sink::Writer, this);
+#endif
+}
+
+void
+Sink::Disable (void)
+{
+  if (!enabled.exchange (false))
+    {
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stop = true;
+  }
+  m_wakeup.notify_one ();
+  m_writer.join ();
+#endif
+  Drain ();
+  std::lock_guard<std::mutex> drainLock (m_drainMutex);
+  m_file.close ();
+}
+
+void
+Sink::Flush (void)
+{
+  if (enabled.load (std::memory_order_acquire))
+    {
+      Drain ();
+    }
+}
+
+uint32_t
+Sink::AddSite (const char * name, const char * function, const char * file,
+               uint32_t line, uint32_t level, LogBinarySite::Kind kind)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  uint32_t id = m_sites++;
+  m_definitions.push_back (CHUNK_SITE);
+  AppendBytes<uint32_t> (m_definitions, id);
+  AppendBytes<uint8_t> (m_definitions, kind);
+  AppendBytes<uint32_t> (m_definitions, level);
+  AppendBytes<uint32_t> (m_definitions, line);
+  AppendString (m_definitions, name, std::strlen (name));
+  AppendString (m_definitions, function, std::strlen (function));
+  AppendString (m_definitions, file, std::strlen (file));
+  return id;
+}
+
+uint32_t
+Sink::AddLiteral (const char * value, std::size_t size)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  uint32_t id = m_literals++;
+  m_definitions.push_back (CHUNK_LITERAL);
+  AppendBytes<uint32_t> (m_definitions, id);
+  AppendString (m_definitions, value, size);
+  return id;
+}
+
+Ring *
+Sink::AddRing (void)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  Ring *ring = new Ring (m_ringIds++, m_ringSize);
+  m_rings.push_back (ring);
+  return ring;
+}
+
+void
+Sink::Push (Ring * ring, const uint8_t * data, std::size_t size)
+{
+  uint64_t capacity = ring->data.size ();
+  while (size > 0)
+    {
+      uint64_t head = ring->head.load (std::memory_order_relaxed);
+      uint64_t space = capacity - (head - ring->tail.load (std::memory_order_acquire));
+      if (space == 0)
+        {
+          if (!enabled.load (std::memory_order_acquire))
+            {
+              // The writer is gone: drop the rest of the record.
+              return;
+            }
+#ifdef HAVE_PTHREAD_H
+          m_wakeup.notify_one ();
+          std::this_thread::yield ();
+#else
+          Drain ();
+#endif
+          continue;
+        }
+      std::size_t count = static_cast<std::size_t> (std::min<uint64_t> (space, size));
+      std::size_t start = static_cast<std::size_t> (head & ring->mask);
+      std::size_t first = std::min<std::size_t> (count, capacity - start);
+      std::memcpy (&ring->data[start], data, first);
+      std::memcpy (&ring->data[0], data + first, count - first);
+      ring->head.store (head + count, std::memory_order_release);
+      data += count;
+      size -= count;
+    }
+}
+
+void
+Sink::Writer (void)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (!m_stop)
+    {
+      lock.unlock ();
+      bool wrote = Drain ();
+      lock.lock ();
+      if (!wrote && !m_stop)
+        {
+          m_wakeup.wait_for (lock, std::chrono::milliseconds (1));
+        }
+    }
+}
+
+bool
+Sink::Drain (void)
+{
+  std::lock_guard<std::mutex> drainLock (m_drainMutex);
+  if (!m_file.is_open ())
+    {
+      return false;
+    }
+  std::vector<Ring *> rings;
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    rings = m_rings;
+  }
+  // Take the positions of the records before the definitions, so that
+  // the statements and literals of all the records to write are
+  // already registered.
+  std::vector<uint64_t> heads (rings.size ());
+  std::vector<bool> closed (rings.size ());
+  for (std::size_t i = 0; i < rings.size (); i++)
+    {
+      closed[i] = rings[i]->closed.load (std::memory_order_acquire);
+      heads[i] = rings[i]->head.load (std::memory_order_acquire);
+    }
+  bool wrote = false;
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    if (m_written < m_definitions.size ())
+      {
+        m_file.write (reinterpret_cast<const char *> (&m_definitions[m_written]),
+                      m_definitions.size () - m_written);
+        m_written = m_definitions.size ();
+        wrote = true;
+      }
+  }
+  int resolution = Time::GetResolution ();
+  if (resolution != m_resolution)
+    {
+      m_resolution = resolution;
+      char chunk[2] = { CHUNK_RESOLUTION, static_cast<char> (resolution) };
+      m_file.write (chunk, sizeof (chunk));
+      wrote = true;
+    }
+  std::vector<Ring *> released;
+  for (std::size_t i = 0; i < rings.size (); i++)
+    {
+      Ring *ring = rings[i];
+      uint64_t tail = ring->tail.load (std::memory_order_relaxed);
+      if (heads[i] != tail)
+        {
+          uint64_t capacity = ring->data.size ();
+          uint32_t size = static_cast<uint32_t> (heads[i] - tail);
+          m_file.put (CHUNK_DATA);
+          m_file.write (reinterpret_cast<const char *> (&ring->id), sizeof (ring->id));
+          m_file.write (reinterpret_cast<const char *> (&size), sizeof (size));
+          std::size_t start = static_cast<std::size_t> (tail & ring->mask);
+          std::size_t first = std::min<std::size_t> (size, capacity - start);
+          m_file.write (reinterpret_cast<const char *> (&ring->data[start]), first);
+          m_file.write (reinterpret_cast<const char *> (&ring->data[0]), size - first);
+          ring->tail.store (heads[i], std::memory_order_release);
+          wrote = true;
+        }
+      if (closed[i])
+        {
+          released.push_back (ring);
+        }
+    }
+  if (!released.empty ())
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      for (std::vector<Ring *>::iterator i = released.begin (); i != released.end (); ++i)
+        {
+          m_rings.erase (std::find (m_rings.begin (), m_rings.end (), *i));
+          delete *i;
+        }
+    }
+  if (wrote)
+    {
+      m_file.flush ();
+    }
+  return wrote;
+}
+
+
+/** The logging state of a thread. */
+struct ThreadState
+{
+  ThreadState ();
+  ~ThreadState ();
+  /**
+   * Get a buffer for a new record.
+   *
+   * A record may be started while another one is being built, when
+   * the arguments of a message call functions which log, so the
+   * buffers are a stack.
+   *
+   * \returns The buffer.
+   */
+  LogBinaryRecord::Buffer * Acquire (void);
+  /** Release the last buffer acquired. */
+  void Release (void);
+
+  /** An interned literal. */
+  struct Literal
+  {
+    uint32_t id;       //!< The literal id, or the size of a mutable array.
+    std::string text;  //!< The literal text.
+    bool interned;     //!< The array is a literal, not a mutable array.
+  };
+
+  Ring *ring;  //!< The ring of the thread.
+  std::vector<LogBinaryRecord::Buffer *> buffers;  //!< The record buffers.
+  std::vector<std::ostringstream *> streams;       //!< The record text streams.
+  std::size_t depth;   //!< The number of records being built.
+  std::unordered_map<const char *, Literal> literals;  //!< The literal cache.
+  std::stringbuf discarded;  //!< The context of the discarded records.
+};
+
+/**
+ * Flag set once the state of the thread has been destroyed, for the
+ * messages logged during the thread (or program) termination.
+ */
+thread_local bool g_threadStateDestroyed = false;
+/** The logging state of the thread. */
+thread_local ThreadState g_threadState;
+
+ThreadState::ThreadState ()
+  : ring (0),
+    depth (0)
+{
+}
+
+ThreadState::~ThreadState ()
+{
+  if (ring != 0)
+    {
+      ring->closed.store (true, std::memory_order_release);
+    }
+  for (std::size_t i = 0; i < buffers.size (); i++)
+    {
+      delete buffers[i];
+      delete streams[i];
+    }
+  g_threadStateDestroyed = true;
+}
+
+LogBinaryRecord::Buffer *
+ThreadState::Acquire (void)
+{
+  if (depth == buffers.size ())
+    {
+      buffers.push_back (new LogBinaryRecord::Buffer ());
+      streams.push_back (new std::ostringstream ());
+      buffers.back ()->text = streams.back ();
+    }
+  LogBinaryRecord::Buffer *buffer = buffers[depth++];
+  buffer->bytes.clear ();
+  return buffer;
+}
+
+void
+ThreadState::Release (void)
+{
+  depth--;
+}
+
+/** Serializes the NS_LOG_APPEND_CONTEXT captures of std::clog. */
+std::recursive_mutex g_contextMutex;
+
+
+/**
+ * Print a time step as DefaultTimePrinter prints the current time.
+ * \param [in,out] os The output stream.
+ * \param [in] step The time step.
+ * \param [in] unit The time resolution of \p step.
+ */
+void
+PrintTime (std::ostream & os, int64_t step, Time::Unit unit)
+{
+  std::ios_base::fmtflags ff = os.flags ();
+  std::streamsize oldPrecision = os.precision ();
+  os << std::fixed;
+  switch (unit)
+    {
+    case Time::US :    os << std::setprecision (6);   break;
+    case Time::NS :    os << std::setprecision (9);   break;
+    case Time::PS :    os << std::setprecision (12);  break;
+    case Time::FS :    os << std::setprecision (15);  break;
+    default :
+      os << std::setprecision (5);
+    }
+  os << Time::FromInteger (step, unit).As (Time::S);
+  os << std::setprecision (oldPrecision);
+  os.flags (ff);
+}
+
+/** A logging statement read from a binary log. */
+struct DecodedSite
+{
+  LogBinarySite::Kind kind;  //!< The logging macro.
+  uint32_t level;            //!< The log level.
+  std::string name;          //!< The component name.
+  std::string function;      //!< The function name.
+};
+
+/** The state of LogBinaryDecode. */
+class Decoder
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] os The output stream.
+   */
+  Decoder (std::ostream & os);
+  /**
+   * Render the complete records of a ring.
+   * \param [in,out] pending The bytes received from the ring.
+   * \returns \c false if a record is not valid.
+   */
+  bool Render (std::vector<uint8_t> & pending);
+
+  std::map<uint32_t, DecodedSite> sites;     //!< The statements.
+  std::map<uint32_t, std::string> literals;  //!< The literals.
+  Time::Unit unit;                           //!< The Time resolution.
+
+private:
+  /**
+   * Read a value from the record being rendered.
+   * \param [out] value The value.
+   * \returns \c false at the end of the record.
+   */
+  template <typename T>
+  bool Read (T & value);
+  /**
+   * Render the next argument of the record.
+   * \param [in] quote Quote the strings.
+   * \returns \c false if the argument is not valid.
+   */
+  bool RenderItem (bool quote);
+  /**
+   * Render a record.
+   * \returns \c false if the record is not valid.
+   */
+  bool RenderRecord (void);
+
+  std::ostream &m_os;            //!< The output stream.
+  std::ostringstream m_line;     //!< The message being rendered.
+  const uint8_t *m_current;      //!< The read position in the record.
+  const uint8_t *m_end;          //!< The end of the record.
+};
+
+Decoder::Decoder (std::ostream & os)
+  : unit (Time::NS),
+    m_os (os),
+    m_current (0),
+    m_end (0)
+{
+}
+
+template <typename T>
+bool
+Decoder::Read (T & value)
+{
+  if (static_cast<std::size_t> (m_end - m_current) < sizeof (value))
+    {
+      return false;
+    }
+  std::memcpy (&value, m_current, sizeof (value));
+  m_current += sizeof (value);
+  return true;
+}
+
+bool
+Decoder::RenderItem (bool quote)
+{
+  uint8_t tag;
+  if (!Read (tag))
+    {
+      return false;
+    }
+  switch (tag)
+    {
+    case LogBinaryRecord::TEXT:
+    case LogBinaryRecord::STRING:
+      {
+        uint32_t size;
+        if (!Read (size) || static_cast<std::size_t> (m_end - m_current) < size)
+          {
+            return false;
+          }
+        std::string text (reinterpret_cast<const char *> (m_current), size);
+        m_current += size;
+        if (quote && tag == LogBinaryRecord::STRING)
+          {
+            m_line << "\"" << text << "\"";
+          }
+        else
+          {
+            m_line << text;
+          }
+        return true;
+      }
+    case LogBinaryRecord::LITERAL:
+      {
+        uint32_t id;
+        if (!Read (id) || literals.find (id) == literals.end ())
+          {
+            return false;
+          }
+        if (quote)
+          {
+            m_line << "\"" << literals[id] << "\"";
+          }
+        else
+          {
+            m_line << literals[id];
+          }
+        return true;
+      }
+#define NS_LOG_BINARY_RENDER(tag, type)         \
+    case LogBinaryRecord::tag:                  \
+      {                                         \
+        type value;                             \
+        if (!Read (value))                      \
+          {                                     \
+            return false;                       \
+          }                                     \
+        m_line << value;                        \
+        return true;                            \
+      }
+      NS_LOG_BINARY_RENDER (CHAR, char)
+      NS_LOG_BINARY_RENDER (BOOL, bool)
+      NS_LOG_BINARY_RENDER (INT16, int16_t)
+      NS_LOG_BINARY_RENDER (UINT16, uint16_t)
+      NS_LOG_BINARY_RENDER (INT32, int32_t)
+      NS_LOG_BINARY_RENDER (UINT32, uint32_t)
+      NS_LOG_BINARY_RENDER (INT64, int64_t)
+      NS_LOG_BINARY_RENDER (UINT64, uint64_t)
+      NS_LOG_BINARY_RENDER (FLOAT, float)
+      NS_LOG_BINARY_RENDER (DOUBLE, double)
+      NS_LOG_BINARY_RENDER (LONG_DOUBLE, long double)
+#undef NS_LOG_BINARY_RENDER
+    case LogBinaryRecord::POINTER:
+      {
+        uint64_t value;
+        if (!Read (value))
+          {
+            return false;
+          }
+        m_line << reinterpret_cast<const void *> (static_cast<uintptr_t> (value));
+        return true;
+      }
+    case LogBinaryRecord::TIME:
+      {
+        int64_t value;
+        if (!Read (value))
+          {
+            return false;
+          }
+        m_line << Time::FromInteger (value, unit).As (unit);
+        return true;
+      }
+    default:
+      return false;
+    }
+}
+
+bool
+Decoder::RenderRecord (void)
+{
+  uint32_t id;
+  uint8_t flags;
+  if (!Read (id) || !Read (flags) || sites.find (id) == sites.end ())
+    {
+      return false;
+    }
+  const DecodedSite &site = sites[id];
+  m_line.str ("");
+  m_line.clear ();
+  m_line.flags (std::ios_base::dec | std::ios_base::skipws);
+  m_line.precision (6);
+  m_line.width (0);
+  m_line.fill (' ');
+
+  int64_t step;
+  if (flags & LogBinaryRecord::PREFIX_TIME)
+    {
+      if (!Read (step))
+        {
+          return false;
+        }
+      PrintTime (m_line, step, unit);
+      m_line << " ";
+    }
+  else if (flags & LogBinaryRecord::TEXT_TIME)
+    {
+      if (!RenderItem (false))
+        {
+          return false;
+        }
+      m_line << " ";
+    }
+  uint32_t context;
+  if (flags & LogBinaryRecord::PREFIX_NODE)
+    {
+      if (!Read (context))
+        {
+          return false;
+        }
+      if (context == Simulator::NO_CONTEXT)
+        {
+          m_line << "-1";
+        }
+      else
+        {
+          m_line << context;
+        }
+      m_line << " ";
+    }
+  else if (flags & LogBinaryRecord::TEXT_NODE)
+    {
+      if (!RenderItem (false))
+        {
+          return false;
+        }
+      m_line << " ";
+    }
+  if ((flags & LogBinaryRecord::TEXT_CONTEXT) && !RenderItem (false))
+    {
+      return false;
+    }
+
+  if (site.kind == LogBinarySite::MESSAGE)
+    {
+      if (flags & LogBinaryRecord::PREFIX_FUNC)
+        {
+          m_line << site.name << ":" << site.function << "(): ";
+        }
+      if (flags & LogBinaryRecord::PREFIX_LEVEL)
+        {
+          m_line << "[" << LogComponent::GetLevelLabel (static_cast<LogLevel> (site.level)) << "] ";
+        }
+      while (m_current != m_end)
+        {
+          if (!RenderItem (false))
+            {
+              return false;
+            }
+        }
+    }
+  else
+    {
+      m_line << site.name << ":" << site.function << "(";
+      bool first = true;
+      while (m_current != m_end)
+        {
+          if (!first)
+            {
+              m_line << ", ";
+            }
+          first = false;
+          if (!RenderItem (true))
+            {
+              return false;
+            }
+        }
+      m_line << ")";
+    }
+  m_os << m_line.str () << '\n';
+  return true;
+}
+
+bool
+Decoder::Render (std::vector<uint8_t> & pending)
+{
+  std::size_t offset = 0;
+  while (pending.size () - offset >= sizeof (uint32_t))
+    {
+      uint32_t size;
+      std::memcpy (&size, &pending[offset], sizeof (size));
+      if (pending.size () - offset - sizeof (size) < size)
+        {
+          break;
+        }
+      m_current = &pending[offset + sizeof (size)];
+      m_end = m_current + size;
+      if (!RenderRecord ())
+        {
+          return false;
+        }
+      offset += sizeof (size) + size;
+    }
+  pending.erase (pending.begin (), pending.begin () + offset);
+  return true;
+}
+
+/**
+ * Read a value from a binary log.
+ * \param [in,out] is The binary log.
+ * \param [out] value The value.
+ * \returns \c false at the end of the file.
+ */
+template <typename T>
+bool
+ReadValue (std::istream & is, T & value)
+{
+  return static_cast<bool> (is.read (reinterpret_cast<char *> (&value), sizeof (value)));
+}
+
+/**
+ * Read a string from a binary log.
+ * \param [in,out] is The binary log.
+ * \param [out] value The string.
+ * \returns \c false at the end of the file.
+ */
+bool
+ReadString (std::istream & is, std::string & value)
+{
+  uint32_t size;
+  if (!ReadValue (is, size))
+    {
+      return false;
+    }
+  value.resize (size);
+  return size == 0 || static_cast<bool> (is.read (&value[0], size));
+}
+
+
+/**
+ * Handler for the \c NS_LOG_BINARY environment variable, and for the
+ * binary log file at the end of the program.
+ */
+class EnvironmentBinaryLog
+{
+public:
+  /** Enable the binary log if \c NS_LOG_BINARY is set. */
+  EnvironmentBinaryLog ();
+  /** Write the pending records and close the file. */
+  ~EnvironmentBinaryLog ();
+};
+
+EnvironmentBinaryLog::EnvironmentBinaryLog ()
+{
+#ifdef HAVE_GETENV
+  char *envVar = getenv ("NS_LOG_BINARY");
+  if (envVar != 0 && std::strlen (envVar) != 0)
+    {
+      LogBinaryEnable (envVar);
+    }
+#endif
+}
+
+EnvironmentBinaryLog::~EnvironmentBinaryLog ()
+{
+  LogBinaryDisable ();
+}
+
+/** Invoke the handler of the \c NS_LOG_BINARY environment variable. */
+EnvironmentBinaryLog g_environmentBinaryLog;
+
+} // unnamed namespace
+
+
+void
+LogBinaryEnable (const std::string & filename, uint32_t ringSize)
+{
+  GetSink ().Enable (filename, ringSize);
+}
+
+void
+LogBinaryDisable (void)
+{
+  GetSink ().Disable ();
+}
+
+bool
+LogBinaryIsEnabled (void)
+{
+  return GetSink ().enabled.load (std::memory_order_relaxed);
+}
+
+void
+LogBinaryFlush (void)
+{
+  GetSink ().Flush ();
+}
+
+bool
+LogBinaryDecode (std::istream & is, std::ostream & os)
+{
+  char magic[sizeof (LOG_BINARY_MAGIC)];
+  uint32_t version;
+  if (!is.read (magic, sizeof (magic))
+      || std::memcmp (magic, LOG_BINARY_MAGIC, sizeof (magic)) != 0
+      || !ReadValue (is, version) || version != LOG_BINARY_VERSION)
+    {
+      return false;
+    }
+  Decoder decoder (os);
+  std::map<uint32_t, std::vector<uint8_t> > pending;
+  char chunk;
+  while (is.get (chunk))
+    {
+      switch (chunk)
+        {
+        case CHUNK_SITE:
+          {
+            uint32_t id;
+            uint8_t kind;
+            uint32_t line;
+            std::string file;
+            DecodedSite site;
+            if (!ReadValue (is, id) || !ReadValue (is, kind) || !ReadValue (is, site.level)
+                || !ReadValue (is, line) || !ReadString (is, site.name)
+                || !ReadString (is, site.function) || !ReadString (is, file))
+              {
+                return false;
+              }
+            site.kind = static_cast<LogBinarySite::Kind> (kind);
+            decoder.sites[id] = site;
+            break;
+          }
+        case CHUNK_LITERAL:
+          {
+            uint32_t id;
+            std::string text;
+            if (!ReadValue (is, id) || !ReadString (is, text))
+              {
+                return false;
+              }
+            decoder.literals[id] = text;
+            break;
+          }
+        case CHUNK_RESOLUTION:
+          {
+            uint8_t unit;
+            if (!ReadValue (is, unit) || unit >= Time::LAST)
+              {
+                return false;
+              }
+            decoder.unit = static_cast<Time::Unit> (unit);
+            if (Time::GetResolution () != decoder.unit)
+              {
+                Time::SetResolution (decoder.unit);
+              }
+            break;
+          }
+        case CHUNK_DATA:
+          {
+            uint32_t id;
+            uint32_t size;
+            if (!ReadValue (is, id) || !ReadValue (is, size))
+              {
+                return false;
+              }
+            std::vector<uint8_t> &bytes = pending[id];
+            std::size_t offset = bytes.size ();
+            bytes.resize (offset + size);
+            if (size != 0 && !is.read (reinterpret_cast<char *> (&bytes[offset]), size))
+              {
+                return false;
+              }
+            if (!decoder.Render (bytes))
+              {
+                return false;
+              }
+            break;
+          }
+        default:
+          return false;
+        }
+    }
+  return true;
+}
+
+
+LogBinarySite::LogBinarySite (const LogComponent & log, const char * function,
+                              const char * file, uint32_t line, uint32_t level,
+                              Kind kind)
+  : m_id (GetSink ().AddSite (log.Name (), function, file, line, level, kind)),
+    m_kind (kind)
+{
+}
+
+uint32_t
+LogBinarySite::GetId (void) const
+{
+  return m_id;
+}
+
+LogBinarySite::Kind
+LogBinarySite::GetKind (void) const
+{
+  return m_kind;
+}
+
+
+LogBinaryRecord::Buffer::Buffer ()
+  : text (0)
+{
+}
+
+LogBinaryRecord::LogBinaryRecord (const LogBinarySite & site, const LogComponent & log)
+  : m_buffer (0),
+    m_parameters (site.GetKind () == LogBinarySite::FUNCTION),
+    m_formatting (false),
+    m_flagsOffset (0)
+{
+  if (g_threadStateDestroyed)
+    {
+      return;
+    }
+  m_buffer = g_threadState.Acquire ();
+  std::vector<uint8_t> &bytes = m_buffer->bytes;
+  AppendBytes<uint32_t> (bytes, 0);
+  AppendBytes<uint32_t> (bytes, site.GetId ());
+  m_flagsOffset = bytes.size ();
+  uint8_t flags = 0;
+  if (log.IsEnabled (LOG_PREFIX_FUNC))
+    {
+      flags |= PREFIX_FUNC;
+    }
+  if (log.IsEnabled (LOG_PREFIX_LEVEL))
+    {
+      flags |= PREFIX_LEVEL;
+    }
+  bytes.push_back (flags);
+  if (log.IsEnabled (LOG_PREFIX_TIME))
+    {
+      TimePrinter printer = LogGetTimePrinter ();
+      if (printer == &DefaultTimePrinter)
+        {
+          bytes[m_flagsOffset] |= PREFIX_TIME;
+          AppendBytes<int64_t> (bytes, Simulator::Now ().GetTimeStep ());
+        }
+      else if (printer != 0)
+        {
+          bytes[m_flagsOffset] |= TEXT_TIME;
+          (*printer)(StartFormatting ());
+          FlushText ();
+          m_formatting = false;
+        }
+    }
+  if (log.IsEnabled (LOG_PREFIX_NODE))
+    {
+      NodePrinter printer = LogGetNodePrinter ();
+      if (printer == &DefaultNodePrinter)
+        {
+          bytes[m_flagsOffset] |= PREFIX_NODE;
+          AppendBytes<uint32_t> (bytes, Simulator::GetContext ());
+        }
+      else if (printer != 0)
+        {
+          bytes[m_flagsOffset] |= TEXT_NODE;
+          (*printer)(StartFormatting ());
+          FlushText ();
+          m_formatting = false;
+        }
+    }
+}
+
+LogBinaryRecord::~LogBinaryRecord ()
+{
+  if (m_buffer == 0)
+    {
+      return;
+    }
+  FlushText ();
+  std::vector<uint8_t> &bytes = m_buffer->bytes;
+  uint32_t size = static_cast<uint32_t> (bytes.size () - sizeof (size));
+  std::memcpy (&bytes[0], &size, sizeof (size));
+  ThreadState &state = g_threadState;
+  if (state.ring == 0)
+    {
+      state.ring = GetSink ().AddRing ();
+    }
+  GetSink ().Push (state.ring, &bytes[0], bytes.size ());
+  state.Release ();
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (std::ostream & (*manipulator)(std::ostream &))
+{
+  if (m_buffer != 0)
+    {
+      StartFormatting () << manipulator;
+    }
+  return *this;
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (std::ios_base & (*manipulator)(std::ios_base &))
+{
+  if (m_buffer != 0)
+    {
+      StartFormatting () << manipulator;
+    }
+  return *this;
+}
+
+void
+LogBinaryRecord::PutString (const char * value, std::size_t size)
+{
+  if (m_buffer == 0)
+    {
+      return;
+    }
+  if (m_formatting)
+    {
+      std::ostream &os = *m_buffer->text;
+      if (m_parameters)
+        {
+          os << "\"";
+          os.write (value, size);
+          os << "\"";
+        }
+      else
+        {
+          os.write (value, size);
+        }
+      return;
+    }
+  m_buffer->bytes.push_back (STRING);
+  AppendString (m_buffer->bytes, value, size);
+}
+
+void
+LogBinaryRecord::PutLiteral (const char * value, std::size_t capacity)
+{
+  if (m_buffer == 0)
+    {
+      return;
+    }
+  std::size_t size = strnlen (value, capacity);
+  if (m_formatting)
+    {
+      PutString (value, size);
+      return;
+    }
+  // Character arrays are not always literals: an array whose content
+  // changes is recorded as a string from then on.
+  std::unordered_map<const char *, ThreadState::Literal> &literals = g_threadState.literals;
+  std::unordered_map<const char *, ThreadState::Literal>::iterator i = literals.find (value);
+  if (i == literals.end ())
+    {
+      ThreadState::Literal literal;
+      literal.id = GetSink ().AddLiteral (value, size);
+      literal.text.assign (value, size);
+      literal.interned = true;
+      i = literals.insert (std::make_pair (value, literal)).first;
+    }
+  else if (i->second.interned
+           && (i->second.text.size () != size
+               || std::memcmp (i->second.text.data (), value, size) != 0))
+    {
+      i->second.interned = false;
+    }
+  if (!i->second.interned)
+    {
+      PutString (value, size);
+      return;
+    }
+  Append (LITERAL, &i->second.id, sizeof (i->second.id));
+}
+
+void
+LogBinaryRecord::PutTime (const Time & value)
+{
+  if (m_formatting)
+    {
+      *m_buffer->text << value;
+      return;
+    }
+  int64_t step = value.GetTimeStep ();
+  Append (TIME, &step, sizeof (step));
+}
+
+void
+LogBinaryRecord::EndParameter (void)
+{
+  FlushText ();
+}
+
+std::ostream &
+LogBinaryRecord::StartFormatting (void)
+{
+  std::ostream &os = *m_buffer->text;
+  if (!m_formatting)
+    {
+      // Each message is formatted from the default stream state.
+      os.flags (std::ios_base::dec | std::ios_base::skipws);
+      os.precision (6);
+      os.width (0);
+      os.fill (' ');
+      m_formatting = true;
+    }
+  return os;
+}
+
+void
+LogBinaryRecord::FlushText (void)
+{
+  if (!m_formatting)
+    {
+      return;
+    }
+  std::ostringstream &os = static_cast<std::ostringstream &> (*m_buffer->text);
+  std::string text = os.str ();
+  os.str ("");
+  m_buffer->bytes.push_back (TEXT);
+  AppendString (m_buffer->bytes, text.data (), text.size ());
+}
+
+std::streambuf *
+LogBinaryRecord::BeginContext (void)
+{
+  if (m_buffer == 0)
+    {
+      return g_threadStateDestroyed ? std::clog.rdbuf () : &g_threadState.discarded;
+    }
+  // The context is captured right after the prefixes, so the text
+  // stream of the record is empty.
+  return StartFormatting ().rdbuf ();
+}
+
+void
+LogBinaryRecord::EndContext (void)
+{
+  if (m_buffer == 0)
+    {
+      if (!g_threadStateDestroyed)
+        {
+          g_threadState.discarded.str ("");
+        }
+      return;
+    }
+  std::ostringstream &os = static_cast<std::ostringstream &> (*m_buffer->text);
+  if (os.tellp () > 0)
+    {
+      m_buffer->bytes[m_flagsOffset] |= TEXT_CONTEXT;
+      FlushText ();
+    }
+  m_formatting = false;
+}
+
+LogBinaryParameters::LogBinaryParameters (LogBinaryRecord & record)
+  : m_record (record)
+{
+}
+
+
+LogBinaryContext::LogBinaryContext (LogBinaryRecord & record)
+  : m_record (record),
+    m_previous (0)
+{
+  g_contextMutex.lock ();
+  m_previous = std::clog.rdbuf (m_record.BeginContext ());
+}
+
+LogBinaryContext::~LogBinaryContext ()
+{
+  std::clog.rdbuf (m_previous);
+  m_record.EndContext ();
+  g_contextMutex.unlock ();
+}
+
+} // namespace ns3
@@ -111,6 +111,45 @@
 #define NS_LOG_APPEND_CONTEXT
 #endif /* NS_LOG_APPEND_CONTEXT */
 
+/**
+ * \ingroup logging
+ * Stringify the expansion of a macro.
+ * \internal
+ * Logging implementation macro; should not be called directly.
+ *
+ * \param [in] ... The macro.
+ */
+#define NS_LOG_BINARY_STRINGIFY(...) NS_LOG_BINARY_STRINGIFY_ (__VA_ARGS__)
+/**
+ * \ingroup logging
+ * Stringify the arguments, see NS_LOG_BINARY_STRINGIFY.
+ * \internal
+ * Logging implementation macro; should not be called directly.
+ *
+ * \param [in] ... The arguments.
+ */
+#define NS_LOG_BINARY_STRINGIFY_(...) #__VA_ARGS__
+
+/**
+ * \ingroup logging
+ * Record the NS_LOG_APPEND_CONTEXT text in a binary log record.
+ * \internal
+ * Logging implementation macro; should not be called directly.
+ *
+ * NS_LOG_APPEND_CONTEXT is expanded where the log statement is, since
+ * most files define it after including this header.  The text is only
+ * captured when NS_LOG_APPEND_CONTEXT is not empty, which is known at
+ * compile time.
+ *
+ * \param [in] record The ns3::LogBinaryRecord.
+ */
+#define NS_LOG_BINARY_APPEND_CONTEXT(record)                    \
+  if (sizeof (NS_LOG_BINARY_STRINGIFY (NS_LOG_APPEND_CONTEXT)) > 1) \
+    {                                                           \
+      ns3::LogBinaryContext ns3LogContext (record);             \
+      NS_LOG_APPEND_CONTEXT;                                    \
+    }
+
 
 #ifndef NS_LOG_CONDITION
 /**
@@ -130,6 +169,27 @@
 #define NS_LOG_CONDITION
 #endif
 
+/**
+ * \ingroup logging
+ * Record a log message in the binary log.
+ * \internal
+ * Logging implementation macro; should not be called directly.
+ *
+ * \param [in] kind The ns3::LogBinarySite::Kind of the statement.
+ * \param [in] level The log level.
+ * \param [in] items The statement recording the arguments
+ *             on \c ns3LogRecord.
+ */
+#define NS_LOG_BINARY(kind, level, items)                       \
+  {                                                             \
+    static ns3::LogBinarySite ns3LogSite (g_log, __FUNCTION__,  \
+                                          __FILE__, __LINE__,   \
+                                          level, kind);         \
+    ns3::LogBinaryRecord ns3LogRecord (ns3LogSite, g_log);      \
+    NS_LOG_BINARY_APPEND_CONTEXT (ns3LogRecord);                \
+    items;                                                      \
+  }
+
 /**
  * \ingroup logging
  *
@@ -155,12 +215,20 @@
     {                                                           \
       if (g_log.IsEnabled (level))                              \
         {                                                       \
-          NS_LOG_APPEND_TIME_PREFIX;                            \
-          NS_LOG_APPEND_NODE_PREFIX;                            \
-          NS_LOG_APPEND_CONTEXT;                                \
-          NS_LOG_APPEND_FUNC_PREFIX;                            \
-          NS_LOG_APPEND_LEVEL_PREFIX (level);                   \
-          std::clog << msg << std::endl;                        \
+          if (ns3::LogBinaryIsEnabled ())                       \
+            {                                                   \
+              NS_LOG_BINARY (ns3::LogBinarySite::MESSAGE, level, \
+                             ns3LogRecord << msg);              \
+            }                                                   \
+          else                                                  \
+            {                                                   \
+              NS_LOG_APPEND_TIME_PREFIX;                        \
+              NS_LOG_APPEND_NODE_PREFIX;                        \
+              NS_LOG_APPEND_CONTEXT;                            \
+              NS_LOG_APPEND_FUNC_PREFIX;                        \
+              NS_LOG_APPEND_LEVEL_PREFIX (level);               \
+              std::clog << msg << std::endl;                    \
+            }                                                   \
         }                                                       \
     }                                                           \
   while (false)
@@ -179,11 +247,19 @@
     {                                                           \
       if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
         {                                                       \
-          NS_LOG_APPEND_TIME_PREFIX;                            \
-          NS_LOG_APPEND_NODE_PREFIX;                            \
-          NS_LOG_APPEND_CONTEXT;                                \
-          std::clog << g_log.Name () << ":"                     \
-                    << __FUNCTION__ << "()" << std::endl;       \
+          if (ns3::LogBinaryIsEnabled ())                       \
+            {                                                   \
+              NS_LOG_BINARY (ns3::LogBinarySite::FUNCTION_NOARGS, \
+                             ns3::LOG_FUNCTION, (void) 0);      \
+            }                                                   \
+          else                                                  \
+            {                                                   \
+              NS_LOG_APPEND_TIME_PREFIX;                        \
+              NS_LOG_APPEND_NODE_PREFIX;                        \
+              NS_LOG_APPEND_CONTEXT;                            \
+              std::clog << g_log.Name () << ":"                 \
+                        << __FUNCTION__ << "()" << std::endl;   \
+            }                                                   \
         }                                                       \
     }                                                           \
   while (false)
@@ -216,13 +292,23 @@
     {                                                           \
       if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
         {                                                       \
-          NS_LOG_APPEND_TIME_PREFIX;                            \
-          NS_LOG_APPEND_NODE_PREFIX;                            \
-          NS_LOG_APPEND_CONTEXT;                                \
-          std::clog << g_log.Name () << ":"                     \
-                    << __FUNCTION__ << "(";                     \
-          ns3::ParameterLogger (std::clog) << parameters;       \
-          std::clog << ")" << std::endl;                        \
+          if (ns3::LogBinaryIsEnabled ())                       \
+            {                                                   \
+              NS_LOG_BINARY (ns3::LogBinarySite::FUNCTION,      \
+                             ns3::LOG_FUNCTION,                 \
+                             ns3::LogBinaryParameters (ns3LogRecord) \
+                             << parameters);                    \
+            }                                                   \
+          else                                                  \
+            {                                                   \
+              NS_LOG_APPEND_TIME_PREFIX;                        \
+              NS_LOG_APPEND_NODE_PREFIX;                        \
+              NS_LOG_APPEND_CONTEXT;                            \
+              std::clog << g_log.Name () << ":"                 \
+                        << __FUNCTION__ << "(";                 \
+              ns3::ParameterLogger (std::clog) << parameters;   \
+              std::clog << ")" << std::endl;                    \
+            }                                                   \
         }                                                       \
     }                                                           \
   while (false)
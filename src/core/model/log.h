@@ -29,6 +29,7 @@
 
 #include "node-printer.h"
 #include "time-printer.h"
+#include "log-binary.h"
 #include "log-macros-enabled.h"
 #include "log-macros-disabled.h"
 
@@ -63,6 +64,9 @@
  * would enable two components, at all log levels, etc.
  * \c NS_LOG="*" will enable all available log components at all levels.
  *
+ * Set the \c NS_LOG_BINARY environment variable to a file name to
+ * record the messages in a binary file instead, see \ref logbinary.
+ *
  * To control more selectively the log levels for each component, use
  * this syntax:
  * \code
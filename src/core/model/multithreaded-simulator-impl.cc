@@ -0,0 +1,922 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "simulator.h"
+#include "multithreaded-simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+#include "config.h"
+#include "uinteger.h"
+#include "boolean.h"
+
+#include "ptr.h"
+#include "pointer.h"
+#include "assert.h"
+#include "fatal-error.h"
+#include "log.h"
+#include "ns3/core-config.h"
+
+#include <algorithm>
+
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+namespace {
+
+/** Largest representable timestamp. */
+const uint64_t MAX_TS = 0x7fffffffffffffffULL;
+
+/**
+ * Order the events received by a partition by timestamp, then by
+ * sender, so that their insertion order does not depend on the
+ * thread interleaving.
+ */
+struct RemoteEventLess
+{
+  /**
+   * \param [in] a The first event.
+   * \param [in] b The second event.
+   * \return \c true if \pname{a} must be inserted before \pname{b}.
+   */
+  template <typename T>
+  bool operator () (const T &a, const T &b) const
+  {
+    if (a.ts != b.ts)
+      {
+        return a.ts < b.ts;
+      }
+    if (a.source != b.source)
+      {
+        return a.source < b.source;
+      }
+    return a.sequence < b.sequence;
+  }
+};
+
+} // unnamed namespace
+
+thread_local MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::m_current = 0;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Core")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("ThreadCount",
+                   "The number of partition threads, or 0 to use one thread "
+                   "per hardware core when ns-3 is configured with "
+                   "--enable-atomic-refcount, and a single thread otherwise.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_threadCount),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Lookahead",
+                   "The minimum delay of any event sent between two partitions, "
+                   "or 0 to compute it from the delay of the channels.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::m_lookaheadAttribute),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("RequireAtomicRefCount",
+                   "Whether more than one thread requires ns-3 configured with "
+                   "--enable-atomic-refcount.  Clear it only for models whose "
+                   "partitions share no reference-counted object.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&MultithreadedSimulatorImpl::m_requireAtomicRefCount),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_global (0),
+    m_foreignEventsEmpty (true),
+    m_parallel (false),
+    m_roundEnd (0),
+    m_uid (4),
+    m_round (0),
+    m_running (0),
+    m_exit (false),
+    m_stop (false)
+{
+  NS_LOG_FUNCTION (this);
+  // uids are allocated from 4.
+  // uid 0 is "invalid" events
+  // uid 1 is "now" events
+  // uid 2 is "destroy" events
+  m_lookahead = 0;
+  m_main = SystemThread::Self ();
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  StopThreads ();
+  MergeRemoteEvents ();
+
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      while (!(*i)->events->IsEmpty ())
+        {
+          Scheduler::Event next = (*i)->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      delete *i;
+    }
+  m_partitions.clear ();
+  if (m_global != 0)
+    {
+      while (!m_global->events->IsEmpty ())
+        {
+          Scheduler::Event next = m_global->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      delete m_global;
+      m_global = 0;
+    }
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+#ifndef NS3_ATOMIC_REFCOUNT
+  // The partition threads share objects through Ptr.
+  if (m_threadCount > 1 && m_requireAtomicRefCount)
+    {
+      NS_FATAL_ERROR ("MultithreadedSimulatorImpl with more than one thread "
+                      "requires ns-3 configured with --enable-atomic-refcount; "
+                      "reconfigure, or set ThreadCount to 1, or clear "
+                      "RequireAtomicRefCount if the partitions share no Ptr");
+    }
+#endif
+  m_schedulerFactory = schedulerFactory;
+
+  if (m_global == 0)
+    {
+      m_global = new Partition ();
+      m_global->currentUid = 0;
+      m_global->currentTs = 0;
+      m_global->currentContext = Simulator::NO_CONTEXT;
+      m_global->eventCount = 0;
+      m_global->unscheduledEvents = 0;
+      m_global->sequence = 0;
+    }
+  std::vector<Partition *> partitions = m_partitions;
+  partitions.push_back (m_global);
+  for (std::vector<Partition *>::iterator i = partitions.begin (); i != partitions.end (); ++i)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if ((*i)->events != 0)
+        {
+          while (!(*i)->events->IsEmpty ())
+            {
+              Scheduler::Event next = (*i)->events->RemoveNext ();
+              scheduler->Insert (next);
+            }
+        }
+      (*i)->events = scheduler;
+    }
+
+  if (m_partitions.empty ())
+    {
+      Repartition (GetThreadCount ());
+    }
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetThreadCount (void) const
+{
+  if (m_threadCount != 0)
+    {
+      return m_threadCount;
+    }
+#ifdef NS3_ATOMIC_REFCOUNT
+  return std::max (std::thread::hardware_concurrency (), 1U);
+#else
+  if (std::thread::hardware_concurrency () > 1)
+    {
+      NS_LOG_WARN ("One thread per core requires ns-3 configured with "
+                   "--enable-atomic-refcount: running with a single partition");
+    }
+  return 1;
+#endif
+}
+
+void
+MultithreadedSimulatorImpl::Repartition (uint32_t count)
+{
+  NS_LOG_FUNCTION (this << count);
+  NS_ASSERT (count > 0);
+  if (count == m_partitions.size ())
+    {
+      return;
+    }
+
+  std::vector<Partition *> old = m_partitions;
+  m_partitions.clear ();
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      Partition *p = new Partition ();
+      p->index = i;
+      p->events = m_schedulerFactory.Create<Scheduler> ();
+      p->currentUid = 0;
+      p->currentTs = m_global->currentTs;
+      p->currentContext = Simulator::NO_CONTEXT;
+      p->eventCount = 0;
+      p->unscheduledEvents = 0;
+      p->sequence = 0;
+      m_partitions.push_back (p);
+    }
+  m_global->index = count;
+
+  // Event uids are unique across partitions, so the pending events
+  // keep their key when they move to their new partition.
+  for (std::vector<Partition *>::iterator i = old.begin (); i != old.end (); ++i)
+    {
+      while (!(*i)->events->IsEmpty ())
+        {
+          Scheduler::Event next = (*i)->events->RemoveNext ();
+          Partition *p = GetPartition (next.key.m_context);
+          p->events->Insert (next);
+          p->unscheduledEvents++;
+        }
+      m_partitions[0]->eventCount += (*i)->eventCount;
+      delete *i;
+    }
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return m_global;
+    }
+  return m_partitions[context % m_partitions.size ()];
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetGlobalTs (void) const
+{
+  uint64_t ts = m_global->currentTs;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      ts = std::max (ts, (*i)->currentTs);
+    }
+  return ts;
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookahead (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_lookaheadAttribute.IsStrictlyPositive ())
+    {
+      m_lookahead = m_lookaheadAttribute.GetTimeStep ();
+      return;
+    }
+
+  m_lookahead = MAX_TS;
+  // The nodes of a shared medium, like ns3::CsmaChannel, all read and
+  // write its state, and may belong to different partitions: only the
+  // point-to-point channels, whose ends only exchange events, provide
+  // a lookahead.
+  TypeId pointToPoint;
+  bool havePointToPoint = TypeId::LookupByNameFailSafe ("ns3::PointToPointChannel", &pointToPoint);
+  Config::MatchContainer channels = Config::LookupMatches ("/ChannelList/*");
+  for (Config::MatchContainer::Iterator i = channels.Begin (); i != channels.End (); ++i)
+    {
+      Ptr<Object> channel = *i;
+      TypeId tid = channel->GetInstanceTypeId ();
+      if (havePointToPoint && (tid == pointToPoint || tid.IsChildOf (pointToPoint)))
+        {
+          TimeValue delay;
+          channel->GetAttribute ("Delay", delay);
+          m_lookahead = std::min (m_lookahead, (uint64_t) delay.Get ().GetTimeStep ());
+        }
+      else
+        {
+          NS_LOG_LOGIC ("channel " << tid.GetName () << " is not point-to-point");
+          m_lookahead = 0;
+        }
+    }
+  NS_LOG_LOGIC ("lookahead " << m_lookahead);
+}
+
+Scheduler::Event
+MultithreadedSimulatorImpl::Insert (Partition *p, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = m_uid++;
+  p->unscheduledEvents++;
+  p->events->Insert (ev);
+  return ev;
+}
+
+void
+MultithreadedSimulatorImpl::MergeRemoteEvents (void)
+{
+  std::vector<Partition *> partitions = m_partitions;
+  if (m_global != 0)
+    {
+      partitions.push_back (m_global);
+    }
+  for (std::vector<Partition *>::iterator i = partitions.begin (); i != partitions.end (); ++i)
+    {
+      Partition *p = *i;
+      RemoteEvents inbox;
+      {
+        CriticalSection cs (p->inboxMutex);
+        p->inbox.swap (inbox);
+      }
+      std::sort (inbox.begin (), inbox.end (), RemoteEventLess ());
+      for (RemoteEvents::const_iterator j = inbox.begin (); j != inbox.end (); ++j)
+        {
+          Insert (p, j->ts, j->context, j->impl);
+        }
+    }
+
+  if (m_foreignEventsEmpty)
+    {
+      return;
+    }
+  std::list<struct RemoteEvent> foreignEvents;
+  {
+    CriticalSection cs (m_foreignEventsMutex);
+    m_foreignEvents.swap (foreignEvents);
+    m_foreignEventsEmpty = true;
+  }
+  // Foreign events carry a delay relative to the time they are merged.
+  uint64_t now = GetGlobalTs ();
+  for (std::list<struct RemoteEvent>::const_iterator j = foreignEvents.begin (); j != foreignEvents.end (); ++j)
+    {
+      Insert (GetPartition (j->context), now + j->ts, j->context, j->impl);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessPartition (Partition *p)
+{
+  m_current = p;
+  while (!p->events->IsEmpty () && !m_stop)
+    {
+      if (p->events->PeekNext ().key.m_ts >= m_roundEnd)
+        {
+          break;
+        }
+      Scheduler::Event next = p->events->RemoveNext ();
+
+      NS_ASSERT (next.key.m_ts >= p->currentTs);
+      p->unscheduledEvents--;
+      p->eventCount++;
+
+      p->currentTs = next.key.m_ts;
+      p->currentContext = next.key.m_context;
+      p->currentUid = next.key.m_uid;
+      next.impl->Invoke ();
+      next.impl->Unref ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessGlobalEvents (void)
+{
+  m_current = m_global;
+  uint64_t ts = m_global->events->PeekNext ().key.m_ts;
+  while (!m_global->events->IsEmpty () && !m_stop)
+    {
+      if (m_global->events->PeekNext ().key.m_ts != ts)
+        {
+          break;
+        }
+      Scheduler::Event next = m_global->events->RemoveNext ();
+
+      NS_ASSERT (next.key.m_ts >= m_global->currentTs);
+      m_global->unscheduledEvents--;
+      m_global->eventCount++;
+
+      NS_LOG_LOGIC ("handle global " << next.key.m_ts);
+      m_global->currentTs = next.key.m_ts;
+      m_global->currentUid = next.key.m_uid;
+      next.impl->Invoke ();
+      next.impl->Unref ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::PartitionThread (Partition *p, uint64_t round)
+{
+  while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lock (m_roundMutex);
+        while (!m_exit && m_round == round)
+          {
+            m_roundStartCondition.wait (lock);
+          }
+        if (m_exit)
+          {
+            break;
+          }
+        round = m_round;
+      }
+
+      ProcessPartition (p);
+
+      {
+        std::lock_guard<std::mutex> lock (m_roundMutex);
+        m_running--;
+        if (m_running == 0)
+          {
+            m_roundDoneCondition.notify_one ();
+          }
+      }
+    }
+  m_current = 0;
+}
+
+void
+MultithreadedSimulatorImpl::StartThreads (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_threads.empty ());
+  m_exit = false;
+  // Partition 0 is processed by the main thread.
+  for (uint32_t i = 1; i < m_partitions.size (); ++i)
+    {
+      m_threads.push_back (std::thread (&MultithreadedSimulatorImpl::PartitionThread,
+                                        this, m_partitions[i], m_round));
+    }
+}
+
+void
+MultithreadedSimulatorImpl::StopThreads (void)
+{
+  NS_LOG_FUNCTION (this);
+  {
+    std::lock_guard<std::mutex> lock (m_roundMutex);
+    m_exit = true;
+  }
+  m_roundStartCondition.notify_all ();
+  for (std::vector<std::thread>::iterator i = m_threads.begin (); i != m_threads.end (); ++i)
+    {
+      i->join ();
+    }
+  m_threads.clear ();
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop || !m_global->events->IsEmpty ())
+    {
+      return m_stop;
+    }
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if (!(*i)->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Set the current threadId as the main threadId
+  m_main = SystemThread::Self ();
+  m_stop = false;
+
+  CalculateLookahead ();
+  if (m_lookahead == 0)
+    {
+      NS_LOG_WARN ("No positive lookahead: running with a single partition");
+      Repartition (1);
+    }
+  else
+    {
+      Repartition (GetThreadCount ());
+    }
+  MergeRemoteEvents ();
+  if (m_partitions.size () > 1)
+    {
+      StartThreads ();
+    }
+  m_current = m_global;
+
+  while (!m_stop)
+    {
+      uint64_t next = MAX_TS;
+      bool pending = false;
+      for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+        {
+          if (!(*i)->events->IsEmpty ())
+            {
+              next = std::min (next, (*i)->events->PeekNext ().key.m_ts);
+              pending = true;
+            }
+        }
+      uint64_t globalNext = MAX_TS;
+      if (!m_global->events->IsEmpty ())
+        {
+          globalNext = m_global->events->PeekNext ().key.m_ts;
+          pending = true;
+        }
+      if (!pending)
+        {
+          break;
+        }
+
+      // Global events run alone, after all the partition events which
+      // precede them and before the partition events at the same time.
+      if (globalNext <= next)
+        {
+          ProcessGlobalEvents ();
+        }
+      else
+        {
+          m_roundEnd = globalNext;
+          if (m_lookahead < MAX_TS - next)
+            {
+              m_roundEnd = std::min (m_roundEnd, next + m_lookahead);
+            }
+          if (m_partitions.size () == 1)
+            {
+              ProcessPartition (m_partitions[0]);
+            }
+          else
+            {
+              {
+                std::lock_guard<std::mutex> lock (m_roundMutex);
+                m_parallel = true;
+                m_running = m_partitions.size () - 1;
+                m_round++;
+              }
+              m_roundStartCondition.notify_all ();
+              ProcessPartition (m_partitions[0]);
+              {
+                std::unique_lock<std::mutex> lock (m_roundMutex);
+                while (m_running != 0)
+                  {
+                    m_roundDoneCondition.wait (lock);
+                  }
+                m_parallel = false;
+              }
+            }
+          m_current = m_global;
+        }
+      MergeRemoteEvents ();
+    }
+
+  StopThreads ();
+  m_global->currentTs = GetGlobalTs ();
+  m_current = 0;
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  NS_ASSERT (m_stop || m_global->unscheduledEvents == 0);
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      NS_ASSERT (m_stop || (*i)->unscheduledEvents == 0);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  Simulator::Schedule (delay, &Simulator::Stop);
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (m_current != 0 || SystemThread::Equals (m_main),
+                 "Simulator::Schedule Thread-unsafe invocation!");
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+
+  Partition *p = m_current != 0 ? m_current : m_global;
+  Time tAbsolute = delay + TimeStep (p->currentTs);
+  Scheduler::Event ev = Insert (p, (uint64_t) tAbsolute.GetTimeStep (), p->currentContext, event);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+
+  if (m_current == 0 && !SystemThread::Equals (m_main))
+    {
+      RemoteEvent ev;
+      ev.impl = event;
+      // Current time added in MergeRemoteEvents()
+      ev.ts = delay.GetTimeStep ();
+      ev.context = context;
+      ev.source = 0;
+      ev.sequence = 0;
+      {
+        CriticalSection cs (m_foreignEventsMutex);
+        m_foreignEvents.push_back (ev);
+        m_foreignEventsEmpty = false;
+      }
+      return;
+    }
+
+  Partition *p = m_current != 0 ? m_current : m_global;
+  Partition *target = GetPartition (context);
+  Time tAbsolute = delay + TimeStep (p->currentTs);
+  uint64_t ts = (uint64_t) tAbsolute.GetTimeStep ();
+  if (target == p || !m_parallel)
+    {
+      Insert (target, ts, context, event);
+      return;
+    }
+
+  if (ts < m_roundEnd)
+    {
+      NS_FATAL_ERROR ("MultithreadedSimulatorImpl: event for context " << context <<
+                      " at " << ts << " is earlier than the lookahead allows (" <<
+                      m_roundEnd << "); set the Lookahead attribute to at most " <<
+                      delay.GetTimeStep () << " time steps");
+    }
+  RemoteEvent ev;
+  ev.impl = event;
+  ev.ts = ts;
+  ev.context = context;
+  ev.source = p->index;
+  ev.sequence = p->sequence++;
+  {
+    CriticalSection cs (target->inboxMutex);
+    target->inbox.push_back (ev);
+  }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  NS_ASSERT_MSG (m_current != 0 || SystemThread::Equals (m_main),
+                 "Simulator::ScheduleNow Thread-unsafe invocation!");
+
+  Partition *p = m_current != 0 ? m_current : m_global;
+  Scheduler::Event ev = Insert (p, p->currentTs, p->currentContext, event);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_ASSERT_MSG (SystemThread::Equals (m_main) && (m_current == 0 || m_current == m_global),
+                 "Simulator::ScheduleDestroy Thread-unsafe invocation!");
+
+  EventId id (Ptr<EventImpl> (event, false), m_global->currentTs, 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  m_uid++;
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  Partition *p = m_current != 0 ? m_current : m_global;
+  return TimeStep (p->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs ()) - Now ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *p = GetPartition (id.GetContext ());
+  NS_ASSERT_MSG (m_current == 0 || m_current == p || !m_parallel,
+                 "Simulator::Remove of an event owned by another partition");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  p->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  p->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  NS_ASSERT_MSG (id.GetUid () == 2 || m_current == GetPartition (id.GetContext ()) || !m_parallel,
+                 "Simulator::Cancel of an event owned by another partition");
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0 ||
+          id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  if (id.PeekEventImpl () == 0)
+    {
+      return true;
+    }
+  Partition *p = GetPartition (id.GetContext ());
+  // The global partition only runs between the rounds.
+  NS_ASSERT_MSG (m_current == p || p == m_global || !m_parallel,
+                 "Simulator::IsExpired of an event owned by another partition");
+  if (id.GetTs () < p->currentTs ||
+      (id.GetTs () == p->currentTs &&
+       id.GetUid () <= p->currentUid) ||
+      id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (MAX_TS);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  Partition *p = m_current != 0 ? m_current : m_global;
+  return p->currentContext;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionId (void) const
+{
+  if (m_current == 0 || m_current == m_global)
+    {
+      return 0;
+    }
+  return m_current->index + 1;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContextPartitionId (uint32_t context) const
+{
+  Partition *p = GetPartition (context);
+  if (p == m_global)
+    {
+      return 0;
+    }
+  return p->index + 1;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount (void) const
+{
+  uint64_t count = m_global->eventCount;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      count += (*i)->eventCount;
+    }
+  return count;
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookahead (void) const
+{
+  if (m_lookahead == 0)
+    {
+      return m_lookaheadAttribute;
+    }
+  return TimeStep (m_lookahead);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionCount (void) const
+{
+  return m_partitions.size ();
+}
+
+} // namespace ns3
@@ -0,0 +1,318 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+#include "system-mutex.h"
+#include "system-thread.h"
+#include "nstime.h"
+
+#include "ptr.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MultithreadedSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * A shared-memory parallel simulator implementation.
+ *
+ * Events are partitioned by their execution context (the node id for
+ * all events scheduled through Simulator::ScheduleWithContext): context
+ * \c c belongs to partition <tt>c % ThreadCount</tt>.  Each partition owns
+ * its own Scheduler and is processed by its own thread.  Events without
+ * a context (Simulator::NO_CONTEXT) live in a separate, global partition
+ * which is only ever processed by the main thread while all the
+ * partition threads are idle.
+ *
+ * Partitions are synchronized conservatively: at each round, the
+ * simulator computes the earliest pending timestamp over all the
+ * partitions and lets every partition process, in parallel, all the
+ * events strictly earlier than that timestamp plus the lookahead.  An
+ * event scheduled for a different partition during a round is
+ * therefore required to be at least one lookahead in the future; a
+ * violation of this rule is a fatal error.  The partition threads read
+ * and write the current time and the events of their partition without
+ * locks, so during a round an event can only be removed or cancelled by
+ * the events of its own partition.  An event without a context can also
+ * be checked for expiry by the other partitions.
+ *
+ * The lookahead can be set with the \c Lookahead attribute.  When left
+ * to zero, it is computed at the start of Run() as the smallest \c Delay
+ * attribute of the ns3::PointToPointChannel of the \c /ChannelList
+ * path.  The other channels do not provide a lower bound: wireless and
+ * spectrum channels compute their delay with a PropagationDelayModel,
+ * and shared media like ns3::CsmaChannel keep a state that all their
+ * nodes modify, whatever their partition.  When such a channel is
+ * present and the \c Lookahead attribute is not set, the simulation
+ * falls back to a single partition.  Setting the \c Lookahead attribute
+ * requires that the nodes of a shared medium belong to the same
+ * partition.
+ *
+ * Events scheduled within a partition, and events exchanged between
+ * partitions, are ordered deterministically for a given \c ThreadCount.
+ * Model code executed by the partition threads must not share mutable
+ * state with other partitions beyond what is exchanged through
+ * scheduled events, or must keep it per partition, indexed by
+ * Simulator::GetPartitionId, as Packet does for its uids.  The copy
+ * on write data of a Packet is not thread safe either: a packet handed
+ * to another partition must be copied with Packet::CopyForContext,
+ * which makes a deep copy when the target context belongs to another
+ * partition, as ns3::PointToPointChannel does.
+ *
+ * Objects are shared between the partitions through Ptr, so running
+ * more than one thread requires ns-3 configured with
+ * \c --enable-atomic-refcount.  Otherwise, the default \c ThreadCount
+ * of 0 runs a single partition, and a \c ThreadCount greater than 1 is
+ * a fatal error, unless the \c RequireAtomicRefCount attribute is
+ * cleared for models whose partitions share no reference-counted
+ * object, other than the events they schedule for each other.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+  virtual uint32_t GetPartitionId (void) const;
+  virtual uint32_t GetContextPartitionId (uint32_t context) const;
+
+  /**
+   * Get the lookahead used to synchronize the partitions.
+   *
+   * \return The lookahead computed by the last call to Run(), or the
+   *         value of the \c Lookahead attribute before that.
+   */
+  Time GetLookahead (void) const;
+  /**
+   * Get the number of partitions, excluding the global partition.
+   *
+   * \return The number of partition threads.
+   */
+  uint32_t GetPartitionCount (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event sent to a partition by another thread. */
+  struct RemoteEvent
+  {
+    /** The event implementation. */
+    EventImpl *impl;
+    /** Absolute event timestamp. */
+    uint64_t ts;
+    /** The event context. */
+    uint32_t context;
+    /** Index of the sending partition, used for deterministic ordering. */
+    uint32_t source;
+    /** Sequence number within the sending partition. */
+    uint64_t sequence;
+  };
+  /** Container type for the events sent to a partition. */
+  typedef std::vector<struct RemoteEvent> RemoteEvents;
+
+  /** The per-thread state of one partition. */
+  struct Partition
+  {
+    /** Index of this partition. */
+    uint32_t index;
+    /** The event priority queue of this partition. */
+    Ptr<Scheduler> events;
+    /** Unique id of the current event. */
+    uint32_t currentUid;
+    /** Timestamp of the current event. */
+    uint64_t currentTs;
+    /** Execution context of the current event. */
+    uint32_t currentContext;
+    /** The event count. */
+    uint64_t eventCount;
+    /** Number of events inserted but not yet processed. */
+    int unscheduledEvents;
+    /** Sequence number of the next event sent to another partition. */
+    uint64_t sequence;
+    /** Events sent to this partition by other partitions. */
+    RemoteEvents inbox;
+    /** Mutex protecting the inbox. */
+    SystemMutex inboxMutex;
+  };
+
+  /**
+   * Get the partition which owns a context.
+   * \param [in] context The event context.
+   * \return The partition.
+   */
+  Partition * GetPartition (uint32_t context) const;
+  /**
+   * Insert an event in the event queue of a partition.
+   * \param [in] p The partition.
+   * \param [in] ts The absolute event timestamp.
+   * \param [in] context The event context.
+   * \param [in] event The event implementation.
+   * \return The inserted event.
+   */
+  Scheduler::Event Insert (Partition *p, uint64_t ts, uint32_t context, EventImpl *event);
+  /**
+   * Move the events sent by other threads into the event queue of
+   * their partition.
+   */
+  void MergeRemoteEvents (void);
+  /**
+   * Process all the events of a partition earlier than the current
+   * round end.
+   * \param [in] p The partition.
+   */
+  void ProcessPartition (Partition *p);
+  /**
+   * Process all the events of the global partition at the timestamp
+   * of its next event.
+   */
+  void ProcessGlobalEvents (void);
+  /**
+   * The main loop of a partition thread.
+   * \param [in] p The partition processed by this thread.
+   * \param [in] round The round counter when the thread was started.
+   */
+  void PartitionThread (Partition *p, uint64_t round);
+  /** Compute the lookahead from the channel delays. */
+  void CalculateLookahead (void);
+  /**
+   * Create the partitions, moving the pending events to their new
+   * partition if the number of partitions changed.
+   * \param [in] count The number of partitions.
+   */
+  void Repartition (uint32_t count);
+  /**
+   * Get the number of partitions to use when the lookahead allows it.
+   * \return The value of the \c ThreadCount attribute or, if it is
+   *         zero, the number of hardware cores with atomic reference
+   *         counts and 1 without.
+   */
+  uint32_t GetThreadCount (void) const;
+  /**
+   * Get the latest timestamp reached by any partition.
+   * \return The timestamp.
+   */
+  uint64_t GetGlobalTs (void) const;
+  /** Start the partition threads. */
+  void StartThreads (void);
+  /** Stop and join the partition threads. */
+  void StopThreads (void);
+
+  /** The number of partition threads. */
+  uint32_t m_threadCount;
+  /** Whether more than one thread requires atomic reference counts. */
+  bool m_requireAtomicRefCount;
+  /** The configured lookahead, or zero to compute it from the channels. */
+  Time m_lookaheadAttribute;
+  /** The lookahead in use, in time steps. */
+  uint64_t m_lookahead;
+  /** The scheduler factory, used for the partitions created lazily. */
+  ObjectFactory m_schedulerFactory;
+
+  /** The partitions, indexed by <tt>context % size</tt>. */
+  std::vector<Partition *> m_partitions;
+  /** The partition of the events without a context. */
+  Partition *m_global;
+  /** The partition of the calling thread, if it is a simulator thread. */
+  static thread_local Partition *m_current;
+
+  /** Events sent by threads which are not simulator threads. */
+  std::list<struct RemoteEvent> m_foreignEvents;
+  /** Flag \c true if m_foreignEvents is empty. */
+  std::atomic<bool> m_foreignEventsEmpty;
+  /** Mutex protecting m_foreignEvents. */
+  SystemMutex m_foreignEventsMutex;
+
+  /** Flag \c true while the partition threads process a round. */
+  bool m_parallel;
+  /** End (excluded) of the current round, in time steps. */
+  uint64_t m_roundEnd;
+  /** Next event unique id, shared by all the partitions. */
+  std::atomic<uint32_t> m_uid;
+
+  /** The partition threads. */
+  std::vector<std::thread> m_threads;
+  /** Mutex for the round synchronization. */
+  std::mutex m_roundMutex;
+  /** Condition signaled when a round starts or the threads must exit. */
+  std::condition_variable m_roundStartCondition;
+  /** Condition signaled when the last partition finishes its round. */
+  std::condition_variable m_roundDoneCondition;
+  /** Round generation counter. */
+  uint64_t m_round;
+  /** Number of partition threads still working on the current round. */
+  uint32_t m_running;
+  /** Flag \c true to make the partition threads exit. */
+  bool m_exit;
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Flag calling for the end of the simulation. */
+  std::atomic<bool> m_stop;
+
+  /** Main execution thread. */
+  SystemThread::ThreadId m_main;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
@@ -22,6 +22,7 @@
 #include "assert.h"
 #include "abort.h"
 #include "names.h"
+#include "config.h"
 #include "singleton.h"
 
 /**
@@ -311,6 +312,7 @@ NamesPriv::Clear (void)
   m_root.m_name = "Names";
   m_root.m_object = 0;
   m_root.m_nameMap.clear ();
+  Config::InvalidatePathCache ();
 }
 
 bool
@@ -417,6 +419,7 @@ NamesPriv::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
   NameNode *newNode = new NameNode (node, name, object);
   node->m_nameMap[name] = newNode;
   m_objectMap[object] = newNode;
+  Config::InvalidatePathCache ();
 
   return true;
 }
@@ -539,6 +542,7 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       node->m_nameMap.erase (i);
       changeNode->m_name = newname;
       node->m_nameMap[newname] = changeNode;
+      Config::InvalidatePathCache ();
       return true;
     }
 }
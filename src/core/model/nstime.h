@@ -27,6 +27,7 @@
 #include "unused.h"
 #include <stdint.h>
 #include <limits>
+#include <cfloat>
 #include <cmath>
 #include <ostream>
 #include <set>
@@ -455,6 +456,11 @@ public:
   }
   inline static Time FromDouble (double value, enum Unit unit)
   {
+    int64_t ts;
+    if (FromDoubleFast (value, PeekInformation (unit), &ts))
+      {
+        return Time (ts);
+      }
     return From (int64x64_t (value), unit);
   }
   inline static Time From (const int64x64_t & value, enum Unit unit)
@@ -504,6 +510,14 @@ public:
   }
   inline double ToDouble (enum Unit unit) const
   {
+    // Integer conversion factors and times below 2^53 are exact
+    // doubles, so one division or multiplication gives the correctly
+    // rounded value, without int64x64_t.
+    struct Information *info = PeekInformation (unit);
+    if (info->fastFactor != 0 && m_data < FAST_LIMIT && m_data > -FAST_LIMIT)
+      {
+        return info->toMul ? GetDouble () * info->fastFactor : GetDouble () / info->fastFactor;
+      }
     return To (unit).GetDouble ();
   }
   inline int64x64_t To (enum Unit unit) const
@@ -561,6 +575,9 @@ private:
     int64_t factor;                 //!< Ratio of this unit / current unit
     int64x64_t timeTo;              //!< Multiplier to convert to this unit
     int64x64_t timeFrom;            //!< Multiplier to convert from this unit
+    double fastFactor;              //!< factor, if it is an exact double, otherwise 0
+    double fastFactorHi;            //!< High 26 bits of fastFactor
+    double fastFactorLo;            //!< Low bits of fastFactor
   };
   /** Current time unit, and conversion info. */
   struct Resolution
@@ -590,6 +607,75 @@ private:
     return & (PeekResolution ()->info[timeUnit]);
   }
 
+  /** Bound of the values converted without int64x64_t, 2^53. */
+  static const int64_t FAST_LIMIT = 9007199254740992LL;
+
+  /**
+   *  Convert a double to a Time, if this can be done exactly without
+   *  int64x64_t.
+   *
+   *  From (int64x64_t (value), unit) is the floor of the exact product
+   *  of \p value, rounded to the 64 fractional bits of int64x64_t, by
+   *  the conversion factor.  The product is rounded in a double, and its
+   *  rounding error, computed exactly, gives the floor of the exact
+   *  product when the rounded product is an integer.
+   *
+   *  \param [in] value The value, expressed in the unit of \p info.
+   *  \param [in] info The conversion information of the unit.
+   *  \param [out] ts The Time value, in the current unit.
+   *  \return \c true if \p ts is set, \c false if the int64x64_t
+   *  conversion is needed.
+   */
+  static inline bool FromDoubleFast (double value, const struct Information *info, int64_t *ts)
+  {
+#if FLT_EVAL_METHOD == 0 && !defined (INT64X64_USE_DOUBLE)
+    if (std::fabs (value) < 1.0 / 4096)
+      {
+        // Below 2^-12 value has bits beyond 2^-64, which int64x64_t
+        // rounds half away from zero.  Scaling by 2^64 is exact, and
+        // adding 0.5 is exact below 2^52.
+        const double scaled = std::floor (std::fabs (value) * 18446744073709551616.0 + 0.5);
+        value = std::copysign (scaled / 18446744073709551616.0, value);
+      }
+    if (value == 0)
+      {
+        *ts = 0;
+        return true;
+      }
+    // Above 2^62 the Time overflows anyway, and the int64_t
+    // conversion of the product would not be exact.
+    if (!info->fromMul || info->fastFactor == 0
+        || !(std::fabs (value) * info->fastFactor < 4611686018427387904.0))
+      {
+        return false;
+      }
+    const double product = value * info->fastFactor;
+#if defined (FP_FAST_FMA)
+    const double error = std::fma (value, info->fastFactor, -product);
+#else
+    // Dekker's exact product, with the factor split in SetResolution.
+    const double split = 134217729.0 * value;
+    const double hi = split - (split - value);
+    const double lo = value - hi;
+    const double error = ((hi * info->fastFactorHi - product) + hi * info->fastFactorLo
+                          + lo * info->fastFactorHi) + lo * info->fastFactorLo;
+#endif
+    const double integer = std::floor (product);
+    *ts = static_cast<int64_t> (integer);
+    if (integer == product)
+      {
+        // The exact product is product + error; above 2^53 the error
+        // can exceed 1.
+        *ts += static_cast<int64_t> (std::floor (error));
+      }
+    return true;
+#else
+    // Extended precision intermediate values break the exact product,
+    // and the long double int64x64_t does not compute it.
+    return false;
+#endif
+  }
+
   /**
    *  Set the default resolution
    *
@@ -1108,6 +1194,91 @@ inline Time FemtoSeconds (int64x64_t value)
   return Time::From (value, Time::FS);
 }
 /**@}*/
+
+/**
+ * \ingroup timecivil
+ * Time literals, in the indicated unit.
+ *
+ * For example:
+ * \code
+ *   Simulator::Schedule (2_s, ...);
+ *   Time slot = 9_us;
+ *   Time rtt = 1.5_ms;
+ * \endcode
+ *
+ * Integer literals are converted with Time::FromInteger, floating
+ * literals as the Seconds (double) family.  Like those, they depend on
+ * the current resolution, so they are not \c constexpr.
+ *
+ * \param [in] value The value
+ * \return The Time
+ * @{
+ */
+inline Time operator "" _h (unsigned long long value)
+{
+  return Time::FromInteger (value, Time::H);
+}
+inline Time operator "" _h (long double value)
+{
+  return Time::FromDouble (static_cast<double> (value), Time::H);
+}
+inline Time operator "" _min (unsigned long long value)
+{
+  return Time::FromInteger (value, Time::MIN);
+}
+inline Time operator "" _min (long double value)
+{
+  return Time::FromDouble (static_cast<double> (value), Time::MIN);
+}
+inline Time operator "" _s (unsigned long long value)
+{
+  return Time::FromInteger (value, Time::S);
+}
+inline Time operator "" _s (long double value)
+{
+  return Time::FromDouble (static_cast<double> (value), Time::S);
+}
+inline Time operator "" _ms (unsigned long long value)
+{
+  return Time::FromInteger (value, Time::MS);
+}
+inline Time operator "" _ms (long double value)
+{
+  return Time::FromDouble (static_cast<double> (value), Time::MS);
+}
+inline Time operator "" _us (unsigned long long value)
+{
+  return Time::FromInteger (value, Time::US);
+}
+inline Time operator "" _us (long double value)
+{
+  return Time::FromDouble (static_cast<double> (value), Time::US);
+}
+inline Time operator "" _ns (unsigned long long value)
+{
+  return Time::FromInteger (value, Time::NS);
+}
+inline Time operator "" _ns (long double value)
+{
+  return Time::FromDouble (static_cast<double> (value), Time::NS);
+}
+inline Time operator "" _ps (unsigned long long value)
+{
+  return Time::FromInteger (value, Time::PS);
+}
+inline Time operator "" _ps (long double value)
+{
+  return Time::FromDouble (static_cast<double> (value), Time::PS);
+}
+inline Time operator "" _fs (unsigned long long value)
+{
+  return Time::FromInteger (value, Time::FS);
+}
+inline Time operator "" _fs (long double value)
+{
+  return Time::FromDouble (static_cast<double> (value), Time::FS);
+}
+/**@}*/
   
 
 /**
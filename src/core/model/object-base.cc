@@ -22,10 +22,14 @@
 #include "trace-source-accessor.h"
 #include "attribute-construction-list.h"
 #include "string.h"
+#include "pointer.h"
 #include "ns3/core-config.h"
 #ifdef HAVE_STDLIB_H
 #include <cstdlib>
 #endif
+#include <map>
+#include <mutex>
+#include <vector>
 
 /**
  * \file
@@ -76,93 +80,231 @@ ObjectBase::NotifyConstructionCompleted (void)
   NS_LOG_FUNCTION (this);
 }
 
+namespace {
+
+/**
+ * \ingroup object
+ * \internal
+ * An attribute initialized by ObjectBase::ConstructSelf.
+ */
+struct AttributeDefault
+{
+  /** The full name of the attribute, for the logs. */
+  std::string name;
+  /** The attribute flags. */
+  uint32_t flags;
+  /** The accessor. */
+  Ptr<const AttributeAccessor> accessor;
+  /** The checker. */
+  Ptr<const AttributeChecker> checker;
+  /** The initial value, as registered. */
+  Ptr<const AttributeValue> initialValue;
+  /**
+   * The initial value, already checked and deserialized, or 0 if it
+   * must be deserialized for each instance.
+   */
+  Ptr<const AttributeValue> value;
+};
+
+/**
+ * \ingroup object
+ * \internal
+ * The attributes of a TypeId and of its parents, in the order
+ * ObjectBase::ConstructSelf initializes them.
+ */
+struct AttributeSnapshot
+{
+  /** The TypeId attribute generation of the snapshot. */
+  uint32_t generation;
+  /** The attributes. */
+  std::vector<struct AttributeDefault> attributes;
+};
+
+/**
+ * \ingroup object
+ * \internal
+ * The attribute snapshots of the TypeIds.
+ *
+ * The snapshots are built on the first construction of an object of
+ * each TypeId, and rebuilt when the attribute generation changes.
+ * The outdated snapshots are kept until exit, as other threads may
+ * still be constructing objects with them.
+ */
+class AttributeSnapshots
+{
+public:
+  ~AttributeSnapshots ()
+  {
+    for (std::size_t i = 0; i < m_snapshots.size (); ++i)
+      {
+        delete m_snapshots[i];
+      }
+    for (std::size_t i = 0; i < m_outdated.size (); ++i)
+      {
+        delete m_outdated[i];
+      }
+  }
+
+  /**
+   * Get the snapshot of a TypeId.
+   * \param [in] tid The TypeId.
+   * \returns The snapshot.
+   */
+  const struct AttributeSnapshot * Get (TypeId tid)
+  {
+    uint16_t uid = tid.GetUid ();
+    uint32_t generation = TypeId::GetAttributeGeneration ();
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      if (uid < m_snapshots.size () && m_snapshots[uid] != 0
+          && m_snapshots[uid]->generation == generation)
+        {
+          return m_snapshots[uid];
+        }
+    }
+    // Build the snapshot without the lock: the deserialization of the
+    // initial values may construct other objects.
+    struct AttributeSnapshot *snapshot = Build (tid);
+    snapshot->generation = generation;
+    std::lock_guard<std::mutex> lock (m_mutex);
+    if (uid >= m_snapshots.size ())
+      {
+        m_snapshots.resize (uid + 1, 0);
+      }
+    if (m_snapshots[uid] != 0)
+      {
+        m_outdated.push_back (m_snapshots[uid]);
+      }
+    m_snapshots[uid] = snapshot;
+    return snapshot;
+  }
+
+private:
+  /**
+   * Build the snapshot of a TypeId.
+   * \param [in] tid The TypeId.
+   * \returns The snapshot.
+   */
+  static struct AttributeSnapshot * Build (TypeId tid)
+  {
+    NS_LOG_FUNCTION (tid.GetName ());
+    std::map<std::string, std::string> env;
+#ifdef HAVE_GETENV
+    char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
+    if (envVar != 0)
+      {
+        std::string value = std::string (envVar);
+        std::string::size_type cur = 0;
+        std::string::size_type next = 0;
+        while (next != std::string::npos)
+          {
+            next = value.find (";", cur);
+            std::string tmp = std::string (value, cur, next - cur);
+            std::string::size_type equal = tmp.find ("=");
+            if (equal != std::string::npos)
+              {
+                env[tmp.substr (0, equal)] = tmp.substr (equal + 1);
+              }
+            cur = next + 1;
+          }
+      }
+#endif /* HAVE_GETENV */
+
+    struct AttributeSnapshot *snapshot = new AttributeSnapshot ();
+    // loop over the inheritance tree back to the Object base class.
+    do {
+        for (std::size_t i = 0; i < tid.GetAttributeN (); i++)
+          {
+            struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+            struct AttributeDefault attribute;
+            attribute.name = tid.GetAttributeFullName (i);
+            attribute.flags = info.flags;
+            attribute.accessor = info.accessor;
+            attribute.checker = info.checker;
+            attribute.initialValue = info.initialValue;
+            std::map<std::string, std::string>::const_iterator it = env.find (attribute.name);
+            if (it != env.end ()
+                && info.checker->CreateValidValue (StringValue (it->second)) != 0)
+              {
+                attribute.initialValue = Create<StringValue> (it->second);
+              }
+            if (info.checker->Check (*attribute.initialValue))
+              {
+                attribute.value = attribute.initialValue;
+              }
+            else
+              {
+                // Deserializing a PointerValue creates a new object,
+                // and each instance needs its own.
+                Ptr<const AttributeValue> value = info.checker->CreateValidValue (*attribute.initialValue);
+                if (value != 0 && dynamic_cast<const PointerValue *> (PeekPointer (value)) == 0)
+                  {
+                    attribute.value = value;
+                  }
+              }
+            snapshot->attributes.push_back (attribute);
+          }
+        tid = tid.GetParent ();
+      } while (tid != ObjectBase::GetTypeId ());
+    return snapshot;
+  }
+
+  /** The mutex protecting the snapshots. */
+  std::mutex m_mutex;
+  /** The current snapshots, indexed by TypeId uid. */
+  std::vector<struct AttributeSnapshot *> m_snapshots;
+  /** The outdated snapshots. */
+  std::vector<struct AttributeSnapshot *> m_outdated;
+};
+
+} // unnamed namespace
+
 void
 ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
 {
-  // loop over the inheritance tree back to the Object base class.
   NS_LOG_FUNCTION (this << &attributes);
-  TypeId tid = GetInstanceTypeId ();
-  do {
-      // loop over all attributes in object type
-      NS_LOG_DEBUG ("construct tid="<<tid.GetName ()<<", params="<<tid.GetAttributeN ());
-      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+  static AttributeSnapshots snapshots;
+  const struct AttributeSnapshot *snapshot = snapshots.Get (GetInstanceTypeId ());
+  bool overrides = attributes.Begin () != attributes.End ();
+  for (std::vector<struct AttributeDefault>::const_iterator i = snapshot->attributes.begin ();
+       i != snapshot->attributes.end (); ++i)
+    {
+      if (overrides)
         {
-          struct TypeId::AttributeInformation info = tid.GetAttribute(i);
-          NS_LOG_DEBUG ("try to construct \""<< tid.GetName ()<<"::"<<
-                        info.name <<"\"");
           // is this attribute stored in this AttributeConstructionList instance ?
-          Ptr<AttributeValue> value = attributes.Find(info.checker);
-          // See if this attribute should not be set here in the
-          // constructor.
-          if (!(info.flags & TypeId::ATTR_CONSTRUCT))
+          Ptr<AttributeValue> value = attributes.Find (i->checker);
+          if (value != 0)
             {
-              // Handle this attribute if it should not be 
-              // set here.
-              if (value == 0)
-                {
-                  // Skip this attribute if it's not in the
-                  // AttributeConstructionList.
-                  continue;
-                }              
-              else
+              if (!(i->flags & TypeId::ATTR_CONSTRUCT))
                 {
                   // This is an error because this attribute is not
                   // settable in its constructor but is present in
                   // the AttributeConstructionList.
-                  NS_FATAL_ERROR ("Attribute name="<<info.name<<" tid="<<tid.GetName () << ": initial value cannot be set using attributes");
+                  NS_FATAL_ERROR ("Attribute name="<<i->name<<": initial value cannot be set using attributes");
                 }
-            }
-
-          if (value != 0)
-            {
-              // We have a matching attribute value.
-              if (DoSet (info.accessor, info.checker, *value))
+              if (DoSet (i->accessor, i->checker, *value))
                 {
-                  NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                                info.name<<"\"");
+                  NS_LOG_DEBUG ("construct \""<< i->name<<"\"");
                   continue;
                 }
             }
+        }
+      if (!(i->flags & TypeId::ATTR_CONSTRUCT))
+        {
+          continue;
+        }
 
-#ifdef HAVE_GETENV
-          // No matching attribute value so we try to look at the env var.
-          char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
-          if (envVar != 0)
-            {
-              std::string env = std::string (envVar);
-              std::string::size_type cur = 0;
-              std::string::size_type next = 0;
-              while (next != std::string::npos)
-                {
-                  next = env.find (";", cur);
-                  std::string tmp = std::string (env, cur, next-cur);
-                  std::string::size_type equal = tmp.find ("=");
-                  if (equal != std::string::npos)
-                    {
-                      std::string name = tmp.substr (0, equal);
-                      std::string envval = tmp.substr (equal+1, tmp.size () - equal - 1);
-                      if (name == tid.GetAttributeFullName (i))
-                        {
-                          if (DoSet (info.accessor, info.checker, StringValue (envval)))
-                            {
-                              NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                                            info.name <<"\" from env var");
-                              break;
-                            }
-                        }
-                    }
-                  cur = next + 1;
-                }
-            }
-#endif /* HAVE_GETENV */
-
-          // No matching attribute value so we try to set the default value.
-          DoSet (info.accessor, info.checker, *info.initialValue);
-          NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                        info.name <<"\" from initial value.");
+      // No matching attribute value so we set the default value.
+      if (i->value != 0)
+        {
+          i->accessor->Set (this, *i->value);
         }
-      tid = tid.GetParent ();
-    } while (tid != ObjectBase::GetTypeId ());
+      else
+        {
+          DoSet (i->accessor, i->checker, *i->initialValue);
+        }
+      NS_LOG_DEBUG ("construct \""<< i->name <<"\" from initial value.");
+    }
   NotifyConstructionCompleted ();
 }
 
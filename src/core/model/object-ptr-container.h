@@ -220,6 +220,24 @@ public:
   virtual bool Get (const ObjectBase * object, AttributeValue &value) const;
   virtual bool HasGetter (void) const;
   virtual bool HasSetter (void) const;
+  /**
+   * Get the number of instances in the container, without building an
+   * ObjectPtrContainerValue.
+   * \param [in] object The container object.
+   * \param [out] n The number of instances in the container.
+   * \returns true if the value could be obtained successfully.
+   */
+  bool GetN (const ObjectBase *object, std::size_t *n) const;
+  /**
+   * Get an instance from the container, without building an
+   * ObjectPtrContainerValue.
+   * \param [in] object The container object.
+   * \param [in] i The position of the instance, in [0, GetN ()).
+   * \param [out] index The index of the instance, which is the key of
+   *             the ObjectPtrContainerValue entry.
+   * \returns The instance.
+   */
+  Ptr<Object> GetItem (const ObjectBase *object, std::size_t i, std::size_t *index) const;
 private:
   /**
    * Get the number of instances in the container.
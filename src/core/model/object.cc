@@ -23,6 +23,7 @@
 #include "object-factory.h"
 #include "assert.h"
 #include "attribute.h"
+#include "config.h"
 #include "log.h"
 #include "string.h"
 #include <vector>
@@ -222,6 +223,9 @@ Object::Dispose (void)
    * user code.
    */
   NS_LOG_FUNCTION (this);
+  // The disposed objects are usually removed from their containers,
+  // and must not be matched by the cached Config paths anymore.
+  Config::InvalidatePathCache ();
 restart:
   uint32_t n = m_aggregates->n;
   for (uint32_t i = 0; i < n; i++)
@@ -289,6 +293,9 @@ Object::AggregateObject (Ptr<Object> o)
   struct Aggregates *a = m_aggregates;
   struct Aggregates *b = other->m_aggregates;
 
+  // The objects reachable with $TypeId Config path elements change.
+  Config::InvalidatePathCache ();
+
   // Then, assign the new aggregation buffer to every object
   uint32_t n = aggregates->n;
   for (uint32_t i = 0; i < n; i++)
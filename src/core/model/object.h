@@ -83,6 +83,11 @@ struct ObjectDeleter
  * all its aggregates. The DoDispose() method is always automatically
  * invoked from the Unref() method before destroying the Object,
  * even if the user did not call Dispose() directly.
+ *
+ * With \c --enable-atomic-refcount, Ref() and Unref() are atomic.  The
+ * last references to the Objects of an aggregate must still be released
+ * from a single thread, as the aggregate is deleted once all of their
+ * counts are zero.
  */
 class Object : public SimpleRefCount<Object, ObjectBase, ObjectDeleter>
 {
@@ -0,0 +1,247 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pairing-heap-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+
+#include <utility>  // swap
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::PairingHeapScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PairingHeapScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (PairingHeapScheduler);
+
+const uint32_t PairingHeapScheduler::NIL;
+
+TypeId
+PairingHeapScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PairingHeapScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<PairingHeapScheduler> ()
+  ;
+  return tid;
+}
+
+PairingHeapScheduler::PairingHeapScheduler ()
+  : m_free (NIL),
+    m_root (NIL)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PairingHeapScheduler::~PairingHeapScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+PairingHeapScheduler::Allocate (const Scheduler::Event &ev)
+{
+  uint32_t id;
+  if (m_free != NIL)
+    {
+      id = m_free;
+      m_free = m_nodes[id].next;
+    }
+  else
+    {
+      NS_ASSERT (m_nodes.size () < NIL);
+      id = m_nodes.size ();
+      m_nodes.push_back (Node ());
+    }
+  Node &node = m_nodes[id];
+  node.ev = ev;
+  node.child = NIL;
+  node.next = NIL;
+  node.prev = NIL;
+  return id;
+}
+
+void
+PairingHeapScheduler::Release (uint32_t id)
+{
+  m_nodes[id].ev.impl = 0;
+  m_nodes[id].next = m_free;
+  m_free = id;
+}
+
+uint32_t
+PairingHeapScheduler::Meld (uint32_t a, uint32_t b)
+{
+  if (a == NIL)
+    {
+      return b;
+    }
+  if (b == NIL)
+    {
+      return a;
+    }
+  if (m_nodes[b].ev.key < m_nodes[a].ev.key)
+    {
+      std::swap (a, b);
+    }
+  // b becomes the first child of a.
+  Node &parent = m_nodes[a];
+  Node &child = m_nodes[b];
+  child.next = parent.child;
+  if (parent.child != NIL)
+    {
+      m_nodes[parent.child].prev = b;
+    }
+  child.prev = a;
+  parent.child = b;
+  return a;
+}
+
+uint32_t
+PairingHeapScheduler::MergePairs (uint32_t first)
+{
+  if (first == NIL)
+    {
+      return NIL;
+    }
+  // First pass: meld the siblings two by two, from left to right.
+  m_pairs.clear ();
+  uint32_t a = first;
+  while (a != NIL)
+    {
+      uint32_t b = m_nodes[a].next;
+      m_nodes[a].next = NIL;
+      m_nodes[a].prev = NIL;
+      if (b == NIL)
+        {
+          m_pairs.push_back (a);
+          break;
+        }
+      uint32_t rest = m_nodes[b].next;
+      m_nodes[b].next = NIL;
+      m_nodes[b].prev = NIL;
+      m_pairs.push_back (Meld (a, b));
+      a = rest;
+    }
+  // Second pass: meld the pairs, from right to left.
+  uint32_t root = m_pairs.back ();
+  for (std::size_t i = m_pairs.size () - 1; i > 0; i--)
+    {
+      root = Meld (m_pairs[i - 1], root);
+    }
+  return root;
+}
+
+void
+PairingHeapScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  m_root = Meld (m_root, Allocate (ev));
+}
+
+void
+PairingHeapScheduler::InsertBatch (const std::vector<Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  if (events.empty ())
+    {
+      return;
+    }
+  // Chain the new nodes as siblings, and pair them.
+  uint32_t first = NIL;
+  for (std::vector<Event>::const_reverse_iterator i = events.rbegin (); i != events.rend (); ++i)
+    {
+      uint32_t id = Allocate (*i);
+      m_nodes[id].next = first;
+      first = id;
+    }
+  m_root = Meld (m_root, MergePairs (first));
+}
+
+bool
+PairingHeapScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_root == NIL;
+}
+
+Scheduler::Event
+PairingHeapScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_root != NIL);
+  return m_nodes[m_root].ev;
+}
+
+Scheduler::Event
+PairingHeapScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_root != NIL);
+  uint32_t root = m_root;
+  Event next = m_nodes[root].ev;
+  m_root = MergePairs (m_nodes[root].child);
+  Release (root);
+  return next;
+}
+
+void
+PairingHeapScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  uint32_t uid = ev.key.m_uid;
+  for (uint32_t id = 0; id < m_nodes.size (); id++)
+    {
+      Node &node = m_nodes[id];
+      if (node.ev.impl == 0 || uid != node.ev.key.m_uid)
+        {
+          continue;
+        }
+      NS_ASSERT (node.ev.impl == ev.impl);
+      if (id == m_root)
+        {
+          RemoveNext ();
+          return;
+        }
+      // Cut the subtree rooted at this node out of the heap.
+      if (m_nodes[node.prev].child == id)
+        {
+          m_nodes[node.prev].child = node.next;
+        }
+      else
+        {
+          m_nodes[node.prev].next = node.next;
+        }
+      if (node.next != NIL)
+        {
+          m_nodes[node.next].prev = node.prev;
+        }
+      uint32_t subtree = MergePairs (node.child);
+      Release (id);
+      m_root = Meld (m_root, subtree);
+      return;
+    }
+  NS_ASSERT (false);
+}
+
+} // namespace ns3
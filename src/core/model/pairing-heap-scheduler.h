@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PAIRING_HEAP_SCHEDULER_H
+#define PAIRING_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::PairingHeapScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a pairing heap event scheduler with pooled event nodes
+ *
+ * This is a classic pairing heap (Fredman, Sedgewick, Sleator and
+ * Tarjan, 1986) with the usual two-pass pairing on RemoveNext:
+ * Insert is O(1) and RemoveNext is O(log(n)) amortized.
+ *
+ * What is smart about this code ?
+ *  - the heap nodes are not allocated one by one: they live in a
+ *    single contiguous array which acts as a slab allocator.  Released
+ *    nodes are chained in a free list and reused by the next Insert,
+ *    so that a steady-state simulation does not allocate at all and
+ *    touches a compact working set.
+ *  - the links between nodes are 32-bit indexes into that array,
+ *    rather than pointers, which keeps the nodes small and makes the
+ *    array trivially relocatable when it grows.
+ *  - InsertBatch pairs the new events into a single heap, in linear
+ *    time, before melding it with the main heap.
+ *  - Remove looks up the event with a linear scan of the array, like
+ *    HeapScheduler, and then cuts its subtree out of the heap in
+ *    O(log(n)) amortized.
+ */
+class PairingHeapScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  PairingHeapScheduler ();
+  /** Destructor. */
+  virtual ~PairingHeapScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual void InsertBatch (const std::vector<Scheduler::Event> &events);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** A heap node. */
+  struct Node
+  {
+    Scheduler::Event ev;   /**< The event, or a null impl if the node is free. */
+    uint32_t child;        /**< The first child. */
+    uint32_t next;         /**< The next sibling, or the next free node. */
+    uint32_t prev;         /**< The previous sibling, or the parent for a first child. */
+  };
+  /** The node array type. */
+  typedef std::vector<Node> Nodes;
+
+  /**
+   * Get a free node from the pool.
+   *
+   * \param [in] ev The event to store in the node.
+   * \returns The index of the node.
+   */
+  uint32_t Allocate (const Scheduler::Event &ev);
+  /**
+   * Return a node to the pool.
+   *
+   * \param [in] id The index of the node.
+   */
+  void Release (uint32_t id);
+  /**
+   * Meld two heaps.
+   *
+   * \param [in] a The root of the first heap.
+   * \param [in] b The root of the second heap.
+   * \returns The root of the melded heap.
+   */
+  uint32_t Meld (uint32_t a, uint32_t b);
+  /**
+   * Meld a list of siblings with the two-pass pairing method.
+   *
+   * \param [in] first The first sibling.
+   * \returns The root of the resulting heap.
+   */
+  uint32_t MergePairs (uint32_t first);
+
+  /** Index of a missing node. */
+  static const uint32_t NIL = 0xffffffff;
+
+  /** The node pool. */
+  Nodes m_nodes;
+  /** The first free node in the pool. */
+  uint32_t m_free;
+  /** The root of the heap. */
+  uint32_t m_root;
+  /** Scratch space for MergePairs. */
+  std::vector<uint32_t> m_pairs;
+};
+
+} // namespace ns3
+
+#endif /* PAIRING_HEAP_SCHEDULER_H */
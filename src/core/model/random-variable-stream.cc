@@ -33,7 +33,9 @@
 #include "log.h"
 #include "rng-stream.h"
 #include "rng-seed-manager.h"
+#include "simulator.h"
 #include "unused.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -76,13 +78,25 @@ RandomVariableStream::RandomVariableStream()
   : m_rng (0)
 {
   NS_LOG_FUNCTION (this);
+  static uint64_t serial = 0;
+  m_serial = serial++;
+  GetRegistry ()[m_serial] = this;
 }
 RandomVariableStream::~RandomVariableStream()
 {
   NS_LOG_FUNCTION (this);
+  GetRegistry ().erase (m_serial);
   delete m_rng;
 }
 
+RandomVariableStream::Registry &
+RandomVariableStream::GetRegistry (void)
+{
+  // Never destroyed: streams may outlive any static registry.
+  static Registry *registry = new Registry ();
+  return *registry;
+}
+
 void
 RandomVariableStream::SetAntithetic(bool isAntithetic)
 {
@@ -102,7 +116,27 @@ RandomVariableStream::SetStream (int64_t stream)
   // negative values are not legal.
   NS_ASSERT (stream >= -1);
   delete m_rng;
-  if (stream == -1)
+  if (RngSeedManager::GetType () == RngStream::PHILOX)
+    {
+      // The streams are keyed by context, and the automatic stream
+      // numbers are counted in each context, so that the streams
+      // created by the events of a node do not depend on the other
+      // nodes.  As above, the first 2^63 streams are automatic.
+      // GetContext does not create the simulator implementation, so
+      // that the streams can be created before SimulatorImplementationType
+      // is set.
+      uint32_t context = Simulator::GetContext ();
+      uint64_t target = ((1ULL)<<63) + stream;
+      if (stream == -1)
+        {
+          target = RngSeedManager::GetNextStreamIndex (context);
+          NS_ASSERT (target < ((1ULL)<<63));
+        }
+      m_rng = new RngStream (RngSeedManager::GetSeed (),
+                             RngSeedManager::GetRun (),
+                             target, context);
+    }
+  else if (stream == -1)
     {
       // The first 2^63 streams are reserved for automatic stream
       // number assignment.
@@ -138,6 +172,16 @@ RandomVariableStream::Peek(void) const
   return m_rng;
 }
 
+void
+RandomVariableStream::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      values[i] = GetValue ();
+    }
+}
+
 NS_OBJECT_ENSURE_REGISTERED(UniformRandomVariable);
 
 TypeId 
@@ -208,6 +252,26 @@ UniformRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_min, m_max + 1);
 }
+void
+UniformRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  Peek ()->RandU01 (values, n);
+  // The same operations as GetValue (double, double), one loop at a time.
+  const double min = m_min;
+  const double max = m_max;
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      values[i] = min + values[i] * (max - min);
+    }
+  if (IsAntithetic ())
+    {
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          values[i] = min + (max - values[i]);
+        }
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(ConstantRandomVariable);
 
@@ -445,6 +509,46 @@ ExponentialRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_mean, m_bound);
 }
+void
+ExponentialRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  const double mean = m_mean;
+  const double bound = m_bound;
+  std::size_t filled = 0;
+  while (filled < n)
+    {
+      // Each uniform gives at most one value, so drawing one per
+      // missing value never draws ahead of GetValue (double, double).
+      double *v = values + filled;
+      const std::size_t count = n - filled;
+      Peek ()->RandU01 (v, count);
+      if (IsAntithetic ())
+        {
+          for (std::size_t i = 0; i < count; ++i)
+            {
+              v[i] = (1 - v[i]);
+            }
+        }
+      for (std::size_t i = 0; i < count; ++i)
+        {
+          v[i] = -mean*std::log (v[i]);
+        }
+      if (bound == 0)
+        {
+          return;
+        }
+      // Keep the values within the bound, in order, and draw again
+      // for the rejected ones.
+      for (std::size_t i = 0; i < count; ++i)
+        {
+          if (v[i] <= bound)
+            {
+              values[filled++] = v[i];
+            }
+        }
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(ParetoRandomVariable);
 
@@ -778,6 +882,74 @@ NormalRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_mean, m_variance, m_bound);
 }
+void
+NormalRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  std::size_t filled = 0;
+  if (n > 0 && m_nextValid)
+    { // use previously generated
+      m_nextValid = false;
+      values[filled++] = m_next;
+    }
+
+  // The pairs of uniforms drawn at once.
+  const std::size_t BATCH = 128;
+  double v[2 * BATCH];
+  double w[BATCH];
+  const double mean = m_mean;
+  const double stddev = std::sqrt (m_variance);
+  const double bound = m_bound;
+  while (filled < n)
+    {
+      // Each pair gives at most two values, so drawing one pair per
+      // two missing values never draws ahead of GetValue (void): at
+      // most the second value of the last pair is left over, and it
+      // is kept in m_next as GetValue (void) would.
+      const std::size_t pairs = std::min ((n - filled + 1) / 2, BATCH);
+      Peek ()->RandU01 (v, 2 * pairs);
+      if (IsAntithetic ())
+        {
+          for (std::size_t i = 0; i < 2 * pairs; ++i)
+            {
+              v[i] = (1 - v[i]);
+            }
+        }
+      for (std::size_t i = 0; i < 2 * pairs; ++i)
+        {
+          v[i] = 2 * v[i] - 1;
+        }
+      for (std::size_t i = 0; i < pairs; ++i)
+        {
+          w[i] = v[2 * i] * v[2 * i] + v[2 * i + 1] * v[2 * i + 1];
+        }
+      for (std::size_t i = 0; i < pairs; ++i)
+        {
+          if (w[i] <= 1.0)
+            { // Got good pair, see GetValue (double, double, double)
+              double y = std::sqrt ((-2 * std::log (w[i])) / w[i]);
+              double x1 = mean + v[2 * i] * y * stddev;
+              double x2 = mean + v[2 * i + 1] * y * stddev;
+              if (std::fabs (x1 - mean) <= bound)
+                {
+                  values[filled++] = x1;
+                }
+              if (std::fabs (x2 - mean) <= bound)
+                {
+                  if (filled < n)
+                    {
+                      values[filled++] = x2;
+                    }
+                  else
+                    {
+                      m_next = x2;
+                      m_nextValid = true;
+                    }
+                }
+            }
+        }
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(LogNormalRandomVariable);
 
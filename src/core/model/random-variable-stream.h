@@ -30,6 +30,8 @@
 #include "object.h"
 #include "attribute-helper.h"
 #include <stdint.h>
+#include <cstddef>
+#include <map>
 
 /**
  * \file
@@ -149,6 +151,21 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  /**
+   * \brief Get the next \p n random values drawn from the distribution.
+   *
+   * The values are those of \p n successive calls to GetValue(void),
+   * and the stream is left in the same state, so a model can switch
+   * to drawing its variates in bulk without changing its results.
+   * This default implementation calls GetValue(void); distributions
+   * which are drawn in large numbers override it to generate the
+   * underlying uniforms in one batch and transform them in tight loops.
+   *
+   * \param [out] values The array to fill, of at least \p n values.
+   * \param [in] n The number of values to draw.
+   */
+  virtual void GetValues (double *values, std::size_t n);
+
 protected:
   /**
    * \brief Get the pointer to the underlying RngStream.
@@ -157,6 +174,16 @@ protected:
   RngStream *Peek(void) const;
 
 private:
+  friend class SimulationCheckpoint;
+
+  /** Container type for the live streams, indexed by creation order. */
+  typedef std::map<uint64_t, RandomVariableStream *> Registry;
+  /**
+   * Get the live streams.
+   * \return The registry of all the streams not yet destroyed.
+   */
+  static Registry & GetRegistry (void);
+
   /**
    * Copy constructor.  These objects are not copyable.
    *
@@ -187,6 +214,9 @@ private:
   /** The stream number for the RngStream. */
   int64_t m_stream;
 
+  /** The creation order of this stream, its key in the registry. */
+  uint64_t m_serial;
+
 };  // class RandomVariableStream
 
   
@@ -294,6 +324,13 @@ public:
    * \note The upper limit is included in the output range.
    */
   virtual uint32_t GetInteger (void);
+  /**
+   * \brief Get the next \p n random values drawn from the distribution.
+   * \param [out] values The array to fill.
+   * \param [in] n The number of values to draw.
+   * \note The upper limit is excluded from the output range.
+   */
+  virtual void GetValues (double *values, std::size_t n);
   
 private:
   /** The lower bound on values that can be returned by this RNG stream. */
@@ -586,6 +623,7 @@ public:
   // Inherited from RandomVariableStream
   virtual double GetValue (void);
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, std::size_t n);
 
 private:
   /** The mean value of the unbounded exponential distribution. */
@@ -1234,6 +1272,19 @@ public:
    */
   virtual uint32_t GetInteger (void);
 
+  /**
+   * \brief Get the next \p n random values from a normal distribution
+   * with the current mean, variance, and bound.
+   *
+   * The pairs of uniforms for all the values are drawn at once.  If
+   * the last pair gives one value more than needed, it is kept for the
+   * next call, as with GetValue(void).
+   *
+   * \param [out] values The array to fill.
+   * \param [in] n The number of values to draw.
+   */
+  virtual void GetValues (double *values, std::size_t n);
+
 private:
   /** The mean value for the normal distribution returned by this RNG stream. */
   double m_mean;
@@ -31,9 +31,12 @@
 #include "system-mutex.h"
 #include "boolean.h"
 #include "enum.h"
+#include "trace-source-accessor.h"
 
 
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 
 
 /**
@@ -69,6 +72,22 @@ RealtimeSimulatorImpl::GetTypeId (void)
                    TimeValue (Seconds (0.1)),
                    MakeTimeAccessor (&RealtimeSimulatorImpl::m_hardLimit),
                    MakeTimeChecker ())
+    .AddAttribute ("LatenessInterval",
+                   "The simulation time between the reports of the lateness "
+                   "histogram, or zero to report it only when Run returns.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&RealtimeSimulatorImpl::m_latenessInterval),
+                   MakeTimeChecker (Time (0)))
+    .AddTraceSource ("Lateness",
+                     "The real time elapsed between the timestamp of an "
+                     "event and its start.",
+                     MakeTraceSourceAccessor (&RealtimeSimulatorImpl::m_latenessTrace),
+                     "ns3::Time::TracedCallback")
+    .AddTraceSource ("LatenessHistogram",
+                     "The histogram of the lateness of the events run "
+                     "since the last report.",
+                     MakeTraceSourceAccessor (&RealtimeSimulatorImpl::m_latenessHistogramTrace),
+                     "ns3::RealtimeSimulatorImpl::LatenessHistogramCallback")
   ;
   return tid;
 }
@@ -92,6 +111,13 @@ RealtimeSimulatorImpl::RealtimeSimulatorImpl ()
   m_unscheduledEvents = 0;
   m_eventCount = 0;
 
+  m_inboxStub.next.store (0, std::memory_order_relaxed);
+  m_inboxHead.store (&m_inboxStub, std::memory_order_relaxed);
+  m_inboxTail = &m_inboxStub;
+
+  m_lateness.assign (LATENESS_BUCKETS, 0);
+  m_nextLatenessReport = 0;
+
   m_main = SystemThread::Self();
 
   // Be very careful not to do anything that would cause a change or assignment
@@ -108,6 +134,12 @@ void
 RealtimeSimulatorImpl::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  InboxEvent *event;
+  while ((event = PopInbox ()) != 0)
+    {
+      event->impl->Unref ();
+      delete event;
+    }
   while (!m_events->IsEmpty ())
     {
       Scheduler::Event next = m_events->RemoveNext ();
@@ -209,6 +241,16 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
 
       { 
         CriticalSection cs (m_mutex);
+        //
+        // We're going to sleep, but need to work with the synchronizer to make
+        // sure we're awakened if something external happens (like a packet is
+        // received).  This next line resets the synchronizer so that any future
+        // event will cause it to interrupt.  The events scheduled from other
+        // threads before that are in the inbox: move them to the event list.
+        //
+        m_synchronizer->SetCondition (false);
+        DrainInbox ();
+
         //
         // Since we are in realtime mode, the time to delay has got to be the 
         // difference between the current realtime and the timestamp of the next 
@@ -249,15 +291,6 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
           {
             tsDelay = tsNext - tsNow;
           }
-
-        //
-        // We've figured out how long we need to delay in order to pace the 
-        // simulation time with the real time.  We're going to sleep, but need
-        // to work with the synchronizer to make sure we're awakened if something 
-        // external happens (like a packet is received).  This next line resets
-        // the synchronizer so that any future event will cause it to interrupt.
-        //
-        m_synchronizer->SetCondition (false);
       }
 
       //
@@ -317,6 +350,7 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
   // whatever event is at the head of this list if the list is in time order.
   //
   Scheduler::Event next;
+  int64_t lateness;
 
   { 
     CriticalSection cs (m_mutex);
@@ -348,10 +382,18 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
     // executing.  From the rest of the simulation's point of view, simulation time
     // is frozen until the next event is executed.
     //
-    m_currentTs = next.key.m_ts;
+    m_currentTs.store (next.key.m_ts, std::memory_order_release);
     m_currentContext = next.key.m_context;
     m_currentUid = next.key.m_uid;
 
+    //
+    // The lateness is the real time elapsed since the timestamp of the event.
+    // It is negative in the unlikely case where the synchronizer woke us up
+    // early.
+    //
+    uint64_t tsFinal = m_synchronizer->GetCurrentRealtime ();
+    lateness = static_cast<int64_t> (tsFinal - m_currentTs);
+
     // 
     // We're about to run the event and we've done our best to synchronize this
     // event execution time to real time.  Now, if we're in SYNC_HARD_LIMIT mode
@@ -363,17 +405,7 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
     //
     if (m_synchronizationMode == SYNC_HARD_LIMIT)
       {
-        uint64_t tsFinal = m_synchronizer->GetCurrentRealtime ();
-        uint64_t tsJitter;
-
-        if (tsFinal >= m_currentTs)
-          {
-            tsJitter = tsFinal - m_currentTs;
-          }
-        else
-          {
-            tsJitter = m_currentTs - tsFinal;
-          }
+        uint64_t tsJitter = static_cast<uint64_t> (std::abs (lateness));
 
         if (tsJitter > static_cast<uint64_t> (m_hardLimit.GetTimeStep ()))
           {
@@ -388,6 +420,8 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
   // event list so we can execute it outside a critical section without fear of someone
   // changing things out from under us.
 
+  RecordLateness (lateness);
+
   EventImpl *event = next.impl;
   m_synchronizer->EventStart ();
   event->Invoke ();
@@ -401,7 +435,7 @@ RealtimeSimulatorImpl::IsFinished (void) const
   bool rc;
   {
     CriticalSection cs (m_mutex);
-    rc = m_events->IsEmpty () || m_stop;
+    rc = (m_events->IsEmpty () && IsInboxEmpty ()) || m_stop;
   }
 
   return rc;
@@ -433,6 +467,7 @@ RealtimeSimulatorImpl::Run (void)
   m_stop = false;
   m_running = true;
   m_synchronizer->SetOrigin (m_currentTs);
+  m_nextLatenessReport = m_currentTs + m_latenessInterval.GetTimeStep ();
 
   // Sleep until signalled
   uint64_t tsNow = 0;
@@ -444,6 +479,7 @@ RealtimeSimulatorImpl::Run (void)
       {
         CriticalSection cs (m_mutex);
 
+        DrainInbox ();
         if (!m_events->IsEmpty ())
           {
             process = true;
@@ -478,6 +514,11 @@ RealtimeSimulatorImpl::Run (void)
                    "RealtimeSimulatorImpl::Run(): Empty queue and unprocessed events");
   }
 
+  if (std::accumulate (m_lateness.begin (), m_lateness.end (), (uint64_t) 0) > 0)
+    {
+      ReportLateness ();
+    }
+
   m_running = false;
 }
 
@@ -544,23 +585,23 @@ RealtimeSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
 {
   NS_LOG_FUNCTION (this << context << delay << impl);
 
+  if (!SystemThread::Equals (m_main))
+    {
+      //
+      // If the simulator is running, we're pacing and have a meaningful 
+      // realtime clock.  If we're not, then m_currentTs is where we stopped.
+      // We do not hold m_mutex here: both fields are atomic.
+      // 
+      uint64_t ts = m_running.load (std::memory_order_acquire)
+        ? m_synchronizer->GetCurrentRealtime ()
+        : m_currentTs.load (std::memory_order_acquire);
+      ScheduleInbox (ts + delay.GetTimeStep (), context, impl);
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
-    uint64_t ts;
-
-    if (SystemThread::Equals (m_main))
-      {
-        ts = m_currentTs + delay.GetTimeStep ();
-      }
-    else
-      {
-        //
-        // If the simulator is running, we're pacing and have a meaningful 
-        // realtime clock.  If we're not, then m_currentTs is where we stopped.
-        // 
-        ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
-        ts += delay.GetTimeStep ();
-      }
+    uint64_t ts = m_currentTs + delay.GetTimeStep ();
 
     NS_ASSERT_MSG (ts >= m_currentTs, "RealtimeSimulatorImpl::ScheduleRealtime(): schedule for time < m_currentTs");
     Scheduler::Event ev;
@@ -596,6 +637,125 @@ RealtimeSimulatorImpl::ScheduleNow (EventImpl *impl)
   return EventId (impl, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
 
+void
+RealtimeSimulatorImpl::ScheduleInbox (uint64_t ts, uint32_t context, EventImpl *impl)
+{
+  InboxEvent *event = new InboxEvent;
+  event->impl = impl;
+  event->ts = ts;
+  event->context = context;
+  PushInbox (event);
+  m_synchronizer->Signal ();
+}
+
+void
+RealtimeSimulatorImpl::PushInbox (InboxEvent *event)
+{
+  event->next.store (0, std::memory_order_relaxed);
+  InboxEvent *prev = m_inboxHead.exchange (event, std::memory_order_acq_rel);
+  //
+  // Until the next line, the event is not reachable from the tail: the
+  // consumer sees an empty inbox, and will be woken up by our Signal.
+  //
+  prev->next.store (event, std::memory_order_release);
+}
+
+RealtimeSimulatorImpl::InboxEvent *
+RealtimeSimulatorImpl::PopInbox (void)
+{
+  InboxEvent *tail = m_inboxTail;
+  InboxEvent *next = tail->next.load (std::memory_order_acquire);
+  if (tail == &m_inboxStub)
+    {
+      if (next == 0)
+        {
+          return 0;
+        }
+      m_inboxTail = next;
+      tail = next;
+      next = next->next.load (std::memory_order_acquire);
+    }
+  if (next != 0)
+    {
+      m_inboxTail = next;
+      return tail;
+    }
+  if (tail != m_inboxHead.load (std::memory_order_acquire))
+    {
+      // A push is in progress.
+      return 0;
+    }
+  //
+  // The tail is the last event: link the stub after it, so that it can be
+  // unlinked.
+  //
+  PushInbox (&m_inboxStub);
+  next = tail->next.load (std::memory_order_acquire);
+  if (next != 0)
+    {
+      m_inboxTail = next;
+      return tail;
+    }
+  return 0;
+}
+
+void
+RealtimeSimulatorImpl::DrainInbox (void)
+{
+  InboxEvent *event;
+  while ((event = PopInbox ()) != 0)
+    {
+      //
+      // The timestamp was taken by the other thread when the event was
+      // scheduled: the simulator may have run past it since.
+      //
+      Scheduler::Event ev;
+      ev.impl = event->impl;
+      ev.key.m_ts = std::max (event->ts, m_currentTs.load (std::memory_order_relaxed));
+      ev.key.m_context = event->context;
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      m_unscheduledEvents++;
+      m_events->Insert (ev);
+      delete event;
+    }
+}
+
+bool
+RealtimeSimulatorImpl::IsInboxEmpty (void) const
+{
+  return m_inboxTail == &m_inboxStub
+    && m_inboxStub.next.load (std::memory_order_acquire) == 0;
+}
+
+void
+RealtimeSimulatorImpl::RecordLateness (int64_t lateness)
+{
+  uint32_t bucket = 0;
+  for (uint64_t ns = lateness > 0 ? lateness : 0;
+       ns != 0 && bucket < LATENESS_BUCKETS - 1;
+       ns >>= 1)
+    {
+      bucket++;
+    }
+  m_lateness[bucket]++;
+  m_latenessTrace (Time (lateness));
+
+  if (m_latenessInterval.IsStrictlyPositive ()
+      && m_currentTs >= m_nextLatenessReport)
+    {
+      ReportLateness ();
+      m_nextLatenessReport = m_currentTs + m_latenessInterval.GetTimeStep ();
+    }
+}
+
+void
+RealtimeSimulatorImpl::ReportLateness (void)
+{
+  m_latenessHistogramTrace (m_lateness);
+  std::fill (m_lateness.begin (), m_lateness.end (), 0);
+}
+
 Time
 RealtimeSimulatorImpl::Now (void) const
 {
@@ -610,6 +770,13 @@ RealtimeSimulatorImpl::ScheduleRealtimeWithContext (uint32_t context, Time const
 {
   NS_LOG_FUNCTION (this << context << time << impl);
 
+  if (!SystemThread::Equals (m_main))
+    {
+      ScheduleInbox (m_synchronizer->GetCurrentRealtime () + time.GetTimeStep (),
+                     context, impl);
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
 
@@ -637,6 +804,16 @@ void
 RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext (uint32_t context, EventImpl *impl)
 {
   NS_LOG_FUNCTION (this << context << impl);
+
+  if (!SystemThread::Equals (m_main))
+    {
+      uint64_t ts = m_running.load (std::memory_order_acquire)
+        ? m_synchronizer->GetCurrentRealtime ()
+        : m_currentTs.load (std::memory_order_acquire);
+      ScheduleInbox (ts, context, impl);
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
 
@@ -644,7 +821,7 @@ RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext (uint32_t context, EventIm
     // If the simulator is running, we're pacing and have a meaningful 
     // realtime clock.  If we're not, then m_currentTs is were we stopped.
     // 
-    uint64_t ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
+    uint64_t ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs.load ();
     NS_ASSERT_MSG (ts >= m_currentTs, 
                    "RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext(): schedule for time < m_currentTs");
     Scheduler::Event ev;
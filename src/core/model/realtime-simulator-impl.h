@@ -30,8 +30,12 @@
 #include "assert.h"
 #include "log.h"
 #include "system-mutex.h"
+#include "nstime.h"
+#include "traced-callback.h"
 
+#include <atomic>
 #include <list>
+#include <vector>
 
 /**
  * \file
@@ -52,6 +56,20 @@ namespace ns3 {
  * \ingroup realtime
  *
  * Realtime version of SimulatorImpl.
+ *
+ * The events scheduled with ScheduleWithContext() or
+ * ScheduleRealtime*WithContext() from a thread other than the simulator
+ * thread, such as the reader thread of an FdNetDevice, do not take the
+ * simulator mutex: they are pushed on a lock-free inbox, which the
+ * simulator thread moves to the event list before each wait.
+ *
+ * The lateness of each event, the real time elapsed between its
+ * timestamp and the time it is started, is reported by the Lateness
+ * trace source, and accumulated in a histogram reported every
+ * LatenessInterval by the LatenessHistogram trace source.  Bucket 0 of
+ * the histogram counts the events started on time, and bucket \f$i > 0\f$
+ * the events started between \f$2^{i-1}\f$ and \f$2^i\f$ ns late.
+ * The last bucket also counts the later events.
  */
 class RealtimeSimulatorImpl : public SimulatorImpl
 {
@@ -83,6 +101,15 @@ public:
     SYNC_HARD_LIMIT,  
   };
 
+  /** Number of buckets of the lateness histogram. */
+  static const uint32_t LATENESS_BUCKETS = 40;
+
+  /**
+   * TracedCallback signature for the lateness histogram.
+   * \param [in] histogram The number of events in each bucket.
+   */
+  typedef void (* LatenessHistogramCallback)(const std::vector<uint64_t> &histogram);
+
   /** Constructor. */
   RealtimeSimulatorImpl ();
   /** Destructor. */
@@ -173,6 +200,53 @@ private:
   uint64_t NextTs (void) const;
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /**
+   * Record the lateness of the event about to run.
+   * \param [in] lateness The real time elapsed since the event timestamp,
+   *     in ns.
+   */
+  void RecordLateness (int64_t lateness);
+  /** Fire the LatenessHistogram trace source, and reset the histogram. */
+  void ReportLateness (void);
+
+  /** An event scheduled from another thread, waiting in the inbox. */
+  struct InboxEvent
+  {
+    std::atomic<InboxEvent *> next;     //!< The next event in the inbox.
+    EventImpl *impl;                    //!< The event.
+    uint64_t ts;                        //!< The event timestamp.
+    uint32_t context;                   //!< The event context.
+  };
+  /**
+   * Push an event on the inbox, and wake the simulator thread up.
+   * This is safe to call from any thread, without locking.
+   * \param [in] ts The event timestamp.
+   * \param [in] context The event context.
+   * \param [in] impl The event.
+   */
+  void ScheduleInbox (uint64_t ts, uint32_t context, EventImpl *impl);
+  /**
+   * Link an event at the head of the inbox.
+   * \param [in] event The event.
+   */
+  void PushInbox (InboxEvent *event);
+  /**
+   * Unlink the event at the tail of the inbox.
+   * Must be called with #m_mutex held.
+   * \returns The event, or 0 if the inbox is empty.
+   */
+  InboxEvent * PopInbox (void);
+  /**
+   * Move the events of the inbox to the event list.
+   * Must be called with #m_mutex held.
+   */
+  void DrainInbox (void);
+  /**
+   * Check if the inbox is empty.
+   * Must be called with #m_mutex held.
+   * \returns \c true if the inbox is empty.
+   */
+  bool IsInboxEmpty (void) const;
   /** Destructor implementation. */
   virtual void DoDispose (void);
 
@@ -182,8 +256,13 @@ private:
   DestroyEvents m_destroyEvents;
   /** Has the stopping condition been reached? */
   bool m_stop;
-  /** Is the simulator currently running. */
-  bool m_running;
+  /**
+   * Is the simulator currently running.
+   *
+   * Atomic, since the threads which schedule events in the inbox read it
+   * without holding #m_mutex.
+   */
+  std::atomic<bool> m_running;
 
   /**
    * \name Mutex-protected variables.
@@ -199,14 +278,29 @@ private:
   uint32_t m_uid;
   /**< Unique id of the current event. */
   uint32_t m_currentUid;
-  /**< Timestep of the current event. */
-  uint64_t m_currentTs;
+  /**
+   * Timestep of the current event.
+   *
+   * Written with #m_mutex held, but atomic since the threads which
+   * schedule events in the inbox read it without holding #m_mutex.
+   */
+  std::atomic<uint64_t> m_currentTs;
   /**< Execution context. */
   uint32_t m_currentContext;  
   /** The event count. */
   uint64_t m_eventCount;
+  /** The consumer end of the inbox. */
+  InboxEvent *m_inboxTail;
   /**@}*/
 
+  /**
+   * The producer end of the inbox, a Vyukov multiple-producer
+   * single-consumer intrusive list.
+   */
+  std::atomic<InboxEvent *> m_inboxHead;
+  /** The inbox placeholder, linked when the inbox is drained. */
+  InboxEvent m_inboxStub;
+
   /** Mutex to control access to key state. */  
   mutable SystemMutex m_mutex;  
 
@@ -221,6 +315,17 @@ private:
 
   /** Main SystemThread. */
   SystemThread::ThreadId m_main;
+
+  /** The lateness histogram since the last report. */
+  std::vector<uint64_t> m_lateness;
+  /** The interval between the reports of the lateness histogram. */
+  Time m_latenessInterval;
+  /** The timestamp of the next report of the lateness histogram. */
+  uint64_t m_nextLatenessReport;
+  /** Trace of the lateness of each event. */
+  TracedCallback<Time> m_latenessTrace;
+  /** Trace of the lateness histogram. */
+  TracedCallback<const std::vector<uint64_t> &> m_latenessHistogramTrace;
 };
 
 } // namespace ns3
@@ -21,8 +21,11 @@
 #include "global-value.h"
 #include "attribute-helper.h"
 #include "uinteger.h"
+#include "enum.h"
 #include "config.h"
 #include "log.h"
+#include <map>
+#include <mutex>
 
 /**
  * \file
@@ -40,6 +43,18 @@ NS_LOG_COMPONENT_DEFINE ("RngSeedManager");
  * for automatic assignment.
  */
 static uint64_t g_nextStreamIndex = 0;
+/**
+ * \relates RngSeedManager
+ * The next random number generator stream number to use
+ * for automatic assignment, in each context.
+ */
+static std::map<uint32_t, uint64_t> g_nextContextStreamIndex;
+/**
+ * \relates RngSeedManager
+ * The mutex protecting g_nextContextStreamIndex, as streams may be
+ * created by the events of parallel partitions.
+ */
+static std::mutex g_nextContextStreamIndexMutex;
 /**
  * \relates RngSeedManager
  * The random number generator seed number global value.  This is used to
@@ -66,6 +81,20 @@ static ns3::GlobalValue g_rngRun ("RngRun",
                                   "The substream index used for all streams",
                                   ns3::UintegerValue (1),
                                   ns3::MakeUintegerChecker<uint64_t> ());
+/**
+ * \relates RngSeedManager
+ * The random number generator algorithm.  With "Philox", the streams are
+ * keyed by the seed, run, stream number and context, so they do not
+ * depend on how the work of a parallel simulation is partitioned.
+ *
+ * This is accessible as "--RngType" from CommandLine.
+ */
+static ns3::GlobalValue g_rngType ("RngType",
+                                   "The algorithm of all rng streams: "
+                                   "MRG32k3a or Philox (counter-based)",
+                                   ns3::EnumValue (RngStream::MRG32K3A),
+                                   ns3::MakeEnumChecker (RngStream::MRG32K3A, "MRG32k3a",
+                                                         RngStream::PHILOX, "Philox"));
 
 
 uint32_t RngSeedManager::GetSeed (void)
@@ -105,4 +134,19 @@ uint64_t RngSeedManager::GetNextStreamIndex (void)
   return next;
 }
 
+uint64_t RngSeedManager::GetNextStreamIndex (uint32_t context)
+{
+  NS_LOG_FUNCTION (context);
+  std::lock_guard<std::mutex> lock (g_nextContextStreamIndexMutex);
+  return g_nextContextStreamIndex[context]++;
+}
+
+RngStream::Type RngSeedManager::GetType (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  EnumValue value;
+  g_rngType.GetValue (value);
+  return static_cast<RngStream::Type> (value.Get ());
+}
+
 } // namespace ns3
@@ -21,6 +21,7 @@
 #define RNG_SEED_MANAGER_H
 
 #include <stdint.h>
+#include "rng-stream.h"
 
 /**
  * \file
@@ -105,6 +106,29 @@ public:
    */
   static uint64_t GetNextStreamIndex(void);
 
+  /**
+   * Get the next automatically assigned stream index of a context.
+   *
+   * Each context counts its streams separately, so the index of a
+   * stream created by the events of a context does not depend on the
+   * streams created concurrently by the other contexts.
+   *
+   * \param [in] context The context.
+   * \returns The next stream index of \p context.
+   */
+  static uint64_t GetNextStreamIndex (uint32_t context);
+
+  /**
+   * \brief Get the generator algorithm of the subsequently instantiated
+   * RandomVariableStream objects.
+   *
+   * This is the "RngType" global value: "MRG32k3a" (the default) or
+   * "Philox".
+   *
+   * \return The generator type.
+   */
+  static RngStream::Type GetType (void);
+
 };
 
 /** Alias for compatibility. */
@@ -325,12 +325,174 @@ void PowerOfTwoMatrix (int n, Matrix a1p, Matrix a2p)
 } // namespace MRG32k3a
 
 
+/** Namespace for Philox4x64-10 implementation details. */
+namespace Philox4x64
+{
+
+/** First round multiplier. */
+const uint64_t M0 = 0xD2E7470EE14C6C93ULL;
+/** Second round multiplier. */
+const uint64_t M1 = 0xCA5A826395121157ULL;
+/** First key Weyl increment, the golden ratio. */
+const uint64_t W0 = 0x9E3779B97F4A7C15ULL;
+/** Second key Weyl increment, sqrt (3) - 1. */
+const uint64_t W1 = 0xBB67AE8584CAA73BULL;
+/** The number of rounds. */
+const int ROUNDS = 10;
+/** Normalization to obtain randoms on (0,1) from 53 bits, 2<sup>-53</sup> */
+const double norm = 1.0 / 9007199254740992.0;
+
+/**
+ * Compute the 128 bit product of two 64 bit words.
+ *
+ * \param [in] a First argument.
+ * \param [in] b Second argument.
+ * \param [out] hi The high word of the product.
+ * \returns The low word of the product.
+ */
+inline uint64_t MulHiLo (uint64_t a, uint64_t b, uint64_t *hi)
+{
+#if defined (__SIZEOF_INT128__)
+  unsigned __int128 product = static_cast<unsigned __int128> (a) * b;
+  *hi = static_cast<uint64_t> (product >> 64);
+  return static_cast<uint64_t> (product);
+#else
+  const uint64_t mask = 0xffffffffULL;
+  uint64_t aLo = a & mask;
+  uint64_t aHi = a >> 32;
+  uint64_t bLo = b & mask;
+  uint64_t bHi = b >> 32;
+  uint64_t ll = aLo * bLo;
+  uint64_t lh = aLo * bHi;
+  uint64_t hl = aHi * bLo;
+  uint64_t hh = aHi * bHi;
+  uint64_t middle = (ll >> 32) + (lh & mask) + (hl & mask);
+  *hi = hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+  return (middle << 32) | (ll & mask);
+#endif
+}
+
+/**
+ * Compute the Philox4x64-10 bijection of a counter.
+ *
+ * \param [in] counter The counter.
+ * \param [in] key The key.
+ * \param [out] block The four random words.
+ */
+void Block (const uint64_t counter[4], const uint64_t key[2], uint64_t block[4])
+{
+  uint64_t c0 = counter[0];
+  uint64_t c1 = counter[1];
+  uint64_t c2 = counter[2];
+  uint64_t c3 = counter[3];
+  uint64_t k0 = key[0];
+  uint64_t k1 = key[1];
+  for (int round = 0; round < ROUNDS; round++)
+    {
+      uint64_t hi0, hi1;
+      uint64_t lo0 = MulHiLo (M0, c0, &hi0);
+      uint64_t lo1 = MulHiLo (M1, c2, &hi1);
+      c0 = hi1 ^ c1 ^ k0;
+      c1 = lo1;
+      c2 = hi0 ^ c3 ^ k1;
+      c3 = lo0;
+      k0 += W0;
+      k1 += W1;
+    }
+  block[0] = c0;
+  block[1] = c1;
+  block[2] = c2;
+  block[3] = c3;
+}
+
+/**
+ * Convert a random word to a double uniformly distributed in (0,1).
+ *
+ * \param [in] word The random word.
+ * \returns The random double.
+ */
+inline double ToU01 (uint64_t word)
+{
+  return (static_cast<double> (word >> 11) + 0.5) * norm;
+}
+
+} // namespace Philox4x64
+
+
 namespace ns3 {
 
 using namespace MRG32k3a;
   
+RngStream::Type
+RngStream::GetType (void) const
+{
+  return m_type;
+}
+
+void
+RngStream::GetState (uint64_t state[STATE_SIZE]) const
+{
+  if (m_type == PHILOX)
+    {
+      state[0] = m_key[0];
+      state[1] = m_key[1];
+      state[2] = m_stream;
+      state[3] = m_position;
+      state[4] = 0;
+      state[5] = 0;
+      return;
+    }
+  for (int i = 0; i < 6; ++i)
+    {
+      // The components are integers below 2^32.
+      state[i] = static_cast<uint64_t> (m_currentState[i]);
+    }
+}
+
+void
+RngStream::SetState (const uint64_t state[STATE_SIZE])
+{
+  if (m_type == PHILOX)
+    {
+      m_key[0] = state[0];
+      m_key[1] = state[1];
+      m_stream = state[2];
+      m_position = state[3];
+      m_blockValid = false;
+      return;
+    }
+  for (int i = 0; i < 6; ++i)
+    {
+      m_currentState[i] = static_cast<double> (state[i]);
+    }
+}
+
+void
+RngStream::PhiloxBlock (void)
+{
+  uint64_t counter[4] = { m_position / 4, m_stream, 0, 0 };
+  Philox4x64::Block (counter, m_key, m_block);
+  m_blockValid = true;
+}
+
+double
+RngStream::PhiloxRandU01 (void)
+{
+  unsigned int word = m_position % 4;
+  if (word == 0 || !m_blockValid)
+    {
+      PhiloxBlock ();
+    }
+  m_position++;
+  return Philox4x64::ToU01 (m_block[word]);
+}
+
 double RngStream::RandU01 ()
 {
+  if (m_type == PHILOX)
+    {
+      return PhiloxRandU01 ();
+    }
   int32_t k;
   double p1, p2, u;
 
@@ -360,7 +522,55 @@ double RngStream::RandU01 ()
   return u;
 }
 
+void
+RngStream::RandU01 (double *u, std::size_t n)
+{
+  if (m_type == PHILOX)
+    {
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          u[i] = PhiloxRandU01 ();
+        }
+      return;
+    }
+  // Same steps as RandU01 (void), on local copies of the state.
+  double s0 = m_currentState[0];
+  double s1 = m_currentState[1];
+  double s2 = m_currentState[2];
+  double s3 = m_currentState[3];
+  double s4 = m_currentState[4];
+  double s5 = m_currentState[5];
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      double p1 = a12 * s1 - a13n * s0;
+      int32_t k = static_cast<int32_t> (p1 / m1);
+      p1 -= k * m1;
+      if (p1 < 0.0)
+        {
+          p1 += m1;
+        }
+      s0 = s1; s1 = s2; s2 = p1;
+
+      double p2 = a21 * s5 - a23n * s3;
+      k = static_cast<int32_t> (p2 / m2);
+      p2 -= k * m2;
+      if (p2 < 0.0)
+        {
+          p2 += m2;
+        }
+      s3 = s4; s4 = s5; s5 = p2;
+
+      u[i] = ((p1 > p2) ? (p1 - p2) * norm : (p1 - p2 + m1) * norm);
+    }
+  m_currentState[0] = s0; m_currentState[1] = s1; m_currentState[2] = s2;
+  m_currentState[3] = s3; m_currentState[4] = s4; m_currentState[5] = s5;
+}
+
 RngStream::RngStream (uint32_t seedNumber, uint64_t stream, uint64_t substream)
+  : m_type (MRG32K3A),
+    m_stream (0),
+    m_position (0),
+    m_blockValid (false)
 {
   if (seedNumber >= m1 || seedNumber >= m2 || seedNumber == 0)
     {
@@ -372,14 +582,67 @@ RngStream::RngStream (uint32_t seedNumber, uint64_t stream, uint64_t substream)
     }
   AdvanceNthBy (stream, 127, m_currentState);
   AdvanceNthBy (substream, 76, m_currentState);
+  m_key[0] = 0;
+  m_key[1] = 0;
+}
+
+RngStream::RngStream (uint32_t seed, uint64_t run, uint64_t stream, uint32_t context)
+  : m_type (PHILOX),
+    m_stream (stream),
+    m_position (0),
+    m_blockValid (false)
+{
+  for (int i = 0; i < 6; ++i)
+    {
+      m_currentState[i] = 0;
+    }
+  m_key[0] = (static_cast<uint64_t> (context) << 32) | seed;
+  m_key[1] = run;
 }
 
 RngStream::RngStream(const RngStream& r)
+  : m_type (r.m_type),
+    m_stream (r.m_stream),
+    m_position (r.m_position),
+    m_blockValid (false)
 {
   for (int i = 0; i < 6; ++i)
     {
       m_currentState[i] = r.m_currentState[i];
     }
+  m_key[0] = r.m_key[0];
+  m_key[1] = r.m_key[1];
+}
+
+void
+RngStream::Advance (uint64_t n)
+{
+  if (m_type == PHILOX)
+    {
+      m_position += n;
+      m_blockValid = false;
+      return;
+    }
+  // The transition matrices A^(2^i) of the set bits of n commute.
+  Matrix matrix1, matrix2;
+  for (int i = 0; i < 64; i++)
+    {
+      if (((n >> i) & 0x1) == 0)
+        {
+          continue;
+        }
+      if (i == 0)
+        {
+          MatVecModM (A1p0, m_currentState, m_currentState, m1);
+          MatVecModM (A2p0, &m_currentState[3], &m_currentState[3], m2);
+        }
+      else
+        {
+          PowerOfTwoMatrix (i, matrix1, matrix2);
+          MatVecModM (matrix1, m_currentState, m_currentState, m1);
+          MatVecModM (matrix2, &m_currentState[3], &m_currentState[3], m2);
+        }
+    }
 }
 
 void 
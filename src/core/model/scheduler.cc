@@ -49,4 +49,14 @@ Scheduler::GetTypeId (void)
   return tid;
 }
 
+void
+Scheduler::InsertBatch (const std::vector<Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  for (std::vector<Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      Insert (*i);
+    }
+}
+
 } // namespace ns3
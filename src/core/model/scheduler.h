@@ -22,6 +22,7 @@
 #define SCHEDULER_H
 
 #include <stdint.h>
+#include <vector>
 #include "object.h"
 
 /**
@@ -104,6 +105,16 @@ public:
    * \param [in] ev Event to store in the event list
    */
   virtual void Insert (const Event &ev) = 0;
+  /**
+   * Insert a batch of new Events in the schedule.
+   *
+   * The default implementation calls Insert for each event; subclasses
+   * can override it when the events can be inserted more efficiently
+   * all at once.
+   *
+   * \param [in] events The events to store in the event list
+   */
+  virtual void InsertBatch (const std::vector<Event> &events);
   /**
    * Test if the schedule is empty.
    *
@@ -22,12 +22,14 @@
 #ifndef SIMPLE_REF_COUNT_H
 #define SIMPLE_REF_COUNT_H
 
+#include "ns3/core-config.h"
 #include "empty.h"
 #include "default-deleter.h"
 #include "assert.h"
 #include "unused.h"
 #include <stdint.h>
 #include <limits>
+#include <atomic>
 
 /**
  * \file
@@ -37,6 +39,101 @@
 
 namespace ns3 {
 
+/**
+ * \ingroup ptr
+ * \brief Reference count policy of SimpleRefCount for objects used by
+ * a single thread at a time.
+ */
+struct NonAtomicRefCountPolicy
+{
+  /** The type of the reference count. */
+  typedef uint32_t Counter;
+  /**
+   * Increment a reference count.
+   * \param [in,out] count The reference count.
+   */
+  static inline void Increment (Counter &count)
+  {
+    count++;
+  }
+  /**
+   * Decrement a reference count.
+   * \param [in,out] count The reference count.
+   * \returns \c true if this removed the last reference.
+   */
+  static inline bool Decrement (Counter &count)
+  {
+    return --count == 0;
+  }
+  /**
+   * Read a reference count.
+   * \param [in] count The reference count.
+   * \returns The reference count.
+   */
+  static inline uint32_t Get (const Counter &count)
+  {
+    return count;
+  }
+};
+
+/**
+ * \ingroup ptr
+ * \brief Reference count policy of SimpleRefCount for objects whose Ptr
+ * are copied and released from several threads.
+ *
+ * Increments are relaxed.  The decrement which removes the last
+ * reference synchronizes with the other decrements, so that the
+ * deleter sees every write made through the released references.
+ */
+struct AtomicRefCountPolicy
+{
+  /** The type of the reference count. */
+  typedef std::atomic<uint32_t> Counter;
+  /**
+   * Increment a reference count.
+   * \param [in,out] count The reference count.
+   */
+  static inline void Increment (Counter &count)
+  {
+    count.fetch_add (1, std::memory_order_relaxed);
+  }
+  /**
+   * Decrement a reference count.
+   * \param [in,out] count The reference count.
+   * \returns \c true if this removed the last reference.
+   */
+  static inline bool Decrement (Counter &count)
+  {
+    if (count.fetch_sub (1, std::memory_order_release) == 1)
+      {
+        std::atomic_thread_fence (std::memory_order_acquire);
+        return true;
+      }
+    return false;
+  }
+  /**
+   * Read a reference count.
+   * \param [in] count The reference count.
+   * \returns The reference count.
+   */
+  static inline uint32_t Get (const Counter &count)
+  {
+    return count.load (std::memory_order_relaxed);
+  }
+};
+
+/**
+ * \ingroup ptr
+ * The reference count policy of SimpleRefCount, and so of Object and
+ * Packet: AtomicRefCountPolicy when configured with
+ * \c --enable-atomic-refcount, NonAtomicRefCountPolicy otherwise.
+ */
+#ifdef NS3_ATOMIC_REFCOUNT
+typedef AtomicRefCountPolicy DefaultRefCountPolicy;
+#else
+typedef NonAtomicRefCountPolicy DefaultRefCountPolicy;
+#endif
+
 /**
  * \ingroup ptr
  * \brief A template-based reference counting class
@@ -51,7 +148,7 @@ namespace ns3 {
  * virtual.
  *
  *
- * This template takes 3 arguments but only the first argument is
+ * This template takes 4 arguments but only the first argument is
  * mandatory:
  *
  * \tparam T \explicit The typename of the subclass which derives
@@ -66,10 +163,16 @@ namespace ns3 {
  *      a public static method named 'Delete'. This method will be called
  *      whenever the SimpleRefCount template detects that no references
  *      to the object it manages exist anymore.
+ * \tparam POLICY \explicit The reference count policy,
+ *      NonAtomicRefCountPolicy or AtomicRefCountPolicy.  By default,
+ *      DefaultRefCountPolicy, chosen at configure time.  The atomic
+ *      policy makes copying and releasing Ptr thread-safe; it does not
+ *      make the object itself thread-safe.
  *
  * Interesting users of this class include ns3::Object as well as ns3::Packet.
  */
-template <typename T, typename PARENT = empty, typename DELETER = DefaultDeleter<T> >
+template <typename T, typename PARENT = empty, typename DELETER = DefaultDeleter<T>,
+          typename POLICY = DefaultRefCountPolicy>
 class SimpleRefCount : public PARENT
 {
 public:
@@ -104,8 +207,8 @@ public:
    */
   inline void Ref (void) const
   {
-    NS_ASSERT (m_count < std::numeric_limits<uint32_t>::max());
-    m_count++;
+    NS_ASSERT (POLICY::Get (m_count) < std::numeric_limits<uint32_t>::max());
+    POLICY::Increment (m_count);
   }
   /**
    * Decrement the reference count. This method should not be called
@@ -115,8 +218,7 @@ public:
    */
   inline void Unref (void) const
   {
-    m_count--;
-    if (m_count == 0)
+    if (POLICY::Decrement (m_count))
       {
         DELETER::Delete (static_cast<T*> (const_cast<SimpleRefCount *> (this)));
       }
@@ -130,7 +232,7 @@ public:
    */
   inline uint32_t GetReferenceCount (void) const
   {
-    return m_count;
+    return POLICY::Get (m_count);
   }
 
 private:
@@ -141,7 +243,7 @@ private:
    * Note we make this mutable so that the const methods can still
    * change it.
    */
-  mutable uint32_t m_count;
+  mutable typename POLICY::Counter m_count;
 };
 
 } // namespace ns3
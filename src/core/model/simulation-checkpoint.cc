@@ -0,0 +1,522 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "simulation-checkpoint.h"
+#include "config.h"
+#include "object.h"
+#include "object-ptr-container.h"
+#include "pointer.h"
+#include "random-variable-stream.h"
+#include "rng-seed-manager.h"
+#include "rng-stream.h"
+#include "simulator.h"
+#include "fatal-error.h"
+#include "fatal-impl.h"
+#include "log.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+#include <utility>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::SimulationCheckpoint implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SimulationCheckpoint");
+
+namespace {
+
+/** The first line of a checkpoint file. */
+const std::string CHECKPOINT_MAGIC = "ns3-checkpoint 1";
+
+/** Visitor for the settable attributes of an object graph. */
+class AttributeVisitor
+{
+public:
+  /** Destructor. */
+  virtual ~AttributeVisitor ()
+  {}
+  /**
+   * Visit one attribute.
+   * \param [in] object The object.
+   * \param [in] path The path to the object.
+   * \param [in] info The attribute.
+   */
+  virtual void Visit (Ptr<Object> object, const std::string &path,
+                      const struct TypeId::AttributeInformation &info) = 0;
+};
+
+/**
+ * Visit the attributes of an object and of all the objects it refers
+ * to through Pointer and ObjectVector attributes and aggregation.
+ *
+ * Each object is visited once, with the first path found, so that
+ * shared objects and cycles are handled.
+ *
+ * \param [in] object The object.
+ * \param [in] path The path to the object.
+ * \param [in] visitor The visitor.
+ * \param [in,out] visited The objects visited so far.
+ */
+void
+VisitObject (Ptr<Object> object, std::string path, AttributeVisitor &visitor,
+             std::set<Object *> &visited)
+{
+  if (object == 0 || !visited.insert (PeekPointer (object)).second)
+    {
+      return;
+    }
+
+  TypeId tid = object->GetInstanceTypeId ();
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (std::size_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          if (!(info.flags & TypeId::ATTR_GET) || !info.accessor->HasGetter ()
+              || info.supportLevel == TypeId::OBSOLETE)
+            {
+              continue;
+            }
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              PointerValue value;
+              if (info.accessor->Get (PeekPointer (object), value))
+                {
+                  VisitObject (value.Get<Object> (), path + "/" + info.name, visitor, visited);
+                }
+              continue;
+            }
+          if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              ObjectPtrContainerValue value;
+              if (info.accessor->Get (PeekPointer (object), value))
+                {
+                  for (ObjectPtrContainerValue::Iterator j = value.Begin (); j != value.End (); ++j)
+                    {
+                      std::ostringstream oss;
+                      oss << path << "/" << info.name << "/" << j->first;
+                      VisitObject (j->second, oss.str (), visitor, visited);
+                    }
+                }
+              continue;
+            }
+          if ((info.flags & TypeId::ATTR_SET) && info.accessor->HasSetter ())
+            {
+              visitor.Visit (object, path, info);
+            }
+        }
+      nextTid = tid.GetParent ();
+    }
+  while (nextTid != tid);
+
+  Object::AggregateIterator aggregates = object->GetAggregateIterator ();
+  while (aggregates.HasNext ())
+    {
+      Ptr<Object> aggregate = ConstCast<Object> (aggregates.Next ());
+      VisitObject (aggregate, path + "/$" + aggregate->GetInstanceTypeId ().GetName (),
+                   visitor, visited);
+    }
+}
+
+/**
+ * Visit the attributes of all the objects reachable from the
+ * Config root namespace objects.
+ *
+ * \param [in] visitor The visitor.
+ */
+void
+VisitAttributes (AttributeVisitor &visitor)
+{
+  std::set<Object *> visited;
+  for (std::size_t i = 0; i < Config::GetRootNamespaceObjectN (); i++)
+    {
+      VisitObject (Config::GetRootNamespaceObject (i), "", visitor, visited);
+    }
+}
+
+/**
+ * Get the value of an attribute as a string.
+ * \param [in] object The object.
+ * \param [in] info The attribute.
+ * \param [out] value The serialized value.
+ * \returns \c true if the attribute could be read.
+ */
+bool
+GetAttributeString (Ptr<Object> object, const struct TypeId::AttributeInformation &info,
+                    std::string &value)
+{
+  Ptr<AttributeValue> v = info.checker->Create ();
+  if (!info.accessor->Get (PeekPointer (object), *v))
+    {
+      return false;
+    }
+  value = v->SerializeToString (info.checker);
+  return true;
+}
+
+/** Write the attributes to a checkpoint file. */
+class SaveVisitor : public AttributeVisitor
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] os The checkpoint file.
+   */
+  SaveVisitor (std::ostream &os)
+    : m_os (os)
+  {}
+  virtual void Visit (Ptr<Object> object, const std::string &path,
+                      const struct TypeId::AttributeInformation &info)
+  {
+    std::string value;
+    if (!GetAttributeString (object, info, value))
+      {
+        return;
+      }
+    if (value.find_first_of ("\t\n") != std::string::npos)
+      {
+        NS_LOG_WARN ("Cannot save " << path << "/" << info.name << " = " << value);
+        return;
+      }
+    m_os << "attribute\t" << (path == "" ? "/" : path) << "\t" << info.name
+         << "\t" << value << std::endl;
+  }
+
+private:
+  std::ostream &m_os;  //!< The checkpoint file.
+};
+
+/** Restore the attributes from a checkpoint file. */
+class RestoreVisitor : public AttributeVisitor
+{
+public:
+  /** The saved attribute values, by path and name. */
+  typedef std::map<std::pair<std::string, std::string>, std::string> Values;
+
+  /**
+   * Constructor.
+   * \param [in] values The saved attribute values.
+   */
+  RestoreVisitor (const Values &values)
+    : m_values (values),
+      m_found (0),
+      m_restored (0)
+  {}
+  virtual void Visit (Ptr<Object> object, const std::string &path,
+                      const struct TypeId::AttributeInformation &info)
+  {
+    Values::const_iterator saved = m_values.find (std::make_pair (path == "" ? "/" : path, info.name));
+    if (saved == m_values.end ())
+      {
+        return;
+      }
+    m_found++;
+    std::string value;
+    if (GetAttributeString (object, info, value) && value == saved->second)
+      {
+        return;
+      }
+    Ptr<AttributeValue> v = info.checker->Create ();
+    if (!v->DeserializeFromString (saved->second, info.checker)
+        || !info.checker->Check (*v)
+        || !info.accessor->Set (PeekPointer (object), *v))
+      {
+        NS_LOG_WARN ("Cannot restore " << saved->first.first << "/" << info.name
+                     << " = " << saved->second);
+        return;
+      }
+    NS_LOG_LOGIC ("Restored " << saved->first.first << "/" << info.name
+                  << " = " << saved->second);
+    m_restored++;
+  }
+  /**
+   * Get the number of saved attributes found in the simulation.
+   * \returns The number of attributes.
+   */
+  std::size_t GetFound (void) const
+  {
+    return m_found;
+  }
+  /**
+   * Get the number of attributes changed.
+   * \returns The number of attributes.
+   */
+  std::size_t GetRestored (void) const
+  {
+    return m_restored;
+  }
+
+private:
+  const Values &m_values;   //!< The saved attribute values.
+  std::size_t m_found;      //!< The number of saved attributes found.
+  std::size_t m_restored;   //!< The number of attributes changed.
+};
+
+/**
+ * Wait for one branch process to exit.
+ * \param [in,out] running The running branches, by process id.
+ * \returns \c false if the branch failed.
+ */
+bool
+WaitBranch (std::map<pid_t, uint32_t> &running)
+{
+  while (true)
+    {
+      int status;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("waitpid failed: " << std::strerror (errno));
+        }
+      std::map<pid_t, uint32_t>::iterator i = running.find (pid);
+      if (i == running.end ())
+        {
+          // Not one of our branches.
+          continue;
+        }
+      uint32_t branch = i->second;
+      running.erase (i);
+      if (WIFEXITED (status) && WEXITSTATUS (status) == 0)
+        {
+          NS_LOG_LOGIC ("Branch " << branch << " done");
+          return true;
+        }
+      std::cerr << "Branch " << branch << " (pid " << pid << ") failed with status "
+                << status << std::endl;
+      return false;
+    }
+}
+
+} // unnamed namespace
+
+void
+SimulationCheckpoint::Save (const std::string &path)
+{
+  NS_LOG_FUNCTION (path);
+  std::ofstream os (path.c_str ());
+  if (!os)
+    {
+      NS_FATAL_ERROR ("Cannot open checkpoint file " << path);
+    }
+  os << std::setprecision (17);
+  os << CHECKPOINT_MAGIC << std::endl;
+  os << "time " << Simulator::Now ().GetTimeStep () << std::endl;
+  os << "seed " << RngSeedManager::GetSeed () << std::endl;
+  os << "run " << RngSeedManager::GetRun () << std::endl;
+  os << "rng " << RngSeedManager::GetType () << std::endl;
+
+  const RandomVariableStream::Registry &streams = RandomVariableStream::GetRegistry ();
+  for (RandomVariableStream::Registry::const_iterator i = streams.begin (); i != streams.end (); ++i)
+    {
+      RngStream *rng = i->second->Peek ();
+      if (rng == 0)
+        {
+          continue;
+        }
+      uint64_t state[RngStream::STATE_SIZE];
+      rng->GetState (state);
+      os << "stream " << i->second->GetStream ();
+      for (int j = 0; j < RngStream::STATE_SIZE; j++)
+        {
+          os << " " << state[j];
+        }
+      os << std::endl;
+    }
+
+  SaveVisitor visitor (os);
+  VisitAttributes (visitor);
+  if (!os)
+    {
+      NS_FATAL_ERROR ("Cannot write checkpoint file " << path);
+    }
+}
+
+void
+SimulationCheckpoint::Restore (const std::string &path)
+{
+  NS_LOG_FUNCTION (path);
+  std::ifstream is (path.c_str ());
+  std::string line;
+  if (!std::getline (is, line) || line != CHECKPOINT_MAGIC)
+    {
+      NS_FATAL_ERROR ("Invalid checkpoint file " << path);
+    }
+
+  RestoreVisitor::Values attributes;
+  const RandomVariableStream::Registry &streams = RandomVariableStream::GetRegistry ();
+  RandomVariableStream::Registry::const_iterator stream = streams.begin ();
+  std::size_t streamCount = 0;
+  // Checkpoints without a rng line are MRG32k3a.
+  RngStream::Type rngType = RngStream::MRG32K3A;
+  while (std::getline (is, line))
+    {
+      std::istringstream iss (line);
+      std::string kind;
+      std::getline (iss, kind, line.compare (0, 10, "attribute\t") == 0 ? '\t' : ' ');
+      if (kind == "time")
+        {
+          int64_t ts;
+          iss >> ts;
+          if (ts != Simulator::Now ().GetTimeStep ())
+            {
+              NS_LOG_WARN ("Checkpoint taken at " << TimeStep (ts).As (Time::S)
+                           << ", restored at " << Simulator::Now ().As (Time::S));
+            }
+        }
+      else if (kind == "seed")
+        {
+          uint32_t seed;
+          iss >> seed;
+          RngSeedManager::SetSeed (seed);
+        }
+      else if (kind == "run")
+        {
+          uint64_t run;
+          iss >> run;
+          RngSeedManager::SetRun (run);
+        }
+      else if (kind == "rng")
+        {
+          int type;
+          iss >> type;
+          rngType = static_cast<RngStream::Type> (type);
+        }
+      else if (kind == "stream")
+        {
+          // Streams are matched in creation order.
+          streamCount++;
+          while (stream != streams.end () && stream->second->Peek () == 0)
+            {
+              ++stream;
+            }
+          int64_t number;
+          uint64_t state[RngStream::STATE_SIZE];
+          iss >> number;
+          for (int j = 0; j < RngStream::STATE_SIZE; j++)
+            {
+              iss >> state[j];
+            }
+          if (stream == streams.end ())
+            {
+              continue;
+            }
+          if (stream->second->GetStream () != number)
+            {
+              NS_FATAL_ERROR ("Checkpoint " << path << " does not match this simulation: "
+                              "stream " << streamCount << " is " << stream->second->GetStream ()
+                              << " instead of " << number);
+            }
+          if (stream->second->Peek ()->GetType () != rngType)
+            {
+              NS_FATAL_ERROR ("Checkpoint " << path << " does not match this simulation: "
+                              "stream " << streamCount << " has another RngType");
+            }
+          stream->second->Peek ()->SetState (state);
+          ++stream;
+        }
+      else if (kind == "attribute")
+        {
+          std::string objectPath, name, value;
+          std::getline (iss, objectPath, '\t');
+          std::getline (iss, name, '\t');
+          std::getline (iss, value);
+          attributes[std::make_pair (objectPath, name)] = value;
+        }
+      else
+        {
+          NS_FATAL_ERROR ("Invalid line in checkpoint file " << path << ": " << line);
+        }
+    }
+  while (stream != streams.end () && stream->second->Peek () == 0)
+    {
+      ++stream;
+    }
+  if (stream != streams.end () || streamCount > streams.size ())
+    {
+      NS_LOG_WARN ("Checkpoint " << path << " has " << streamCount << " streams, "
+                   "the simulation has " << streams.size ());
+    }
+
+  RestoreVisitor visitor (attributes);
+  VisitAttributes (visitor);
+  if (visitor.GetFound () != attributes.size ())
+    {
+      NS_LOG_WARN ("Only " << visitor.GetFound () << " of the " << attributes.size ()
+                   << " attributes of checkpoint " << path << " were found");
+    }
+  NS_LOG_INFO ("Restored " << visitor.GetRestored () << " attributes from " << path);
+}
+
+uint32_t
+SimulationCheckpoint::Fork (uint32_t count, uint32_t parallel)
+{
+  NS_LOG_FUNCTION (count << parallel);
+  // Do not let the branches write the buffered output again.
+  FatalImpl::FlushRegisteredStreams ();
+
+  std::map<pid_t, uint32_t> running;
+  uint32_t failures = 0;
+  for (uint32_t branch = 0; branch < count; branch++)
+    {
+      if (parallel != 0 && running.size () >= parallel && !WaitBranch (running))
+        {
+          failures++;
+        }
+      pid_t pid = fork ();
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("fork failed: " << std::strerror (errno));
+        }
+      if (pid == 0)
+        {
+          return branch;
+        }
+      NS_LOG_LOGIC ("Branch " << branch << " is pid " << pid);
+      running[pid] = branch;
+    }
+  while (!running.empty ())
+    {
+      if (!WaitBranch (running))
+        {
+          failures++;
+        }
+    }
+  if (failures != 0)
+    {
+      NS_FATAL_ERROR (failures << " of " << count << " branches failed");
+    }
+  return count;
+}
+
+} // namespace ns3
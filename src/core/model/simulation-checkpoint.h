@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SIMULATION_CHECKPOINT_H
+#define SIMULATION_CHECKPOINT_H
+
+#include <stdint.h>
+#include <string>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::SimulationCheckpoint declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Save, restore and fork the state of a simulation.
+ *
+ * Two complementary mechanisms are provided.
+ *
+ * <b>Warm branches.</b>  Fork() splits the calling process into several
+ * branch processes, which all continue from the exact state of the
+ * simulation at the time of the call: pending events, protocol state,
+ * random streams and so on.  This is the way to share a long warm-up
+ * between the runs of a parameter sweep:
+ *
+ * \code
+ *   // Build the scenario, then warm it up once.
+ *   Simulator::Stop (Seconds (200));
+ *   Simulator::Run ();
+ *
+ *   uint32_t branch = SimulationCheckpoint::Fork (sweep.size ());
+ *   if (branch == sweep.size ())
+ *     {
+ *       return 0;   // the original process, once all the branches exited
+ *     }
+ *   Config::Set ("/NodeList/0/...", sweep[branch]);
+ *   Simulator::Stop (Seconds (100));
+ *   Simulator::Run ();
+ *   Simulator::Destroy ();
+ * \endcode
+ *
+ * <b>Checkpoint files.</b>  Save() writes the part of the state which
+ * can be introspected to a text file: the simulation time, the
+ * RngSeedManager configuration, the state of every RngStream, and the
+ * value of every attribute of the objects reachable from the Config
+ * root namespace objects (such as NodeList and ChannelList), walking
+ * the Pointer and ObjectVector attributes and the aggregated objects.
+ * Restore() applies a checkpoint file to a simulation built by the same
+ * program: it restores the random streams, in creation order, and every
+ * attribute whose value differs from the checkpoint.
+ *
+ * The pending events are C++ closures bound to arbitrary arguments and
+ * cannot be serialized, so a checkpoint file does not restore them: use
+ * Fork() to branch a running simulation, and checkpoint files to record
+ * and reproduce its configuration and random state.
+ */
+class SimulationCheckpoint
+{
+public:
+  /**
+   * Write a checkpoint file.
+   *
+   * \param [in] path The name of the checkpoint file.
+   */
+  static void Save (const std::string &path);
+  /**
+   * Apply a checkpoint file to the current simulation.
+   *
+   * \param [in] path The name of the checkpoint file.
+   */
+  static void Restore (const std::string &path);
+
+  /**
+   * Fork the simulation into several processes.
+   *
+   * The calling process waits for the branches to exit, at most
+   * \p parallel at a time, and aborts if any of them failed.  The
+   * simulation must not be running in several threads.
+   *
+   * The standard streams, the \c FILE* streams and the streams
+   * registered with FatalImpl::RegisterStream (the trace files opened
+   * through OutputStreamWrapper, PcapFile, AsciiFile and so on) are
+   * flushed before forking, so that the branches do not write the
+   * buffered output again.
+   *
+   * \warning The files open at the time of the call are shared by
+   * all the branches, which write to them at the same file offset:
+   * the traces written after Fork() by several branches are garbled.
+   * The trace files are not reopened: each branch should open its own
+   * trace files after Fork(), with the branch index in their names,
+   * and the trace files which are not needed after Fork() should be
+   * closed before.  Threads are not duplicated by \c fork(): the files
+   * written by a background thread, such as a PcapFile with
+   * asynchronous writes, must be closed before Fork().
+   *
+   * \param [in] count The number of branches.
+   * \param [in] parallel The maximum number of branches running at
+   *             the same time, or zero for no limit.
+   * \returns The index of the branch, in <tt>[0, count)</tt>, in each
+   *          branch process, and \p count in the calling process once
+   *          all the branches exited.
+   */
+  static uint32_t Fork (uint32_t count, uint32_t parallel = 0);
+};
+
+} // namespace ns3
+
+#endif /* SIMULATION_CHECKPOINT_H */
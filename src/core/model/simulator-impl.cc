@@ -42,4 +42,26 @@ SimulatorImpl::GetTypeId (void)
   return tid;
 }
 
+void
+SimulatorImpl::ScheduleWithContextBatch (const Simulator::ContextEvents &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  for (Simulator::ContextEvents::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      ScheduleWithContext (i->context, i->delay, i->event);
+    }
+}
+
+uint32_t
+SimulatorImpl::GetPartitionId (void) const
+{
+  return 0;
+}
+
+uint32_t
+SimulatorImpl::GetContextPartitionId (uint32_t context) const
+{
+  return 0;
+}
+
 } // namespace ns3
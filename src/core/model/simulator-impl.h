@@ -27,6 +27,7 @@
 #include "object.h"
 #include "object-factory.h"
 #include "ptr.h"
+#include "simulator.h"
 
 /**
  * \file
@@ -67,6 +68,12 @@ public:
   virtual EventId Schedule (const Time &delay, EventImpl *event) = 0;
   /** \copydoc Simulator::ScheduleWithContext(uint32_t,const Time&,EventImpl*) */
   virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event) = 0;
+  /**
+   * \copydoc Simulator::ScheduleWithContextBatch
+   *
+   * The default implementation calls ScheduleWithContext for each event.
+   */
+  virtual void ScheduleWithContextBatch (const Simulator::ContextEvents &events);
   /** \copydoc Simulator::ScheduleNow(const Ptr<EventImpl>&) */
   virtual EventId ScheduleNow (EventImpl *event) = 0;
   /** \copydoc Simulator::ScheduleDestroy(const Ptr<EventImpl>&) */
@@ -97,6 +104,18 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory) = 0;
   /** \copydoc Simulator::GetSystemId */
   virtual uint32_t GetSystemId () const = 0; 
+  /**
+   * \copydoc Simulator::GetPartitionId
+   *
+   * The default implementation returns 0.
+   */
+  virtual uint32_t GetPartitionId (void) const;
+  /**
+   * \copydoc Simulator::GetContextPartitionId
+   *
+   * The default implementation returns 0.
+   */
+  virtual uint32_t GetContextPartitionId (uint32_t context) const;
   /** \copydoc Simulator::GetContext */
   virtual uint32_t GetContext (void) const = 0;
   /** \copydoc Simulator::GetEventCount */
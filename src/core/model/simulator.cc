@@ -24,6 +24,7 @@
 #include "map-scheduler.h"
 #include "event-impl.h"
 #include "des-metrics.h"
+#include "simulation-checkpoint.h"
 
 #include "ptr.h"
 #include "string.h"
@@ -224,6 +225,17 @@ Simulator::ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *
 #endif
   return GetImpl ()->ScheduleWithContext (context, delay, impl);
 }
+void
+Simulator::ScheduleWithContextBatch (const ContextEvents &events)
+{
+#ifdef ENABLE_DES_METRICS
+  for (ContextEvents::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      DesMetrics::Get ()->TraceWithContext (i->context, Now (), i->delay);
+    }
+#endif
+  return GetImpl ()->ScheduleWithContextBatch (events);
+}
 EventId
 Simulator::ScheduleDestroy (const Ptr<EventImpl> &ev)
 {
@@ -321,6 +333,10 @@ Simulator::GetMaximumSimulationTime (void)
 uint32_t
 Simulator::GetContext (void)
 {
+  if (*PeekImpl () == 0)
+    {
+      return NO_CONTEXT;
+    }
   return GetImpl ()->GetContext ();
 }
   
@@ -330,6 +346,20 @@ Simulator::GetEventCount (void)
   return GetImpl ()-> GetEventCount ();
 }
 
+void
+Simulator::Checkpoint (const std::string &path)
+{
+  NS_LOG_FUNCTION (path);
+  SimulationCheckpoint::Save (path);
+}
+
+void
+Simulator::Restore (const std::string &path)
+{
+  NS_LOG_FUNCTION (path);
+  SimulationCheckpoint::Restore (path);
+}
+
 uint32_t
 Simulator::GetSystemId (void)
 {
@@ -345,6 +375,36 @@ Simulator::GetSystemId (void)
     }
 }
 
+uint32_t
+Simulator::GetPartitionId (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  if (*PeekImpl () != 0)
+    {
+      return GetImpl ()->GetPartitionId ();
+    }
+  else
+    {
+      return 0;
+    }
+}
+
+uint32_t
+Simulator::GetContextPartitionId (uint32_t context)
+{
+  NS_LOG_FUNCTION (context);
+
+  if (*PeekImpl () != 0)
+    {
+      return GetImpl ()->GetContextPartitionId (context);
+    }
+  else
+    {
+      return 0;
+    }
+}
+
 void
 Simulator::SetImplementation (Ptr<SimulatorImpl> impl)
 {
@@ -30,6 +30,7 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 /**
  * @file
@@ -180,6 +181,9 @@ public:
    * during object initialization, the \c enum value \c NO_CONTEXT
    * should be used.
    *
+   * This does not create the simulator implementation: before it is
+   * created, the context is \c NO_CONTEXT.
+   *
    * @return The current simulation context
    */
   static uint32_t GetContext (void);
@@ -203,6 +207,23 @@ public:
    * \returns The total number of events executed.
    */
   static uint64_t GetEventCount (void);
+
+  /**
+   * Write a checkpoint file of the simulation state.
+   *
+   * See SimulationCheckpoint for what is saved.
+   *
+   * \param [in] path The name of the checkpoint file.
+   */
+  static void Checkpoint (const std::string &path);
+  /**
+   * Restore the simulation state from a checkpoint file.
+   *
+   * See SimulationCheckpoint for what is restored.
+   *
+   * \param [in] path The name of the checkpoint file.
+   */
+  static void Restore (const std::string &path);
   
 
   /**
@@ -1303,6 +1324,30 @@ public:
    */
   static void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
 
+  /** An event to schedule with ScheduleWithContextBatch(). */
+  struct ContextEvent
+  {
+    uint32_t context;   //!< Event context.
+    Time delay;         //!< Delay until the event expires.
+    EventImpl *event;   //!< The event to schedule.
+  };
+  /** A batch of events to schedule with ScheduleWithContextBatch(). */
+  typedef std::vector<ContextEvent> ContextEvents;
+
+  /**
+   * Schedule a batch of future event executions, each in its own context.
+   * This method is thread-safe: it can be called from any thread.
+   *
+   * This is equivalent to calling ScheduleWithContext for each event, in
+   * order, but lets the simulator insert all the events in the event
+   * list in one operation.  Channels which deliver a packet to all
+   * their receivers should prefer it.
+   *
+   * @param [in] events The events to schedule.  The simulator takes
+   *             ownership of the EventImpl objects.
+   */
+  static void ScheduleWithContextBatch (const ContextEvents &events);
+
   /**
    * Schedule an event to run at the end of the simulation, after
    * the Stop() time or condition has been reached.
@@ -1328,6 +1373,32 @@ public:
    * @return The system id for this simulator.
    */
   static uint32_t GetSystemId (void);
+
+  /**
+   * Get the partition processing the current event.
+   *
+   * Implementations which process events in parallel threads, like
+   * MultithreadedSimulatorImpl, return a distinct id, counted from 1,
+   * for the events of each partition.  The events processed one at a
+   * time, and the code run outside of Simulator::Run, get 0.  Models
+   * can use it to keep per-partition state, such as counters, whose
+   * values do not depend on the timing of the threads.
+   * @return The partition id, or 0.
+   */
+  static uint32_t GetPartitionId (void);
+
+  /**
+   * Get the partition processing the events of a context.
+   *
+   * The events of another partition may run in parallel with the
+   * current one, so that the objects handed to them must not be shared
+   * with the current partition: for example, Packet::CopyForContext
+   * makes a deep copy of the packets sent to another partition.
+   * @param [in] context The event context.
+   * @return The partition id, as returned by GetPartitionId in the
+   *         events of this context, or 0.
+   */
+  static uint32_t GetContextPartitionId (uint32_t context);
   
 private:
   /** Default constructor. */
@@ -222,6 +222,20 @@ Time::SetResolution (enum Unit unit, struct Resolution *resolution,
       NS_LOG_DEBUG ("SetResolution factor " << factor << " real factor " << realFactor);
       struct Information *info = &resolution->info[i];
       info->factor = factor;
+      if (factor <= FAST_LIMIT)
+        {
+          // Veltkamp split, for the exact products of FromDoubleFast.
+          info->fastFactor = static_cast<double> (factor);
+          double split = 134217729.0 * info->fastFactor;
+          info->fastFactorHi = split - (split - info->fastFactor);
+          info->fastFactorLo = info->fastFactor - info->fastFactorHi;
+        }
+      else
+        {
+          info->fastFactor = 0;
+          info->fastFactorHi = 0;
+          info->fastFactorLo = 0;
+        }
       // here we could equivalently check for realFactor == 1.0 but it's better
       // to avoid checking equality of doubles
       if (shift == 0 && quotient == 1)
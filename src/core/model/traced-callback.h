@@ -21,7 +21,8 @@
 #ifndef TRACED_CALLBACK_H
 #define TRACED_CALLBACK_H
 
-#include <list>
+#include <string>
+#include <vector>
 #include "callback.h"
 
 /**
@@ -42,6 +43,15 @@ namespace ns3 {
  * of Callback.  Connect adds a Callback at the end of the chain
  * of callbacks.  Disconnect removes a Callback from the chain of callbacks.
  *
+ * The chain is held in a contiguous vector, so invoking a TracedCallback
+ * with no connected sinks costs a single comparison.  Sinks connected
+ * with a context are stored with their context path, and invoked with a
+ * single virtual call, rather than through a bound Callback.
+ *
+ * Sinks connected while the chain is invoked are invoked too.  A sink
+ * which disconnects itself while the chain is invoked may cause the
+ * next sink to be skipped in this invocation.
+ *
  * This is a functor: the chain of Callbacks is invoked by
  * calling one of the \c operator() forms with the appropriate
  * number of arguments.
@@ -93,6 +103,15 @@ public:
    * \param [in] path Context path which was used to connect the Callback.
    */
   void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * Check whether no Callback is connected.
+   *
+   * Firing the trace is already cheap when this is true, but callers
+   * can use it to skip computing expensive trace arguments.
+   *
+   * \returns \c true if the chain is empty.
+   */
+  bool IsEmpty (void) const;
   /**
    * \name Functors taking various numbers of arguments.
    *
@@ -222,21 +241,22 @@ public:
 
   
 private:
-  /**
-   * Container type for holding the chain of Callbacks.
-   *
-   * \tparam T1 \deduced Type of the first argument to the functor.
-   * \tparam T2 \deduced Type of the second argument to the functor.
-   * \tparam T3 \deduced Type of the third argument to the functor.
-   * \tparam T4 \deduced Type of the fourth argument to the functor.
-   * \tparam T5 \deduced Type of the fifth argument to the functor.
-   * \tparam T6 \deduced Type of the sixth argument to the functor.
-   * \tparam T7 \deduced Type of the seventh argument to the functor.
-   * \tparam T8 \deduced Type of the eighth argument to the functor.
-   */
-  typedef std::list<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
+  /** A connected Callback, with its context if it has one. */
+  struct Sink
+  {
+    /** The Callback connected without a context. */
+    Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> callback;
+    /** The Callback connected with a context. */
+    Callback<void,std::string,T1,T2,T3,T4,T5,T6,T7,T8> contextCallback;
+    /** The context path given to contextCallback. */
+    std::string path;
+    /** Whether contextCallback is used rather than callback. */
+    bool hasContext;
+  };
+  /** Container type for holding the chain of Callbacks. */
+  typedef std::vector<Sink> SinkList;
   /** The chain of Callbacks. */
-  CallbackList m_callbackList;
+  SinkList m_sinks;
 };
 
 } // namespace ns3
@@ -253,7 +273,7 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback ()
-  : m_callbackList () 
+  : m_sinks () 
 {
 }
 template<typename T1, typename T2,
@@ -263,10 +283,11 @@ template<typename T1, typename T2,
 void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::ConnectWithoutContext (const CallbackBase & callback)
 {
-  Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> cb;
-  if (!cb.Assign (callback))
+  Sink sink;
+  if (!sink.callback.Assign (callback))
     NS_FATAL_ERROR_NO_MSG();
-  m_callbackList.push_back (cb);
+  sink.hasContext = false;
+  m_sinks.push_back (sink);
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -275,11 +296,12 @@ template<typename T1, typename T2,
 void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Connect (const CallbackBase & callback, std::string path)
 {
-  Callback<void,std::string,T1,T2,T3,T4,T5,T6,T7,T8> cb;
-  if (!cb.Assign (callback))
+  Sink sink;
+  if (!sink.contextCallback.Assign (callback))
     NS_FATAL_ERROR ("when connecting to " << path);
-  Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
-  m_callbackList.push_back (realCb);
+  sink.path = path;
+  sink.hasContext = true;
+  m_sinks.push_back (sink);
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -288,12 +310,12 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectWithoutContext (const CallbackBase & callback)
 {
-  for (typename CallbackList::iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); /* empty */)
+  for (typename SinkList::iterator i = m_sinks.begin ();
+       i != m_sinks.end (); /* empty */)
     {
-      if ((*i).IsEqual (callback))
+      if (!i->hasContext && i->callback.IsEqual (callback))
         {
-          i = m_callbackList.erase (i);
+          i = m_sinks.erase (i);
         }
       else
         {
@@ -311,8 +333,27 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Disconnect (const CallbackBase & callba
   Callback<void,std::string,T1,T2,T3,T4,T5,T6,T7,T8> cb;
   if (!cb.Assign (callback))
     NS_FATAL_ERROR ("when disconnecting from " << path);
-  Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
-  DisconnectWithoutContext (realCb);
+  for (typename SinkList::iterator i = m_sinks.begin ();
+       i != m_sinks.end (); /* empty */)
+    {
+      if (i->hasContext && i->path == path && i->contextCallback.IsEqual (cb))
+        {
+          i = m_sinks.erase (i);
+        }
+      else
+        {
+          i++;
+        }
+    }
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+bool
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::IsEmpty (void) const
+{
+  return m_sinks.empty ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -321,10 +362,18 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index, rather than iterate, as a sink may connect another one.
+  for (std::size_t i = 0; i < m_sinks.size (); i++)
     {
-      (*i)();
+      const Sink &sink = m_sinks[i];
+      if (sink.hasContext)
+        {
+          sink.contextCallback (sink.path);
+        }
+      else
+        {
+          sink.callback ();
+        }
     }
 }
 template<typename T1, typename T2, 
@@ -334,10 +383,18 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index, rather than iterate, as a sink may connect another one.
+  for (std::size_t i = 0; i < m_sinks.size (); i++)
     {
-      (*i)(a1);
+      const Sink &sink = m_sinks[i];
+      if (sink.hasContext)
+        {
+          sink.contextCallback (sink.path, a1);
+        }
+      else
+        {
+          sink.callback (a1);
+        }
     }
 }
 template<typename T1, typename T2, 
@@ -347,10 +404,18 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index, rather than iterate, as a sink may connect another one.
+  for (std::size_t i = 0; i < m_sinks.size (); i++)
     {
-      (*i)(a1, a2);
+      const Sink &sink = m_sinks[i];
+      if (sink.hasContext)
+        {
+          sink.contextCallback (sink.path, a1, a2);
+        }
+      else
+        {
+          sink.callback (a1, a2);
+        }
     }
 }
 template<typename T1, typename T2, 
@@ -360,10 +425,18 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index, rather than iterate, as a sink may connect another one.
+  for (std::size_t i = 0; i < m_sinks.size (); i++)
     {
-      (*i)(a1, a2, a3);
+      const Sink &sink = m_sinks[i];
+      if (sink.hasContext)
+        {
+          sink.contextCallback (sink.path, a1, a2, a3);
+        }
+      else
+        {
+          sink.callback (a1, a2, a3);
+        }
     }
 }
 template<typename T1, typename T2, 
@@ -373,10 +446,18 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index, rather than iterate, as a sink may connect another one.
+  for (std::size_t i = 0; i < m_sinks.size (); i++)
     {
-      (*i)(a1, a2, a3, a4);
+      const Sink &sink = m_sinks[i];
+      if (sink.hasContext)
+        {
+          sink.contextCallback (sink.path, a1, a2, a3, a4);
+        }
+      else
+        {
+          sink.callback (a1, a2, a3, a4);
+        }
     }
 }
 template<typename T1, typename T2, 
@@ -386,10 +467,18 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index, rather than iterate, as a sink may connect another one.
+  for (std::size_t i = 0; i < m_sinks.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5);
+      const Sink &sink = m_sinks[i];
+      if (sink.hasContext)
+        {
+          sink.contextCallback (sink.path, a1, a2, a3, a4, a5);
+        }
+      else
+        {
+          sink.callback (a1, a2, a3, a4, a5);
+        }
     }
 }
 template<typename T1, typename T2, 
@@ -399,10 +488,18 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index, rather than iterate, as a sink may connect another one.
+  for (std::size_t i = 0; i < m_sinks.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5, a6);
+      const Sink &sink = m_sinks[i];
+      if (sink.hasContext)
+        {
+          sink.contextCallback (sink.path, a1, a2, a3, a4, a5, a6);
+        }
+      else
+        {
+          sink.callback (a1, a2, a3, a4, a5, a6);
+        }
     }
 }
 template<typename T1, typename T2, 
@@ -412,10 +509,18 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index, rather than iterate, as a sink may connect another one.
+  for (std::size_t i = 0; i < m_sinks.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7);
+      const Sink &sink = m_sinks[i];
+      if (sink.hasContext)
+        {
+          sink.contextCallback (sink.path, a1, a2, a3, a4, a5, a6, a7);
+        }
+      else
+        {
+          sink.callback (a1, a2, a3, a4, a5, a6, a7);
+        }
     }
 }
 template<typename T1, typename T2, 
@@ -425,10 +530,18 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index, rather than iterate, as a sink may connect another one.
+  for (std::size_t i = 0; i < m_sinks.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7, a8);
+      const Sink &sink = m_sinks[i];
+      if (sink.hasContext)
+        {
+          sink.contextCallback (sink.path, a1, a2, a3, a4, a5, a6, a7, a8);
+        }
+      else
+        {
+          sink.callback (a1, a2, a3, a4, a5, a6, a7, a8);
+        }
     }
 }
 
@@ -19,11 +19,14 @@
  */
 #include "log.h"  // NS_ASSERT and NS_LOG
 #include "hash.h"
+#include "hash-murmur3.h"
 #include "type-id.h"
 #include "singleton.h"
 #include "trace-source-accessor.h"
 
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <sstream>
 #include <iomanip>
@@ -271,6 +274,27 @@ public:
    */
   bool MustHideFromDocumentation (uint16_t uid) const;
 
+  /**
+   * Find an Attribute of a type id, or of its parents.
+   * \param [in] uid The id.
+   * \param [in] name The Attribute name.
+   * \param [out] owner The id of the type which registered the Attribute.
+   * \param [out] i The index of the Attribute in \p owner.
+   * \returns \c true if the Attribute was found.
+   */
+  bool LookupAttribute (uint16_t uid, const std::string &name,
+                        uint16_t *owner, std::size_t *i);
+  /**
+   * Find a TraceSource of a type id, or of its parents.
+   * \param [in] uid The id.
+   * \param [in] name The TraceSource name.
+   * \param [out] owner The id of the type which registered the TraceSource.
+   * \param [out] i The index of the TraceSource in \p owner.
+   * \returns \c true if the TraceSource was found.
+   */
+  bool LookupTraceSource (uint16_t uid, const std::string &name,
+                          uint16_t *owner, std::size_t *i);
+
 private:
   /**
    * Check if a type id has a given TraceSource.
@@ -292,6 +316,39 @@ private:
    * \returns The hashed value of \p name.
    */
   static TypeId::hash_t Hasher (const std::string name);
+  /**
+   * Hash a name for the indices.
+   *
+   * Unlike Hasher(), this function has no shared state, so it can be
+   * used by concurrent lookups.
+   * \param [in] name The name.
+   * \returns The Murmur3 hash of \p name.
+   */
+  static uint32_t HashName (const std::string &name);
+
+  /** A slot of an open addressing hash index. */
+  struct IndexSlot {
+    /** The hash of the name. */
+    uint32_t hash;
+    /** The type id, or 0 if the slot is empty. */
+    uint16_t uid;
+    /** The index of the Attribute or TraceSource in the type id. */
+    uint32_t index;
+  };
+  /** Type of an open addressing hash index, with linear probing. */
+  typedef std::vector<struct IndexSlot> index_t;
+  /**
+   * Insert a slot in a hash index.  The index must have an empty slot.
+   * \param [in,out] index The index.
+   * \param [in] slot The slot.
+   */
+  static void IndexInsert (index_t &index, const struct IndexSlot &slot);
+  /**
+   * Get the capacity of an index, as a power of two at most half full.
+   * \param [in] n The number of names to index.
+   * \returns The capacity.
+   */
+  static std::size_t IndexCapacity (std::size_t n);
 
   /** The information record about a single type id. */
   struct IidInformation {
@@ -319,6 +376,12 @@ private:
     TypeId::SupportLevel supportLevel;
     /** Support message. */
     std::string supportMsg;
+    /** The index of the Attributes, including those of the parents. */
+    index_t attributeIndex;
+    /** The index of the TraceSources, including those of the parents. */
+    index_t traceSourceIndex;
+    /** The member generation of the indices. */
+    uint32_t indexGeneration;
   };
   /** Iterator type. */
   typedef std::vector<struct IidInformation>::const_iterator Iterator;
@@ -329,14 +392,21 @@ private:
    * \returns The information record.
    */
   struct IidManager::IidInformation *LookupInformation (uint16_t uid) const;
+  /**
+   * Rebuild the Attribute and TraceSource indices of a type id, if
+   * Attributes, TraceSources or parents were added since they were built.
+   * \param [in] uid The id.
+   * \returns The type id record.
+   */
+  struct IidInformation * UpdateIndices (uint16_t uid);
 
   /** The container of all type id records. */
   std::vector<struct IidInformation> m_information;
 
-  /** Type of the by-name index. */
-  typedef std::map<std::string, uint16_t> namemap_t;
   /** The by-name index. */
-  namemap_t m_namemap;
+  index_t m_nameIndex;
+  /** The mutex protecting the Attribute and TraceSource indices. */
+  std::mutex m_indexMutex;
 
   /** Type of the by-hash index. */
   typedef std::map<TypeId::hash_t, uint16_t> hashmap_t;
@@ -378,12 +448,59 @@ IidManager::Hasher (const std::string name)
  */
 #define IIDL IID << ": "
 
+/**
+ * \ingroup object
+ * \internal
+ * The attribute generation, incremented whenever an attribute is added
+ * or its initial value is changed.  It is read by the partition threads
+ * without lock, see ObjectBase::ConstructSelf.
+ */
+static std::atomic<uint32_t> g_attributeGeneration (0);
+
+/**
+ * \ingroup object
+ * \internal
+ * The member generation, incremented whenever an attribute, a trace
+ * source or a parent is added to a type id.
+ */
+static uint32_t g_memberGeneration = 1;
+
+uint32_t
+IidManager::HashName (const std::string &name)
+{
+  Hash::Function::Murmur3 murmur;
+  return murmur.GetHash32 (name.c_str (), name.size ());
+}
+
+std::size_t
+IidManager::IndexCapacity (std::size_t n)
+{
+  std::size_t capacity = 8;
+  while (capacity < 2 * n)
+    {
+      capacity *= 2;
+    }
+  return capacity;
+}
+
+void
+IidManager::IndexInsert (index_t &index, const struct IndexSlot &slot)
+{
+  std::size_t mask = index.size () - 1;
+  std::size_t i = slot.hash & mask;
+  while (index[i].uid != 0)
+    {
+      i = (i + 1) & mask;
+    }
+  index[i] = slot;
+}
+
 uint16_t
 IidManager::AllocateUid (std::string name)
 {
   NS_LOG_FUNCTION (IID << name);
   // Type names are definitive: equal names are equal types
-  NS_ASSERT_MSG (m_namemap.count (name) == 0,
+  NS_ASSERT_MSG (GetUid (name) == 0,
                  "Trying to allocate twice the same uid: " << name);
   
   TypeId::hash_t hash = Hasher (name) & (~HashChainFlag);
@@ -439,13 +556,33 @@ IidManager::AllocateUid (std::string name)
   information.size = (std::size_t)(-1);
   information.hasConstructor = false;
   information.mustHideFromDocumentation = false;
+  information.indexGeneration = 0;
   m_information.push_back (information);
   std::size_t tuid = m_information.size();
   NS_ASSERT (tuid <= 0xffff);
   uint16_t uid = static_cast<uint16_t> (tuid);
 
-  // Add to both maps:
-  m_namemap.insert (std::make_pair (name, uid));
+  // Add to both indices:
+  if (m_nameIndex.size () < IndexCapacity (m_information.size ()))
+    {
+      m_nameIndex.assign (IndexCapacity (2 * m_information.size ()), IndexSlot ());
+      for (std::size_t i = 0; i < m_information.size (); ++i)
+        {
+          struct IndexSlot slot;
+          slot.hash = HashName (m_information[i].name);
+          slot.uid = static_cast<uint16_t> (i + 1);
+          slot.index = 0;
+          IndexInsert (m_nameIndex, slot);
+        }
+    }
+  else
+    {
+      struct IndexSlot slot;
+      slot.hash = HashName (name);
+      slot.uid = uid;
+      slot.index = 0;
+      IndexInsert (m_nameIndex, slot);
+    }
   m_hashmap.insert (std::make_pair (hash, uid));
   NS_LOG_LOGIC (IIDL << uid);
   return uid;
@@ -467,6 +604,7 @@ IidManager::SetParent (uint16_t uid, uint16_t parent)
   NS_ASSERT (parent <= m_information.size ());
   struct IidInformation *information = LookupInformation (uid);
   information->parent = parent;
+  g_memberGeneration++;
 }
 void 
 IidManager::SetGroupName (uint16_t uid, std::string groupName)
@@ -508,10 +646,19 @@ IidManager::GetUid (std::string name) const
 {
   NS_LOG_FUNCTION (IID << name);
   uint16_t uid = 0;
-  namemap_t::const_iterator it = m_namemap.find (name);
-  if (it != m_namemap.end ())
+  if (!m_nameIndex.empty ())
     {
-      uid = it->second;
+      uint32_t hash = HashName (name);
+      std::size_t mask = m_nameIndex.size () - 1;
+      for (std::size_t i = hash & mask; m_nameIndex[i].uid != 0; i = (i + 1) & mask)
+        {
+          if (m_nameIndex[i].hash == hash
+              && m_information[m_nameIndex[i].uid - 1].name == name)
+            {
+              uid = m_nameIndex[i].uid;
+              break;
+            }
+        }
     }
   NS_LOG_LOGIC (IIDL << uid);
   return uid;
@@ -676,6 +823,8 @@ IidManager::AddAttribute (uint16_t uid,
   info.supportLevel = supportLevel;
   info.supportMsg = supportMsg;
   information->attributes.push_back (info);
+  g_attributeGeneration++;
+  g_memberGeneration++;
   NS_LOG_LOGIC (IIDL << information->attributes.size () - 1);
 }
 void 
@@ -687,6 +836,7 @@ IidManager::SetAttributeInitialValue (uint16_t uid,
   struct IidInformation *information = LookupInformation (uid);
   NS_ASSERT (i < information->attributes.size ());
   information->attributes[i].initialValue = initialValue;
+  g_attributeGeneration++;
 }
 
 
@@ -767,8 +917,113 @@ IidManager::AddTraceSource (uint16_t uid,
   source.supportLevel = supportLevel;
   source.supportMsg = supportMsg;
   information->traceSources.push_back (source);
+  g_memberGeneration++;
   NS_LOG_LOGIC (IIDL << information->traceSources.size () - 1);
 }
+struct IidManager::IidInformation *
+IidManager::UpdateIndices (uint16_t uid)
+{
+  NS_LOG_FUNCTION (IID << uid);
+  struct IidInformation *information = LookupInformation (uid);
+  if (information->indexGeneration == g_memberGeneration)
+    {
+      return information;
+    }
+  // Walk up the inheritance tree once, to size the indices.
+  std::vector<uint16_t> uids;
+  std::size_t nAttributes = 0;
+  std::size_t nTraceSources = 0;
+  struct IidInformation *current = information;
+  while (true)
+    {
+      uids.push_back (uid);
+      nAttributes += current->attributes.size ();
+      nTraceSources += current->traceSources.size ();
+      if (current->parent == 0 || current->parent == uid)
+        {
+          // top of inheritance tree
+          break;
+        }
+      uid = current->parent;
+      current = LookupInformation (uid);
+    }
+  // Insert the members of the derived types first: the first match wins.
+  information->attributeIndex.assign (IndexCapacity (nAttributes), IndexSlot ());
+  information->traceSourceIndex.assign (IndexCapacity (nTraceSources), IndexSlot ());
+  for (std::vector<uint16_t>::const_iterator u = uids.begin (); u != uids.end (); ++u)
+    {
+      current = LookupInformation (*u);
+      for (std::size_t i = 0; i < current->attributes.size (); ++i)
+        {
+          struct IndexSlot slot;
+          slot.hash = HashName (current->attributes[i].name);
+          slot.uid = *u;
+          slot.index = static_cast<uint32_t> (i);
+          IndexInsert (information->attributeIndex, slot);
+        }
+      for (std::size_t i = 0; i < current->traceSources.size (); ++i)
+        {
+          struct IndexSlot slot;
+          slot.hash = HashName (current->traceSources[i].name);
+          slot.uid = *u;
+          slot.index = static_cast<uint32_t> (i);
+          IndexInsert (information->traceSourceIndex, slot);
+        }
+    }
+  information->indexGeneration = g_memberGeneration;
+  return information;
+}
+
+bool
+IidManager::LookupAttribute (uint16_t uid, const std::string &name,
+                             uint16_t *owner, std::size_t *i)
+{
+  NS_LOG_FUNCTION (IID << uid << name);
+  uint32_t hash = HashName (name);
+  std::lock_guard<std::mutex> lock (m_indexMutex);
+  struct IidInformation *information = UpdateIndices (uid);
+  const index_t &index = information->attributeIndex;
+  std::size_t mask = index.size () - 1;
+  for (std::size_t j = hash & mask; index[j].uid != 0; j = (j + 1) & mask)
+    {
+      if (index[j].hash == hash
+          && LookupInformation (index[j].uid)->attributes[index[j].index].name == name)
+        {
+          *owner = index[j].uid;
+          *i = index[j].index;
+          NS_LOG_LOGIC (IIDL << true);
+          return true;
+        }
+    }
+  NS_LOG_LOGIC (IIDL << false);
+  return false;
+}
+
+bool
+IidManager::LookupTraceSource (uint16_t uid, const std::string &name,
+                               uint16_t *owner, std::size_t *i)
+{
+  NS_LOG_FUNCTION (IID << uid << name);
+  uint32_t hash = HashName (name);
+  std::lock_guard<std::mutex> lock (m_indexMutex);
+  struct IidInformation *information = UpdateIndices (uid);
+  const index_t &index = information->traceSourceIndex;
+  std::size_t mask = index.size () - 1;
+  for (std::size_t j = hash & mask; index[j].uid != 0; j = (j + 1) & mask)
+    {
+      if (index[j].hash == hash
+          && LookupInformation (index[j].uid)->traceSources[index[j].index].name == name)
+        {
+          *owner = index[j].uid;
+          *i = index[j].index;
+          NS_LOG_LOGIC (IIDL << true);
+          return true;
+        }
+    }
+  NS_LOG_LOGIC (IIDL << false);
+  return false;
+}
+
 std::size_t
 IidManager::GetTraceSourceN (uint16_t uid) const
 {
@@ -872,43 +1127,37 @@ TypeId::GetRegistered (uint16_t i)
   NS_LOG_FUNCTION (i);
   return TypeId (IidManager::Get ()->GetRegistered (i));
 }
+uint32_t
+TypeId::GetAttributeGeneration (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return g_attributeGeneration.load ();
+}
 
 bool
 TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
 {
   NS_LOG_FUNCTION (this << name << info);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (std::size_t i = 0; i < tid.GetAttributeN (); i++)
-        {
-          struct TypeId::AttributeInformation tmp = tid.GetAttribute (i);
-          if (tmp.name == name)
-            {
-              if (tmp.supportLevel == TypeId::SUPPORTED)
-                {
-                  *info = tmp;
-                  return true;
-                }
-              else if (tmp.supportLevel == TypeId::DEPRECATED)
-                {
-                  std::cerr << "Attribute '" << name << "' is deprecated: "
-                                 << tmp.supportMsg << std::endl;
-                  *info = tmp;
-                  return true;
-                }
-              else if (tmp.supportLevel == TypeId::OBSOLETE)
-                {
-                  NS_FATAL_ERROR ("Attribute '" << name
-                                  << "' is obsolete, with no fallback: "
-                                  << tmp.supportMsg);
-                }
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return false;
+  uint16_t owner;
+  std::size_t i;
+  if (!IidManager::Get ()->LookupAttribute (m_tid, name, &owner, &i))
+    {
+      return false;
+    }
+  struct TypeId::AttributeInformation tmp = IidManager::Get ()->GetAttribute (owner, i);
+  if (tmp.supportLevel == TypeId::DEPRECATED)
+    {
+      std::cerr << "Attribute '" << name << "' is deprecated: "
+                << tmp.supportMsg << std::endl;
+    }
+  else if (tmp.supportLevel == TypeId::OBSOLETE)
+    {
+      NS_FATAL_ERROR ("Attribute '" << name
+                      << "' is obsolete, with no fallback: "
+                      << tmp.supportMsg);
+    }
+  *info = tmp;
+  return true;
 }
 
 TypeId 
@@ -1137,39 +1386,26 @@ TypeId::LookupTraceSourceByName (std::string name,
                                  struct TraceSourceInformation *info) const
 {
   NS_LOG_FUNCTION (this << name);
-  TypeId tid;
-  TypeId nextTid = *this;
-  struct TypeId::TraceSourceInformation tmp;
-  do {
-      tid = nextTid;
-      for (std::size_t i = 0; i < tid.GetTraceSourceN(); i++)
-        {
-          tmp = tid.GetTraceSource (i);
-          if (tmp.name == name)
-            {
-              if (tmp.supportLevel == TypeId::SUPPORTED)
-                {
-                  *info = tmp;
-                   return tmp.accessor;
-                }
-              else if (tmp.supportLevel == TypeId::DEPRECATED)
-                {
-                  std::cerr << "TraceSource '" << name << "' is deprecated: "
-                                 << tmp.supportMsg << std::endl;
-                  *info = tmp;
-                  return tmp.accessor;
-                }
-              else  if (tmp.supportLevel == TypeId::OBSOLETE)
-                {
-                  NS_FATAL_ERROR ("TraceSource '" << name
-                                  << "' is obsolete, with no fallback: "
-                                  << tmp.supportMsg);
-                }
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return 0;
+  uint16_t owner;
+  std::size_t i;
+  if (!IidManager::Get ()->LookupTraceSource (m_tid, name, &owner, &i))
+    {
+      return 0;
+    }
+  struct TypeId::TraceSourceInformation tmp = IidManager::Get ()->GetTraceSource (owner, i);
+  if (tmp.supportLevel == TypeId::DEPRECATED)
+    {
+      std::cerr << "TraceSource '" << name << "' is deprecated: "
+                << tmp.supportMsg << std::endl;
+    }
+  else if (tmp.supportLevel == TypeId::OBSOLETE)
+    {
+      NS_FATAL_ERROR ("TraceSource '" << name
+                      << "' is obsolete, with no fallback: "
+                      << tmp.supportMsg);
+    }
+  *info = tmp;
+  return tmp.accessor;
 }
 
 Ptr<const TraceSourceAccessor> 
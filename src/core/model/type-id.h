@@ -164,6 +164,16 @@ public:
    * \returns The TypeId instance whose index is \c i.
    */
   static TypeId GetRegistered (uint16_t i);
+  /**
+   * Get the generation of the attributes of all the TypeIds.
+   *
+   * The generation changes whenever an attribute is added to a
+   * TypeId, or the initial value of an attribute is changed,
+   * so that the data derived from the attributes can be refreshed.
+   *
+   * \returns The attribute generation.
+   */
+  static uint32_t GetAttributeGeneration (void);
 
   /**
    * Constructor.
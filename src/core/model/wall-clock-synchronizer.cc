@@ -22,6 +22,7 @@
                        // clock_getres: glibc < 2.17, link with librt
 
 #include "log.h"
+#include "enum.h"
 #include "system-condition.h"
 
 #include "wall-clock-synchronizer.h"
@@ -44,6 +45,20 @@ WallClockSynchronizer::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::WallClockSynchronizer")
     .SetParent<Synchronizer> ()
     .SetGroupName ("Core")
+    .AddAttribute ("WaitMode",
+                   "How to wait for the next event: Sleep, Hybrid (sleep, "
+                   "then busy-wait the last SpinThreshold) or Spin (always "
+                   "busy-wait, for the lowest jitter).",
+                   EnumValue (WAIT_SLEEP),
+                   MakeEnumAccessor (&WallClockSynchronizer::m_waitMode),
+                   MakeEnumChecker (WAIT_SLEEP, "Sleep",
+                                    WAIT_HYBRID, "Hybrid",
+                                    WAIT_SPIN, "Spin"))
+    .AddAttribute ("SpinThreshold",
+                   "The last part of a wait which is busy-waited in Hybrid mode.",
+                   TimeValue (MicroSeconds (100)),
+                   MakeTimeAccessor (&WallClockSynchronizer::m_spinThreshold),
+                   MakeTimeChecker (Time (0)))
   ;
   return tid;
 }
@@ -205,6 +220,32 @@ WallClockSynchronizer::DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay)
   uint64_t numberJiffies = ns / m_jiffy;
   NS_LOG_INFO ("Synchronize numberJiffies = " << numberJiffies);
 //
+// In the Hybrid and Spin wait modes, the split is not made on jiffies, but
+// on the time it takes to be woken up: we sleep until we are within the
+// spin threshold of the deadline, or not at all.
+//
+  uint64_t nsSleep = 0;
+  switch (m_waitMode)
+    {
+    case WAIT_SPIN:
+      break;
+    case WAIT_HYBRID:
+      {
+        uint64_t threshold = m_spinThreshold.GetNanoSeconds ();
+        if (ns > threshold)
+          {
+            nsSleep = ns - threshold;
+          }
+      }
+      break;
+    default:
+      if (numberJiffies > 3)
+        {
+          nsSleep = (numberJiffies - 3) * m_jiffy;
+        }
+      break;
+    }
+//
 // This is where the real world interjects its very ugly head.  The code 
 // immediately below reflects the fact that a sleep is actually quite probably
 // going to end up sleeping for some number of jiffies longer than you wanted.
@@ -225,18 +266,17 @@ WallClockSynchronizer::DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay)
 //
 // \todo Hardcoded tunable parameter below.
 //
-  if (numberJiffies > 3)
+  if (nsSleep > 0)
     {
-      NS_LOG_INFO ("SleepWait for " << numberJiffies * m_jiffy << " ns");
-      NS_LOG_INFO ("SleepWait until " << nsCurrent + numberJiffies * m_jiffy 
-                                      << " ns");
+      NS_LOG_INFO ("SleepWait for " << nsSleep << " ns");
+      NS_LOG_INFO ("SleepWait until " << nsCurrent + nsSleep << " ns");
 //
 // SleepWait is interruptible.  If it returns true it meant that the sleep
 // went until the end.  If it returns false, it means that the sleep was 
 // interrupted by a Signal.  In this case, we need to return and let the 
 // simulator re-evaluate what to do.
 //
-      if (SleepWait ((numberJiffies - 3) * m_jiffy) == false)
+      if (SleepWait (nsSleep) == false)
         {
           NS_LOG_INFO ("SleepWait interrupted");
           return false;
@@ -287,7 +327,14 @@ WallClockSynchronizer::DoSignal (void)
   NS_LOG_FUNCTION (this);
 
   m_condition.SetCondition (true);
-  m_condition.Signal ();
+  //
+  // In Spin mode, nobody waits on the condition variable: setting the
+  // condition is enough, and keeps the signalling threads off its mutex.
+  //
+  if (m_waitMode != WAIT_SPIN)
+    {
+      m_condition.Signal ();
+    }
 }
 
 void
@@ -21,6 +21,7 @@
 
 #include "system-condition.h"
 #include "synchronizer.h"
+#include "nstime.h"
 
 /**
  * @file
@@ -60,6 +61,17 @@ namespace ns3 {
  * to use the function @c clock_nanosleep() to sleep until a simulation Time
  * specified by the caller. 
  *
+ * The way the synchronizer waits for the next event is selected with the
+ * WaitMode attribute:
+ *  - in @c Sleep mode, the default, the process sleeps for all but the last
+ *    few jiffies of the delay, and busy-waits for the rest;
+ *  - in @c Hybrid mode, the process sleeps until it is within SpinThreshold
+ *    of the deadline, and busy-waits for the rest, which absorbs the wake-up
+ *    latency of the condition variable;
+ *  - in @c Spin mode, the process never sleeps, and is never woken up
+ *    through the condition variable: this gives the lowest jitter, at the
+ *    cost of a full CPU core.
+ *
  * @todo Add more on jiffies, sleep, processes, etc.
  *
  * @internal
@@ -81,6 +93,14 @@ public:
   /** Destructor. */
   virtual ~WallClockSynchronizer ();
 
+  /** How to wait for the next event. */
+  enum WaitMode
+  {
+    WAIT_SLEEP,   /**< Sleep, and busy-wait the last few jiffies. */
+    WAIT_HYBRID,  /**< Sleep, and busy-wait the last SpinThreshold. */
+    WAIT_SPIN     /**< Always busy-wait. */
+  };
+
   /** Conversion constant between &mu;s and ns. */
   static const uint64_t US_PER_NS = (uint64_t)1000;
   /** Conversion constant between &mu;s and seconds. */
@@ -193,6 +213,10 @@ protected:
   uint64_t m_jiffy;
   /** Time recorded by DoEventStart. */
   uint64_t m_nsEventStart;
+  /** How to wait for the next event. */
+  WaitMode m_waitMode;
+  /** The last part of a wait which is busy-waited in WAIT_HYBRID mode. */
+  Time m_spinThreshold;
 
   /** Thread synchronizer. */
   SystemCondition m_condition;
@@ -1410,6 +1410,72 @@ CallbackValueTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_gotCbValue, 2, "Callback Attribute set to null callback unexpectedly fired");
 }
 
+// ===========================================================================
+// Test the initial values of the Attributes of new objects.
+// ===========================================================================
+class InitialValueAttributeTestCase : public TestCase
+{
+public:
+  InitialValueAttributeTestCase (std::string description);
+  virtual ~InitialValueAttributeTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+InitialValueAttributeTestCase::InitialValueAttributeTestCase (std::string description)
+  : TestCase (description)
+{
+}
+
+void
+InitialValueAttributeTestCase::DoRun (void)
+{
+  IntegerValue iv;
+  PointerValue pv1;
+  PointerValue pv2;
+  TimeValue tv;
+
+  Ptr<AttributeObjectTest> p1 = CreateObject<AttributeObjectTest> ();
+  p1->GetAttribute ("TestInt16", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -2, "Bad initial value");
+
+  //
+  // A new default value applies to the objects created afterwards.
+  //
+  Config::SetDefault ("ns3::AttributeObjectTest::TestInt16", IntegerValue (5));
+  Ptr<AttributeObjectTest> p2 = CreateObject<AttributeObjectTest> ();
+  p2->GetAttribute ("TestInt16", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 5, "New default value not applied");
+  p1->GetAttribute ("TestInt16", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -2, "Existing object changed by the new default value");
+
+  //
+  // Objects created from a string are not shared between the instances.
+  //
+  p1->GetAttribute ("PointerInitialized", pv1);
+  p2->GetAttribute ("PointerInitialized", pv2);
+  NS_TEST_ASSERT_MSG_NE (pv1.GetObject (), 0, "Pointer not initialized");
+  NS_TEST_ASSERT_MSG_NE (pv1.GetObject (), pv2.GetObject (), "Object shared between instances");
+
+  //
+  // The values of the construction list take precedence.
+  //
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::AttributeObjectTest");
+  factory.Set ("TestInt16", IntegerValue (7));
+  Ptr<AttributeObjectTest> p3 = factory.Create<AttributeObjectTest> ();
+  p3->GetAttribute ("TestInt16", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 7, "Construction list value not applied");
+  p3->GetAttribute ("TestTimeWithBounds", tv);
+  NS_TEST_ASSERT_MSG_EQ (tv.Get (), Seconds (-2), "Bad initial value with a construction list");
+
+  Config::SetDefault ("ns3::AttributeObjectTest::TestInt16", IntegerValue (-2));
+  p3 = CreateObject<AttributeObjectTest> ();
+  p3->GetAttribute ("TestInt16", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -2, "Default value not restored");
+}
+
 // ===========================================================================
 // The Test Suite that glues all of the Test Cases together.
 // ===========================================================================
@@ -1433,6 +1499,7 @@ AttributesTestSuite::AttributesTestSuite ()
   AddTestCase (new ObjectMapAttributeTestCase ("Check Attributes of type ObjectMapValue"), TestCase::QUICK);
   AddTestCase (new PointerAttributeTestCase ("Check Attributes of type PointerValue"), TestCase::QUICK);
   AddTestCase (new CallbackValueTestCase ("Check Attributes of type CallbackValue"), TestCase::QUICK);
+  AddTestCase (new InitialValueAttributeTestCase ("Check the initial values of the Attributes of new objects"), TestCase::QUICK);
   AddTestCase (new IntegerTraceSourceAttributeTestCase ("Ensure TracedValue<uint8_t> can be set like IntegerValue"), TestCase::QUICK);
   AddTestCase (new IntegerTraceSourceTestCase ("Ensure TracedValue<uint8_t> also works as trace source"), TestCase::QUICK);
   AddTestCase (new TracedCallbackTestCase ("Ensure TracedCallback<double, int, float> works as trace source"), TestCase::QUICK);
@@ -100,6 +100,9 @@ public:
   int8_t GetB (void) const;
 
 private:
+  /** Release the children, as NodeList does. */
+  virtual void DoDispose (void);
+
   std::vector<Ptr<ConfigTestObject> > m_nodesA; //!< NodesA attribute target.
   std::vector<Ptr<ConfigTestObject> > m_nodesB; //!< NodesB attribute target.
   Ptr<ConfigTestObject> m_nodeA;  //!< NodeA attribute target.
@@ -173,6 +176,16 @@ ConfigTestObject::AddNodeB (Ptr<ConfigTestObject> b)
   m_nodesB.push_back (b);
 }
 
+void
+ConfigTestObject::DoDispose (void)
+{
+  m_nodesA.clear ();
+  m_nodesB.clear ();
+  m_nodeA = 0;
+  m_nodeB = 0;
+  Object::DoDispose ();
+}
+
 int8_t 
 ConfigTestObject::GetA (void) const
 {
@@ -830,6 +843,120 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test the compiled paths, and the invalidation of their cached matches.
+ */
+class CompiledPathConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  CompiledPathConfigTestCase ();
+  /** Destructor. */
+  virtual ~CompiledPathConfigTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Trace callback without context.
+   * \param oldValue The old value.
+   * \param newValue The new value.
+   */
+  void Trace (int16_t oldValue, int16_t newValue)
+  {
+    NS_UNUSED (oldValue);
+    m_got = newValue;
+  }
+
+  int16_t m_got;  //!< Value from the trace.
+};
+
+CompiledPathConfigTestCase::CompiledPathConfigTestCase ()
+  : TestCase ("Check that compiled paths match like Config and refresh their cached matches")
+{
+}
+
+void
+CompiledPathConfigTestCase::DoRun (void)
+{
+  IntegerValue iv;
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Names::Add ("compiledPathRoot", root);
+  Ptr<ConfigTestObject> nodes[4];
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      nodes[i] = CreateObject<ConfigTestObject> ();
+      root->AddNodeA (nodes[i]);
+    }
+
+  //
+  // Wildcards, ranges and lists select the same objects as the
+  // string API.
+  //
+  Config::Path all ("/Names/compiledPathRoot/NodesA/*/A");
+  all.Set (IntegerValue (-3));
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      nodes[i]->GetAttribute ("A", iv);
+      NS_TEST_ASSERT_MSG_EQ (iv.Get (), -3, "Object Attribute \"A\" not set on node " << i);
+    }
+  Config::Path some ("/Names/compiledPathRoot/NodesA/0|2");
+  Config::MatchContainer matches = some.LookupMatches ();
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 2, "Bad number of matches");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (0), nodes[0], "Bad first match");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (1), nodes[2], "Bad second match");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (1), "/Names/compiledPathRoot/NodesA/2/",
+                         "Bad matched path");
+  matches = Config::LookupMatches ("/Names/compiledPathRoot/NodesA/[1-2]");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 2, "Bad number of range matches");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (0), nodes[1], "Bad first range match");
+
+  //
+  // Containers that are not tracked are refreshed by an explicit
+  // invalidation.
+  //
+  nodes[3] = CreateObject<ConfigTestObject> ();
+  root->AddNodeA (nodes[3]);
+  Config::InvalidatePathCache ();
+  all.Set (IntegerValue (-4));
+  nodes[3]->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -4, "Cached matches not refreshed");
+
+  //
+  // Disposing objects invalidates the cached matches.
+  //
+  Ptr<ConfigTestObject> other = CreateObject<ConfigTestObject> ();
+  other->AddNodeA (CreateObject<ConfigTestObject> ());
+  Names::Add ("compiledPathOther", other);
+  Config::Path children ("/Names/compiledPathOther/NodesA/*");
+  NS_TEST_ASSERT_MSG_EQ (children.LookupMatches ().GetN (), 1, "Bad number of matches");
+  other->Dispose ();
+  NS_TEST_ASSERT_MSG_EQ (children.LookupMatches ().GetN (), 0, "Disposed objects still matched");
+
+  //
+  // Aggregation and trace sources.
+  //
+  Config::Path derived ("/Names/compiledPathRoot/NodesA/1/$DerivedConfigObject/X");
+  NS_TEST_ASSERT_MSG_EQ (derived.LookupMatches ().GetN (), 0, "Unexpected match");
+  Ptr<DerivedConfigObject> object = CreateObject<DerivedConfigObject> ();
+  nodes[1]->AggregateObject (object);
+  derived.Set (IntegerValue (42));
+  object->GetAttribute ("X", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 42, "Aggregated object not matched");
+
+  Config::Path source ("/Names/compiledPathRoot/NodesA/2/Source");
+  m_got = 0;
+  source.ConnectWithoutContext (MakeCallback (&CompiledPathConfigTestCase::Trace, this));
+  nodes[2]->SetAttribute ("Source", IntegerValue (5));
+  NS_TEST_ASSERT_MSG_EQ (m_got, 5, "Trace source not connected");
+  source.DisconnectWithoutContext (MakeCallback (&CompiledPathConfigTestCase::Trace, this));
+  nodes[2]->SetAttribute ("Source", IntegerValue (6));
+  NS_TEST_ASSERT_MSG_EQ (m_got, 5, "Trace source not disconnected");
+
+  Names::Clear ();
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -848,6 +975,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new CompiledPathConfigTestCase);
 }
 
 /**
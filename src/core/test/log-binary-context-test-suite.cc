@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+/**
+ * A file-local context defined after the includes, as most models do,
+ * to check that the binary log captures it.
+ */
+#undef NS_LOG_APPEND_CONTEXT
+#define NS_LOG_APPEND_CONTEXT                                   \
+  if (m_context != 0)                                           \
+    {                                                           \
+      std::clog << "[late " << m_context << "] ";               \
+    }
+
+/**
+ * \file
+ * \ingroup logging-tests
+ * Binary log context test suite.
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+NS_LOG_COMPONENT_DEFINE ("LogBinaryContextTest");
+
+
+/**
+ * \ingroup logging-tests
+ * Check that the binary log records NS_LOG_APPEND_CONTEXT when it is
+ * defined after including the logging headers.
+ */
+class LogBinaryLateContextTestCase : public TestCase
+{
+public:
+  LogBinaryLateContextTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /** Log messages with and without context. */
+  void LogMessages (void);
+
+  int m_context;  //!< The context appended to the messages, 0 for none.
+};
+
+LogBinaryLateContextTestCase::LogBinaryLateContextTestCase ()
+  : TestCase ("Record the context defined after the includes"),
+    m_context (0)
+{
+}
+
+void
+LogBinaryLateContextTestCase::LogMessages (void)
+{
+  m_context = 0;
+  NS_LOG_DEBUG ("without context");
+  m_context = 5;
+  NS_LOG_DEBUG ("with context " << 1);
+  NS_LOG_FUNCTION (this);
+  m_context = 0;
+}
+
+void
+LogBinaryLateContextTestCase::DoRun (void)
+{
+  LogComponentEnable ("LogBinaryContextTest", LOG_LEVEL_ALL);
+
+  std::ostringstream text;
+  std::streambuf *previous = std::clog.rdbuf (text.rdbuf ());
+  LogMessages ();
+  std::clog.rdbuf (previous);
+
+  std::string filename = CreateTempDirFilename ("log-binary-context.blog");
+  LogBinaryEnable (filename, 4096);
+  LogMessages ();
+  LogBinaryDisable ();
+  LogComponentDisable ("LogBinaryContextTest", LOG_LEVEL_ALL);
+
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  std::ostringstream decoded;
+  NS_TEST_ASSERT_MSG_EQ (LogBinaryDecode (is, decoded), true, "Invalid binary log");
+  is.close ();
+  std::remove (filename.c_str ());
+
+#ifdef NS3_LOG_ENABLE
+  NS_TEST_ASSERT_MSG_NE (text.str ().find ("[late 5] "), std::string::npos,
+                         "No context in the text log\n" << text.str ());
+#endif
+  NS_TEST_EXPECT_MSG_EQ (decoded.str (), text.str (), "Decoded binary log differs from the text log");
+}
+
+
+/**
+ * \ingroup logging-tests
+ * Binary log context test suite.
+ */
+class LogBinaryContextTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  LogBinaryContextTestSuite ()
+    : TestSuite ("log-binary-context")
+  {
+    AddTestCase (new LogBinaryLateContextTestCase (), TestCase::QUICK);
+  }
+};
+
+/** The test suite instance. */
+static LogBinaryContextTestSuite g_logBinaryContextTestSuite;
+
+}  // namespace tests
+
+}  // namespace ns3
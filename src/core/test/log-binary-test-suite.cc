@@ -0,0 +1,309 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** A file-local context, to check that the binary log captures it. */
+#define NS_LOG_APPEND_CONTEXT                                   \
+  if (g_logBinaryTestContext != 0)                              \
+    {                                                           \
+      std::clog << "[ctx " << g_logBinaryTestContext << "] ";   \
+    }
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/vector.h"
+#include "ns3/test.h"
+#include "ns3/core-config.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#ifdef HAVE_PTHREAD_H
+#include <thread>
+#endif
+
+/**
+ * \file
+ * \ingroup logging-tests
+ * Binary log test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup logging-tests Logging tests
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+NS_LOG_COMPONENT_DEFINE ("LogBinaryTest");
+
+/** The context appended to the messages, 0 for none. */
+static int g_logBinaryTestContext = 0;
+
+
+/**
+ * \ingroup logging-tests
+ * Check that the decoded binary log is the text log.
+ */
+class LogBinaryDecodeTestCase : public TestCase
+{
+public:
+  LogBinaryDecodeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /** Log all the kinds of messages. */
+  void LogMessages (void);
+  /**
+   * Log from an event.
+   * \param [in] value A value to log.
+   */
+  void LogEvent (uint32_t value);
+  /**
+   * Run a simulation which logs.
+   * \returns The log messages, as printed on std::clog.
+   */
+  std::string RunText (void);
+  /**
+   * Run a simulation which logs in a binary log.
+   * \param [in] filename The binary log file name.
+   * \returns The decoded log messages.
+   */
+  std::string RunBinary (std::string filename);
+  /** Run a simulation which logs. */
+  void Run (void);
+
+  Ptr<Object> m_object;  //!< An object to log.
+};
+
+LogBinaryDecodeTestCase::LogBinaryDecodeTestCase ()
+  : TestCase ("Decode a binary log as the text log")
+{
+}
+
+void
+LogBinaryDecodeTestCase::LogMessages (void)
+{
+  NS_LOG_FUNCTION (this << 42 << "literal" << std::string ("string")
+                        << static_cast<int8_t> (-3) << static_cast<uint8_t> (200)
+                        << 2.5 << Seconds (1.5) << m_object << 'c');
+  NS_LOG_FUNCTION_NOARGS ();
+  std::vector<uint16_t> vector;
+  vector.push_back (1);
+  vector.push_back (2);
+  NS_LOG_FUNCTION (vector);
+  NS_LOG_DEBUG ("int " << 1 << " unsigned " << 2u << " long " << -5L
+                << " char " << 'x' << " bool " << true << " double " << 0.1
+                << " float " << 1.5f << " pointer " << static_cast<void *> (this)
+                << " null " << static_cast<void *> (0) << " time " << MilliSeconds (3));
+  NS_LOG_INFO ("formatted " << std::hex << 255 << " " << 16 << std::dec
+               << " " << std::setprecision (3) << 3.14159 << std::setprecision (6)
+               << " then " << 17);
+  NS_LOG_WARN ("vector " << Vector (1, 2, 3) << " done");
+  char buffer[16];
+  for (int i = 0; i < 3; i++)
+    {
+      std::snprintf (buffer, sizeof (buffer), "value %d", i);
+      NS_LOG_LOGIC (buffer);
+    }
+  g_logBinaryTestContext = 7;
+  NS_LOG_ERROR ("with context");
+  NS_LOG_FUNCTION (this);
+  g_logBinaryTestContext = 0;
+  NS_LOG_DEBUG ("large " << std::string (10000, 'a'));
+}
+
+void
+LogBinaryDecodeTestCase::LogEvent (uint32_t value)
+{
+  NS_LOG_FUNCTION (this << value);
+  NS_LOG_DEBUG ("event " << value << " at " << Simulator::Now ());
+}
+
+void
+LogBinaryDecodeTestCase::Run (void)
+{
+  Simulator::Now ();
+  LogMessages ();
+  Simulator::Schedule (Seconds (1.25), &LogBinaryDecodeTestCase::LogEvent, this, 1);
+  Simulator::ScheduleWithContext (3, MicroSeconds (2500001),
+                                  &LogBinaryDecodeTestCase::LogEvent, this, 2);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+std::string
+LogBinaryDecodeTestCase::RunText (void)
+{
+  std::ostringstream text;
+  std::streambuf *previous = std::clog.rdbuf (text.rdbuf ());
+  Run ();
+  std::clog.rdbuf (previous);
+  return text.str ();
+}
+
+std::string
+LogBinaryDecodeTestCase::RunBinary (std::string filename)
+{
+  LogBinaryEnable (filename, 4096);
+  NS_TEST_EXPECT_MSG_EQ (LogBinaryIsEnabled (), true, "Binary log not enabled");
+  std::ostringstream text;
+  std::streambuf *previous = std::clog.rdbuf (text.rdbuf ());
+  Run ();
+  std::clog.rdbuf (previous);
+  LogBinaryDisable ();
+  NS_TEST_EXPECT_MSG_EQ (text.str (), "", "Binary log written on std::clog");
+
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  std::ostringstream decoded;
+  NS_TEST_EXPECT_MSG_EQ (LogBinaryDecode (is, decoded), true, "Invalid binary log");
+  return decoded.str ();
+}
+
+void
+LogBinaryDecodeTestCase::DoRun (void)
+{
+  m_object = CreateObject<Object> ();
+  LogComponentEnable ("LogBinaryTest", static_cast<LogLevel> (LOG_LEVEL_ALL | LOG_PREFIX_ALL));
+
+  std::string expected = RunText ();
+  std::string filename = CreateTempDirFilename ("log-binary.blog");
+  std::string decoded = RunBinary (filename);
+  // Run again, so that the statements are registered with a previous
+  // file and the literals are cached.
+  std::string again = RunBinary (filename);
+
+  LogComponentDisable ("LogBinaryTest", static_cast<LogLevel> (LOG_LEVEL_ALL | LOG_PREFIX_ALL));
+  m_object = 0;
+  std::remove (filename.c_str ());
+
+#ifdef NS3_LOG_ENABLE
+  NS_TEST_ASSERT_MSG_NE (expected, "", "No log messages");
+#endif
+  NS_TEST_EXPECT_MSG_EQ (decoded, expected, "Decoded binary log differs from the text log");
+  NS_TEST_EXPECT_MSG_EQ (again, expected, "Decoded binary log differs from the text log");
+}
+
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * \ingroup logging-tests
+ * Check that the messages of concurrent threads are all recorded,
+ * in order within each thread.
+ */
+class LogBinaryThreadsTestCase : public TestCase
+{
+public:
+  LogBinaryThreadsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Log messages.
+   * \param [in] thread The thread index.
+   */
+  static void LogMessages (uint32_t thread);
+};
+
+LogBinaryThreadsTestCase::LogBinaryThreadsTestCase ()
+  : TestCase ("Record the messages of concurrent threads")
+{
+}
+
+void
+LogBinaryThreadsTestCase::LogMessages (uint32_t thread)
+{
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      NS_LOG_DEBUG ("thread " << thread << " message " << i);
+    }
+}
+
+void
+LogBinaryThreadsTestCase::DoRun (void)
+{
+  const uint32_t threads = 4;
+  LogComponentEnable ("LogBinaryTest", LOG_DEBUG);
+  std::string filename = CreateTempDirFilename ("log-binary-threads.blog");
+  LogBinaryEnable (filename, 4096);
+  std::vector<std::thread> workers;
+  for (uint32_t i = 0; i < threads; i++)
+    {
+      workers.push_back (std::thread (&LogBinaryThreadsTestCase::LogMessages, i));
+    }
+  for (uint32_t i = 0; i < threads; i++)
+    {
+      workers[i].join ();
+    }
+  LogBinaryDisable ();
+  LogComponentDisable ("LogBinaryTest", LOG_LEVEL_ALL);
+
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  std::stringstream decoded;
+  NS_TEST_ASSERT_MSG_EQ (LogBinaryDecode (is, decoded), true, "Invalid binary log");
+  is.close ();
+  std::remove (filename.c_str ());
+
+#ifdef NS3_LOG_ENABLE
+  std::vector<uint32_t> next (threads, 0);
+  std::string word;
+  uint32_t thread;
+  uint32_t message;
+  while (decoded >> word >> thread >> word >> message)
+    {
+      NS_TEST_ASSERT_MSG_LT (thread, threads, "Bad thread");
+      NS_TEST_EXPECT_MSG_EQ (message, next[thread], "Message out of order in thread " << thread);
+      next[thread] = message + 1;
+    }
+  for (uint32_t i = 0; i < threads; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (next[i], 2000, "Missing messages of thread " << i);
+    }
+#endif
+}
+#endif /* HAVE_PTHREAD_H */
+
+
+/**
+ * \ingroup logging-tests
+ * Binary log test suite.
+ */
+class LogBinaryTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  LogBinaryTestSuite ()
+    : TestSuite ("log-binary")
+  {
+    AddTestCase (new LogBinaryDecodeTestCase (), TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+    AddTestCase (new LogBinaryThreadsTestCase (), TestCase::QUICK);
+#endif
+  }
+};
+
+/** The test suite instance. */
+static LogBinaryTestSuite g_logBinaryTestSuite;
+
+}  // namespace tests
+
+}  // namespace ns3
@@ -18,8 +18,12 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <thread>
+#include <vector>
+
 #include "ns3/test.h"
 #include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
 
 /**
  * \file
@@ -325,6 +329,112 @@ PtrTestCase::DoRun (void)
   }
 }
 
+/**
+ * \ingroup ptr-tests
+ * Object counted with a reference count policy, which counts its
+ * deletions.
+ *
+ * \tparam POLICY \explicit The reference count policy.
+ */
+template <typename POLICY>
+class PolicyCounted
+  : public SimpleRefCount<PolicyCounted<POLICY>, empty, DefaultDeleter<PolicyCounted<POLICY> >, POLICY>
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] deleted The deletion counter.
+   */
+  PolicyCounted (uint32_t *deleted)
+    : m_deleted (deleted)
+  {
+  }
+  /** Destructor. */
+  ~PolicyCounted ()
+  {
+    (*m_deleted)++;
+  }
+private:
+  uint32_t *m_deleted;  //!< The deletion counter.
+};
+
+/**
+ * \ingroup ptr-tests
+ * Test the reference count policies of SimpleRefCount.
+ *
+ * \tparam POLICY \explicit The reference count policy.
+ */
+template <typename POLICY>
+class RefCountPolicyTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] name The policy name.
+   * \param [in] threads The number of threads sharing a Ptr.
+   */
+  RefCountPolicyTestCase (std::string name, uint32_t threads);
+private:
+  virtual void DoRun (void);
+  /**
+   * Copy and release a Ptr many times.
+   * \param [in] p The Ptr.
+   */
+  static void Copy (Ptr<PolicyCounted<POLICY> > p);
+  uint32_t m_threads;   //!< The number of threads sharing a Ptr.
+};
+
+template <typename POLICY>
+RefCountPolicyTestCase<POLICY>::RefCountPolicyTestCase (std::string name, uint32_t threads)
+  : TestCase ("Check the " + name + " reference count policy"),
+    m_threads (threads)
+{
+}
+
+template <typename POLICY>
+void
+RefCountPolicyTestCase<POLICY>::Copy (Ptr<PolicyCounted<POLICY> > p)
+{
+  for (uint32_t i = 0; i < 100000; ++i)
+    {
+      Ptr<PolicyCounted<POLICY> > copy = p;
+      std::vector<Ptr<PolicyCounted<POLICY> > > copies (4, copy);
+    }
+}
+
+template <typename POLICY>
+void
+RefCountPolicyTestCase<POLICY>::DoRun (void)
+{
+  uint32_t deleted = 0;
+  {
+    Ptr<PolicyCounted<POLICY> > p = Create<PolicyCounted<POLICY> > (&deleted);
+    NS_TEST_EXPECT_MSG_EQ (p->GetReferenceCount (), 1, "Wrong initial count");
+    {
+      Ptr<PolicyCounted<POLICY> > q = p;
+      NS_TEST_EXPECT_MSG_EQ (p->GetReferenceCount (), 2, "Copy not counted");
+    }
+    NS_TEST_EXPECT_MSG_EQ (p->GetReferenceCount (), 1, "Release not counted");
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < m_threads; ++i)
+      {
+        threads.push_back (std::thread (&RefCountPolicyTestCase<POLICY>::Copy, p));
+      }
+    if (m_threads == 0)
+      {
+        Copy (p);
+      }
+    for (uint32_t i = 0; i < threads.size (); ++i)
+      {
+        threads[i].join ();
+      }
+    NS_TEST_EXPECT_MSG_EQ (p->GetReferenceCount (), 1, "Copies not all released");
+    NS_TEST_EXPECT_MSG_EQ (deleted, 0, "Deleted while referenced");
+  }
+  NS_TEST_EXPECT_MSG_EQ (deleted, 1, "Not deleted once");
+}
+
 /**
  * \ingroup ptr-tests
  * Test suite for pointer
@@ -337,6 +447,8 @@ public:
     : TestSuite ("ptr")
   {
     AddTestCase (new PtrTestCase ());  
+    AddTestCase (new RefCountPolicyTestCase<NonAtomicRefCountPolicy> ("non-atomic", 0));
+    AddTestCase (new RefCountPolicyTestCase<AtomicRefCountPolicy> ("atomic", 4));
   }
 };
 
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup randomvariable
+ * \ingroup randomvariable-tests
+ * RandomVariableStream::GetValues test suite.
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+
+/**
+ * \ingroup randomvariable-tests
+ * Check that GetValues draws the same values as GetValue.
+ */
+class RandomVariableStreamGetValuesTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] name The name of the distribution.
+   * \param [in] factory The factory of the random variables.
+   */
+  RandomVariableStreamGetValuesTestCase (std::string name, ObjectFactory factory);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Create a random variable.
+   * \returns A random variable on a fixed stream.
+   */
+  Ptr<RandomVariableStream> Create (void) const;
+
+  ObjectFactory m_factory;  //!< The factory of the random variables.
+};
+
+RandomVariableStreamGetValuesTestCase::RandomVariableStreamGetValuesTestCase (std::string name, ObjectFactory factory)
+  : TestCase ("GetValues of " + name),
+    m_factory (factory)
+{
+}
+
+Ptr<RandomVariableStream>
+RandomVariableStreamGetValuesTestCase::Create (void) const
+{
+  Ptr<RandomVariableStream> x = m_factory.Create<RandomVariableStream> ();
+  x->SetStream (13);
+  return x;
+}
+
+void
+RandomVariableStreamGetValuesTestCase::DoRun (void)
+{
+  Ptr<RandomVariableStream> scalar = Create ();
+  Ptr<RandomVariableStream> bulk = Create ();
+
+  // Draw in batches of various sizes, including odd ones which leave
+  // a value over for the normal distribution, and empty ones.
+  const std::size_t sizes[] = { 1, 2, 0, 3, 7, 1, 128, 255, 256, 257, 1000, 5 };
+  const std::size_t nSizes = sizeof (sizes) / sizeof (sizes[0]);
+  uint32_t drawn = 0;
+  for (std::size_t s = 0; s < nSizes; ++s)
+    {
+      std::vector<double> values (sizes[s] + 1, -1.0);
+      bulk->GetValues (&values[0], sizes[s]);
+      for (std::size_t i = 0; i < sizes[s]; ++i)
+        {
+          double expected = scalar->GetValue ();
+          NS_TEST_ASSERT_MSG_EQ (values[i], expected, "Different value " << drawn);
+          drawn++;
+        }
+      NS_TEST_ASSERT_MSG_EQ (values[sizes[s]], -1.0, "Value written past the end");
+    }
+
+  // Both variables must be left in the same state.
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (bulk->GetValue (), scalar->GetValue (),
+                             "Different value after GetValues " << i);
+    }
+}
+
+
+/**
+ * \ingroup randomvariable-tests
+ * RandomVariableStream::GetValues test suite.
+ */
+class RandomVariableStreamGetValuesTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  RandomVariableStreamGetValuesTestSuite ();
+  /**
+   * Add a test case for a distribution, and for its antithetic variant.
+   * \param [in] name The name of the distribution.
+   * \param [in] factory The factory of the random variables.
+   */
+  void AddDistribution (std::string name, ObjectFactory factory);
+};
+
+RandomVariableStreamGetValuesTestSuite::RandomVariableStreamGetValuesTestSuite ()
+  : TestSuite ("random-variable-stream-get-values", UNIT)
+{
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::UniformRandomVariable");
+  factory.Set ("Min", DoubleValue (-2.0));
+  factory.Set ("Max", DoubleValue (3.0));
+  AddDistribution ("uniform", factory);
+
+  factory.SetTypeId ("ns3::ExponentialRandomVariable");
+  factory.Set ("Mean", DoubleValue (2.0));
+  factory.Set ("Bound", DoubleValue (0.0));
+  AddDistribution ("exponential", factory);
+  factory.Set ("Bound", DoubleValue (1.5));
+  AddDistribution ("bounded exponential", factory);
+
+  factory = ObjectFactory ();
+  factory.SetTypeId ("ns3::NormalRandomVariable");
+  factory.Set ("Mean", DoubleValue (5.0));
+  factory.Set ("Variance", DoubleValue (4.0));
+  AddDistribution ("normal", factory);
+  // Reject about half of the values, so that pairs give 0, 1 or 2 values.
+  factory.Set ("Bound", DoubleValue (1.4));
+  AddDistribution ("bounded normal", factory);
+
+  // The default implementation.
+  factory = ObjectFactory ();
+  factory.SetTypeId ("ns3::ParetoRandomVariable");
+  AddDistribution ("pareto", factory);
+}
+
+void
+RandomVariableStreamGetValuesTestSuite::AddDistribution (std::string name, ObjectFactory factory)
+{
+  AddTestCase (new RandomVariableStreamGetValuesTestCase (name, factory), TestCase::QUICK);
+  factory.Set ("Antithetic", BooleanValue (true));
+  AddTestCase (new RandomVariableStreamGetValuesTestCase ("antithetic " + name, factory),
+               TestCase::QUICK);
+}
+
+/**
+ * \ingroup randomvariable-tests
+ * RandomVariableStreamGetValuesTestSuite instance variable.
+ */
+static RandomVariableStreamGetValuesTestSuite g_randomVariableStreamGetValuesTestSuite;
+
+
+}  // namespace tests
+
+}  // namespace ns3
@@ -0,0 +1,326 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/enum.h"
+#include "ns3/global-value.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/rng-stream.h"
+#include "ns3/simulator.h"
+#include "ns3/simulator-impl.h"
+#include "ns3/string.h"
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup randomvariable
+ * \ingroup randomvariable-tests
+ * RngStream generators test suite.
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+
+/**
+ * \ingroup randomvariable-tests
+ * Check the Philox4x64-10 generator against the known answer of its
+ * reference implementation.
+ */
+class RngStreamPhiloxKnownAnswerTestCase : public TestCase
+{
+public:
+  RngStreamPhiloxKnownAnswerTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RngStreamPhiloxKnownAnswerTestCase::RngStreamPhiloxKnownAnswerTestCase ()
+  : TestCase ("Philox4x64-10 known answer")
+{
+}
+
+void
+RngStreamPhiloxKnownAnswerTestCase::DoRun (void)
+{
+  // Random123 kat_vectors: philox4x64_10, counter and key 0.
+  const uint64_t expected[4] = {
+    0x16554d9eca36314cULL, 0xdb20fe9d672d0fdcULL,
+    0xd7e772cee186176bULL, 0x7e68b68aec7ba23bULL
+  };
+  // The key is the seed, run and context, the counter the position
+  // and stream.
+  RngStream rng (0, 0, 0, 0);
+  NS_TEST_ASSERT_MSG_EQ (rng.GetType (), RngStream::PHILOX, "Wrong type");
+  for (int i = 0; i < 4; i++)
+    {
+      double u = (static_cast<double> (expected[i] >> 11) + 0.5) / 9007199254740992.0;
+      NS_TEST_EXPECT_MSG_EQ (rng.RandU01 (), u, "Wrong random " << i);
+    }
+}
+
+
+/**
+ * \ingroup randomvariable-tests
+ * Check Advance, GetState and SetState of both generators.
+ */
+class RngStreamAdvanceTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] type The generator type.
+   */
+  RngStreamAdvanceTestCase (RngStream::Type type);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Create a generator.
+   * \returns A new generator of m_type.
+   */
+  RngStream Create (void) const;
+
+  RngStream::Type m_type;  //!< The generator type.
+};
+
+RngStreamAdvanceTestCase::RngStreamAdvanceTestCase (RngStream::Type type)
+  : TestCase (type == RngStream::PHILOX ? "Philox Advance and state" : "MRG32k3a Advance and state"),
+    m_type (type)
+{
+}
+
+RngStream
+RngStreamAdvanceTestCase::Create (void) const
+{
+  if (m_type == RngStream::PHILOX)
+    {
+      return RngStream (3, 2, 17, 5);
+    }
+  return RngStream (3, 17, 2);
+}
+
+void
+RngStreamAdvanceTestCase::DoRun (void)
+{
+  RngStream reference = Create ();
+  std::vector<double> values (1000);
+  for (std::size_t i = 0; i < values.size (); ++i)
+    {
+      values[i] = reference.RandU01 ();
+    }
+
+  // Skips of every size, including within a Philox block.
+  const uint64_t skips[] = { 0, 1, 2, 3, 5, 8, 64, 255, 300 };
+  for (std::size_t s = 0; s < sizeof (skips) / sizeof (skips[0]); ++s)
+    {
+      RngStream rng = Create ();
+      rng.RandU01 ();
+      rng.Advance (skips[s]);
+      NS_TEST_EXPECT_MSG_EQ (rng.RandU01 (), values[skips[s] + 1],
+                             "Wrong random after skipping " << skips[s]);
+    }
+
+  // Large skips compose.
+  RngStream once = Create ();
+  RngStream twice = Create ();
+  once.Advance (3000000000ULL);
+  twice.Advance (1000000000ULL);
+  twice.Advance (2000000000ULL);
+  NS_TEST_EXPECT_MSG_EQ (once.RandU01 (), twice.RandU01 (), "Skips do not compose");
+
+  // The state restores the sequence, also within a Philox block.
+  RngStream rng = Create ();
+  rng.Advance (6);
+  uint64_t state[RngStream::STATE_SIZE];
+  rng.GetState (state);
+  RngStream restored = Create ();
+  restored.SetState (state);
+  NS_TEST_EXPECT_MSG_EQ (restored.RandU01 (), values[6], "Wrong random after SetState");
+  RngStream copy (restored);
+  NS_TEST_EXPECT_MSG_EQ (copy.RandU01 (), values[7], "Wrong random of a copy");
+}
+
+
+/**
+ * \ingroup randomvariable-tests
+ * Check that with RngType Philox, the streams created by the events
+ * of a context do not depend on the streams of the other contexts.
+ */
+class RngStreamContextTestCase : public TestCase
+{
+public:
+  RngStreamContextTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Create streams in contexts 1 and 2, and draw from them.
+   * \param [in] firstContext The context which creates its streams first.
+   * \param [in] count The number of streams of the other context.
+   * \returns The randoms of the streams of context 1.
+   */
+  std::vector<double> Run (uint32_t firstContext, uint32_t count);
+  /**
+   * Create streams, and draw from them.
+   * \param [in] count The number of streams.
+   * \param [out] values The randoms, if not null.
+   */
+  static void Create (uint32_t count, std::vector<double> *values);
+};
+
+RngStreamContextTestCase::RngStreamContextTestCase ()
+  : TestCase ("Philox streams of a context")
+{
+}
+
+void
+RngStreamContextTestCase::Create (uint32_t count, std::vector<double> *values)
+{
+  for (uint32_t i = 0; i < count; i++)
+    {
+      Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable> ();
+      double value = x->GetValue ();
+      if (values != 0)
+        {
+          values->push_back (value);
+        }
+    }
+}
+
+std::vector<double>
+RngStreamContextTestCase::Run (uint32_t firstContext, uint32_t count)
+{
+  std::vector<double> values;
+  uint32_t other = 3 - firstContext;
+  Simulator::ScheduleWithContext (firstContext, Seconds (1), &RngStreamContextTestCase::Create,
+                                  firstContext == 1 ? 3 : count,
+                                  firstContext == 1 ? &values : 0);
+  Simulator::ScheduleWithContext (other, Seconds (2), &RngStreamContextTestCase::Create,
+                                  other == 1 ? 3 : count,
+                                  other == 1 ? &values : 0);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return values;
+}
+
+void
+RngStreamContextTestCase::DoRun (void)
+{
+  EnumValue previous;
+  GlobalValue::GetValueByName ("RngType", previous);
+  GlobalValue::Bind ("RngType", EnumValue (RngStream::PHILOX));
+
+  std::vector<double> first = Run (1, 4);
+  std::vector<double> second = Run (2, 7);
+  std::vector<double> third = Run (2, 2);
+
+  GlobalValue::Bind ("RngType", previous);
+
+  NS_TEST_ASSERT_MSG_EQ (first.size (), 3, "Wrong number of values");
+  NS_TEST_ASSERT_MSG_EQ (second.size (), 3, "Wrong number of values");
+  NS_TEST_ASSERT_MSG_EQ (third.size (), 3, "Wrong number of values");
+  // The automatic stream numbers of context 1 are 0 to 2, then 3 to 5,
+  // then 6 to 8, whatever the streams of context 2.
+  for (uint32_t i = 0; i < 9; i++)
+    {
+      RngStream expected (RngSeedManager::GetSeed (), RngSeedManager::GetRun (), i, 1);
+      double value = expected.RandU01 ();
+      const std::vector<double> &values = (i < 3) ? first : (i < 6) ? second : third;
+      NS_TEST_EXPECT_MSG_EQ (values[i % 3], value, "Wrong value of stream " << i);
+    }
+}
+
+
+/**
+ * \ingroup randomvariable-tests
+ * Check that with RngType Philox, creating a stream does not create
+ * the simulator implementation.
+ */
+class RngStreamImplementationTestCase : public TestCase
+{
+public:
+  RngStreamImplementationTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RngStreamImplementationTestCase::RngStreamImplementationTestCase ()
+  : TestCase ("Philox streams do not create the simulator")
+{
+}
+
+void
+RngStreamImplementationTestCase::DoRun (void)
+{
+  TypeId tid;
+  if (!TypeId::LookupByNameFailSafe ("ns3::RealtimeSimulatorImpl", &tid))
+    {
+      return;
+    }
+  EnumValue previous;
+  GlobalValue::GetValueByName ("RngType", previous);
+  StringValue previousImpl;
+  GlobalValue::GetValueByName ("SimulatorImplementationType", previousImpl);
+  GlobalValue::Bind ("RngType", EnumValue (RngStream::PHILOX));
+  Simulator::Destroy ();
+
+  Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable> ();
+  x->GetValue ();
+  // The implementation type is only read when the implementation is
+  // created.
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue (tid.GetName ()));
+  std::string name = Simulator::GetImplementation ()->GetInstanceTypeId ().GetName ();
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType", previousImpl);
+  GlobalValue::Bind ("RngType", previous);
+
+  NS_TEST_EXPECT_MSG_EQ (name, tid.GetName (), "The stream created the simulator implementation");
+}
+
+
+/**
+ * \ingroup randomvariable-tests
+ * RngStream generators test suite.
+ */
+class RngStreamTestSuite : public TestSuite
+{
+public:
+  RngStreamTestSuite ();
+};
+
+RngStreamTestSuite::RngStreamTestSuite ()
+  : TestSuite ("rng-stream", UNIT)
+{
+  AddTestCase (new RngStreamPhiloxKnownAnswerTestCase, TestCase::QUICK);
+  AddTestCase (new RngStreamAdvanceTestCase (RngStream::MRG32K3A), TestCase::QUICK);
+  AddTestCase (new RngStreamAdvanceTestCase (RngStream::PHILOX), TestCase::QUICK);
+  AddTestCase (new RngStreamContextTestCase, TestCase::QUICK);
+  AddTestCase (new RngStreamImplementationTestCase, TestCase::QUICK);
+}
+
+/** RngStreamTestSuite instance variable. */
+static RngStreamTestSuite g_rngStreamTestSuite;
+
+
+}  // namespace tests
+
+}  // namespace ns3
@@ -0,0 +1,250 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/simulation-checkpoint.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/object.h"
+#include "ns3/pointer.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup simulator-tests
+ * SimulationCheckpoint test suite.
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+
+/**
+ * \ingroup simulator-tests
+ * An object with attributes, to checkpoint.
+ */
+class CheckpointTestObject : public Object
+{
+public:
+  /**
+   * Register this type.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::tests::CheckpointTestObject")
+      .SetParent<Object> ()
+      .SetGroupName ("Core")
+      .AddConstructor<CheckpointTestObject> ()
+      .AddAttribute ("Value", "A value.",
+                     UintegerValue (1),
+                     MakeUintegerAccessor (&CheckpointTestObject::m_value),
+                     MakeUintegerChecker<uint32_t> ())
+      .AddAttribute ("Child", "Another object.",
+                     PointerValue (),
+                     MakePointerAccessor (&CheckpointTestObject::m_child),
+                     MakePointerChecker<CheckpointTestObject> ())
+      .AddAttribute ("Random", "A random variable.",
+                     StringValue ("ns3::UniformRandomVariable"),
+                     MakePointerAccessor (&CheckpointTestObject::m_random),
+                     MakePointerChecker<RandomVariableStream> ())
+    ;
+    return tid;
+  }
+
+  uint32_t m_value;                         //!< The value.
+  Ptr<CheckpointTestObject> m_child;        //!< The child object.
+  Ptr<RandomVariableStream> m_random;       //!< The random variable.
+};
+
+
+/**
+ * \ingroup simulator-tests
+ * Check that a checkpoint file restores the attributes and the
+ * random streams.
+ */
+class CheckpointSaveRestoreTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  CheckpointSaveRestoreTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+CheckpointSaveRestoreTestCase::CheckpointSaveRestoreTestCase ()
+  : TestCase ("Check that a checkpoint file restores attributes and random streams")
+{
+}
+
+void
+CheckpointSaveRestoreTestCase::DoRun (void)
+{
+  Ptr<CheckpointTestObject> root = CreateObject<CheckpointTestObject> ();
+  root->SetAttribute ("Child", PointerValue (CreateObject<CheckpointTestObject> ()));
+  Config::RegisterRootNamespaceObject (root);
+  root->m_value = 3;
+  root->m_child->m_value = 5;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      root->m_random->GetValue ();
+    }
+
+  std::string path = CreateTempDirFilename ("checkpoint.txt");
+  Simulator::Checkpoint (path);
+
+  std::ifstream is (path.c_str ());
+  std::stringstream content;
+  content << is.rdbuf ();
+  NS_TEST_EXPECT_MSG_NE (content.str ().find ("attribute\t/Child\tValue\t5\n"), std::string::npos,
+                         "Missing attribute in\n" << content.str ());
+
+  double expected[3];
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      expected[i] = root->m_random->GetValue ();
+    }
+  root->m_value = 7;
+  root->m_child->m_value = 9;
+
+  Simulator::Restore (path);
+  NS_TEST_EXPECT_MSG_EQ (root->m_value, 3, "Attribute not restored");
+  NS_TEST_EXPECT_MSG_EQ (root->m_child->m_value, 5, "Child attribute not restored");
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (root->m_random->GetValue (), expected[i], "Random stream not restored");
+    }
+
+  Config::UnregisterRootNamespaceObject (root);
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup simulator-tests
+ * Check that the simulation can be forked into several branches.
+ */
+class CheckpointForkTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  CheckpointForkTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Record an event of a branch.
+   * \param [in] branch The branch.
+   */
+  void Event (uint32_t branch);
+  /** The events of this process. */
+  std::ostringstream m_events;
+};
+
+CheckpointForkTestCase::CheckpointForkTestCase ()
+  : TestCase ("Check that the branches of a forked simulation continue from the same state")
+{
+}
+
+void
+CheckpointForkTestCase::Event (uint32_t branch)
+{
+  m_events << branch << "@" << Simulator::Now ().GetSeconds () << " ";
+}
+
+void
+CheckpointForkTestCase::DoRun (void)
+{
+  Simulator::Schedule (Seconds (1), &CheckpointForkTestCase::Event, this, 100);
+  Simulator::Schedule (Seconds (3), &CheckpointForkTestCase::Event, this, 100);
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+
+  // A trace file with buffered output, which the branches close.
+  std::string sharedName = CreateTempDirFilename ("branch-shared");
+  std::ofstream shared (sharedName.c_str ());
+  FatalImpl::RegisterStream (&shared);
+  shared << "before ";
+
+  uint32_t branch = SimulationCheckpoint::Fork (3, 2);
+  if (branch < 3)
+    {
+      shared.close ();
+      // Each branch schedules its own event, and finds the pending one.
+      Simulator::Schedule (Seconds (branch), &CheckpointForkTestCase::Event, this, branch);
+      Simulator::Run ();
+      std::ostringstream name;
+      name << "branch-" << branch;
+      std::ofstream os (CreateTempDirFilename (name.str ()).c_str ());
+      os << m_events.str ();
+      os.close ();
+      _exit (0);
+    }
+  FatalImpl::UnregisterStream (&shared);
+  shared.close ();
+  std::ifstream sharedIs (sharedName.c_str ());
+  std::string sharedText;
+  std::getline (sharedIs, sharedText);
+  NS_TEST_EXPECT_MSG_EQ (sharedText, "before ", "Buffered output written by the branches");
+
+  NS_TEST_EXPECT_MSG_EQ (branch, 3, "Bad branch count");
+  std::string expected[] = {
+    "100@1 0@2 100@3 ",
+    "100@1 100@3 1@3 ",
+    "100@1 100@3 2@4 "
+  };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      std::ostringstream name;
+      name << "branch-" << i;
+      std::ifstream is (CreateTempDirFilename (name.str ()).c_str ());
+      std::string events;
+      std::getline (is, events);
+      NS_TEST_EXPECT_MSG_EQ (events, expected[i], "Bad events in branch " << i);
+    }
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup simulator-tests
+ * SimulationCheckpoint test suite.
+ */
+class SimulationCheckpointTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  SimulationCheckpointTestSuite ()
+    : TestSuite ("simulation-checkpoint")
+  {
+    AddTestCase (new CheckpointSaveRestoreTestCase (), TestCase::QUICK);
+    AddTestCase (new CheckpointForkTestCase (), TestCase::QUICK);
+  }
+};
+
+/** The test suite instance. */
+static SimulationCheckpointTestSuite g_simulationCheckpointTestSuite;
+
+}  // namespace tests
+
+}  // namespace ns3
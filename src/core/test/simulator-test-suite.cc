@@ -23,6 +23,13 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/pairing-heap-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/event-profiler.h"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
 
 using namespace ns3;
 
@@ -170,6 +177,276 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that events are ordered after random inserts and removes with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+static void
+SchedulerOrderNothing (void)
+{
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+
+  // As in a simulation, events are never inserted before the last
+  // removed event.
+  std::vector<Scheduler::Event> events;
+  uint64_t now = 0;
+  uint32_t batchUid = 100000;
+  for (uint32_t uid = 4; uid < 2004; ++uid)
+    {
+      Scheduler::Event ev;
+      ev.impl = MakeEvent (&SchedulerOrderNothing);
+      ev.key.m_ts = now + random->GetInteger (0, 500);
+      ev.key.m_uid = uid;
+      ev.key.m_context = 0;
+      scheduler->Insert (ev);
+      events.push_back (ev);
+      if (uid % 50 == 0)
+        {
+          // Insert a batch of events, sometimes bigger than the schedule.
+          std::vector<Scheduler::Event> batch;
+          uint32_t size = random->GetInteger (1, 100);
+          for (uint32_t i = 0; i < size; ++i)
+            {
+              ev.impl = MakeEvent (&SchedulerOrderNothing);
+              ev.key.m_ts = now + random->GetInteger (0, 500);
+              ev.key.m_uid = batchUid++;
+              batch.push_back (ev);
+            }
+          scheduler->InsertBatch (batch);
+          events.insert (events.end (), batch.begin (), batch.end ());
+        }
+      if (uid % 5 == 0)
+        {
+          // Remove and run a few events along the way.
+          uint32_t i = random->GetInteger (0, events.size () - 1);
+          scheduler->Remove (events[i]);
+          events[i].impl->Unref ();
+          events.erase (events.begin () + i);
+          Scheduler::Event next = scheduler->RemoveNext ();
+          std::vector<Scheduler::Event>::iterator j = std::min_element (events.begin (), events.end ());
+          NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, j->key.m_uid, "Bad next event");
+          now = next.key.m_ts;
+          next.impl->Unref ();
+          events.erase (j);
+        }
+    }
+
+  std::sort (events.begin (), events.end ());
+  for (std::vector<Scheduler::Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), false, "Missing events");
+      Scheduler::Event next = scheduler->RemoveNext ();
+      NS_TEST_EXPECT_MSG_EQ (next.key.m_uid, i->key.m_uid, "Bad event order");
+      next.impl->Unref ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (scheduler->IsEmpty (), true, "Too many events");
+}
+
+class ScheduleWithContextBatchTestCase : public TestCase
+{
+public:
+  ScheduleWithContextBatchTestCase ();
+  virtual void DoRun (void);
+  void Event (uint32_t i);
+  std::vector<uint32_t> m_order;
+};
+
+ScheduleWithContextBatchTestCase::ScheduleWithContextBatchTestCase ()
+  : TestCase ("Check that a batch of events with context is scheduled")
+{
+}
+
+void
+ScheduleWithContextBatchTestCase::Event (uint32_t i)
+{
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetContext (), 10 + i, "Bad context");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (1 + i % 3), "Bad time");
+  m_order.push_back (i);
+}
+
+void
+ScheduleWithContextBatchTestCase::DoRun (void)
+{
+  Simulator::ContextEvents batch;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      Simulator::ContextEvent ev;
+      ev.context = 10 + i;
+      ev.delay = Seconds (1 + i % 3);
+      ev.event = MakeEvent (&ScheduleWithContextBatchTestCase::Event, this, i);
+      batch.push_back (ev);
+    }
+  Simulator::ScheduleWithContextBatch (batch);
+  Simulator::Run ();
+  // Events with the same timestamp run in the batch order.
+  uint32_t expected[] = { 0, 3, 1, 4, 2, 5 };
+  NS_TEST_ASSERT_MSG_EQ (m_order.size (), 6, "Missing events");
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_order[i], expected[i], "Bad order");
+    }
+  Simulator::Destroy ();
+}
+
+class EventRecyclingTestCase : public TestCase
+{
+public:
+  EventRecyclingTestCase ();
+  virtual void DoRun (void);
+  void Event1 (uint32_t a);
+  void Event2 (uint64_t a, uint64_t b);
+  uint64_t m_sum;
+};
+
+EventRecyclingTestCase::EventRecyclingTestCase ()
+  : TestCase ("Check that the storage of the events is recycled")
+{
+}
+
+void
+EventRecyclingTestCase::Event1 (uint32_t a)
+{
+  m_sum += a;
+}
+
+void
+EventRecyclingTestCase::Event2 (uint64_t a, uint64_t b)
+{
+  m_sum += a * b;
+}
+
+void
+EventRecyclingTestCase::DoRun (void)
+{
+  m_sum = 0;
+  EventId id = Simulator::Schedule (MicroSeconds (1), &EventRecyclingTestCase::Event1, this, 1);
+  EventImpl *first = id.PeekEventImpl ();
+  id = EventId ();
+  Simulator::Run ();
+
+  // The storage released by the first event is reused by the next
+  // event of the same size.
+  id = Simulator::Schedule (MicroSeconds (1), &EventRecyclingTestCase::Event1, this, 2);
+  NS_TEST_EXPECT_MSG_EQ (id.PeekEventImpl (), first, "Event storage was not recycled");
+
+  // An event of another size class.
+  EventId other = Simulator::Schedule (MicroSeconds (2), &EventRecyclingTestCase::Event2, this, 3, 4);
+  id = EventId ();
+  other = EventId ();
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 1 + 2 + 3 * 4, "Bad events");
+
+  Simulator::Destroy ();
+}
+
+class EventProfilerTestCase : public TestCase
+{
+public:
+  EventProfilerTestCase ();
+  virtual void DoRun (void);
+  void Event1 (uint32_t a);
+  void Event2 (void);
+  void Event3 (uint32_t a);
+  uint32_t m_count;
+};
+
+EventProfilerTestCase::EventProfilerTestCase ()
+  : TestCase ("Check that the event profiler accounts for every event")
+{
+}
+
+void
+EventProfilerTestCase::Event1 (uint32_t a)
+{
+  m_count++;
+}
+
+void
+EventProfilerTestCase::Event2 (void)
+{
+  m_count++;
+}
+
+void
+EventProfilerTestCase::Event3 (uint32_t a)
+{
+  m_count++;
+}
+
+static void
+EventProfilerFunction (void)
+{
+}
+
+void
+EventProfilerTestCase::DoRun (void)
+{
+  m_count = 0;
+  EventProfiler *profiler = EventProfiler::Get ();
+  profiler->Reset ();
+  profiler->Enable (Seconds (1));
+
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Simulator::ScheduleWithContext (i % 2, Seconds (i), &EventProfilerTestCase::Event1, this, i);
+    }
+  Simulator::Schedule (Seconds (0.5), &EventProfilerTestCase::Event2, this);
+  Simulator::Schedule (Seconds (2.5), &EventProfilerFunction);
+  Simulator::Schedule (Seconds (3.5), &EventProfilerTestCase::Event3, this, 0);
+  Simulator::Run ();
+  profiler->Disable ();
+  NS_TEST_EXPECT_MSG_EQ (m_count, 12, "Missing events");
+
+  NS_TEST_EXPECT_MSG_EQ (profiler->GetEventCount (), 13, "Bad event count");
+  NS_TEST_EXPECT_MSG_EQ (profiler->GetContextEventCount (0), 5, "Bad context 0 count");
+  NS_TEST_EXPECT_MSG_EQ (profiler->GetContextEventCount (1), 5, "Bad context 1 count");
+  NS_TEST_EXPECT_MSG_EQ (profiler->GetContextEventCount (Simulator::NO_CONTEXT), 3,
+                         "Bad count for the events without context");
+  // Event1 and Event3 have the same type, but are profiled separately.
+  std::string type1 = "void (EventProfilerTestCase::*)(unsigned int)";
+  std::string event1 = "EventProfilerTestCase::Event1(unsigned int)";
+  std::string event3 = "EventProfilerTestCase::Event3(unsigned int)";
+  NS_TEST_EXPECT_MSG_EQ (profiler->GetTypeEventCount (event1), 10, "Bad Event1 count");
+  NS_TEST_EXPECT_MSG_EQ (profiler->GetTypeEventCount (event3), 1, "Bad Event3 count");
+  NS_TEST_EXPECT_MSG_EQ (profiler->GetTypeEventCount (type1), 0, "Events merged by type");
+  NS_TEST_EXPECT_MSG_EQ (EventProfiler::GetEventClassName (type1), "EventProfilerTestCase",
+                         "Bad event class");
+
+  std::ostringstream report;
+  profiler->WriteReport (report);
+  NS_TEST_EXPECT_MSG_NE (report.str ().find ("[+2.0s, +3.0s)"), std::string::npos,
+                         "Missing time bucket in\n" << report.str ());
+
+  std::ostringstream folded;
+  profiler->WriteFoldedStacks (folded);
+  NS_TEST_EXPECT_MSG_NE (folded.str ().find ("EventProfilerTestCase;" + type1 + ";" + event1 + " "),
+                         std::string::npos, "Missing stack in\n" << folded.str ());
+  // EventProfilerFunction is static, hence has no dynamic symbol.
+  NS_TEST_EXPECT_MSG_NE (folded.str ().find ("(function);void (*)() at "), std::string::npos,
+                         "Missing function stack in\n" << folded.str ());
+
+  profiler->Reset ();
+  Simulator::Destroy ();
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -477,5 +754,24 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (PairingHeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    AddTestCase (new ScheduleWithContextBatchTestCase (), TestCase::QUICK);
+    AddTestCase (new EventRecyclingTestCase (), TestCase::QUICK);
+    AddTestCase (new EventProfilerTestCase (), TestCase::QUICK);
+
+    std::string schedulerTypes[] = {
+      "ns3::ListScheduler",
+      "ns3::MapScheduler",
+      "ns3::HeapScheduler",
+      "ns3::CalendarScheduler",
+      "ns3::PairingHeapScheduler"
+    };
+    for (unsigned int i = 0; i < (sizeof (schedulerTypes) / sizeof (schedulerTypes[0])); ++i)
+      {
+        factory.SetTypeId (schedulerTypes[i]);
+        AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+      }
   }
 } g_simulatorTestSuite;
@@ -23,15 +23,24 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/pairing-heap-scheduler.h"
 #include "ns3/config.h"
 #include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/nstime.h"
 #include "ns3/system-thread.h"
+#include "ns3/simulator-impl.h"
+#include "ns3/core-config.h"
 
 #include <chrono>  // seconds, milliseconds
 #include <ctime>
 #include <list>
+#include <set>
+#include <sstream>
 #include <thread>  // sleep_for
 #include <utility>
+#include <vector>
 
 using namespace ns3;
 
@@ -226,6 +235,245 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+class MultithreadedSimulatorPartitionTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorPartitionTestCase (uint32_t threads);
+  void Receive (uint32_t hop);
+  void Tick (void);
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /**
+   * Run the token exchange with a simulator implementation.
+   * \param [in] simulatorType The simulator implementation.
+   * \return The events seen by each context, in execution order.
+   */
+  std::vector<std::string> RunTokens (const std::string &simulatorType);
+
+  static const uint32_t CONTEXTS = 8;
+  static const uint32_t HOPS = 200;
+  uint32_t m_threads;
+  std::vector<std::ostringstream *> m_log;
+  std::vector<uint32_t> m_partition;
+  std::string m_error;
+};
+
+MultithreadedSimulatorPartitionTestCase::MultithreadedSimulatorPartitionTestCase (uint32_t threads)
+  : TestCase ("Check that ns3::MultithreadedSimulatorImpl with " +
+              std::to_string (threads) + " threads runs the same events "
+              "as ns3::DefaultSimulatorImpl"),
+    m_threads (threads)
+{
+}
+
+void
+MultithreadedSimulatorPartitionTestCase::Receive (uint32_t hop)
+{
+  uint32_t context = Simulator::GetContext ();
+  if (context >= CONTEXTS)
+    {
+      m_error = "Bad context";
+      return;
+    }
+  *m_log[context] << Simulator::Now ().GetTimeStep () << ":" << hop << " ";
+  m_partition[context] = Simulator::GetPartitionId ();
+  if (hop == HOPS)
+    {
+      return;
+    }
+  // A local event, then the token goes to the next context.
+  Simulator::Schedule (MicroSeconds (hop % 7),
+                       &MultithreadedSimulatorPartitionTestCase::Tick, this);
+  Simulator::ScheduleWithContext ((context + 1 + hop) % CONTEXTS,
+                                  MilliSeconds (1) + MicroSeconds (hop % 3),
+                                  &MultithreadedSimulatorPartitionTestCase::Receive, this, hop + 1);
+}
+
+void
+MultithreadedSimulatorPartitionTestCase::Tick (void)
+{
+  *m_log[Simulator::GetContext ()] << "t" << Simulator::Now ().GetTimeStep () << " ";
+}
+
+std::vector<std::string>
+MultithreadedSimulatorPartitionTestCase::RunTokens (const std::string &simulatorType)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (simulatorType));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::ThreadCount", UintegerValue (m_threads));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::Lookahead", TimeValue (MilliSeconds (1)));
+  // The events only share the test case, through a plain pointer.
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::RequireAtomicRefCount", BooleanValue (false));
+
+  m_partition.assign (CONTEXTS, 0);
+  for (uint32_t i = 0; i < CONTEXTS; ++i)
+    {
+      m_log.push_back (new std::ostringstream ());
+    }
+  for (uint32_t i = 0; i < CONTEXTS; i += 2)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (i),
+                                      &MultithreadedSimulatorPartitionTestCase::Receive, this, 0);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::vector<std::string> logs;
+  for (uint32_t i = 0; i < CONTEXTS; ++i)
+    {
+      logs.push_back (m_log[i]->str ());
+      delete m_log[i];
+    }
+  m_log.clear ();
+  return logs;
+}
+
+void
+MultithreadedSimulatorPartitionTestCase::DoRun (void)
+{
+  std::vector<std::string> expected = RunTokens ("ns3::DefaultSimulatorImpl");
+  std::vector<std::string> logs = RunTokens ("ns3::MultithreadedSimulatorImpl");
+
+  NS_TEST_EXPECT_MSG_EQ (m_error.empty (), true, m_error);
+  std::set<uint32_t> partitions (m_partition.begin (), m_partition.end ());
+  NS_TEST_EXPECT_MSG_EQ (partitions.size (), m_threads, "Contexts not spread over the partitions");
+  for (uint32_t i = 0; i < CONTEXTS; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (logs[i], expected[i], "Bad events for context " << i);
+    }
+}
+
+void
+MultithreadedSimulatorPartitionTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::Reset ();
+}
+
+#ifdef HAVE_RT
+class RealtimeSimulatorWaitModeTestCase : public TestCase
+{
+public:
+  RealtimeSimulatorWaitModeTestCase (const std::string &waitMode);
+  void Tick (void);
+  void Injected (void);
+  void Inject (void);
+  void Lateness (Time lateness);
+  void LatenessHistogram (const std::vector<uint64_t> &histogram);
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  static const uint32_t INJECTED = 20;
+  std::string m_waitMode;
+  Ptr<SystemThread> m_thread;
+  uint32_t m_injected;
+  uint64_t m_events;
+  uint64_t m_lateness;
+  uint64_t m_histogram;
+  uint32_t m_reports;
+};
+
+RealtimeSimulatorWaitModeTestCase::RealtimeSimulatorWaitModeTestCase (const std::string &waitMode)
+  : TestCase ("Check events injected from another thread, and the lateness traces, "
+              "in ns3::RealtimeSimulatorImpl with the " + waitMode + " wait mode"),
+    m_waitMode (waitMode)
+{
+}
+
+void
+RealtimeSimulatorWaitModeTestCase::Tick (void)
+{
+  m_events++;
+  if (m_injected < INJECTED)
+    {
+      Simulator::Schedule (MilliSeconds (1), &RealtimeSimulatorWaitModeTestCase::Tick, this);
+    }
+}
+
+void
+RealtimeSimulatorWaitModeTestCase::Injected (void)
+{
+  m_events++;
+  if (Simulator::GetContext () != 7)
+    {
+      return;
+    }
+  if (++m_injected == INJECTED)
+    {
+      Simulator::Stop ();
+    }
+}
+
+void
+RealtimeSimulatorWaitModeTestCase::Inject (void)
+{
+  for (uint32_t i = 0; i < INJECTED; ++i)
+    {
+      std::this_thread::sleep_for (std::chrono::microseconds (500));
+      Simulator::ScheduleWithContext (7, MicroSeconds (100),
+                                      &RealtimeSimulatorWaitModeTestCase::Injected, this);
+    }
+}
+
+void
+RealtimeSimulatorWaitModeTestCase::Lateness (Time lateness)
+{
+  m_lateness++;
+}
+
+void
+RealtimeSimulatorWaitModeTestCase::LatenessHistogram (const std::vector<uint64_t> &histogram)
+{
+  m_reports++;
+  for (uint32_t i = 0; i < histogram.size (); ++i)
+    {
+      m_histogram += histogram[i];
+    }
+}
+
+void
+RealtimeSimulatorWaitModeTestCase::DoRun (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::RealtimeSimulatorImpl"));
+  Config::SetDefault ("ns3::WallClockSynchronizer::WaitMode", StringValue (m_waitMode));
+  Config::SetDefault ("ns3::RealtimeSimulatorImpl::LatenessInterval", TimeValue (MilliSeconds (5)));
+  m_injected = 0;
+  m_events = 0;
+  m_lateness = 0;
+  m_histogram = 0;
+  m_reports = 0;
+
+  Ptr<SimulatorImpl> impl = Simulator::GetImplementation ();
+  impl->TraceConnectWithoutContext ("Lateness",
+                                    MakeCallback (&RealtimeSimulatorWaitModeTestCase::Lateness, this));
+  impl->TraceConnectWithoutContext ("LatenessHistogram",
+                                    MakeCallback (&RealtimeSimulatorWaitModeTestCase::LatenessHistogram, this));
+
+  m_thread = Create<SystemThread> (MakeCallback (&RealtimeSimulatorWaitModeTestCase::Inject, this));
+  m_thread->Start ();
+  Simulator::Schedule (MilliSeconds (1), &RealtimeSimulatorWaitModeTestCase::Tick, this);
+  Simulator::Run ();
+  m_thread->Join ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_injected, INJECTED, "Injected events lost");
+  NS_TEST_EXPECT_MSG_EQ (m_lateness, m_events, "Lateness not traced for every event");
+  NS_TEST_EXPECT_MSG_EQ (m_histogram, m_events, "Histogram does not count every event");
+  NS_TEST_EXPECT_MSG_GT (m_reports, 1, "Histogram not reported periodically");
+}
+
+void
+RealtimeSimulatorWaitModeTestCase::DoTeardown (void)
+{
+  m_thread = 0;
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::Reset ();
+}
+#endif /* HAVE_RT */
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -236,13 +484,17 @@ public:
 #ifdef HAVE_RT
       "ns3::RealtimeSimulatorImpl",
 #endif
-      "ns3::DefaultSimulatorImpl"
+      "ns3::DefaultSimulatorImpl",
+      // With the default ThreadCount: one thread per core with atomic
+      // reference counts, and a single one otherwise.
+      "ns3::MultithreadedSimulatorImpl"
     };
     std::string schedulerTypes[] = {
       "ns3::ListScheduler",
       "ns3::HeapScheduler",
       "ns3::MapScheduler",
-      "ns3::CalendarScheduler"
+      "ns3::CalendarScheduler",
+      "ns3::PairingHeapScheduler"
     };
     unsigned int threadcounts[] = {
       0,
@@ -263,5 +515,12 @@ public:
               }
           }
       }
+    AddTestCase (new MultithreadedSimulatorPartitionTestCase (1), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorPartitionTestCase (4), TestCase::QUICK);
+#ifdef HAVE_RT
+    AddTestCase (new RealtimeSimulatorWaitModeTestCase ("Sleep"), TestCase::QUICK);
+    AddTestCase (new RealtimeSimulatorWaitModeTestCase ("Hybrid"), TestCase::QUICK);
+    AddTestCase (new RealtimeSimulatorWaitModeTestCase ("Spin"), TestCase::QUICK);
+#endif
   }
 } g_threadedSimulatorTestSuite;
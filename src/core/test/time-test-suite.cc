@@ -20,13 +20,17 @@
  * TimeStep support by Emmanuelle Laprise <emmanuelle.laprise@bluekazoo.ca>
  */
 
+#include <cmath>
+#include <ctime>
 #include <iomanip>
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include "ns3/nstime.h"
 #include "ns3/int64x64.h"
+#include "ns3/simulator.h"
 #include "ns3/test.h"
 
 using namespace ns3;
@@ -229,7 +233,83 @@ TimeInputOutputTestCase::DoRun (void)
 
   std::cout << std::endl;
 }
-    
+
+class TimeFastConversionTestCase : public TestCase
+{
+public:
+  TimeFastConversionTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the conversions of a value in a unit.
+   * \param [in] value The value.
+   * \param [in] unit The unit of \p value.
+   */
+  void Check (double value, Time::Unit unit);
+};
+
+TimeFastConversionTestCase::TimeFastConversionTestCase ()
+  : TestCase ("Conversions without int64x64_t match int64x64_t")
+{
+}
+
+void
+TimeFastConversionTestCase::Check (double value, Time::Unit unit)
+{
+  // FromDouble must be exactly the int64x64_t conversion.
+  Time fast = Time::FromDouble (value, unit);
+  Time slow = Time::From (int64x64_t (value), unit);
+  NS_TEST_EXPECT_MSG_EQ (fast.GetTimeStep (), slow.GetTimeStep (),
+                         "FromDouble (" << std::setprecision (17) << value
+                         << ", " << unit << ")");
+  // ToDouble is correctly rounded, the int64x64_t conversion is within
+  // its 64 fractional bits.
+  double expected = fast.To (unit).GetDouble ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (fast.ToDouble (unit), expected, std::fabs (expected) * 1e-15 + 1e-18,
+                             "ToDouble (" << fast.GetTimeStep () << ", " << unit << ")");
+}
+
+void
+TimeFastConversionTestCase::DoRun (void)
+{
+  const Time::Unit units[] = { Time::H, Time::MIN, Time::S, Time::MS, Time::US, Time::NS };
+  // Values whose products by the factors are integers, or just below
+  // or above them.
+  const double values[] = { 0, 1, 0.5, 0.1, 0.3, 0.7, 1.1, 2.675, 1e-3, 4.35,
+                            0.000123, 1.0 / 3, 123456.789, 1e-9, 3e-4, 1.7e-6,
+                            // Rounded to 2^-64 by int64x64_t, with ties.
+                            std::ldexp (1.0, -65), std::ldexp (3.0, -66), 5e-20 };
+  for (std::size_t u = 0; u < sizeof (units) / sizeof (units[0]); ++u)
+    {
+      for (std::size_t i = 0; i < sizeof (values) / sizeof (values[0]); ++i)
+        {
+          Check (values[i], units[u]);
+          Check (-values[i], units[u]);
+          Check (std::nextafter (values[i], 0.0), units[u]);
+          Check (std::nextafter (values[i], 1e9), units[u]);
+        }
+      // Pseudo-random values of all magnitudes.
+      uint64_t state = 12345;
+      for (uint32_t i = 0; i < 20000; ++i)
+        {
+          state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+          double mantissa = static_cast<double> (state >> 11) / 9007199254740992.0;
+          int exponent = static_cast<int> ((state >> 3) % 80) - 72;
+          Check (std::ldexp (mantissa, exponent), units[u]);
+        }
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (2_s, Seconds (2), "2_s");
+  NS_TEST_EXPECT_MSG_EQ (1.5_s, Seconds (1.5), "1.5_s");
+  NS_TEST_EXPECT_MSG_EQ (3_ms, MilliSeconds (3), "3_ms");
+  NS_TEST_EXPECT_MSG_EQ (9_us, MicroSeconds (9), "9_us");
+  NS_TEST_EXPECT_MSG_EQ (800_ns, NanoSeconds (800), "800_ns");
+  NS_TEST_EXPECT_MSG_EQ (2_min, Minutes (2), "2_min");
+  NS_TEST_EXPECT_MSG_EQ (1_h, Hours (1), "1_h");
+  NS_TEST_EXPECT_MSG_EQ (0.25_ms, MicroSeconds (250), "0.25_ms");
+}
+
+
 static class TimeTestSuite : public TestSuite
 {
 public:
@@ -238,9 +318,132 @@ public:
   {
     AddTestCase (new TimeWithSignTestCase (), TestCase::QUICK);
     AddTestCase (new TimeInputOutputTestCase (), TestCase::QUICK);
+    AddTestCase (new TimeFastConversionTestCase (), TestCase::QUICK);
     // This should be last, since it changes the resolution
     AddTestCase (new TimeSimpleTestCase (), TestCase::QUICK);
   }
 } g_timeTestSuite;
 
 
+class TimeConversionPerformanceTestCase : public TestCase
+{
+public:
+  TimeConversionPerformanceTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Run the measurements, from an event so that the new Time instances
+   * are not marked.
+   */
+  void Measure (void);
+  /**
+   * Print a measurement.
+   * \param [in] how The conversion measured.
+   * \param [in] delta The clock ticks taken.
+   * \param [in] sum The sum of the results, to use them.
+   */
+  void Report (const std::string how, const clock_t delta, const double sum) const;
+
+  enum { REPETITIONS = 2000000 };
+};
+
+TimeConversionPerformanceTestCase::TimeConversionPerformanceTestCase ()
+  : TestCase ("Measure the Time conversion throughput")
+{
+}
+
+void
+TimeConversionPerformanceTestCase::Report (const std::string how, const clock_t delta,
+                                           const double sum) const
+{
+  double per = 1E9 * double (delta) / (double (REPETITIONS) * double (CLOCKS_PER_SEC));
+  std::cout << GetParent ()->GetName () << " " << std::left << std::setw (32) << how
+            << std::right << " ticks: " << std::setw (8) << delta
+            << "  per: " << std::setw (8) << per << " ns/conversion"
+            << "  (" << sum << ")" << std::endl;
+}
+
+void
+TimeConversionPerformanceTestCase::DoRun (void)
+{
+  Simulator::Schedule (Seconds (0), &TimeConversionPerformanceTestCase::Measure, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+TimeConversionPerformanceTestCase::Measure (void)
+{
+  const char *impl = (int64x64_t::implementation == int64x64_t::int128_impl) ? "int128"
+    : (int64x64_t::implementation == int64x64_t::cairo_impl) ? "cairo" : "long double";
+  std::cout << GetParent ()->GetName () << " int64x64_t implementation: " << impl
+            << ", repetitions: " << REPETITIONS << std::endl;
+
+  // Durations of a few microseconds, as computed for frames.
+  std::vector<double> seconds (1024);
+  std::vector<Time> times (1024);
+  for (uint32_t i = 0; i < seconds.size (); ++i)
+    {
+      seconds[i] = (i + 1) * 1.7e-6;
+      times[i] = NanoSeconds (i * 1733 + 17);
+    }
+  const uint32_t mask = seconds.size () - 1;
+
+  double sum = 0;
+  clock_t start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      sum += Time::From (int64x64_t (seconds[i & mask]), Time::S).GetTimeStep ();
+    }
+  Report ("Seconds (double), int64x64_t", clock () - start, sum);
+
+  sum = 0;
+  start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      sum += Seconds (seconds[i & mask]).GetTimeStep ();
+    }
+  Report ("Seconds (double)", clock () - start, sum);
+
+  sum = 0;
+  start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      sum += times[i & mask].To (Time::S).GetDouble ();
+    }
+  Report ("GetSeconds, int64x64_t", clock () - start, sum);
+
+  sum = 0;
+  start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      sum += times[i & mask].GetSeconds ();
+    }
+  Report ("GetSeconds", clock () - start, sum);
+
+  sum = 0;
+  start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      sum += (times[i & mask] * int64x64_t (3, 0) / int64x64_t (2, 0)).GetTimeStep ();
+    }
+  Report ("Time * int64x64_t / int64x64_t", clock () - start, sum);
+
+  sum = 0;
+  start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      sum += (times[i & mask] * 3 / 2).GetTimeStep ();
+    }
+  Report ("Time * int64_t / int64_t", clock () - start, sum);
+}
+
+static class TimePerformanceTestSuite : public TestSuite
+{
+public:
+  TimePerformanceTestSuite ()
+    : TestSuite ("time-perf", PERFORMANCE)
+  {
+    AddTestCase (new TimeConversionPerformanceTestCase (), TestCase::QUICK);
+  }
+} g_timePerformanceTestSuite;
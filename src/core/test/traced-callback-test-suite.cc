@@ -16,6 +16,12 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
 #include "ns3/test.h"
 #include "ns3/traced-callback.h"
 #include "ns3/unused.h"
@@ -113,6 +119,102 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class ContextTracedCallbackTestCase : public TestCase
+{
+public:
+  ContextTracedCallbackTestCase ();
+  virtual ~ContextTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void CbContext (std::string context, uint8_t a, double b);
+  void CbConnect (uint8_t a, double b);
+  void CbCount (uint8_t a, double b);
+
+  std::vector<std::string> m_contexts;
+  TracedCallback<uint8_t, double> *m_trace;
+  uint32_t m_count;
+};
+
+ContextTracedCallbackTestCase::ContextTracedCallbackTestCase ()
+  : TestCase ("Check TracedCallback with contexts and changes while invoked")
+{
+}
+
+void
+ContextTracedCallbackTestCase::CbContext (std::string context, uint8_t a, double b)
+{
+  NS_UNUSED (a);
+  NS_UNUSED (b);
+  m_contexts.push_back (context);
+}
+
+void
+ContextTracedCallbackTestCase::CbConnect (uint8_t a, double b)
+{
+  NS_UNUSED (a);
+  NS_UNUSED (b);
+  m_trace->ConnectWithoutContext (MakeCallback (&ContextTracedCallbackTestCase::CbCount, this));
+}
+
+void
+ContextTracedCallbackTestCase::CbCount (uint8_t a, double b)
+{
+  NS_UNUSED (a);
+  NS_UNUSED (b);
+  m_count++;
+}
+
+void
+ContextTracedCallbackTestCase::DoRun (void)
+{
+  TracedCallback<uint8_t, double> trace;
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "New TracedCallback not empty");
+
+  //
+  // The same callback connected with two contexts is invoked with each.
+  //
+  trace.Connect (MakeCallback (&ContextTracedCallbackTestCase::CbContext, this), "/a");
+  trace.Connect (MakeCallback (&ContextTracedCallbackTestCase::CbContext, this), "/b");
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), false, "Connected TracedCallback empty");
+  trace (1, 2);
+  NS_TEST_ASSERT_MSG_EQ (m_contexts.size (), 2, "Context callbacks not called");
+  NS_TEST_ASSERT_MSG_EQ (m_contexts[0], "/a", "Wrong first context");
+  NS_TEST_ASSERT_MSG_EQ (m_contexts[1], "/b", "Wrong second context");
+
+  //
+  // Disconnecting one context leaves the other.
+  //
+  trace.Disconnect (MakeCallback (&ContextTracedCallbackTestCase::CbContext, this), "/a");
+  m_contexts.clear ();
+  trace (1, 2);
+  NS_TEST_ASSERT_MSG_EQ (m_contexts.size (), 1, "Wrong number of context callbacks");
+  NS_TEST_ASSERT_MSG_EQ (m_contexts[0], "/b", "Wrong remaining context");
+
+  //
+  // Disconnecting without a context does not remove a context callback.
+  //
+  trace.DisconnectWithoutContext (MakeCallback (&ContextTracedCallbackTestCase::CbContext, this));
+  trace.Disconnect (MakeCallback (&ContextTracedCallbackTestCase::CbContext, this), "/b");
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "Disconnected TracedCallback not empty");
+  m_contexts.clear ();
+  trace (1, 2);
+  NS_TEST_ASSERT_MSG_EQ (m_contexts.size (), 0, "Context callback unexpectedly called");
+
+  //
+  // A sink connected while the chain is invoked is invoked too.
+  //
+  m_trace = &trace;
+  m_count = 0;
+  trace.ConnectWithoutContext (MakeCallback (&ContextTracedCallbackTestCase::CbConnect, this));
+  trace (1, 2);
+  NS_TEST_ASSERT_MSG_EQ (m_count, 1, "Sink connected while invoked not called");
+  trace.DisconnectWithoutContext (MakeCallback (&ContextTracedCallbackTestCase::CbConnect, this));
+  trace (1, 2);
+  NS_TEST_ASSERT_MSG_EQ (m_count, 2, "Sink connected while invoked called twice");
+}
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -123,6 +225,113 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new ContextTracedCallbackTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
+
+
+class TracedCallbackPerformanceTestCase : public TestCase
+{
+public:
+  TracedCallbackPerformanceTestCase ();
+  virtual ~TracedCallbackPerformanceTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Fire a trace with a number of sinks connected.
+   * \param [in] sinks The number of sinks to connect.
+   * \param [in] context Whether to connect the sinks with a context.
+   */
+  void Measure (uint32_t sinks, bool context);
+  void Sink (uint32_t a, double b);
+  void ContextSink (std::string context, uint32_t a, double b);
+
+  enum { REPETITIONS = 10000000 };
+  uint64_t m_sum;
+};
+
+TracedCallbackPerformanceTestCase::TracedCallbackPerformanceTestCase ()
+  : TestCase ("Measure the TracedCallback invocation throughput")
+{
+}
+
+void
+TracedCallbackPerformanceTestCase::Sink (uint32_t a, double b)
+{
+  NS_UNUSED (b);
+  m_sum += a;
+}
+
+void
+TracedCallbackPerformanceTestCase::ContextSink (std::string context, uint32_t a, double b)
+{
+  NS_UNUSED (context);
+  NS_UNUSED (b);
+  m_sum += a;
+}
+
+void
+TracedCallbackPerformanceTestCase::Measure (uint32_t sinks, bool context)
+{
+  TracedCallback<uint32_t, double> trace;
+  for (uint32_t i = 0; i < sinks; ++i)
+    {
+      if (context)
+        {
+          trace.Connect (MakeCallback (&TracedCallbackPerformanceTestCase::ContextSink, this),
+                         "/NodeList/0/DeviceList/0/$ns3::WifiNetDevice/Phy/PhyTxBegin");
+        }
+      else
+        {
+          trace.ConnectWithoutContext (MakeCallback (&TracedCallbackPerformanceTestCase::Sink, this));
+        }
+    }
+
+  m_sum = 0;
+  clock_t start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      trace (i, 1.0);
+    }
+  clock_t delta = clock () - start;
+
+  double per = 1E9 * double (delta) / (double (REPETITIONS) * double (CLOCKS_PER_SEC));
+  std::cout << GetParent ()->GetName () << " sinks: " << sinks
+            << (context ? " with context   " : " without context")
+            << " ticks: " << std::setw (8) << delta
+            << "  per: " << std::setw (8) << per << " ns/invocation"
+            << "  (" << m_sum << ")" << std::endl;
+  NS_TEST_EXPECT_MSG_EQ (m_sum, uint64_t (sinks) * (uint64_t (REPETITIONS) * (REPETITIONS - 1) / 2),
+                         "Sinks not all invoked");
+}
+
+void
+TracedCallbackPerformanceTestCase::DoRun (void)
+{
+  const uint32_t sinks[] = { 0, 1, 4 };
+  for (std::size_t i = 0; i < sizeof (sinks) / sizeof (sinks[0]); ++i)
+    {
+      Measure (sinks[i], false);
+      if (sinks[i] != 0)
+        {
+          Measure (sinks[i], true);
+        }
+    }
+}
+
+class TracedCallbackPerformanceTestSuite : public TestSuite
+{
+public:
+  TracedCallbackPerformanceTestSuite ();
+};
+
+TracedCallbackPerformanceTestSuite::TracedCallbackPerformanceTestSuite ()
+  : TestSuite ("traced-callback-perf", PERFORMANCE)
+{
+  AddTestCase (new TracedCallbackPerformanceTestCase, TestCase::QUICK);
+}
+
+static TracedCallbackPerformanceTestSuite tracedCallbackPerformanceTestSuite;
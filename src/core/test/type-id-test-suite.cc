@@ -325,6 +325,88 @@ DeprecatedAttributeTestCase::DoRun (void)
        << endl;
 }
 
+
+//----------------------------
+//
+// Inherited Attribute lookup test
+
+class DerivedAttribute : public DeprecatedAttribute
+{
+private:
+  int m_derived;
+
+public:
+  DerivedAttribute () : m_derived (0) { NS_UNUSED (m_derived); };
+  virtual ~DerivedAttribute () { };
+
+  // Register a type with an Attribute, deriving from a type with others
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("DerivedAttribute")
+      .SetParent<DeprecatedAttribute> ()
+      .AddAttribute ("derived",
+                     "the derived Attribute",
+                     IntegerValue (2),
+                     MakeIntegerAccessor (&DerivedAttribute::m_derived),
+                     MakeIntegerChecker<int> ());
+    return tid;
+  }
+
+};
+
+
+class InheritedLookupTestCase : public TestCase
+{
+public:
+  InheritedLookupTestCase ();
+  virtual ~InheritedLookupTestCase ();
+private:
+  virtual void DoRun (void);
+
+};
+
+InheritedLookupTestCase::InheritedLookupTestCase ()
+  : TestCase ("Check Attribute and TraceSource lookups through the parents")
+{
+}
+
+InheritedLookupTestCase::~InheritedLookupTestCase ()
+{
+}
+
+void
+InheritedLookupTestCase::DoRun (void)
+{
+  TypeId tid = DerivedAttribute::GetTypeId ();
+
+  struct TypeId::AttributeInformation ainfo;
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName ("derived", &ainfo), true,
+                         "lookup own attribute");
+  NS_TEST_ASSERT_MSG_EQ (ainfo.name, "derived", "bad own attribute");
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName ("attribute", &ainfo), true,
+                         "lookup inherited attribute");
+  NS_TEST_ASSERT_MSG_EQ (ainfo.name, "attribute", "bad inherited attribute");
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName ("missing", &ainfo), false,
+                         "lookup missing attribute");
+  NS_TEST_ASSERT_MSG_EQ (DeprecatedAttribute::GetTypeId ().LookupAttributeByName ("derived", &ainfo), false,
+                         "lookup derived attribute from the parent");
+
+  struct TypeId::TraceSourceInformation tinfo;
+  Ptr<const TraceSourceAccessor> acc;
+  acc = tid.LookupTraceSourceByName ("trace", &tinfo);
+  NS_TEST_ASSERT_MSG_NE (acc, 0, "lookup inherited trace source");
+  NS_TEST_ASSERT_MSG_EQ (tinfo.name, "trace", "bad inherited trace source");
+  acc = tid.LookupTraceSourceByName ("missing", &tinfo);
+  NS_TEST_ASSERT_MSG_EQ (acc, 0, "lookup missing trace source");
+
+  TypeId found;
+  NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByNameFailSafe ("DerivedAttribute", &found), true,
+                         "lookup type by name");
+  NS_TEST_ASSERT_MSG_EQ (found, tid, "bad type found by name");
+  NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByNameFailSafe ("MissingAttribute", &found), false,
+                         "lookup missing type by name");
+}
+
   
 //----------------------------
 //
@@ -338,7 +420,8 @@ public:
 private:
   void DoRun (void);
   void DoSetup (void);
-  void Report (const std::string how, const uint32_t delta) const ;
+  void Report (const std::string how, const uint32_t delta,
+               const double lookups) const ;
 
   enum { REPETITIONS = 100000 };
 };
@@ -370,7 +453,7 @@ LookupTimeTestCase::DoRun (void)
         }
   }
   int stop = clock ();
-  Report ("name", stop - start);
+  Report ("name", stop - start, nids * REPETITIONS);
 
   start = clock ();
   for (uint32_t j = 0; j < REPETITIONS; ++j)
@@ -382,8 +465,65 @@ LookupTimeTestCase::DoRun (void)
         }
   }
   stop = clock ();
-  Report ("hash", stop - start);
-  
+  Report ("hash", stop - start, nids * REPETITIONS);
+
+  // Look up every Attribute and TraceSource, from the types
+  // which register them, and from their derived types.
+  std::vector<std::pair<TypeId, std::string> > attributes;
+  std::vector<std::pair<TypeId, std::string> > sources;
+  for (uint16_t i = 0; i < nids; ++i)
+    {
+      const TypeId tid = TypeId::GetRegistered (i);
+      TypeId owner = tid;
+      while (true)
+        {
+          for (std::size_t k = 0; k < owner.GetAttributeN (); ++k)
+            {
+              if (owner.GetAttribute (k).supportLevel == TypeId::SUPPORTED)
+                {
+                  attributes.push_back (std::make_pair (tid, owner.GetAttribute (k).name));
+                }
+            }
+          for (std::size_t k = 0; k < owner.GetTraceSourceN (); ++k)
+            {
+              if (owner.GetTraceSource (k).supportLevel == TypeId::SUPPORTED)
+                {
+                  sources.push_back (std::make_pair (tid, owner.GetTraceSource (k).name));
+                }
+            }
+          TypeId parent = owner.GetParent ();
+          if (parent == owner || parent.GetUid () == 0)
+            {
+              break;
+            }
+          owner = parent;
+        }
+    }
+  const uint32_t reps = REPETITIONS / 100;
+
+  struct TypeId::AttributeInformation ainfo;
+  start = clock ();
+  for (uint32_t j = 0; j < reps; ++j)
+    {
+      for (std::size_t i = 0; i < attributes.size (); ++i)
+        {
+          attributes[i].first.LookupAttributeByName (attributes[i].second, &ainfo);
+        }
+    }
+  stop = clock ();
+  Report ("attribute name", stop - start, double (attributes.size ()) * reps);
+
+  struct TypeId::TraceSourceInformation tinfo;
+  start = clock ();
+  for (uint32_t j = 0; j < reps; ++j)
+    {
+      for (std::size_t i = 0; i < sources.size (); ++i)
+        {
+          sources[i].first.LookupTraceSourceByName (sources[i].second, &tinfo);
+        }
+    }
+  stop = clock ();
+  Report ("trace source name", stop - start, double (sources.size ()) * reps);
 }
 
 void
@@ -399,12 +539,10 @@ LookupTimeTestCase::DoSetup (void)
 
 void
 LookupTimeTestCase::Report (const std::string how,
-                            const uint32_t    delta) const
+                            const uint32_t    delta,
+                            const double      lookups) const
 {
-  double nids = TypeId::GetRegisteredN ();
-  double reps = nids * REPETITIONS;
-  
-  double per = 1E6 * double(delta) / (reps * double(CLOCKS_PER_SEC));
+  double per = 1E6 * double(delta) / (lookups * double(CLOCKS_PER_SEC));
   
   cout << suite << "Lookup time: by " << how << ": "
        << "ticks: " << delta
@@ -437,6 +575,7 @@ TypeIdTestSuite::TypeIdTestSuite ()
   AddTestCase (new UniqueTypeIdTestCase, QUICK);
   AddTestCase (new CollisionTestCase, QUICK);
   AddTestCase (new DeprecatedAttributeTestCase, QUICK);
+  AddTestCase (new InheritedLookupTestCase, QUICK);
 }
 
 static TypeIdTestSuite g_TypeIdTestSuite;  
@@ -224,18 +224,23 @@ CsmaChannel::TransmitEnd ()
 
   std::vector<CsmaDeviceRec>::iterator it;
   uint32_t devId = 0;
+  Simulator::ContextEvents receptions;
+  receptions.reserve (m_deviceList.size ());
   for (it = m_deviceList.begin (); it < m_deviceList.end (); it++)
     {
       if (it->IsActive ())
         {
           // schedule reception events
-          Simulator::ScheduleWithContext (it->devicePtr->GetNode ()->GetId (),
-                                          m_delay,
-                                          &CsmaNetDevice::Receive, it->devicePtr,
-                                          m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
+          Simulator::ContextEvent reception;
+          reception.context = it->devicePtr->GetNode ()->GetId ();
+          reception.delay = m_delay;
+          reception.event = MakeEvent (&CsmaNetDevice::Receive, it->devicePtr,
+                                       m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
+          receptions.push_back (reception);
         }
       devId++;
     }
+  Simulator::ScheduleWithContextBatch (receptions);
 
   // also schedule for the tx side to go back to IDLE
   Simulator::Schedule (m_delay, &CsmaChannel::PropagationCompleteEvent,
@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * Benchmark of the packets crossing ranks in a distributed simulation.
+ *
+ * One node is created on each rank, and the nodes are connected in a
+ * line by point-to-point links.  Each node sends raw packets on all its
+ * links at the link data rate, so that all the packets are received
+ * on another rank.  At the end, rank 0 prints the number of packets
+ * which crossed ranks, and the rate at which they were processed, in
+ * packets per wall-clock second.
+ *
+ * Run with at least 2 ranks:
+ *
+ *   mpirun -np 2 ./waf --run "distributed-packet-rate --size=1000 --time=0.1"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/point-to-point-helper.h"
+
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+#include <iomanip>
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DistributedPacketRate");
+
+/** Number of packets received on this rank. */
+static uint64_t g_received = 0;
+
+/**
+ * Count a received packet.
+ * \param device The receiving device.
+ * \param packet The packet.
+ * \param protocol The protocol number.
+ * \param from The sender address.
+ * \returns \c true.
+ */
+static bool
+Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  g_received++;
+  return true;
+}
+
+/**
+ * Send a packet, and schedule the next one.
+ * \param device The sending device.
+ * \param size The packet size.
+ * \param interval The time between packets.
+ * \param stop The time of the last packet.
+ */
+static void
+Send (Ptr<NetDevice> device, uint32_t size, Time interval, Time stop)
+{
+  device->Send (Create<Packet> (size), device->GetBroadcast (), 0x0800);
+  if (Simulator::Now () + interval < stop)
+    {
+      Simulator::Schedule (interval, &Send, device, size, interval, stop);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+#ifdef NS3_MPI
+
+  bool nullmsg = false;
+  uint32_t size = 1000;
+  std::string rate = "10Gbps";
+  Time delay = MicroSeconds (10);
+  Time stop = Seconds (0.1);
+
+  CommandLine cmd;
+  cmd.AddValue ("nullmsg", "Enable the use of null-message synchronization", nullmsg);
+  cmd.AddValue ("size", "Packet size, in bytes", size);
+  cmd.AddValue ("rate", "Link data rate", rate);
+  cmd.AddValue ("delay", "Link delay", delay);
+  cmd.AddValue ("time", "Simulated time", stop);
+  cmd.Parse (argc, argv);
+
+  if (nullmsg)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType",
+                         StringValue ("ns3::NullMessageSimulatorImpl"));
+    }
+  else
+    {
+      GlobalValue::Bind ("SimulatorImplementationType",
+                         StringValue ("ns3::DistributedSimulatorImpl"));
+    }
+
+  MpiInterface::Enable (&argc, &argv);
+
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  uint32_t systemCount = MpiInterface::GetSize ();
+
+  if (systemCount < 2)
+    {
+      std::cout << "This simulation requires at least 2 logical processors." << std::endl;
+      MpiInterface::Disable ();
+      return 1;
+    }
+
+  // One node per rank, connected in a line.
+  NodeContainer nodes;
+  for (uint32_t i = 0; i < systemCount; ++i)
+    {
+      nodes.Add (CreateObject<Node> (i));
+    }
+
+  PointToPointHelper link;
+  link.SetDeviceAttribute ("DataRate", StringValue (rate));
+  link.SetChannelAttribute ("Delay", TimeValue (delay));
+  link.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("1000p"));
+  for (uint32_t i = 0; i + 1 < systemCount; ++i)
+    {
+      link.Install (nodes.Get (i), nodes.Get (i + 1));
+    }
+
+  // Saturate the links of the local node, in both directions.
+  Ptr<Node> node = nodes.Get (systemId);
+  Time interval = DataRate (rate).CalculateBytesTxTime (size + 2);
+  for (uint32_t i = 0; i < node->GetNDevices (); ++i)
+    {
+      Ptr<NetDevice> device = node->GetDevice (i);
+      device->SetReceiveCallback (MakeCallback (&Receive));
+      Simulator::ScheduleWithContext (node->GetId (), Seconds (0),
+                                      &Send, device, size, interval, stop);
+    }
+
+  Simulator::Stop (stop + Seconds (1));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  uint64_t total = 0;
+  MPI_Reduce (&g_received, &total, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+  int64_t slowest = 0;
+  MPI_Reduce (&elapsed, &slowest, 1, MPI_INT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+
+  if (systemId == 0)
+    {
+      std::cout << "Ranks:           " << systemCount << std::endl
+                << "Packet size:     " << size << " bytes" << std::endl
+                << "Packets crossed: " << total << std::endl
+                << "Wall clock:      " << slowest << " ms" << std::endl;
+      if (slowest > 0)
+        {
+          std::cout << "Packet rate:     " << std::fixed << std::setprecision (0)
+                    << total * 1000.0 / slowest << " packets/s" << std::endl;
+        }
+    }
+
+  Simulator::Destroy ();
+  MpiInterface::Disable ();
+  return 0;
+
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
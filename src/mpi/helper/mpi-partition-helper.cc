@@ -0,0 +1,515 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mpi-partition-helper.h"
+
+#include "ns3/channel.h"
+#include "ns3/channel-list.h"
+#include "ns3/event-profiler.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <set>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MpiPartitionHelper");
+
+namespace {
+
+/**
+ * Find the representative of a node in a union-find forest, with path
+ * halving.
+ * \param parents The parent of each node.
+ * \param node The node.
+ * \return The representative of the node.
+ */
+uint32_t
+FindRoot (std::vector<uint32_t> &parents, uint32_t node)
+{
+  while (parents[node] != node)
+    {
+      parents[node] = parents[parents[node]];
+      node = parents[node];
+    }
+  return node;
+}
+
+/** Order indices by decreasing value. */
+class DecreasingValue
+{
+public:
+  /**
+   * Constructor.
+   * \param values The values.
+   */
+  DecreasingValue (const std::vector<double> &values)
+    : m_values (values)
+  {
+  }
+  /**
+   * \param a An index.
+   * \param b Another index.
+   * \return true if the value of \p a is larger than the value of \p b.
+   */
+  bool operator () (uint32_t a, uint32_t b) const
+  {
+    return m_values[a] > m_values[b];
+  }
+private:
+  const std::vector<double> &m_values;  //!< The values.
+};
+
+} // unnamed namespace
+
+MpiPartitionHelper::MpiPartitionHelper ()
+  : m_imbalance (0.1),
+    m_parts (1),
+    m_lookahead (Simulator::GetMaximumSimulationTime ()),
+    m_cutSize (0)
+{
+}
+
+void
+MpiPartitionHelper::SetImbalance (double imbalance)
+{
+  NS_ASSERT (imbalance >= 0);
+  m_imbalance = imbalance;
+}
+
+void
+MpiPartitionHelper::Profile (Time duration)
+{
+  NS_LOG_FUNCTION (this << duration);
+
+  EventProfiler *profiler = EventProfiler::Get ();
+  profiler->Reset ();
+  profiler->Enable ();
+  Simulator::Stop (duration);
+  Simulator::Run ();
+  profiler->Disable ();
+
+  ReadTopology ();
+  for (uint32_t i = 0; i < m_loads.size (); ++i)
+    {
+      m_loads[i] += profiler->GetContextEventCount (i);
+    }
+  if (profiler->GetEventCount () == 0)
+    {
+      NS_LOG_WARN ("No event profiled, the default simulator implementation must be used");
+    }
+  profiler->Reset ();
+}
+
+void
+MpiPartitionHelper::ReadTopology (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_loads.assign (NodeList::GetNNodes (), 1);
+  m_links.clear ();
+
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); ++i)
+    {
+      Ptr<Channel> channel = *i;
+      std::vector<uint32_t> nodes;
+      bool pointToPoint = true;
+      for (std::size_t j = 0; j < channel->GetNDevices (); ++j)
+        {
+          Ptr<NetDevice> device = channel->GetDevice (j);
+          if (device == 0 || device->GetNode () == 0)
+            {
+              continue;
+            }
+          nodes.push_back (device->GetNode ()->GetId ());
+          pointToPoint = pointToPoint && device->IsPointToPoint ();
+        }
+      if (nodes.size () < 2)
+        {
+          continue;
+        }
+
+      TimeValue delay;
+      if (nodes.size () == 2 && pointToPoint
+          && channel->GetAttributeFailSafe ("Delay", delay))
+        {
+          AddLink (nodes[0], nodes[1], delay.Get ());
+        }
+      else
+        {
+          // Only point-to-point channels can be split between tasks.
+          for (std::size_t j = 1; j < nodes.size (); ++j)
+            {
+              AddLink (nodes[0], nodes[j], Time (0));
+            }
+        }
+    }
+}
+
+void
+MpiPartitionHelper::SetNodeLoad (uint32_t node, double load)
+{
+  NS_LOG_FUNCTION (this << node << load);
+  if (node >= m_loads.size ())
+    {
+      m_loads.resize (node + 1, 1);
+    }
+  m_loads[node] = load;
+}
+
+void
+MpiPartitionHelper::AddLink (uint32_t a, uint32_t b, Time delay)
+{
+  NS_LOG_FUNCTION (this << a << b << delay);
+  uint32_t last = std::max (a, b);
+  if (last >= m_loads.size ())
+    {
+      m_loads.resize (last + 1, 1);
+    }
+  Link link;
+  link.a = a;
+  link.b = b;
+  link.delay = delay;
+  m_links.push_back (link);
+}
+
+uint32_t
+MpiPartitionHelper::Cluster (Time threshold, std::vector<uint32_t> &clusters) const
+{
+  std::vector<uint32_t> parents (m_loads.size ());
+  for (uint32_t i = 0; i < parents.size (); ++i)
+    {
+      parents[i] = i;
+    }
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      if (i->delay < threshold)
+        {
+          uint32_t a = FindRoot (parents, i->a);
+          uint32_t b = FindRoot (parents, i->b);
+          parents[std::max (a, b)] = std::min (a, b);
+        }
+    }
+
+  // Number the clusters in the order of their first node.
+  std::map<uint32_t, uint32_t> numbers;
+  clusters.resize (m_loads.size ());
+  for (uint32_t i = 0; i < clusters.size (); ++i)
+    {
+      uint32_t root = FindRoot (parents, i);
+      std::map<uint32_t, uint32_t>::iterator number = numbers.find (root);
+      if (number == numbers.end ())
+        {
+          number = numbers.insert (std::make_pair (root, numbers.size ())).first;
+        }
+      clusters[i] = number->second;
+    }
+  return numbers.size ();
+}
+
+double
+MpiPartitionHelper::Assign (uint32_t count, const std::vector<uint32_t> &clusters,
+                            Time threshold, std::vector<uint32_t> &parts) const
+{
+  // Cluster loads, and number of links between clusters.
+  std::vector<double> loads (count, 0);
+  double total = 0;
+  for (uint32_t i = 0; i < clusters.size (); ++i)
+    {
+      loads[clusters[i]] += m_loads[i];
+      total += m_loads[i];
+    }
+  std::vector<std::map<uint32_t, uint32_t> > neighbors (count);
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      uint32_t a = clusters[i->a];
+      uint32_t b = clusters[i->b];
+      if (a != b)
+        {
+          NS_ASSERT (i->delay >= threshold);
+          neighbors[a][b]++;
+          neighbors[b][a]++;
+        }
+    }
+  double capacity = (1 + m_imbalance) * total / m_parts;
+
+  // Place the clusters, largest first, in the part they have the most
+  // links with among those which have room, or else the least loaded.
+  std::vector<uint32_t> order (count);
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      order[i] = i;
+    }
+  std::stable_sort (order.begin (), order.end (), DecreasingValue (loads));
+
+  const uint32_t NONE = 0xffffffff;
+  parts.assign (count, NONE);
+  std::vector<double> partLoads (m_parts, 0);
+  for (std::vector<uint32_t>::const_iterator i = order.begin (); i != order.end (); ++i)
+    {
+      std::vector<uint32_t> links (m_parts, 0);
+      for (std::map<uint32_t, uint32_t>::const_iterator j = neighbors[*i].begin ();
+           j != neighbors[*i].end (); ++j)
+        {
+          if (parts[j->first] != NONE)
+            {
+              links[parts[j->first]] += j->second;
+            }
+        }
+      uint32_t best = NONE;
+      uint32_t lightest = 0;
+      for (uint32_t p = 0; p < m_parts; ++p)
+        {
+          if (partLoads[p] < partLoads[lightest])
+            {
+              lightest = p;
+            }
+          if (partLoads[p] + loads[*i] <= capacity
+              && (best == NONE
+                  || links[p] > links[best]
+                  || (links[p] == links[best] && partLoads[p] < partLoads[best])))
+            {
+              best = p;
+            }
+        }
+      if (best == NONE)
+        {
+          best = lightest;
+        }
+      parts[*i] = best;
+      partLoads[best] += loads[*i];
+    }
+
+  // Refine: move the clusters which have more links with another part,
+  // as long as it has room.
+  for (uint32_t pass = 0; pass < 8; ++pass)
+    {
+      bool moved = false;
+      for (uint32_t i = 0; i < count; ++i)
+        {
+          std::vector<uint32_t> links (m_parts, 0);
+          for (std::map<uint32_t, uint32_t>::const_iterator j = neighbors[i].begin ();
+               j != neighbors[i].end (); ++j)
+            {
+              links[parts[j->first]] += j->second;
+            }
+          uint32_t best = parts[i];
+          for (uint32_t p = 0; p < m_parts; ++p)
+            {
+              if (links[p] > links[best] && partLoads[p] + loads[i] <= capacity)
+                {
+                  best = p;
+                }
+            }
+          if (best != parts[i])
+            {
+              partLoads[parts[i]] -= loads[i];
+              partLoads[best] += loads[i];
+              parts[i] = best;
+              moved = true;
+            }
+        }
+      if (!moved)
+        {
+          break;
+        }
+    }
+
+  return *std::max_element (partLoads.begin (), partLoads.end ());
+}
+
+void
+MpiPartitionHelper::Partition (uint32_t parts)
+{
+  NS_LOG_FUNCTION (this << parts);
+  NS_ASSERT (parts > 0);
+
+  m_parts = parts;
+  double total = 0;
+  for (std::vector<double>::const_iterator i = m_loads.begin (); i != m_loads.end (); ++i)
+    {
+      total += *i;
+    }
+  double capacity = (1 + m_imbalance) * total / m_parts;
+
+  // Try the delay thresholds from the largest, which gives the largest
+  // lookahead, down to the smallest, which only keeps together the
+  // nodes which cannot be split, until the load can be balanced.
+  std::set<Time> delays;
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      if (i->delay.IsStrictlyPositive ())
+        {
+          delays.insert (i->delay);
+        }
+    }
+  std::vector<Time> thresholds (delays.rbegin (), delays.rend ());
+  thresholds.push_back (TimeStep (1));
+
+  std::vector<uint32_t> clusters;
+  std::vector<uint32_t> clusterParts;
+  bool balanced = false;
+  for (std::vector<Time>::const_iterator threshold = thresholds.begin ();
+       threshold != thresholds.end (); ++threshold)
+    {
+      uint32_t count = Cluster (*threshold, clusters);
+      double maxLoad = Assign (count, clusters, *threshold, clusterParts);
+      NS_LOG_LOGIC ("Threshold " << *threshold << ": " << count << " clusters, "
+                    "maximum load " << maxLoad << " of " << capacity);
+      if (maxLoad <= capacity)
+        {
+          balanced = true;
+          break;
+        }
+    }
+  if (!balanced)
+    {
+      NS_LOG_WARN ("Cannot balance the load of " << m_parts << " tasks within "
+                   << m_imbalance * 100 << "%");
+    }
+
+  m_systemIds.resize (m_loads.size ());
+  for (uint32_t i = 0; i < m_systemIds.size (); ++i)
+    {
+      m_systemIds[i] = clusterParts[clusters[i]];
+    }
+  Evaluate ();
+}
+
+void
+MpiPartitionHelper::Evaluate (void)
+{
+  m_lookahead = Simulator::GetMaximumSimulationTime ();
+  m_cutSize = 0;
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      if (GetSystemId (i->a) != GetSystemId (i->b))
+        {
+          m_lookahead = Min (m_lookahead, i->delay);
+          m_cutSize++;
+        }
+    }
+}
+
+uint32_t
+MpiPartitionHelper::GetSystemId (uint32_t node) const
+{
+  if (node >= m_systemIds.size ())
+    {
+      NS_FATAL_ERROR ("Node " << node << " is not in the partition of "
+                      << m_systemIds.size () << " nodes");
+    }
+  return m_systemIds[node];
+}
+
+Time
+MpiPartitionHelper::GetLookahead (void) const
+{
+  return m_lookahead;
+}
+
+uint32_t
+MpiPartitionHelper::GetCutSize (void) const
+{
+  return m_cutSize;
+}
+
+NodeContainer
+MpiPartitionHelper::Create (uint32_t n) const
+{
+  NS_LOG_FUNCTION (this << n);
+  NodeContainer nodes;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      nodes.Add (CreateObject<Node> (GetSystemId (NodeList::GetNNodes ())));
+    }
+  return nodes;
+}
+
+void
+MpiPartitionHelper::Write (std::string filename) const
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ofstream os (filename.c_str ());
+  if (!os)
+    {
+      NS_FATAL_ERROR ("Cannot open partition file " << filename);
+    }
+  os << "parts " << m_parts << std::endl;
+  os << "lookahead " << m_lookahead.GetTimeStep () << std::endl;
+  os << "cut " << m_cutSize << std::endl;
+  os << "nodes " << m_systemIds.size () << std::endl;
+  for (uint32_t i = 0; i < m_systemIds.size (); ++i)
+    {
+      os << i << " " << m_systemIds[i] << " " << m_loads[i] << std::endl;
+    }
+}
+
+void
+MpiPartitionHelper::Read (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ifstream is (filename.c_str ());
+  std::string key;
+  int64_t lookahead;
+  uint32_t count;
+  if (!(is >> key && key == "parts" && is >> m_parts
+        && is >> key && key == "lookahead" && is >> lookahead
+        && is >> key && key == "cut" && is >> m_cutSize
+        && is >> key && key == "nodes" && is >> count))
+    {
+      NS_FATAL_ERROR ("Invalid partition file " << filename);
+    }
+  m_lookahead = TimeStep (lookahead);
+  m_systemIds.resize (count);
+  m_loads.resize (count);
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      uint32_t node;
+      if (!(is >> node >> m_systemIds[i] >> m_loads[i]) || node != i
+          || m_systemIds[i] >= m_parts)
+        {
+          NS_FATAL_ERROR ("Invalid partition file " << filename);
+        }
+    }
+  m_links.clear ();
+}
+
+void
+MpiPartitionHelper::Print (std::ostream &os) const
+{
+  std::vector<double> loads (m_parts, 0);
+  std::vector<uint32_t> nodes (m_parts, 0);
+  for (uint32_t i = 0; i < m_systemIds.size (); ++i)
+    {
+      loads[m_systemIds[i]] += m_loads[i];
+      nodes[m_systemIds[i]]++;
+    }
+  for (uint32_t p = 0; p < m_parts; ++p)
+    {
+      os << "Task " << p << ": " << nodes[p] << " nodes, load " << loads[p] << std::endl;
+    }
+  os << "Cut links: " << m_cutSize << std::endl;
+  os << "Lookahead: " << m_lookahead.As (Time::S) << std::endl;
+}
+
+} // namespace ns3
@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MPI_PARTITION_HELPER_H
+#define NS3_MPI_PARTITION_HELPER_H
+
+#include "ns3/nstime.h"
+#include "ns3/node-container.h"
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Assign the nodes of a topology to the MPI tasks
+ *
+ * The helper reads the topology from the NodeList and the ChannelList,
+ * estimates the load of each node with a short profiling run of the
+ * topology, and partitions the nodes into balanced sets:
+ *
+ *  - only the channels with two point-to-point devices can be cut, the
+ *    nodes attached to any other channel are kept together;
+ *  - the lookahead, the minimum delay of the cut channels, is
+ *    maximized: the channels with a lower delay are not cut, as long as
+ *    the load of each task can be kept within the imbalance tolerance;
+ *  - then, the number of cut channels is minimized.
+ *
+ * The partition is applied by creating the nodes with Create(), which
+ * gives each node the system id assigned to its node id.  The
+ * point-to-point helpers then create a PointToPointRemoteChannel for
+ * each cut channel, as usual.
+ *
+ * The partition is typically computed by a sequential profiling run of
+ * the program, and loaded by the distributed runs, which must create
+ * the nodes in the same order:
+ *
+ * \code
+ *   if (profile)
+ *     {
+ *       NodeContainer nodes;
+ *       nodes.Create (100);
+ *       BuildTopology (nodes);
+ *       MpiPartitionHelper partition;
+ *       partition.Profile (Seconds (1));
+ *       partition.Partition (ranks);
+ *       partition.Write ("topology.partition");
+ *       Simulator::Destroy ();
+ *       return 0;
+ *     }
+ *
+ *   MpiInterface::Enable (&argc, &argv);
+ *   MpiPartitionHelper partition;
+ *   partition.Read ("topology.partition");
+ *   NodeContainer nodes = partition.Create (100);
+ *   BuildTopology (nodes);
+ * \endcode
+ *
+ * The load of a node is the number of events run in its context during
+ * the profiling run, plus one.  The profiling relies on the
+ * EventProfiler, so it must use the default simulator implementation.
+ */
+class MpiPartitionHelper
+{
+public:
+  MpiPartitionHelper ();
+
+  /**
+   * Set the load imbalance tolerance.  The load of each task is at most
+   * <tt>(1 + imbalance)</tt> times the mean load, if possible.
+   * \param imbalance The imbalance tolerance, 0.1 by default.
+   */
+  void SetImbalance (double imbalance);
+
+  /**
+   * Run the simulation for a short time, with the EventProfiler, to
+   * estimate the load of each node, and read the topology.
+   * \param duration The duration of the profiling run.
+   */
+  void Profile (Time duration);
+  /**
+   * Read the topology from the NodeList and the ChannelList.  The load
+   * of the nodes is reset to one.
+   */
+  void ReadTopology (void);
+
+  /**
+   * Set the load of a node.
+   * \param node The node id.
+   * \param load The load.
+   */
+  void SetNodeLoad (uint32_t node, double load);
+  /**
+   * Add a link between two nodes.
+   * \param a The id of the first node.
+   * \param b The id of the second node.
+   * \param delay The delay of the link, or zero if it cannot be cut.
+   */
+  void AddLink (uint32_t a, uint32_t b, Time delay);
+
+  /**
+   * Partition the nodes.
+   * \param parts The number of MPI tasks.
+   */
+  void Partition (uint32_t parts);
+
+  /**
+   * \param node The node id.
+   * \return The system id assigned to the node.
+   */
+  uint32_t GetSystemId (uint32_t node) const;
+  /**
+   * \return The lookahead of the partition: the minimum delay of the cut
+   *         links, or the maximum time if no link is cut.
+   */
+  Time GetLookahead (void) const;
+  /**
+   * \return The number of cut links.
+   */
+  uint32_t GetCutSize (void) const;
+
+  /**
+   * Create nodes, with the system ids assigned to their node ids.
+   * \param n The number of nodes to create.
+   * \return The nodes.
+   */
+  NodeContainer Create (uint32_t n) const;
+
+  /**
+   * Save the partition.
+   * \param filename The name of the file.
+   */
+  void Write (std::string filename) const;
+  /**
+   * Load a partition saved by Write().
+   * \param filename The name of the file.
+   */
+  void Read (std::string filename);
+  /**
+   * Print the load of each task, the cut size and the lookahead.
+   * \param os The output stream.
+   */
+  void Print (std::ostream &os) const;
+
+private:
+  /** A link between two nodes. */
+  struct Link
+  {
+    uint32_t a;   //!< The first node.
+    uint32_t b;   //!< The second node.
+    Time delay;   //!< The link delay.
+  };
+
+  /**
+   * Group the nodes joined by the links with a delay lower than a
+   * threshold.
+   * \param threshold The delay threshold.
+   * \param clusters The cluster of each node.
+   * \return The number of clusters.
+   */
+  uint32_t Cluster (Time threshold, std::vector<uint32_t> &clusters) const;
+  /**
+   * Assign clusters to parts, balancing the load and minimizing the
+   * number of links between parts.
+   * \param count The number of clusters.
+   * \param clusters The cluster of each node.
+   * \param threshold The delay threshold used to build the clusters.
+   * \param parts The part of each cluster.
+   * \return The load of the most loaded part.
+   */
+  double Assign (uint32_t count, const std::vector<uint32_t> &clusters,
+                 Time threshold, std::vector<uint32_t> &parts) const;
+  /** Update the lookahead and cut size of the partition. */
+  void Evaluate (void);
+
+  double m_imbalance;                   //!< The imbalance tolerance.
+  std::vector<double> m_loads;          //!< The load of each node.
+  std::vector<Link> m_links;            //!< The links.
+  uint32_t m_parts;                     //!< The number of parts.
+  std::vector<uint32_t> m_systemIds;    //!< The system id of each node.
+  Time m_lookahead;                     //!< The lookahead of the partition.
+  uint32_t m_cutSize;                   //!< The number of cut links.
+};
+
+} // namespace ns3
+
+#endif /* NS3_MPI_PARTITION_HELPER_H */
@@ -20,9 +20,9 @@
 // This object contains static methods that provide an easy interface
 // to the necessary MPI information.
 
+#include <cstring>
 #include <iostream>
 #include <iomanip>
-#include <list>
 
 #include "granted-time-window-mpi-interface.h"
 #include "mpi-receiver.h"
@@ -44,36 +44,98 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GrantedTimeWindowMpiInterface");
 
-SentBuffer::SentBuffer ()
+MpiBufferRing::MpiBufferRing ()
+  : m_buffers (0),
+    m_slotSize (0),
+    m_head (0),
+    m_count (0)
 {
-  m_buffer = 0;
-  m_request = 0;
 }
 
-SentBuffer::~SentBuffer ()
+void
+MpiBufferRing::Allocate (uint32_t slots, uint32_t slotSize)
 {
-  delete [] m_buffer;
+  NS_LOG_FUNCTION (this << slots << slotSize);
+  NS_ASSERT (m_buffers == 0 && slots > 0);
+
+#ifdef NS3_MPI
+  MPI_Alloc_mem (slots * slotSize, MPI_INFO_NULL, &m_buffers);
+  m_requests.resize (slots, MPI_REQUEST_NULL);
+#endif
+  m_slotSize = slotSize;
+  m_head = 0;
+  m_count = 0;
 }
 
-uint8_t*
-SentBuffer::GetBuffer ()
+void
+MpiBufferRing::Free ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_count == 0);
+
+#ifdef NS3_MPI
+  if (m_buffers != 0)
+    {
+      MPI_Free_mem (m_buffers);
+    }
+#endif
+  m_buffers = 0;
+  m_requests.clear ();
+}
+
+uint32_t
+MpiBufferRing::GetSlotSize () const
+{
+  return m_slotSize;
+}
+
+uint32_t
+MpiBufferRing::GetCount () const
 {
-  return m_buffer;
+  return m_count;
+}
+
+bool
+MpiBufferRing::IsFull () const
+{
+  return m_count == m_requests.size ();
+}
+
+uint32_t
+MpiBufferRing::Push ()
+{
+  NS_ASSERT (!IsFull ());
+  uint32_t slot = (m_head + m_count) % m_requests.size ();
+  m_count++;
+  return slot;
+}
+
+uint32_t
+MpiBufferRing::Front () const
+{
+  NS_ASSERT (m_count > 0);
+  return m_head;
 }
 
 void
-SentBuffer::SetBuffer (uint8_t* buffer)
+MpiBufferRing::Pop ()
 {
-  m_buffer = buffer;
+  NS_ASSERT (m_count > 0);
+  m_head = (m_head + 1) % m_requests.size ();
+  m_count--;
+}
+
+uint8_t*
+MpiBufferRing::GetBuffer (uint32_t slot)
+{
+  return m_buffers + slot * m_slotSize;
 }
 
-#ifdef NS3_MPI
 MPI_Request*
-SentBuffer::GetRequest ()
+MpiBufferRing::GetRequest (uint32_t slot)
 {
-  return &m_request;
+  return &m_requests[slot];
 }
-#endif
 
 uint32_t              GrantedTimeWindowMpiInterface::m_sid = 0;
 uint32_t              GrantedTimeWindowMpiInterface::m_size = 1;
@@ -81,12 +143,8 @@ bool                  GrantedTimeWindowMpiInterface::m_initialized = false;
 bool                  GrantedTimeWindowMpiInterface::m_enabled = false;
 uint32_t              GrantedTimeWindowMpiInterface::m_rxCount = 0;
 uint32_t              GrantedTimeWindowMpiInterface::m_txCount = 0;
-std::list<SentBuffer> GrantedTimeWindowMpiInterface::m_pendingTx;
-
-#ifdef NS3_MPI
-MPI_Request* GrantedTimeWindowMpiInterface::m_requests;
-char**       GrantedTimeWindowMpiInterface::m_pRxBuffers;
-#endif
+std::vector<MpiBufferRing> GrantedTimeWindowMpiInterface::m_rxRings;
+std::vector<MpiBufferRing> GrantedTimeWindowMpiInterface::m_txRings;
 
 TypeId 
 GrantedTimeWindowMpiInterface::GetTypeId (void)
@@ -104,14 +162,30 @@ GrantedTimeWindowMpiInterface::Destroy ()
   NS_LOG_FUNCTION (this);
 
 #ifdef NS3_MPI
-  for (uint32_t i = 0; i < GetSize (); ++i)
+  for (uint32_t i = 0; i < m_rxRings.size (); ++i)
     {
-      delete [] m_pRxBuffers[i];
+      MpiBufferRing &ring = m_rxRings[i];
+      while (ring.GetCount () > 0)
+        {
+          MPI_Cancel (ring.GetRequest (ring.Front ()));
+          MPI_Request_free (ring.GetRequest (ring.Front ()));
+          ring.Pop ();
+        }
+      ring.Free ();
     }
-  delete [] m_pRxBuffers;
-  delete [] m_requests;
-
-  m_pendingTx.clear ();
+  for (uint32_t i = 0; i < m_txRings.size (); ++i)
+    {
+      // All the packets were received, as the simulation is over.
+      MpiBufferRing &ring = m_txRings[i];
+      while (ring.GetCount () > 0)
+        {
+          MPI_Wait (ring.GetRequest (ring.Front ()), MPI_STATUS_IGNORE);
+          ring.Pop ();
+        }
+      ring.Free ();
+    }
+  m_rxRings.clear ();
+  m_txRings.clear ();
 #endif
 }
 
@@ -173,14 +247,24 @@ GrantedTimeWindowMpiInterface::Enable (int* pargc, char*** pargv)
   MPI_Comm_size (MPI_COMM_WORLD, reinterpret_cast <int *> (&m_size));
   m_enabled = true;
   m_initialized = true;
-  // Post a non-blocking receive for all peers
-  m_pRxBuffers = new char*[m_size];
-  m_requests = new MPI_Request[m_size];
-  for (uint32_t i = 0; i < GetSize (); ++i)
+  // Allocate the rings, and post the non-blocking receives for all peers
+  m_rxRings.resize (m_size);
+  m_txRings.resize (m_size);
+  for (uint32_t i = 0; i < m_size; ++i)
     {
-      m_pRxBuffers[i] = new char[MAX_MPI_MSG_SIZE];
-      MPI_Irecv (m_pRxBuffers[i], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
-                 MPI_COMM_WORLD, &m_requests[i]);
+      if (i == m_sid)
+        {
+          continue;
+        }
+      m_txRings[i].Allocate (MPI_TX_RING_SLOTS, MAX_MPI_MSG_SIZE);
+      MpiBufferRing &ring = m_rxRings[i];
+      ring.Allocate (MPI_RX_RING_SLOTS, MAX_MPI_MSG_SIZE);
+      while (!ring.IsFull ())
+        {
+          uint32_t slot = ring.Push ();
+          MPI_Irecv (ring.GetBuffer (slot), MAX_MPI_MSG_SIZE, MPI_CHAR, i, 0,
+                     MPI_COMM_WORLD, ring.GetRequest (slot));
+        }
     }
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
@@ -193,29 +277,36 @@ GrantedTimeWindowMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, ui
   NS_LOG_FUNCTION (this << p << rxTime.GetTimeStep () << node << dev);
 
 #ifdef NS3_MPI
-  SentBuffer sendBuf;
-  m_pendingTx.push_back (sendBuf);
-  std::list<SentBuffer>::reverse_iterator i = m_pendingTx.rbegin (); // Points to the last element
-
   uint32_t serializedSize = p->GetSerializedSize ();
-  uint8_t* buffer =  new uint8_t[serializedSize + 16];
-  i->SetBuffer (buffer);
-  // Add the time, dest node and dest device
-  uint64_t t = rxTime.GetInteger ();
-  uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
-  *pTime++ = t;
-  uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-  *pData++ = node;
-  *pData++ = dev;
-  // Serialize the packet
-  p->Serialize (reinterpret_cast<uint8_t *> (pData), serializedSize);
+  if (serializedSize + 16 > MAX_MPI_MSG_SIZE)
+    {
+      NS_FATAL_ERROR ("Packet of " << serializedSize << " bytes too large for an MPI message");
+    }
 
   // Find the system id for the destination node
   Ptr<Node> destNode = NodeList::GetNode (node);
   uint32_t nodeSysId = destNode->GetSystemId ();
 
-  MPI_Isend (reinterpret_cast<void *> (i->GetBuffer ()), serializedSize + 16, MPI_CHAR, nodeSysId,
-             0, MPI_COMM_WORLD, (i->GetRequest ()));
+  MpiBufferRing &ring = m_txRings[nodeSysId];
+  if (ring.IsFull ())
+    {
+      NS_LOG_LOGIC ("Send ring to " << nodeSysId << " full, waiting");
+      MPI_Wait (ring.GetRequest (ring.Front ()), MPI_STATUS_IGNORE);
+      ring.Pop ();
+    }
+  uint32_t slot = ring.Push ();
+  uint8_t* buffer = ring.GetBuffer (slot);
+
+  // Add the time, dest node and dest device
+  uint64_t t = rxTime.GetInteger ();
+  std::memcpy (buffer, &t, sizeof (t));
+  std::memcpy (buffer + 8, &node, sizeof (node));
+  std::memcpy (buffer + 12, &dev, sizeof (dev));
+  // Serialize the packet in place
+  p->Serialize (buffer + 16, serializedSize);
+
+  MPI_Isend (buffer, serializedSize + 16, MPI_CHAR, nodeSysId,
+             0, MPI_COMM_WORLD, ring.GetRequest (slot));
   m_txCount++;
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
@@ -228,58 +319,68 @@ GrantedTimeWindowMpiInterface::ReceiveMessages ()
   NS_LOG_FUNCTION_NOARGS ();
 
 #ifdef NS3_MPI
-  // Poll the non-block reads to see if data arrived
-  while (true)
+  // Poll the non-block reads of each peer, in the order they were
+  // posted, to see if data arrived
+  for (uint32_t peer = 0; peer < m_rxRings.size (); ++peer)
     {
-      int flag = 0;
-      int index = 0;
-      MPI_Status status;
-
-      MPI_Testany (MpiInterface::GetSize (), m_requests, &index, &flag, &status);
-      if (!flag)
+      MpiBufferRing &ring = m_rxRings[peer];
+      while (ring.GetCount () > 0)
         {
-          break;        // No more messages
-        }
-      int count;
-      MPI_Get_count (&status, MPI_CHAR, &count);
-      m_rxCount++; // Count this receive
+          uint32_t slot = ring.Front ();
+          int flag = 0;
+          MPI_Status status;
 
-      // Get the meta data first
-      uint64_t* pTime = reinterpret_cast<uint64_t *> (m_pRxBuffers[index]);
-      uint64_t time = *pTime++;
-      uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-      uint32_t node = *pData++;
-      uint32_t dev  = *pData++;
-
-      Time rxTime (time);
-
-      count -= sizeof (time) + sizeof (node) + sizeof (dev);
-
-      Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (pData), count, true);
-
-      // Find the correct node/device to schedule receive event
-      Ptr<Node> pNode = NodeList::GetNode (node);
-      Ptr<MpiReceiver> pMpiRec = 0;
-      uint32_t nDevices = pNode->GetNDevices ();
-      for (uint32_t i = 0; i < nDevices; ++i)
-        {
-          Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
-          if (pThisDev->GetIfIndex () == dev)
+          MPI_Test (ring.GetRequest (slot), &flag, &status);
+          if (!flag)
             {
-              pMpiRec = pThisDev->GetObject<MpiReceiver> ();
-              break;
+              break;        // No more messages from this peer
+            }
+          int count;
+          MPI_Get_count (&status, MPI_CHAR, &count);
+          m_rxCount++; // Count this receive
+
+          // Get the meta data first
+          const uint8_t* buffer = ring.GetBuffer (slot);
+          uint64_t time;
+          uint32_t node;
+          uint32_t dev;
+          std::memcpy (&time, buffer, sizeof (time));
+          std::memcpy (&node, buffer + 8, sizeof (node));
+          std::memcpy (&dev, buffer + 12, sizeof (dev));
+
+          Time rxTime (time);
+
+          count -= sizeof (time) + sizeof (node) + sizeof (dev);
+
+          // Deserialize the packet from the ring buffer
+          Ptr<Packet> p = Create<Packet> (buffer + 16, count, true);
+
+          // Find the correct node/device to schedule receive event
+          Ptr<Node> pNode = NodeList::GetNode (node);
+          Ptr<MpiReceiver> pMpiRec = 0;
+          uint32_t nDevices = pNode->GetNDevices ();
+          for (uint32_t i = 0; i < nDevices; ++i)
+            {
+              Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
+              if (pThisDev->GetIfIndex () == dev)
+                {
+                  pMpiRec = pThisDev->GetObject<MpiReceiver> ();
+                  break;
+                }
             }
-        }
 
-      NS_ASSERT (pNode && pMpiRec);
+          NS_ASSERT (pNode && pMpiRec);
 
-      // Schedule the rx event
-      Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
-                                      &MpiReceiver::Receive, pMpiRec, p);
+          // Schedule the rx event
+          Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
+                                          &MpiReceiver::Receive, pMpiRec, p);
 
-      // Re-queue the next read
-      MPI_Irecv (m_pRxBuffers[index], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
-                 MPI_COMM_WORLD, &m_requests[index]);
+          // Re-queue the next read, at the back of the ring
+          ring.Pop ();
+          slot = ring.Push ();
+          MPI_Irecv (ring.GetBuffer (slot), MAX_MPI_MSG_SIZE, MPI_CHAR, peer, 0,
+                     MPI_COMM_WORLD, ring.GetRequest (slot));
+        }
     }
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
@@ -292,17 +393,20 @@ GrantedTimeWindowMpiInterface::TestSendComplete ()
   NS_LOG_FUNCTION_NOARGS ();
 
 #ifdef NS3_MPI
-  std::list<SentBuffer>::iterator i = m_pendingTx.begin ();
-  while (i != m_pendingTx.end ())
+  // Release the slots of the sends which completed, oldest first
+  for (uint32_t peer = 0; peer < m_txRings.size (); ++peer)
     {
-      MPI_Status status;
-      int flag = 0;
-      MPI_Test (i->GetRequest (), &flag, &status);
-      std::list<SentBuffer>::iterator current = i; // Save current for erasing
-      i++;                                    // Advance to next
-      if (flag)
-        { // This message is complete
-          m_pendingTx.erase (current);
+      MpiBufferRing &ring = m_txRings[peer];
+      while (ring.GetCount () > 0)
+        {
+          int flag = 0;
+          MPI_Test (ring.GetRequest (ring.Front ()), &flag, MPI_STATUS_IGNORE);
+          if (!flag)
+            {
+              break;
+            }
+          // This message is complete
+          ring.Pop ();
         }
     }
 #else
@@ -24,7 +24,7 @@
 #define NS3_GRANTED_TIME_WINDOW_MPI_INTERFACE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
 
 #include "ns3/nstime.h"
 #include "ns3/buffer.h"
@@ -45,36 +45,91 @@ namespace ns3 {
  */
 const uint32_t MAX_MPI_MSG_SIZE = 2000;
 
+/**
+ * number of MPI message buffers in the send
+ * ring of each peer task
+ */
+const uint32_t MPI_TX_RING_SLOTS = 64;
+
+/**
+ * number of receives posted for each peer task; more
+ * posted receives slow down the MPI progress engine
+ */
+const uint32_t MPI_RX_RING_SLOTS = 8;
+
 /**
  * \ingroup mpi
  *
- * \brief Tracks non-blocking sends
+ * \brief Ring of MPI message buffers for one peer task
  *
- * This class is used to keep track of the asynchronous non-blocking
- * sends that have been posted.
+ * The buffers and their MPI requests are allocated once, when the MPI
+ * interface is enabled, with MPI_Alloc_mem so that the MPI library can
+ * register the memory with the network once and for all.  The slots
+ * are used in order: the send ring serializes the packets directly in
+ * the next free slot, and releases the slots as the sends complete; the
+ * receive ring keeps a receive posted in every slot, and processes the
+ * messages in the order they were received.
  */
-class SentBuffer
+class MpiBufferRing
 {
 public:
-  SentBuffer ();
-  ~SentBuffer ();
+  MpiBufferRing ();
 
   /**
-   * \return pointer to sent buffer
+   * Allocate the buffers.
+   * \param slots The number of buffers.
+   * \param slotSize The size of each buffer.
    */
-  uint8_t* GetBuffer ();
+  void Allocate (uint32_t slots, uint32_t slotSize);
   /**
-   * \param buffer pointer to sent buffer
+   * Free the buffers.  There must not be any pending request.
    */
-  void SetBuffer (uint8_t* buffer);
+  void Free ();
+
   /**
-   * \return MPI request
+   * \return the size of each buffer
    */
-  MPI_Request* GetRequest ();
+  uint32_t GetSlotSize () const;
+  /**
+   * \return the number of slots in use
+   */
+  uint32_t GetCount () const;
+  /**
+   * \return true if all the slots are in use
+   */
+  bool IsFull () const;
+
+  /**
+   * Take the next free slot.  The ring must not be full.
+   * \return index of the slot
+   */
+  uint32_t Push ();
+  /**
+   * \return index of the oldest slot in use
+   */
+  uint32_t Front () const;
+  /**
+   * Release the oldest slot in use.
+   */
+  void Pop ();
+
+  /**
+   * \param slot slot index
+   * \return pointer to the buffer of the slot
+   */
+  uint8_t* GetBuffer (uint32_t slot);
+  /**
+   * \param slot slot index
+   * \return MPI request of the slot
+   */
+  MPI_Request* GetRequest (uint32_t slot);
 
 private:
-  uint8_t* m_buffer;
-  MPI_Request m_request;
+  uint8_t* m_buffers;                   //!< The buffers, one after the other.
+  std::vector<MPI_Request> m_requests;  //!< The MPI request of each slot.
+  uint32_t m_slotSize;                  //!< The size of each buffer.
+  uint32_t m_head;                      //!< The index of the oldest slot in use.
+  uint32_t m_count;                     //!< The number of slots in use.
 };
 
 class Packet;
@@ -129,6 +184,10 @@ public:
    * \param dev destination device
    *
    * Serialize and send a packet to the specified node and net device
+   *
+   * The packet is serialized directly in the send ring of the task of
+   * the destination node.  If the ring is full, waits for the oldest
+   * send to complete.
    */
   virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
   /**
@@ -160,14 +219,11 @@ private:
   static bool     m_initialized;
   static bool     m_enabled;
 
-  // Pending non-blocking receives
-  static MPI_Request* m_requests;
-
-  // Data buffers for non-blocking reads
-  static char**   m_pRxBuffers;
+  // Buffers and requests of the non-blocking reads, by peer task
+  static std::vector<MpiBufferRing> m_rxRings;
 
-  // List of pending non-blocking sends
-  static std::list<SentBuffer> m_pendingTx;
+  // Buffers and requests of the non-blocking sends, by peer task
+  static std::vector<MpiBufferRing> m_txRings;
 };
 
 } // namespace ns3
@@ -37,6 +37,7 @@
 #include <mpi.h>
 #endif
 
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <list>
@@ -47,12 +48,56 @@ NS_LOG_COMPONENT_DEFINE ("NullMessageMpiInterface");
 
 /**
  * maximum MPI message size for easy
- * buffer creation
+ * buffer creation, large enough to batch
+ * several full size packets
  */
 #ifdef NS3_MPI
-const uint32_t NULL_MESSAGE_MAX_MPI_MSG_SIZE = 2000;
+const uint32_t NULL_MESSAGE_MAX_MPI_MSG_SIZE = 16384;
+
+/** Size of the header of an MPI message: guarantee time and packet count. */
+const uint32_t NULL_MESSAGE_HEADER_SIZE = sizeof (uint64_t) + sizeof (uint32_t);
+
+/** Size of the header of a packet record: rx time, node, dev and size. */
+const uint32_t NULL_MESSAGE_PACKET_HEADER_SIZE = sizeof (uint64_t) + 3 * sizeof (uint32_t);
+
+/**
+ * Append a value to a message.
+ * \param [in,out] data The message.
+ * \param [in] value The value.
+ */
+template <typename T>
+void
+AppendValue (std::vector<uint8_t> &data, T value)
+{
+  std::size_t size = data.size ();
+  data.resize (size + sizeof (T));
+  std::memcpy (&data[size], &value, sizeof (T));
+}
+
+/**
+ * Read a value from a message, and advance the read pointer.
+ * \param [in,out] p The read pointer.
+ * \returns The value.
+ */
+template <typename T>
+T
+ReadValue (const char * &p)
+{
+  T value;
+  std::memcpy (&value, p, sizeof (T));
+  p += sizeof (T);
+  return value;
+}
 #endif
 
+NullMessageMpiInterface::SendBatch::SendBatch ()
+  : packets (0),
+    nullMessage (false),
+    guarantee (0),
+    lastGuarantee (0)
+{
+}
+
 NullMessageSentBuffer::NullMessageSentBuffer ()
 {
   m_buffer = 0;
@@ -88,6 +133,7 @@ uint32_t              NullMessageMpiInterface::g_numNeighbors = 0;
 bool                  NullMessageMpiInterface::g_initialized = false;
 bool                  NullMessageMpiInterface::g_enabled = false;
 std::list<NullMessageSentBuffer> NullMessageMpiInterface::g_pendingTx;
+std::map<uint32_t, NullMessageMpiInterface::SendBatch> NullMessageMpiInterface::g_sendBatches;
 
 MPI_Request* NullMessageMpiInterface::g_requests;
 char**       NullMessageMpiInterface::g_pRxBuffers;
@@ -209,31 +255,31 @@ NullMessageMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t
   Ptr<Node> destNode = NodeList::GetNode (node);
   uint32_t nodeSysId = destNode->GetSystemId ();
 
-  NullMessageSentBuffer sendBuf;
-  g_pendingTx.push_back (sendBuf);
-  std::list<NullMessageSentBuffer>::reverse_iterator iter = g_pendingTx.rbegin (); // Points to the last element
-
   uint32_t serializedSize = p->GetSerializedSize ();
-  uint32_t bufferSize = serializedSize + ( 2 * sizeof (uint64_t) ) + ( 2 * sizeof (uint32_t) );
-  uint8_t* buffer =  new uint8_t[bufferSize];
-  iter->SetBuffer (buffer);
-  // Add the time, dest node and dest device
-  uint64_t t = rxTime.GetInteger ();
-  uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
-  *pTime++ = t;
+  uint32_t recordSize = NULL_MESSAGE_PACKET_HEADER_SIZE + serializedSize;
+  if (NULL_MESSAGE_HEADER_SIZE + recordSize > NULL_MESSAGE_MAX_MPI_MSG_SIZE)
+    {
+      NS_FATAL_ERROR ("Packet of " << serializedSize << " bytes too large for an MPI message");
+    }
 
-  Time guarantee_update = NullMessageSimulatorImpl::GetInstance ()->CalculateGuaranteeTime (nodeSysId);
-  *pTime++ = guarantee_update.GetTimeStep ();
+  SendBatch &batch = g_sendBatches[nodeSysId];
+  if (NULL_MESSAGE_HEADER_SIZE + batch.data.size () + recordSize > NULL_MESSAGE_MAX_MPI_MSG_SIZE)
+    {
+      FlushSendBatch (nodeSysId, batch);
+    }
 
-  uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-  *pData++ = node;
-  *pData++ = dev;
+  // Add the time, dest node, dest device and size
+  AppendValue<uint64_t> (batch.data, rxTime.GetInteger ());
+  AppendValue<uint32_t> (batch.data, node);
+  AppendValue<uint32_t> (batch.data, dev);
+  AppendValue<uint32_t> (batch.data, serializedSize);
   // Serialize the packet
-  p->Serialize (reinterpret_cast<uint8_t *> (pData), serializedSize);
-
-  MPI_Isend (reinterpret_cast<void *> (iter->GetBuffer ()), bufferSize, MPI_CHAR, nodeSysId,
-             0, MPI_COMM_WORLD, (iter->GetRequest ()));
+  std::size_t offset = batch.data.size ();
+  batch.data.resize (offset + serializedSize);
+  p->Serialize (&batch.data[offset], serializedSize);
+  batch.packets++;
 
+  NullMessageSimulatorImpl::GetInstance ()->m_statistics.packetsSent++;
   NullMessageSimulatorImpl::GetInstance ()->RescheduleNullMessageEvent (nodeSysId);
 
 #endif
@@ -247,27 +293,83 @@ NullMessageMpiInterface::SendNullMessage (const Time& guarantee_update, Ptr<Remo
   NS_ASSERT (g_enabled);
 
 #ifdef NS3_MPI
+  SendBatch &batch = g_sendBatches[bundle->GetSystemId ()];
+  batch.nullMessage = true;
+  batch.guarantee = Max (batch.guarantee, guarantee_update);
+#endif
+}
+
+void
+NullMessageMpiInterface::FlushSendBatches ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+#ifdef NS3_MPI
+  for (std::map<uint32_t, SendBatch>::iterator i = g_sendBatches.begin ();
+       i != g_sendBatches.end (); ++i)
+    {
+      FlushSendBatch (i->first, i->second);
+    }
+#endif
+}
+
+void
+NullMessageMpiInterface::FlushSendBatch (uint32_t rank, SendBatch &batch)
+{
+  NS_LOG_FUNCTION (rank << batch.packets << batch.nullMessage);
+
+#ifdef NS3_MPI
+  if (batch.packets == 0 && !batch.nullMessage)
+    {
+      return;
+    }
+
+  NullMessageSimulatorImpl *impl = NullMessageSimulatorImpl::GetInstance ();
+  Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (rank);
+  NS_ASSERT (bundle);
+  Time guarantee = Max (batch.guarantee, impl->CalculateGuaranteeTime (rank));
+
+  if (batch.packets == 0 && guarantee <= batch.lastGuarantee)
+    {
+      // The remote task already knows, don't send a Null Message
+      // which would not let it advance.
+      NS_LOG_LOGIC ("Null Message to " << rank << " suppressed");
+      impl->m_statistics.nullMessagesSuppressed++;
+      batch.nullMessage = false;
+      return;
+    }
 
   NullMessageSentBuffer sendBuf;
   g_pendingTx.push_back (sendBuf);
   std::list<NullMessageSentBuffer>::reverse_iterator iter = g_pendingTx.rbegin (); // Points to the last element
 
-  uint32_t bufferSize = 2 * sizeof (uint64_t) + 2 * sizeof (uint32_t);
+  uint32_t bufferSize = NULL_MESSAGE_HEADER_SIZE + batch.data.size ();
   uint8_t* buffer =  new uint8_t[bufferSize];
   iter->SetBuffer (buffer);
-  // Add the time, dest node and dest device
-  uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
-  *pTime++ = 0;
-  *pTime++ = guarantee_update.GetInteger ();
-  uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-  *pData++ = 0;
-  *pData++ = 0;
-
-  // Find the system id for the destination MPI rank
-  uint32_t nodeSysId = bundle->GetSystemId ();
-
-  MPI_Isend (reinterpret_cast<void *> (iter->GetBuffer ()), bufferSize, MPI_CHAR, nodeSysId,
+  uint64_t update = guarantee.GetInteger ();
+  std::memcpy (buffer, &update, sizeof (update));
+  std::memcpy (buffer + sizeof (update), &batch.packets, sizeof (batch.packets));
+  if (!batch.data.empty ())
+    {
+      std::memcpy (buffer + NULL_MESSAGE_HEADER_SIZE, &batch.data[0], batch.data.size ());
+    }
+
+  MPI_Isend (reinterpret_cast<void *> (iter->GetBuffer ()), bufferSize, MPI_CHAR, rank,
              0, MPI_COMM_WORLD, (iter->GetRequest ()));
+
+  impl->m_statistics.mpiMessagesSent++;
+  if (batch.packets == 0)
+    {
+      impl->m_statistics.nullMessagesSent++;
+    }
+  impl->m_statistics.grantedLookahead += guarantee - Simulator::Now ();
+  impl->m_statistics.channelLookahead += bundle->GetDelay ();
+
+  batch.data.clear ();
+  batch.packets = 0;
+  batch.nullMessage = false;
+  batch.guarantee = Time (0);
+  batch.lastGuarantee = guarantee;
 #endif
 }
 
@@ -327,26 +429,23 @@ NullMessageMpiInterface::ReceiveMessages (bool blocking)
 
       if (messageReceived)
         {
-          int count;
-          MPI_Get_count (&status, MPI_CHAR, &count);
+          NullMessageSimulatorImpl::GetInstance ()->m_statistics.mpiMessagesReceived++;
 
           // Get the meta data first
-          uint64_t* pTime = reinterpret_cast<uint64_t *> (g_pRxBuffers[index]);
-          uint64_t time = *pTime++;
-          uint64_t guaranteeUpdate = *pTime++;
-
-          uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-          uint32_t node = *pData++;
-          uint32_t dev  = *pData++;
-
-          Time rxTime (time);
+          const char *pData = g_pRxBuffers[index];
+          uint64_t guaranteeUpdate = ReadValue<uint64_t> (pData);
+          uint32_t packets = ReadValue<uint32_t> (pData);
 
-          // rxtime == 0 means this is a Null Message
-          if (rxTime > Time (0))
+          // No packet means this is a Null Message
+          for (uint32_t j = 0; j < packets; ++j)
             {
-              count -= sizeof (time) + sizeof (guaranteeUpdate) + sizeof (node) + sizeof (dev);
+              Time rxTime (ReadValue<uint64_t> (pData));
+              uint32_t node = ReadValue<uint32_t> (pData);
+              uint32_t dev = ReadValue<uint32_t> (pData);
+              uint32_t count = ReadValue<uint32_t> (pData);
 
-              Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (pData), count, true);
+              Ptr<Packet> p = Create<Packet> (reinterpret_cast<const uint8_t *> (pData), count, true);
+              pData += count;
 
               // Find the correct node/device to schedule receive event
               Ptr<Node> pNode = NodeList::GetNode (node);
@@ -449,6 +548,7 @@ NullMessageMpiInterface::Disable ()
       delete [] g_requests;
 
       g_pendingTx.clear ();
+      g_sendBatches.clear ();
 
       g_enabled = false;
       g_initialized = false;
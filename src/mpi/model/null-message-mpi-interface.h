@@ -34,6 +34,8 @@ typedef void* MPI_Request;
 #endif
 
 #include <list>
+#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -130,13 +132,23 @@ public:
    *
    * Serialize and send a packet to the specified node and net device.
    *
+   * The packet is not sent immediately: it is appended to the batch of
+   * messages to the task of the destination node, which is sent by
+   * FlushSendBatches().
+   *
    * \internal
-   * The MPI buffer format packs a delivery information and the serialized packet.
+   * An MPI message carries the Null Message guarantee time, and any
+   * number of packets:
    *
-   * uint64_t time the packed should be delivered
    * uint64_t guarantee time for the Null Message algorithm.
+   * uint32_t number of packets
+   *
+   * followed, for each packet, by:
+   *
+   * uint64_t time the packed should be delivered
    * uint32_t node id of destination
    * unit32_t dev id on destination
+   * uint32_t size of the serialized packet
    * uint8_t[] serialized packet
    */
   virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
@@ -154,15 +166,13 @@ public:
    * this bundle in order to allow time advancement on the remote
    * MPI task.
    *
-   * \internal
-   * The Null Message MPI buffer format is based on the format for sending a packet with
-   * several fields set to 0 to signal that it is a Null Message.  Overloading the normal packet
-   * format simplifies receive logic.
+   * Like the packets, the Null Message is sent by FlushSendBatches(),
+   * in the same MPI message as the packets to the same task.  The
+   * Null Message is dropped if the remote task already received a
+   * guarantee time at least as late.
    *
-   * uint64_t 0 must be zero for Null Message
-   * uint64_t guarantee time
-   * uint32_t 0 must be zero for Null Message
-   * uint32_t 0 must be zero for Null Message
+   * \internal
+   * A Null Message is an MPI message with no packet.
    */
   static void SendNullMessage (const Time& guaranteeUpdate, Ptr<RemoteChannelBundle> bundle);
   /**
@@ -179,6 +189,12 @@ public:
    * Check for completed sends
    */
   static void TestSendComplete ();
+  /**
+   * Send the pending packets and Null Messages, in one MPI message per
+   * remote task.  The guarantee time sent to each task is calculated
+   * at this point.
+   */
+  static void FlushSendBatches ();
 
   /**
    * \brief Initialize send and receive buffers.
@@ -190,6 +206,31 @@ public:
 
 private:
 
+  /**
+   * Packets and Null Message waiting to be sent to a remote task.
+   */
+  struct SendBatch
+  {
+    SendBatch ();
+    /** The packet records. */
+    std::vector<uint8_t> data;
+    /** The number of packets. */
+    uint32_t packets;
+    /** Flag \c true if a Null Message was requested. */
+    bool nullMessage;
+    /** The guarantee time requested by the Null Message. */
+    Time guarantee;
+    /** The last guarantee time sent to the task. */
+    Time lastGuarantee;
+  };
+
+  /**
+   * Send one batch, if not empty.
+   * \param rank The remote task.
+   * \param batch The batch.
+   */
+  static void FlushSendBatch (uint32_t rank, SendBatch &batch);
+
   /**
    * Check for received messages complete.  Will block until message
    * has been received if blocking flag is true.  When blocking will
@@ -219,6 +260,9 @@ private:
 
   // List of pending non-blocking sends
   static std::list<NullMessageSentBuffer> g_pendingTx;
+
+  // Messages waiting to be sent, by remote task
+  static std::map<uint32_t, SendBatch> g_sendBatches;
 };
 
 } // namespace ns3
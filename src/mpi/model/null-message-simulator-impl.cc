@@ -32,11 +32,13 @@
 #include <ns3/channel.h>
 #include <ns3/node-container.h>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
 #include <ns3/ptr.h>
 #include <ns3/pointer.h>
 #include <ns3/assert.h>
 #include <ns3/log.h>
 
+#include <chrono>
 #include <cmath>
 #include <iostream>
 #include <fstream>
@@ -61,6 +63,12 @@ NullMessageSimulatorImpl::GetTypeId (void)
                    DoubleValue (1.0),
                    MakeDoubleAccessor (&NullMessageSimulatorImpl::m_schedulerTune),
                    MakeDoubleChecker<double> (0.01,1.0))
+    .AddAttribute ("AdaptiveLookahead",
+                   "Defer the Null Messages of a bundle to the next local event, "
+                   "and drop the Null Messages which would not advance the remote task.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&NullMessageSimulatorImpl::m_adaptiveLookahead),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -97,6 +105,29 @@ NullMessageSimulatorImpl::NullMessageSimulatorImpl ()
 #endif
 }
 
+NullMessageSimulatorImpl::Statistics::Statistics ()
+  : packetsSent (0),
+    mpiMessagesSent (0),
+    mpiMessagesReceived (0),
+    nullMessagesSent (0),
+    nullMessagesSuppressed (0),
+    blockCount (0),
+    blockedTime (0),
+    grantedLookahead (0),
+    channelLookahead (0)
+{
+}
+
+double
+NullMessageSimulatorImpl::Statistics::GetLookaheadUtilization (void) const
+{
+  if (channelLookahead.IsZero ())
+    {
+      return 0;
+    }
+  return grantedLookahead.GetDouble () / channelLookahead.GetDouble ();
+}
+
 NullMessageSimulatorImpl::~NullMessageSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -132,6 +163,11 @@ NullMessageSimulatorImpl::Destroy ()
         }
     }
 
+  if (g_log.IsEnabled (LOG_INFO))
+    {
+      PrintStatistics (std::clog);
+    }
+
   RemoteChannelBundleManager::Destroy();
   MpiInterface::Destroy ();
 }
@@ -263,12 +299,28 @@ NullMessageSimulatorImpl::Next (void) const
   return TimeStep (ev.key.m_ts);
 }
 
+Time
+NullMessageSimulatorImpl::GetNullMessageDelay (Ptr<RemoteChannelBundle> bundle) const
+{
+  Time delay (m_schedulerTune * bundle->GetDelay ().GetTimeStep ());
+
+  if (m_adaptiveLookahead && !m_events->IsEmpty ())
+    {
+      // The guarantee time cannot grow before the next local event, or
+      // before the safe time if it is earlier, so there is no point in
+      // sending a Null Message before.
+      Time idle = Min (Next (), m_safeTime) - Now ();
+      delay = Max (delay, idle);
+    }
+  return delay;
+}
+
 void
 NullMessageSimulatorImpl::ScheduleNullMessageEvent (Ptr<RemoteChannelBundle> bundle)
 {
   NS_LOG_FUNCTION (this << bundle);
 
-  Time delay (m_schedulerTune * bundle->GetDelay ().GetTimeStep ());
+  Time delay = GetNullMessageDelay (bundle);
 
   bundle->SetEventId (Simulator::Schedule (delay, &NullMessageSimulatorImpl::NullMessageEventHandler, 
                                            this, PeekPointer(bundle)));
@@ -281,7 +333,7 @@ NullMessageSimulatorImpl::RescheduleNullMessageEvent (Ptr<RemoteChannelBundle> b
 
   Simulator::Cancel (bundle->GetEventId ());
 
-  Time delay (m_schedulerTune * bundle->GetDelay ().GetTimeStep ());
+  Time delay = GetNullMessageDelay (bundle);
 
   bundle->SetEventId (Simulator::Schedule (delay, &NullMessageSimulatorImpl::NullMessageEventHandler, 
                                            this, PeekPointer(bundle)));
@@ -324,6 +376,8 @@ NullMessageSimulatorImpl::Run (void)
           HandleArrivingMessagesBlocking ();
         }
     }
+
+  NullMessageMpiInterface::FlushSendBatches ();
 }
 
 void
@@ -331,6 +385,12 @@ NullMessageSimulatorImpl::HandleArrivingMessagesNonBlocking (void)
 {
   NS_LOG_FUNCTION (this);
 
+  // Send the messages of this time step once it is over.
+  if (m_events->IsEmpty () || Next () > Now ())
+    {
+      NullMessageMpiInterface::FlushSendBatches ();
+    }
+
   NullMessageMpiInterface::ReceiveMessagesNonBlocking ();
 
   CalculateSafeTime ();
@@ -344,7 +404,13 @@ NullMessageSimulatorImpl::HandleArrivingMessagesBlocking (void)
 {
   NS_LOG_FUNCTION (this);
 
+  NullMessageMpiInterface::FlushSendBatches ();
+
+  m_statistics.blockCount++;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
   NullMessageMpiInterface::ReceiveMessagesBlocking ();
+  m_statistics.blockedTime += NanoSeconds (std::chrono::duration_cast<std::chrono::nanoseconds>
+                                             (std::chrono::steady_clock::now () - start).count ());
 
   CalculateSafeTime ();
 
@@ -608,5 +674,27 @@ NullMessageSimulatorImpl::GetInstance (void)
   NS_ASSERT (g_instance != 0);
   return g_instance;
 }
+
+const NullMessageSimulatorImpl::Statistics &
+NullMessageSimulatorImpl::GetStatistics (void) const
+{
+  return m_statistics;
+}
+
+void
+NullMessageSimulatorImpl::PrintStatistics (std::ostream &os) const
+{
+  os << "Rank " << m_myId << ": "
+     << m_eventCount << " events, "
+     << m_statistics.packetsSent << " packets sent in "
+     << m_statistics.mpiMessagesSent << " MPI messages, "
+     << m_statistics.mpiMessagesReceived << " MPI messages received, "
+     << m_statistics.nullMessagesSent << " null messages sent, "
+     << m_statistics.nullMessagesSuppressed << " null messages suppressed, "
+     << "blocked " << m_statistics.blockCount << " times for "
+     << m_statistics.blockedTime.As (Time::S) << ", "
+     << "lookahead utilization " << m_statistics.GetLookaheadUtilization ()
+     << std::endl;
+}
 } // namespace ns3
 
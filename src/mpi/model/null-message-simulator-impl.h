@@ -41,6 +41,17 @@ class RemoteChannelBundle;
  * \ingroup mpi
  *
  * \brief Simulator implementation using MPI and a Null Message algorithm.
+ *
+ * The packets and Null Messages sent to a remote task while the
+ * simulation time does not advance are batched in a single MPI
+ * message, which carries the guarantee time calculated when it is
+ * sent.
+ *
+ * With the AdaptiveLookahead attribute, the Null Message event of a
+ * bundle is not scheduled at a fixed fraction of the channel delay, but
+ * deferred to the next local event when it is further away: nothing can
+ * raise the guarantee time before then.  The Null Messages which would
+ * not raise the guarantee time of the remote task are dropped.
  */
 class NullMessageSimulatorImpl : public SimulatorImpl
 {
@@ -80,6 +91,52 @@ public:
    */
   static NullMessageSimulatorImpl * GetInstance (void);
 
+  /**
+   * Statistics of the synchronization of this MPI task.
+   */
+  struct Statistics
+  {
+    Statistics ();
+    /** Number of packets sent to remote tasks. */
+    uint64_t packetsSent;
+    /** Number of MPI messages sent, with packets or not. */
+    uint64_t mpiMessagesSent;
+    /** Number of MPI messages received. */
+    uint64_t mpiMessagesReceived;
+    /** Number of MPI messages sent without packets. */
+    uint64_t nullMessagesSent;
+    /** Number of Null Messages dropped as they would not raise the guarantee time. */
+    uint64_t nullMessagesSuppressed;
+    /** Number of times the task blocked waiting for remote tasks. */
+    uint64_t blockCount;
+    /** Wall-clock time spent blocked waiting for remote tasks. */
+    Time blockedTime;
+    /** Sum over the MPI messages sent of the guarantee time minus the send time. */
+    Time grantedLookahead;
+    /** Sum over the MPI messages sent of the minimum delay of the bundle. */
+    Time channelLookahead;
+
+    /**
+     * Get the lookahead utilization: the lookahead granted to the remote
+     * tasks relative to the channel delays.  This is 1 for a task which
+     * grants no more than the static lookahead, and more when the
+     * remote tasks are allowed to run further ahead.
+     * \return The lookahead utilization.
+     */
+    double GetLookaheadUtilization (void) const;
+  };
+
+  /**
+   * \return The statistics of this MPI task.
+   */
+  const Statistics & GetStatistics (void) const;
+
+  /**
+   * Print the statistics of this MPI task.
+   * \param [in,out] os The output stream.
+   */
+  void PrintStatistics (std::ostream &os) const;
+
 private:
   friend class NullMessageEvent;
   friend class NullMessageMpiInterface;
@@ -132,6 +189,12 @@ private:
    */
   void ScheduleNullMessageEvent (Ptr<RemoteChannelBundle> bundle);
 
+  /**
+   * \param bundle Bundle to schedule Null Message event for
+   * \return The delay until the next Null Message event for the bundle.
+   */
+  Time GetNullMessageDelay (Ptr<RemoteChannelBundle> bundle) const;
+
   /**
    * \param bundle Bundle to reschedule Null Message event for
    *
@@ -204,6 +267,16 @@ private:
    */
   double m_schedulerTune;
 
+  /*
+   * Defer the Null Message events to the next local event.
+   */
+  bool m_adaptiveLookahead;
+
+  /*
+   * Synchronization statistics.
+   */
+  Statistics m_statistics;
+
   /*
    * Singleton instance.
    */
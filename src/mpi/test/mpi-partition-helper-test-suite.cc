@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/mpi-partition-helper.h"
+#include "ns3/boolean.h"
+#include "ns3/mac48-address.h"
+#include "ns3/node.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+/**
+ * \file
+ * \ingroup mpi-tests
+ * MpiPartitionHelper test suite.
+ */
+
+/**
+ * \ingroup mpi
+ * \defgroup mpi-tests MPI module tests
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi-tests
+ * Check the partition of explicit graphs.
+ */
+class MpiPartitionGraphTestCase : public TestCase
+{
+public:
+  MpiPartitionGraphTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+MpiPartitionGraphTestCase::MpiPartitionGraphTestCase ()
+  : TestCase ("Check the partition of explicit graphs")
+{
+}
+
+void
+MpiPartitionGraphTestCase::DoRun (void)
+{
+  // Two rings of four nodes, joined by a long link: cut the long link.
+  MpiPartitionHelper rings;
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      rings.AddLink (i, (i + 1) % 4, MicroSeconds (1));
+      rings.AddLink (4 + i, 4 + (i + 1) % 4, MicroSeconds (1));
+    }
+  rings.AddLink (3, 4, MilliSeconds (10));
+  rings.Partition (2);
+  NS_TEST_EXPECT_MSG_EQ (rings.GetCutSize (), 1, "Only the long link should be cut");
+  NS_TEST_EXPECT_MSG_EQ (rings.GetLookahead (), MilliSeconds (10), "Bad lookahead");
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (rings.GetSystemId (i), 0, "Bad system id for node " << i);
+      NS_TEST_EXPECT_MSG_EQ (rings.GetSystemId (4 + i), 1, "Bad system id for node " << 4 + i);
+    }
+
+  // A chain with a short link in the middle: cut the two long links,
+  // rather than the short one, and keep the load balanced.
+  MpiPartitionHelper chain;
+  chain.AddLink (0, 1, MilliSeconds (5));
+  chain.AddLink (1, 2, MilliSeconds (1));
+  chain.AddLink (2, 3, MilliSeconds (5));
+  chain.Partition (2);
+  NS_TEST_EXPECT_MSG_EQ (chain.GetCutSize (), 2, "Both long links should be cut");
+  NS_TEST_EXPECT_MSG_EQ (chain.GetLookahead (), MilliSeconds (5), "Bad lookahead");
+  NS_TEST_EXPECT_MSG_EQ (chain.GetSystemId (1), chain.GetSystemId (2), "Short link cut");
+  NS_TEST_EXPECT_MSG_EQ (chain.GetSystemId (0), chain.GetSystemId (3), "Unbalanced partition");
+  NS_TEST_EXPECT_MSG_NE (chain.GetSystemId (0), chain.GetSystemId (1), "Unbalanced partition");
+
+  // Links without delay are never cut.
+  MpiPartitionHelper shared;
+  shared.AddLink (0, 1, Time (0));
+  shared.AddLink (1, 2, Time (0));
+  shared.Partition (3);
+  NS_TEST_EXPECT_MSG_EQ (shared.GetCutSize (), 0, "Shared channel cut");
+}
+
+/**
+ * \ingroup mpi-tests
+ * Check the partition of a profiled topology.
+ */
+class MpiPartitionProfileTestCase : public TestCase
+{
+public:
+  MpiPartitionProfileTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Connect two nodes.
+   * \param a The first node.
+   * \param b The second node.
+   * \param delay The channel delay.
+   */
+  void Connect (Ptr<Node> a, Ptr<Node> b, Time delay);
+  /** An event. */
+  void Event (void);
+};
+
+MpiPartitionProfileTestCase::MpiPartitionProfileTestCase ()
+  : TestCase ("Check the partition of a profiled topology")
+{
+}
+
+void
+MpiPartitionProfileTestCase::Connect (Ptr<Node> a, Ptr<Node> b, Time delay)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (delay));
+  Ptr<Node> nodes[] = { a, b };
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAttribute ("PointToPointMode", BooleanValue (true));
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      nodes[i]->AddDevice (device);
+    }
+}
+
+void
+MpiPartitionProfileTestCase::Event (void)
+{
+}
+
+void
+MpiPartitionProfileTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+  Connect (nodes.Get (0), nodes.Get (1), MilliSeconds (1));
+  Connect (nodes.Get (1), nodes.Get (2), MilliSeconds (5));
+  Connect (nodes.Get (2), nodes.Get (3), MilliSeconds (1));
+
+  // Node 0 runs as many events as the others together: the long link
+  // cannot be cut without unbalancing the load.
+  for (uint32_t i = 0; i < 30; ++i)
+    {
+      Simulator::ScheduleWithContext (nodes.Get (0)->GetId (), MilliSeconds (i),
+                                      &MpiPartitionProfileTestCase::Event, this);
+    }
+  for (uint32_t n = 1; n < 4; ++n)
+    {
+      for (uint32_t i = 0; i < 10; ++i)
+        {
+          Simulator::ScheduleWithContext (nodes.Get (n)->GetId (), MilliSeconds (i),
+                                          &MpiPartitionProfileTestCase::Event, this);
+        }
+    }
+
+  MpiPartitionHelper partition;
+  partition.Profile (Seconds (1));
+  Simulator::Destroy ();
+  partition.Partition (2);
+  NS_TEST_EXPECT_MSG_EQ (partition.GetCutSize (), 1, "Bad cut size");
+  NS_TEST_EXPECT_MSG_EQ (partition.GetLookahead (), MilliSeconds (1), "Bad lookahead");
+
+  std::string filename = CreateTempDirFilename ("partition.txt");
+  partition.Write (filename);
+  MpiPartitionHelper loaded;
+  loaded.Read (filename);
+  NS_TEST_EXPECT_MSG_EQ (loaded.GetLookahead (), MilliSeconds (1), "Bad lookahead read");
+
+  nodes = loaded.Create (4);
+  uint32_t expected[] = { 0, 1, 1, 1 };
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (nodes.Get (i)->GetSystemId (), expected[i],
+                             "Bad system id for node " << i);
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup mpi-tests
+ * MpiPartitionHelper test suite.
+ */
+class MpiPartitionHelperTestSuite : public TestSuite
+{
+public:
+  MpiPartitionHelperTestSuite ();
+};
+
+MpiPartitionHelperTestSuite::MpiPartitionHelperTestSuite ()
+  : TestSuite ("mpi-partition-helper", UNIT)
+{
+  AddTestCase (new MpiPartitionGraphTestCase, TestCase::QUICK);
+  AddTestCase (new MpiPartitionProfileTestCase, TestCase::QUICK);
+}
+
+/** Static variable for test initialization. */
+static MpiPartitionHelperTestSuite g_mpiPartitionHelperTestSuite;
@@ -28,6 +28,8 @@
 #include "ns3/names.h"
 #include "ns3/net-device.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/pointer.h"
+#include "ns3/queue.h"
 
 #include "trace-helper.h"
 
@@ -650,5 +652,104 @@ AsciiTraceHelperForDevice::EnableAsciiImpl (
     }
 }
 
-} // namespace ns3
+ColumnarTraceHelper::ColumnarTraceHelper ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+ColumnarTraceHelper::~ColumnarTraceHelper ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+Ptr<ColumnarTraceFile>
+ColumnarTraceHelper::CreateFile (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
 
+  Ptr<ColumnarTraceFile> file = Create<ColumnarTraceFile> ();
+  file->Open (filename, std::ios::out);
+  NS_ABORT_MSG_IF (file->Fail (), "ColumnarTraceHelper::CreateFile():  Unable to Open " <<
+                   filename << " for write.");
+  // The trace sinks may outlive the simulation, so write the last
+  // block when it ends.
+  Simulator::ScheduleDestroy (&ColumnarTraceFile::Close, file);
+  return file;
+}
+
+void
+ColumnarTraceHelper::DefaultSink (Ptr<ColumnarTraceFile> file, uint8_t event, NetDevice *device,
+                                  Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << event << device << p);
+  file->Write (event, device->GetNode ()->GetId (), device->GetIfIndex (), p);
+}
+
+void
+ColumnarTraceHelper::EnableColumnar (Ptr<ColumnarTraceFile> file, Ptr<NetDevice> nd)
+{
+  NS_LOG_FUNCTION (file << nd);
+  NetDevice *device = PeekPointer (nd);
+
+  PointerValue ptr;
+  if (nd->GetAttributeFailSafe ("TxQueue", ptr))
+    {
+      Ptr<Queue<Packet> > queue = ptr.Get<Queue<Packet> > ();
+      if (queue != 0)
+        {
+          queue->TraceConnectWithoutContext ("Enqueue",
+                                             MakeBoundCallback (&DefaultSink, file,
+                                                                uint8_t (ColumnarTraceFile::ENQUEUE), device));
+          queue->TraceConnectWithoutContext ("Dequeue",
+                                             MakeBoundCallback (&DefaultSink, file,
+                                                                uint8_t (ColumnarTraceFile::DEQUEUE), device));
+          queue->TraceConnectWithoutContext ("Drop",
+                                             MakeBoundCallback (&DefaultSink, file,
+                                                                uint8_t (ColumnarTraceFile::DROP), device));
+        }
+    }
+  nd->TraceConnectWithoutContext ("MacRx",
+                                  MakeBoundCallback (&DefaultSink, file,
+                                                     uint8_t (ColumnarTraceFile::RECEIVE), device));
+  nd->TraceConnectWithoutContext ("PhyRxDrop",
+                                  MakeBoundCallback (&DefaultSink, file,
+                                                     uint8_t (ColumnarTraceFile::DROP), device));
+}
+
+void
+ColumnarTraceHelper::EnableColumnar (Ptr<ColumnarTraceFile> file, NetDeviceContainer d)
+{
+  for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+    {
+      EnableColumnar (file, *i);
+    }
+}
+
+void
+ColumnarTraceHelper::EnableColumnar (Ptr<ColumnarTraceFile> file, NodeContainer n)
+{
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          EnableColumnar (file, node->GetDevice (j));
+        }
+    }
+}
+
+void
+ColumnarTraceHelper::EnableColumnarAll (Ptr<ColumnarTraceFile> file)
+{
+  EnableColumnar (file, NodeContainer::GetGlobal ());
+}
+
+Ptr<ColumnarTraceFile>
+ColumnarTraceHelper::EnableColumnarAll (std::string filename)
+{
+  Ptr<ColumnarTraceFile> file = CreateFile (filename);
+  EnableColumnarAll (file);
+  return file;
+}
+
+} // namespace ns3
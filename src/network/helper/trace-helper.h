@@ -25,6 +25,7 @@
 #include "ns3/simulator.h"
 #include "ns3/pcap-file-wrapper.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/columnar-trace-file.h"
 
 namespace ns3 {
 
@@ -865,6 +866,94 @@ private:
   void EnableAsciiImpl (Ptr<OutputStreamWrapper> stream, std::string prefix, Ptr<NetDevice> nd, bool explicitFilename);
 };
 
+/**
+ * \brief Record the packet events of devices in a ColumnarTraceFile
+ *
+ * This is the binary counterpart of the ascii traces: it records the
+ * same enqueue, dequeue, drop and receive events, as ColumnarTraceRecord
+ * rather than text lines, at a small fraction of the size.
+ *
+ * It does not need help from the device helpers: on each device, it
+ * hooks the Enqueue, Dequeue and Drop traces of the Queue<Packet> in the
+ * "TxQueue" attribute, the "MacRx" trace as receive events and the
+ * "PhyRxDrop" trace as drop events, for those the device has.
+ */
+class ColumnarTraceHelper
+{
+public:
+  /**
+   * @brief Create a columnar trace helper.
+   */
+  ColumnarTraceHelper ();
+
+  /**
+   * @brief Destroy a columnar trace helper.
+   */
+  ~ColumnarTraceHelper ();
+
+  /**
+   * @brief Create a columnar trace file, closed when the simulator is
+   * destroyed.
+   *
+   * @param filename file name
+   * @returns the file
+   */
+  Ptr<ColumnarTraceFile> CreateFile (std::string filename);
+
+  /**
+   * @brief Record the packet events of a device.
+   *
+   * @param file the file to record in
+   * @param nd the device
+   */
+  void EnableColumnar (Ptr<ColumnarTraceFile> file, Ptr<NetDevice> nd);
+
+  /**
+   * @brief Record the packet events of devices.
+   *
+   * @param file the file to record in
+   * @param d the devices
+   */
+  void EnableColumnar (Ptr<ColumnarTraceFile> file, NetDeviceContainer d);
+
+  /**
+   * @brief Record the packet events of all the devices of nodes.
+   *
+   * @param file the file to record in
+   * @param n the nodes
+   */
+  void EnableColumnar (Ptr<ColumnarTraceFile> file, NodeContainer n);
+
+  /**
+   * @brief Record the packet events of all the devices of all the nodes.
+   *
+   * @param file the file to record in
+   */
+  void EnableColumnarAll (Ptr<ColumnarTraceFile> file);
+
+  /**
+   * @brief Record the packet events of all the devices of all the nodes
+   * in a new file.
+   *
+   * @param filename file name
+   * @returns the file
+   */
+  Ptr<ColumnarTraceFile> EnableColumnarAll (std::string filename);
+
+  /**
+   * @brief The trace sink recording a packet event of a device.
+   *
+   * The device is not held by a Ptr, as it holds the trace sources.
+   *
+   * @param file the file to record in
+   * @param event the ColumnarTraceFile::Event
+   * @param device the device
+   * @param p the packet
+   */
+  static void DefaultSink (Ptr<ColumnarTraceFile> file, uint8_t event, NetDevice *device,
+                           Ptr<const Packet> p);
+};
+
 } // namespace ns3
 
 #endif /* TRACE_HELPER_H */
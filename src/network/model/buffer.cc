@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "buffer.h"
+#include "packet-memory-pool.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
@@ -50,96 +51,26 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+thread_local uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
- */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
-
-Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
-{
-  NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
-    {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
-        {
-          Buffer::Deallocate (*i);
-        }
-      delete g_freeList;
-      g_freeList = DESTROYED;
-    }
-}
-
 void
 Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
-    {
-      Buffer::Deallocate (data);
-    }
-  else
-    {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
-    }
+  PacketMemoryPool::Deallocate (PacketMemoryPool::BUFFER, data);
 }
 
 Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
-    {
-      g_freeList = new Buffer::FreeList ();
-    }
-  else if (IS_INITIALIZED (g_freeList))
-    {
-      while (!g_freeList->empty ()) 
-        {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
-        }
-    }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
-  NS_ASSERT (data->m_count == 1);
+  /* try to find a buffer correctly sized in the cache of the thread. */
+  uint32_t size = std::max<uint32_t> (dataSize, 1) - 1 + sizeof (struct Buffer::Data);
+  void *block = PacketMemoryPool::Allocate (PacketMemoryPool::BUFFER, size);
+  struct Buffer::Data *data = static_cast<struct Buffer::Data *> (block);
+  data->m_size = size + 1 - sizeof (struct Buffer::Data);
+  data->m_count = 1;
   return data;
 }
 #else /* BUFFER_FREE_LIST */
@@ -186,18 +117,24 @@ Buffer::Deallocate (struct Buffer::Data *data)
 }
 
 Buffer::Buffer ()
+  : m_payload (0),
+    m_payloadStart (0)
 {
   NS_LOG_FUNCTION (this);
   Initialize (0);
 }
 
 Buffer::Buffer (uint32_t dataSize)
+  : m_payload (0),
+    m_payloadStart (0)
 {
   NS_LOG_FUNCTION (this << dataSize);
   Initialize (dataSize);
 }
 
 Buffer::Buffer (uint32_t dataSize, bool initialize)
+  : m_payload (0),
+    m_payloadStart (0)
 {
   NS_LOG_FUNCTION (this << dataSize << initialize);
   if (initialize == true)
@@ -206,6 +143,62 @@ Buffer::Buffer (uint32_t dataSize, bool initialize)
     }
 }
 
+Buffer::Buffer (uint8_t const *payload, uint32_t size)
+  : m_payload (0),
+    m_payloadStart (0)
+{
+  NS_LOG_FUNCTION (this << &payload << size);
+  Initialize (size);
+  if (size > 0)
+    {
+      uint8_t *buf = new uint8_t [sizeof (struct Buffer::Segment) - 1 + size];
+      m_payload = reinterpret_cast<struct Buffer::Segment *> (buf);
+      m_payload->m_count = 1;
+      m_payload->m_size = size;
+      memcpy (m_payload->m_data, payload, size);
+    }
+}
+
+bool
+Buffer::HasPayloadSegment (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_payload != 0;
+}
+
+void
+Buffer::ReleasePayload (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_payload == 0)
+    {
+      return;
+    }
+  m_payload->m_count--;
+  if (m_payload->m_count == 0)
+    {
+      uint8_t *buf = reinterpret_cast<uint8_t *> (m_payload);
+      delete [] buf;
+    }
+  m_payload = 0;
+  m_payloadStart = 0;
+}
+
+void
+Buffer::CopyZeroArea (uint8_t *buffer, uint32_t offset, uint32_t size) const
+{
+  NS_LOG_FUNCTION (this << &buffer << offset << size);
+  NS_ASSERT (offset + size <= m_zeroAreaEnd - m_zeroAreaStart);
+  if (m_payload != 0)
+    {
+      memcpy (buffer, m_payload->m_data + m_payloadStart + offset, size);
+    }
+  else
+    {
+      memset (buffer, 0, size);
+    }
+}
+
 bool
 Buffer::CheckInternalState (void) const
 {
@@ -226,7 +219,11 @@ Buffer::CheckInternalState (void) const
     m_start <= m_data->m_size &&
     m_zeroAreaStart <= m_data->m_size;
 
-  bool ok = m_data->m_count > 0 && offsetsOk && dirtyOk && internalSizeOk;
+  bool payloadOk = m_payload == 0 ||
+    (m_payload->m_count > 0 &&
+     m_payloadStart + (m_zeroAreaEnd - m_zeroAreaStart) <= m_payload->m_size);
+
+  bool ok = m_data->m_count > 0 && offsetsOk && dirtyOk && internalSizeOk && payloadOk;
   if (!ok)
     {
       LOG_INTERNAL_STATE ("check " << this << 
@@ -270,6 +267,16 @@ Buffer::operator = (Buffer const&o)
       m_data = o.m_data;
       m_data->m_count++;
     }
+  if (m_payload != o.m_payload)
+    {
+      ReleasePayload ();
+      m_payload = o.m_payload;
+      if (m_payload != 0)
+        {
+          m_payload->m_count++;
+        }
+    }
+  m_payloadStart = o.m_payloadStart;
   g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
   m_maxZeroAreaStart = o.m_maxZeroAreaStart;
   m_zeroAreaStart = o.m_zeroAreaStart;
@@ -290,6 +297,7 @@ Buffer::~Buffer ()
     {
       Recycle (m_data);
     }
+  ReleasePayload ();
 }
 
 uint32_t
@@ -400,17 +408,55 @@ void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
+  bool adjacentSegment = o.m_payload != 0 &&
+    m_end == m_zeroAreaEnd &&
+    o.m_start == o.m_zeroAreaStart &&
+    (m_zeroAreaEnd == m_zeroAreaStart ||
+     (m_payload == o.m_payload &&
+      m_payloadStart + (m_zeroAreaEnd - m_zeroAreaStart) == o.m_payloadStart));
+  if (adjacentSegment &&
+      (m_data->m_count > 1 || m_end != m_data->m_dirtyEnd))
+    {
+      /* The fragments of a buffer with a payload segment share their
+       * headers: copy ours, but not the payload, to own the data.
+       */
+      uint32_t internalSize = GetInternalSize ();
+      struct Buffer::Data *newData = Buffer::Create (internalSize);
+      memcpy (newData->m_data, m_data->m_data + m_start, internalSize);
+      m_data->m_count--;
+      if (m_data->m_count == 0)
+        {
+          Buffer::Recycle (m_data);
+        }
+      m_data = newData;
+      m_zeroAreaStart -= m_start;
+      m_zeroAreaEnd -= m_start;
+      m_end -= m_start;
+      m_start = 0;
+      m_data->m_dirtyStart = m_start;
+      m_data->m_dirtyEnd = m_end;
+    }
   if (m_data->m_count == 1 &&
       m_end == m_zeroAreaEnd &&
       m_end == m_data->m_dirtyEnd &&
       o.m_start == o.m_zeroAreaStart &&
-      o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
+      o.m_zeroAreaEnd - o.m_zeroAreaStart > 0 &&
+      (adjacentSegment || (m_payload == 0 && o.m_payload == 0)))
     {
       /**
        * This is an optimization which kicks in when
        * we attempt to aggregate two buffers which contain
-       * adjacent zero areas.
+       * adjacent zero areas, either both of zero bytes or
+       * adjacent in the same payload segment, as when the
+       * fragments of a buffer are concatenated in order.
        */
+      if (m_payload != o.m_payload)
+        {
+          ReleasePayload ();
+          m_payload = o.m_payload;
+          m_payload->m_count++;
+          m_payloadStart = o.m_payloadStart;
+        }
       uint32_t zeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
       m_zeroAreaEnd += zeroSize;
       m_end = m_zeroAreaEnd;
@@ -454,6 +500,7 @@ Buffer::RemoveAtStart (uint32_t start)
       m_start = m_zeroAreaStart;
       m_zeroAreaEnd -= delta;
       m_end -= delta;
+      m_payloadStart += delta;
     } 
   else if (newStart <= m_end)
     {
@@ -475,6 +522,10 @@ Buffer::RemoveAtStart (uint32_t start)
       m_zeroAreaEnd = m_end;
       m_zeroAreaStart = m_end;
     }
+  if (m_zeroAreaStart == m_zeroAreaEnd)
+    {
+      ReleasePayload ();
+    }
   m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
   LOG_INTERNAL_STATE ("rem start=" << start << ", ");
   NS_ASSERT (CheckInternalState ());
@@ -510,6 +561,10 @@ Buffer::RemoveAtEnd (uint32_t end)
       m_zeroAreaEnd = m_start;
       m_zeroAreaStart = m_start;
     }
+  if (m_zeroAreaStart == m_zeroAreaEnd)
+    {
+      ReleasePayload ();
+    }
   m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
   LOG_INTERNAL_STATE ("rem end=" << end << ", ");
   NS_ASSERT (CheckInternalState ());
@@ -536,7 +591,14 @@ Buffer::CreateFullCopy (void) const
     {
       Buffer tmp;
       tmp.AddAtStart (m_zeroAreaEnd - m_zeroAreaStart);
-      tmp.Begin ().WriteU8 (0, m_zeroAreaEnd - m_zeroAreaStart);
+      if (m_payload != 0)
+        {
+          tmp.Begin ().Write (m_payload->m_data + m_payloadStart, m_zeroAreaEnd - m_zeroAreaStart);
+        }
+      else
+        {
+          tmp.Begin ().WriteU8 (0, m_zeroAreaEnd - m_zeroAreaStart);
+        }
       uint32_t dataStart = m_zeroAreaStart - m_start;
       tmp.AddAtStart (dataStart);
       tmp.Begin ().Write (m_data->m_data+m_start, dataStart);
@@ -552,10 +614,33 @@ Buffer::CreateFullCopy (void) const
   return *this;
 }
 
+Buffer
+Buffer::CreateDeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Buffer copy;
+  copy.AddAtStart (GetSize ());
+  copy.Begin ().Write (Begin (), End ());
+  NS_ASSERT (copy.CheckInternalState ());
+  return copy;
+}
+
+bool
+Buffer::IsSharedWith (Buffer const &o) const
+{
+  return m_data == o.m_data || (m_payload != 0 && m_payload == o.m_payload);
+}
+
 uint32_t 
 Buffer::GetSerializedSize (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_payload != 0)
+    {
+      // The serialized form has no payload segment: its bytes are
+      // serialized as real bytes.
+      return CreateFullCopy ().GetSerializedSize ();
+    }
   uint32_t dataStart = (m_zeroAreaStart - m_start + 3) & (~0x3);
   uint32_t dataEnd = (m_end - m_zeroAreaEnd + 3) & (~0x3);
 
@@ -576,6 +661,10 @@ uint32_t
 Buffer::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
+  if (m_payload != 0)
+    {
+      return CreateFullCopy ().Serialize (buffer, maxSize);
+    }
   uint32_t* p = reinterpret_cast<uint32_t *> (buffer);
   uint32_t size = 0;
 
@@ -656,6 +745,7 @@ Buffer::Deserialize (const uint8_t *buffer, uint32_t size)
   sizeCheck -= 4;
 
   // Create zero bytes
+  ReleasePayload ();
   Initialize (zeroDataLength);
 
   // Add start data
@@ -724,6 +814,11 @@ Buffer::CopyData (std::ostream *os, uint32_t size) const
           size -= m_zeroAreaStart-m_start;
           tmpsize = std::min (m_zeroAreaEnd - m_zeroAreaStart, size);
           uint32_t left = tmpsize;
+          if (m_payload != 0)
+            {
+              os->write ((const char*)(m_payload->m_data + m_payloadStart), left);
+              left = 0;
+            }
           while (left > 0)
             {
               uint32_t toWrite = std::min (left, g_zeroes.size);
@@ -754,14 +849,8 @@ Buffer::CopyData (uint8_t *buffer, uint32_t size) const
       if (size > 0) 
         { 
           tmpsize = std::min (m_zeroAreaEnd - m_zeroAreaStart, size);
-          uint32_t left = tmpsize;
-          while (left > 0)
-            {
-              uint32_t toWrite = std::min (left, g_zeroes.size);
-              memcpy (buffer, g_zeroes.buffer, toWrite);
-              left -= toWrite;
-              buffer += toWrite;
-            }
+          CopyZeroArea (buffer, 0, tmpsize);
+          buffer += tmpsize;
           size -= tmpsize;
           if (size > 0)
             {
@@ -854,7 +943,14 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      if (start.m_payload != 0)
+        {
+          memcpy (&m_data[m_current], &start.m_payload[start.m_current - start.m_zeroStart], toCopy);
+        }
+      else
+        {
+          memset (&m_data[m_current], 0, toCopy);
+        }
       start.m_current += toCopy;
       m_current += toCopy;
       size -= toCopy;
@@ -88,6 +88,16 @@ namespace ns3 {
  * \endverbatim
  *
  * A simple state invariant is that m_start <= m_zeroStart <= m_zeroEnd <= m_end
+ *
+ * The zero area can also hold real payload bytes, without copying them
+ * into the BufferData: a Buffer created with Buffer (uint8_t const*, uint32_t)
+ * keeps its bytes in a read-only payload segment, which backs the zero area
+ * and is shared by all the copies and fragments of the Buffer.  Headers
+ * and trailers are still written in the BufferData around the zero area,
+ * so that adding a header to a shared Buffer only copies the headers and
+ * trailers, and CreateFragment only adjusts offsets in the segment.
+ * Like the virtual zero bytes, the bytes of a payload segment can be read
+ * but not written.
  */
 class Buffer 
 {
@@ -482,6 +492,11 @@ private:
      * to this pointer.
      */
     uint8_t *m_data;
+    /**
+     * a pointer to the first byte of the payload segment in the
+     * "virtual zero area", or zero if the zero area holds zero bytes.
+     */
+    uint8_t const *m_payload;
   };
 
   /**
@@ -555,6 +570,20 @@ private:
    */
   Buffer CreateFragment (uint32_t start, uint32_t length) const;
 
+  /**
+   * \return a copy of this Buffer which shares no data with it: its
+   * zero area and payload segment are written as real bytes.
+   *
+   * Unlike the copy constructor, the copy can be used by another
+   * thread than this Buffer and its copies.
+   */
+  Buffer CreateDeepCopy (void) const;
+  /**
+   * \param o another Buffer
+   * \return true if this Buffer and o reference the same data.
+   */
+  bool IsSharedWith (Buffer const &o) const;
+
   /**
    * \return an Iterator which points to the
    * start of this Buffer.
@@ -641,7 +670,23 @@ private:
    * \param initialize initialize the buffer with zeroes.
    */
   Buffer (uint32_t dataSize, bool initialize);
+  /**
+   * \brief Constructor
+   *
+   * The bytes are copied once in a read-only payload segment, which is
+   * shared, rather than copied, by the copies and the fragments of this
+   * buffer, and when headers or trailers are added to them.
+   *
+   * \param payload the payload bytes.
+   * \param size the number of payload bytes.
+   */
+  Buffer (uint8_t const *payload, uint32_t size);
   ~Buffer ();
+  /**
+   * \return true if some bytes of this buffer are held in a shared,
+   *         read-only payload segment.
+   */
+  bool HasPayloadSegment (void) const;
 private:
   /**
    * This data structure is variable-sized through its last member whose size
@@ -685,6 +730,28 @@ private:
     uint8_t m_data[1];
   };
 
+  /**
+   * A read-only payload segment, which holds the bytes of the "virtual
+   * zero area" of the Buffer instances which reference it.  Like
+   * Buffer::Data, it is variable-sized through its last member.
+   */
+  struct Segment
+  {
+    /**
+     * The reference count of an instance of this data structure.
+     * Each buffer which references an instance holds a count.
+     */
+    uint32_t m_count;
+    /**
+     * the size of the m_data field below.
+     */
+    uint32_t m_size;
+    /**
+     * The payload bytes. Their real size is stored in the m_size field.
+     */
+    uint8_t m_data[1];
+  };
+
   /**
    * \brief Create a full copy of the buffer, including
    * all the internal structures.
@@ -748,8 +815,30 @@ private:
    * \param data the buffer data storage
    */
   static void Deallocate (struct Buffer::Data *data);
+  /**
+   * \brief Release the reference of this buffer to its payload segment,
+   * if any.
+   */
+  void ReleasePayload (void);
+  /**
+   * \brief Copy bytes of the "virtual zero area"
+   * \param [out] buffer the destination
+   * \param [in] offset the offset of the first byte in the zero area
+   * \param [in] size the number of bytes
+   */
+  void CopyZeroArea (uint8_t *buffer, uint32_t offset, uint32_t size) const;
 
   struct Data *m_data; //!< the buffer data storage
+  /**
+   * the payload segment which holds the bytes of the "virtual zero
+   * area", or zero if they are zero bytes.
+   */
+  struct Segment *m_payload;
+  /**
+   * offset to the start of the virtual zero area from the start
+   * of m_payload->m_data
+   */
+  uint32_t m_payloadStart;
 
   /**
    * keep track of the maximum value of m_zeroAreaStart across
@@ -765,9 +854,9 @@ private:
   /**
    * location in a newly-allocated buffer where you should start
    * writing data. i.e., m_start should be initialized to this 
-   * value.
+   * value.  Each thread keeps its own heuristic.
    */
-  static uint32_t g_recommendedStart;
+  static thread_local uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -789,19 +878,6 @@ private:
    * instance from the start of m_data->m_data
    */
   uint32_t m_end;
-
-#ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
-#endif
 };
 
 } // namespace ns3
@@ -817,7 +893,8 @@ Buffer::Iterator::Iterator ()
     m_dataStart (0),
     m_dataEnd (0),
     m_current (0),
-    m_data (0)
+    m_data (0),
+    m_payload (0)
 {
 }
 Buffer::Iterator::Iterator (Buffer const*buffer)
@@ -839,6 +916,7 @@ Buffer::Iterator::Construct (const Buffer *buffer)
   m_dataStart = buffer->m_start;
   m_dataEnd = buffer->m_end;
   m_data = buffer->m_data->m_data;
+  m_payload = buffer->m_payload == 0 ? 0 : buffer->m_payload->m_data + buffer->m_payloadStart;
 }
 
 void 
@@ -1008,7 +1086,7 @@ Buffer::Iterator::PeekU8 (void)
     }
   else if (m_current < m_zeroEnd)
     {
-      return 0;
+      return m_payload == 0 ? 0 : m_payload[m_current - m_zeroStart];
     }
   else
     {
@@ -1049,6 +1127,8 @@ Buffer::Iterator::Read (Buffer::Iterator start, uint32_t size)
 
 Buffer::Buffer (Buffer const&o)
   : m_data (o.m_data),
+    m_payload (o.m_payload),
+    m_payloadStart (o.m_payloadStart),
     m_maxZeroAreaStart (o.m_zeroAreaStart),
     m_zeroAreaStart (o.m_zeroAreaStart),
     m_zeroAreaEnd (o.m_zeroAreaEnd),
@@ -1056,6 +1136,10 @@ Buffer::Buffer (Buffer const&o)
     m_end (o.m_end)
 {
   m_data->m_count++;
+  if (m_payload != 0)
+    {
+      m_payload->m_count++;
+    }
   NS_ASSERT (CheckInternalState ());
 }
 
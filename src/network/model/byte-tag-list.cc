@@ -18,13 +18,13 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "byte-tag-list.h"
+#include "packet-memory-pool.h"
 #include "ns3/log.h"
 #include <vector>
 #include <cstring>
 #include <limits>
 
 #define USE_FREE_LIST 1
-#define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (std::numeric_limits<int32_t>::max ())
 
 namespace ns3 {
@@ -45,33 +45,6 @@ struct ByteTagListData {
   uint8_t data[4]; //!< data
 };
 
-#ifdef USE_FREE_LIST
-/**
- * \ingroup packet
- *
- * \brief Container class for struct ByteTagListData
- *
- * Internal use only.
- */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
-{
-public:
-  ~ByteTagListDataFreeList ();
-} g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
-
-ByteTagListDataFreeList::~ByteTagListDataFreeList ()
-{
-  NS_LOG_FUNCTION (this);
-  for (ByteTagListDataFreeList::iterator i = begin ();
-       i != end (); i++)
-    {
-      uint8_t *buffer = (uint8_t *)(*i);
-      delete [] buffer;
-    }
-}
-#endif /* USE_FREE_LIST */
-
 ByteTagList::Iterator::Item::Item (TagBuffer buf_)
   : buf (buf_)
 {
@@ -239,6 +212,30 @@ ByteTagList::Add (const ByteTagList &o)
     }
 }
 
+ByteTagList
+ByteTagList::CreateDeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  ByteTagList copy;
+  if (m_data != 0)
+    {
+      copy.m_data = copy.Allocate (m_used);
+      std::memcpy (copy.m_data->data, m_data->data, m_used);
+      copy.m_data->dirty = m_used;
+      copy.m_minStart = m_minStart;
+      copy.m_maxEnd = m_maxEnd;
+      copy.m_adjustment = m_adjustment;
+      copy.m_used = m_used;
+    }
+  return copy;
+}
+
+bool
+ByteTagList::IsSharedWith (const ByteTagList &o) const
+{
+  return m_data != 0 && m_data == o.m_data;
+}
+
 void 
 ByteTagList::RemoveAll (void)
 {
@@ -345,24 +342,11 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
-    {
-      struct ByteTagListData *data = g_freeList.back ();
-      g_freeList.pop_back ();
-      NS_ASSERT (data != 0);
-      if (data->size >= size)
-        {
-          data->count = 1;
-          data->dirty = 0;
-          return data;
-        }
-      uint8_t *buffer = (uint8_t *)data;
-      delete [] buffer;
-    }
-  uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
-  struct ByteTagListData *data = (struct ByteTagListData *)buffer;
+  uint32_t blockSize = size + sizeof (struct ByteTagListData) - 4;
+  void *block = PacketMemoryPool::Allocate (PacketMemoryPool::BYTE_TAG, blockSize);
+  struct ByteTagListData *data = static_cast<struct ByteTagListData *> (block);
   data->count = 1;
-  data->size = size;
+  data->size = blockSize + 4 - sizeof (struct ByteTagListData);
   data->dirty = 0;
   return data;
 }
@@ -375,20 +359,10 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
     {
       return;
     }
-  g_maxSize = std::max (g_maxSize, data->size);
   data->count--;
   if (data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
-          data->size < g_maxSize)
-        {
-          uint8_t *buffer = (uint8_t *)data;
-          delete [] buffer;
-        }
-      else
-        {
-          g_freeList.push_back (data);
-        }
+      PacketMemoryPool::Deallocate (PacketMemoryPool::BYTE_TAG, data);
     }
 }
 
@@ -188,6 +188,19 @@ private:
    */
   void Add (const ByteTagList &o);
 
+  /**
+   * \returns a copy of this list which shares no data with it.
+   *
+   * Unlike the copy constructor, the copy can be used by another
+   * thread than this list and its copies.
+   */
+  ByteTagList CreateDeepCopy (void) const;
+  /**
+   * \param o another list
+   * \returns true if this list and o reference the same data.
+   */
+  bool IsSharedWith (const ByteTagList &o) const;
+
   /**
    * 
    * Removes all of the tags from the ByteTagList
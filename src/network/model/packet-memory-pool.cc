@@ -0,0 +1,247 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-memory-pool.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::PacketMemoryPool definitions.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketMemoryPool");
+
+namespace {
+
+/**
+ * The size of the header of a block, which holds the size of the
+ * block, and keeps the block aligned for any type.
+ */
+const uint32_t BLOCK_HEADER_SIZE = alignof (std::max_align_t);
+
+/** The caches of one thread. */
+struct PacketCache
+{
+  PacketCache ();
+  ~PacketCache ();
+  std::vector<uint8_t *> blocks[PacketMemoryPool::KINDS];           //!< The free lists
+  uint32_t maxSize[PacketMemoryPool::KINDS];                        //!< The largest block size seen
+  PacketMemoryPool::Statistics statistics[PacketMemoryPool::KINDS]; //!< The activity
+};
+
+/**
+ * Flag set once the caches of the thread have been destroyed, for the
+ * packets released during the thread (or program) termination.
+ */
+thread_local bool g_packetCacheDestroyed = false;
+/** The caches of the thread. */
+thread_local PacketCache g_packetCache;
+
+PacketCache::PacketCache ()
+{
+  for (uint32_t i = 0; i < PacketMemoryPool::KINDS; i++)
+    {
+      maxSize[i] = 0;
+      statistics[i] = PacketMemoryPool::Statistics ();
+    }
+}
+
+PacketCache::~PacketCache ()
+{
+  for (uint32_t i = 0; i < PacketMemoryPool::KINDS; i++)
+    {
+      for (std::vector<uint8_t *>::iterator j = blocks[i].begin (); j != blocks[i].end (); j++)
+        {
+          delete [] *j;
+        }
+    }
+  g_packetCacheDestroyed = true;
+}
+
+/**
+ * \param [in] block The start of a block, with its header.
+ * \returns The size of the block, without its header.
+ */
+inline uint32_t &
+BlockSize (uint8_t *block)
+{
+  return *reinterpret_cast<uint32_t *> (block);
+}
+
+} // unnamed namespace
+
+uint32_t PacketMemoryPool::m_maxCachedBlocks[PacketMemoryPool::KINDS] = {
+  1000, 1000, 1000, 1000, 1000
+};
+
+void *
+PacketMemoryPool::Allocate (Kind kind, uint32_t &size)
+{
+  // Do not add function logging here: this is called for every
+  // packet, and several times for each.
+  NS_ASSERT (kind < KINDS);
+  if (!g_packetCacheDestroyed)
+    {
+      PacketCache &cache = g_packetCache;
+      std::vector<uint8_t *> &blocks = cache.blocks[kind];
+      cache.maxSize[kind] = std::max (cache.maxSize[kind], size);
+      while (!blocks.empty ())
+        {
+          uint8_t *block = blocks.back ();
+          blocks.pop_back ();
+          if (BlockSize (block) >= size)
+            {
+              cache.statistics[kind].hits++;
+              size = BlockSize (block);
+              return block + BLOCK_HEADER_SIZE;
+            }
+          cache.statistics[kind].frees++;
+          delete [] block;
+        }
+      cache.statistics[kind].misses++;
+      if (m_maxCachedBlocks[kind] > 0)
+        {
+          // Allocate the largest size, so that the block can be
+          // reused for any later request.
+          size = cache.maxSize[kind];
+        }
+    }
+  uint8_t *block = new uint8_t [BLOCK_HEADER_SIZE + size];
+  BlockSize (block) = size;
+  return block + BLOCK_HEADER_SIZE;
+}
+
+void
+PacketMemoryPool::Deallocate (Kind kind, void *p)
+{
+  NS_ASSERT (kind < KINDS);
+  uint8_t *block = static_cast<uint8_t *> (p) - BLOCK_HEADER_SIZE;
+  if (!g_packetCacheDestroyed)
+    {
+      PacketCache &cache = g_packetCache;
+      std::vector<uint8_t *> &blocks = cache.blocks[kind];
+      cache.maxSize[kind] = std::max (cache.maxSize[kind], BlockSize (block));
+      if (BlockSize (block) >= cache.maxSize[kind]
+          && blocks.size () < m_maxCachedBlocks[kind])
+        {
+          cache.statistics[kind].releases++;
+          blocks.push_back (block);
+          return;
+        }
+      cache.statistics[kind].frees++;
+    }
+  delete [] block;
+}
+
+void
+PacketMemoryPool::SetMaxCachedBlocks (Kind kind, uint32_t blocks)
+{
+  NS_LOG_FUNCTION (kind << blocks);
+  NS_ASSERT (kind < KINDS);
+  m_maxCachedBlocks[kind] = blocks;
+}
+
+uint32_t
+PacketMemoryPool::GetMaxCachedBlocks (Kind kind)
+{
+  NS_LOG_FUNCTION (kind);
+  NS_ASSERT (kind < KINDS);
+  return m_maxCachedBlocks[kind];
+}
+
+PacketMemoryPool::Statistics
+PacketMemoryPool::GetStatistics (Kind kind)
+{
+  NS_LOG_FUNCTION (kind);
+  NS_ASSERT (kind < KINDS);
+  if (g_packetCacheDestroyed)
+    {
+      return Statistics ();
+    }
+  Statistics statistics = g_packetCache.statistics[kind];
+  statistics.cached = g_packetCache.blocks[kind].size ();
+  return statistics;
+}
+
+void
+PacketMemoryPool::ResetStatistics (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (g_packetCacheDestroyed)
+    {
+      return;
+    }
+  for (uint32_t i = 0; i < KINDS; i++)
+    {
+      g_packetCache.statistics[i] = Statistics ();
+    }
+}
+
+void
+PacketMemoryPool::PrintStatistics (std::ostream &os)
+{
+  NS_LOG_FUNCTION (&os);
+  os << std::left << std::setw (12) << "kind" << std::right
+     << std::setw (12) << "hits"
+     << std::setw (12) << "misses"
+     << std::setw (12) << "releases"
+     << std::setw (12) << "frees"
+     << std::setw (12) << "cached"
+     << std::endl;
+  for (uint32_t i = 0; i < KINDS; i++)
+    {
+      Statistics statistics = GetStatistics (static_cast<Kind> (i));
+      os << std::left << std::setw (12) << GetKindName (static_cast<Kind> (i)) << std::right
+         << std::setw (12) << statistics.hits
+         << std::setw (12) << statistics.misses
+         << std::setw (12) << statistics.releases
+         << std::setw (12) << statistics.frees
+         << std::setw (12) << statistics.cached
+         << std::endl;
+    }
+}
+
+const char *
+PacketMemoryPool::GetKindName (Kind kind)
+{
+  switch (kind)
+    {
+    case PACKET:
+      return "packet";
+    case BUFFER:
+      return "buffer";
+    case METADATA:
+      return "metadata";
+    case PACKET_TAG:
+      return "packet-tag";
+    case BYTE_TAG:
+      return "byte-tag";
+    default:
+      break;
+    }
+  return "unknown";
+}
+
+} // namespace ns3
@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PACKET_MEMORY_POOL_H
+#define PACKET_MEMORY_POOL_H
+
+#include <stdint.h>
+#include <ostream>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Per-thread caches of the memory blocks of packets.
+ *
+ * The Packet objects and the variable-sized storage of their Buffer,
+ * PacketMetadata, PacketTagList and ByteTagList are allocated from,
+ * and released to, the cache of the calling thread, with one free list
+ * per kind of block.  The threads of a multi-threaded simulator thus
+ * never share a free list, and a block released by another thread than
+ * the one which allocated it simply joins the cache of the releasing
+ * thread.
+ *
+ * Like the free lists it replaces, each cache keeps the largest block
+ * size it has seen for each kind, allocates blocks of at least this
+ * size, and only keeps blocks of this size, so that a cached block can
+ * be reused for any later request of the same kind.
+ *
+ * The number of blocks cached per kind and thread is set with
+ * SetMaxCachedBlocks: zero disables the cache of a kind, which is
+ * then allocated from the heap.  GetStatistics reports the hits and
+ * misses of the cache of the calling thread.
+ */
+class PacketMemoryPool
+{
+public:
+  /** The kinds of blocks, each with its own free list. */
+  enum Kind
+  {
+    PACKET = 0,   //!< Packet objects
+    BUFFER,       //!< Buffer data
+    METADATA,     //!< PacketMetadata data
+    PACKET_TAG,   //!< PacketTagList nodes
+    BYTE_TAG,     //!< ByteTagList data
+    KINDS         //!< The number of kinds
+  };
+
+  /** The activity of the cache of a kind, in a thread. */
+  struct Statistics
+  {
+    uint64_t hits;      //!< Blocks allocated from the cache
+    uint64_t misses;    //!< Blocks allocated from the heap
+    uint64_t releases;  //!< Blocks released to the cache
+    uint64_t frees;     //!< Blocks released to the heap
+    uint32_t cached;    //!< Blocks currently in the cache
+  };
+
+  /**
+   * Allocate a block from the cache of the calling thread.
+   *
+   * \param [in] kind The kind of block.
+   * \param [in,out] size The requested size, in bytes; set to the
+   *        size of the block, which can be larger.
+   * \returns The block, aligned for any type.
+   */
+  static void *Allocate (Kind kind, uint32_t &size);
+  /**
+   * Release a block to the cache of the calling thread.
+   *
+   * \param [in] kind The kind of block.
+   * \param [in] block The block, returned by Allocate for the same kind.
+   */
+  static void Deallocate (Kind kind, void *block);
+
+  /**
+   * Set the maximum number of blocks of a kind cached per thread.
+   *
+   * This should be called before the simulation threads start.
+   *
+   * \param [in] kind The kind of block.
+   * \param [in] blocks The maximum number of blocks; 0 disables the cache.
+   */
+  static void SetMaxCachedBlocks (Kind kind, uint32_t blocks);
+  /**
+   * \param [in] kind The kind of block.
+   * \returns The maximum number of blocks of a kind cached per thread.
+   */
+  static uint32_t GetMaxCachedBlocks (Kind kind);
+
+  /**
+   * \param [in] kind The kind of block.
+   * \returns The activity of the cache of the calling thread.
+   */
+  static Statistics GetStatistics (Kind kind);
+  /**
+   * Reset the counters of the caches of the calling thread.
+   */
+  static void ResetStatistics (void);
+  /**
+   * Print the activity of the caches of the calling thread, one line
+   * per kind.
+   *
+   * \param [in] os The output stream.
+   */
+  static void PrintStatistics (std::ostream &os);
+  /**
+   * \param [in] kind The kind of block.
+   * \returns The name of the kind.
+   */
+  static const char *GetKindName (Kind kind);
+
+private:
+  /** The maximum number of blocks cached per kind and thread. */
+  static uint32_t m_maxCachedBlocks[KINDS];
+};
+
+} // namespace ns3
+
+#endif /* PACKET_MEMORY_POOL_H */
@@ -19,10 +19,12 @@
  */
 #include <utility>
 #include <list>
+#include <algorithm>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include "packet-metadata.h"
+#include "packet-memory-pool.h"
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -33,20 +35,9 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
+bool PacketMetadata::m_enableCompact = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
-
-PacketMetadata::DataFreeList::~DataFreeList ()
-{
-  NS_LOG_FUNCTION (this);
-  for (iterator i = begin (); i != end (); i++)
-    {
-      PacketMetadata::Deallocate (*i);
-    }
-  PacketMetadata::m_enable = false;
-}
+std::atomic<uint16_t> PacketMetadata::m_chunkUid (0);
 
 void 
 PacketMetadata::Enable (void)
@@ -70,6 +61,21 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableCompact (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Enable ();
+  m_enableCompact = true;
+}
+
+void
+PacketMetadata::DisableCompact (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_enableCompact = false;
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -133,6 +139,12 @@ bool
 PacketMetadata::IsStateOk (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_isCompact)
+    {
+      return m_data->m_size >= PACKET_METADATA_COMPACT_ITEMS * sizeof (struct CompactItem) &&
+             m_head <= m_tail &&
+             m_tail <= PACKET_METADATA_COMPACT_ITEMS;
+    }
   bool ok = m_used <= m_data->m_size;
   ok &= IsPointerOk (m_head);
   ok &= IsPointerOk (m_tail);
@@ -505,6 +517,7 @@ PacketMetadata::ReplaceTail (PacketMetadata::SmallItem *item,
 
   // create a copy of the packet without its tail.
   PacketMetadata h (m_packetUid, 0);
+  h.Materialize ();
   uint16_t current = m_head;
   while (current != 0xffff && current != m_tail)
     {
@@ -570,76 +583,154 @@ struct PacketMetadata::Data *
 PacketMetadata::Create (uint32_t size)
 {
   NS_LOG_FUNCTION (size);
-  NS_LOG_LOGIC ("create size="<<size<<", max="<<m_maxSize);
-  if (size > m_maxSize)
-    {
-      m_maxSize = size;
-    }
-  while (!m_freeList.empty ()) 
-    {
-      struct PacketMetadata::Data *data = m_freeList.back ();
-      m_freeList.pop_back ();
-      if (data->m_size >= size) 
-        {
-          NS_LOG_LOGIC ("create found size="<<data->m_size);
-          data->m_count = 1;
-          return data;
-        }
-      NS_LOG_LOGIC ("create dealloc size="<<data->m_size);
-      PacketMetadata::Deallocate (data);
-    }
-  NS_LOG_LOGIC ("create alloc size="<<m_maxSize);
-  return PacketMetadata::Allocate (m_maxSize);
+  uint32_t n = std::max<uint32_t> (size, PACKET_METADATA_DATA_M_DATA_SIZE);
+  uint32_t blockSize = sizeof (struct Data) + n - PACKET_METADATA_DATA_M_DATA_SIZE;
+  void *block = PacketMemoryPool::Allocate (PacketMemoryPool::METADATA, blockSize);
+  struct PacketMetadata::Data *data = static_cast<struct PacketMetadata::Data *> (block);
+  data->m_size = std::min<uint32_t> (blockSize - sizeof (struct Data) + PACKET_METADATA_DATA_M_DATA_SIZE,
+                                     std::numeric_limits<uint16_t>::max ());
+  data->m_count = 1;
+  data->m_dirtyEnd = 0;
+  NS_LOG_LOGIC ("create size="<<size<<", got="<<data->m_size);
+  return data;
 }
 
 void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
+  NS_ASSERT (data->m_count == 0);
+  PacketMemoryPool::Deallocate (PacketMemoryPool::METADATA, data);
+}
+
+struct PacketMetadata::CompactItem *
+PacketMetadata::GetCompactItems (void) const
+{
+  return reinterpret_cast<struct PacketMetadata::CompactItem *> (m_data->m_data);
+}
+
+bool
+PacketMetadata::AddCompact (uint16_t uid, uint32_t size, bool atStart)
+{
+  NS_LOG_FUNCTION (this << uid << size << atStart);
+  NS_ASSERT (m_isCompact);
+  uint32_t n = m_tail - m_head;
+  if (n == PACKET_METADATA_COMPACT_ITEMS)
     {
-      PacketMetadata::Deallocate (data);
+      DoMaterialize ();
+      return false;
+    }
+  if (m_data->m_count > 1)
+    {
+      // The items are shared with other packets: copy them before
+      // writing.
+      struct PacketMetadata::Data *data =
+        PacketMetadata::Create (PACKET_METADATA_COMPACT_ITEMS * sizeof (struct CompactItem));
+      std::copy (&GetCompactItems ()[m_head], &GetCompactItems ()[m_tail],
+                 &reinterpret_cast<struct PacketMetadata::CompactItem *> (data->m_data)[m_head]);
+      m_data->m_count--;
+      m_data = data;
+    }
+  struct PacketMetadata::CompactItem *items = GetCompactItems ();
+  if (atStart && m_head == 0)
+    {
+      // move the items to the end of the array
+      uint16_t shift = PACKET_METADATA_COMPACT_ITEMS - m_tail;
+      std::copy_backward (&items[m_head], &items[m_tail], &items[m_tail + shift]);
+      m_head += shift;
+      m_tail += shift;
+    }
+  else if (!atStart && m_tail == PACKET_METADATA_COMPACT_ITEMS)
+    {
+      // move the items to the start of the array
+      std::copy (&items[m_head], &items[m_tail], &items[0]);
+      m_head = 0;
+      m_tail = n;
+    }
+  struct PacketMetadata::CompactItem *item = atStart ?
+    &items[--m_head] : &items[m_tail++];
+  item->typeUid = uid;
+  item->chunkUid = m_chunkUid.fetch_add (1, std::memory_order_relaxed);
+  item->size = size;
+  return true;
+}
+
+void
+PacketMetadata::RemoveCompact (uint16_t uid, uint32_t size, bool atStart)
+{
+  NS_LOG_FUNCTION (this << uid << size << atStart);
+  NS_ASSERT (m_isCompact);
+  if (m_head == m_tail)
+    {
+      if (m_enableChecking)
+        {
+          NS_FATAL_ERROR ("Removing a chunk from a packet without metadata items.");
+        }
       return;
-    } 
-  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
-  NS_ASSERT (data->m_count == 0);
-  if (m_freeList.size () > 1000 ||
-      data->m_size < m_maxSize) 
+    }
+  const struct PacketMetadata::CompactItem &item = atStart ?
+    GetCompactItems ()[m_head] : GetCompactItems ()[m_tail - 1];
+  if (item.typeUid != uid || item.size != size)
     {
-      PacketMetadata::Deallocate (data);
-    } 
-  else 
+      if (m_enableChecking)
+        {
+          NS_FATAL_ERROR ((atStart ? "Removing unexpected header." : "Removing unexpected trailer."));
+        }
+      return;
+    }
+  if (atStart)
     {
-      m_freeList.push_back (data);
+      m_head++;
+    }
+  else
+    {
+      m_tail--;
     }
 }
 
-struct PacketMetadata::Data *
-PacketMetadata::Allocate (uint32_t n)
+void
+PacketMetadata::Materialize (void) const
 {
-  NS_LOG_FUNCTION (n);
-  uint32_t size = sizeof (struct Data);
-  if (n <= PACKET_METADATA_DATA_M_DATA_SIZE)
+  if (m_isCompact)
     {
-      n = PACKET_METADATA_DATA_M_DATA_SIZE;
+      const_cast<PacketMetadata *> (this)->DoMaterialize ();
     }
-  size += n - PACKET_METADATA_DATA_M_DATA_SIZE;
-  uint8_t *buf = new uint8_t [size];
-  struct PacketMetadata::Data *data = (struct PacketMetadata::Data *)buf;
-  data->m_size = n;
-  data->m_count = 1;
-  data->m_dirtyEnd = 0;
-  return data;
 }
-void 
-PacketMetadata::Deallocate (struct PacketMetadata::Data *data)
+
+void
+PacketMetadata::DoMaterialize (void)
 {
-  NS_LOG_FUNCTION (data);
-  uint8_t *buf = (uint8_t *)data;
-  delete [] buf;
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_isCompact);
+  struct PacketMetadata::Data *compact = m_data;
+  const struct PacketMetadata::CompactItem *items = GetCompactItems ();
+  uint16_t start = m_head;
+  uint16_t end = m_tail;
+  m_isCompact = false;
+  m_data = PacketMetadata::Create (10 * std::max<uint32_t> (end - start, 1));
+  memset (m_data->m_data, 0xff, 4);
+  m_head = 0xffff;
+  m_tail = 0xffff;
+  m_used = 0;
+  for (uint16_t i = start; i < end; i++)
+    {
+      struct PacketMetadata::SmallItem item;
+      item.next = 0xffff;
+      item.prev = m_tail;
+      item.typeUid = items[i].typeUid << 1;
+      item.size = items[i].size;
+      item.chunkUid = items[i].chunkUid;
+      uint16_t written = AddSmall (&item);
+      UpdateTail (written);
+    }
+  compact->m_count--;
+  if (compact->m_count == 0)
+    {
+      PacketMetadata::Recycle (compact);
+    }
+  NS_ASSERT (IsStateOk ());
 }
 
-
 PacketMetadata 
 PacketMetadata::CreateFragment (uint32_t start, uint32_t end) const
 {
@@ -650,12 +741,36 @@ PacketMetadata::CreateFragment (uint32_t start, uint32_t end) const
   return fragment;
 }
 
+PacketMetadata
+PacketMetadata::CreateDeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  PacketMetadata copy = *this;
+  struct Data *data = PacketMetadata::Create (m_data->m_size);
+  std::memcpy (data->m_data, m_data->m_data, m_data->m_size);
+  data->m_dirtyEnd = m_data->m_dirtyEnd;
+  // this still references the shared data.
+  copy.m_data->m_count--;
+  copy.m_data = data;
+  return copy;
+}
+
+bool
+PacketMetadata::IsSharedWith (PacketMetadata const &o) const
+{
+  return m_data == o.m_data;
+}
+
 void 
 PacketMetadata::AddHeader (const Header &header, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &header << size);
   NS_ASSERT (IsStateOk ());
   uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
+  if (m_isCompact && AddCompact (uid >> 1, size, true))
+    {
+      return;
+    }
   DoAddHeader (uid, size);
   NS_ASSERT (IsStateOk ());
 }
@@ -674,8 +789,7 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
   item.prev = 0xffff;
   item.typeUid = uid;
   item.size = size;
-  item.chunkUid = m_chunkUid;
-  m_chunkUid++;
+  item.chunkUid = m_chunkUid.fetch_add (1, std::memory_order_relaxed);
   uint16_t written = AddSmall (&item);
   UpdateHead (written);
 }
@@ -690,6 +804,11 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_isCompact)
+    {
+      RemoveCompact (uid >> 1, size, true);
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_head, &item, &extraItem);
@@ -738,13 +857,16 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_isCompact && AddCompact (uid >> 1, size, false))
+    {
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   item.next = 0xffff;
   item.prev = m_tail;
   item.typeUid = uid;
   item.size = size;
-  item.chunkUid = m_chunkUid;
-  m_chunkUid++;
+  item.chunkUid = m_chunkUid.fetch_add (1, std::memory_order_relaxed);
   uint16_t written = AddSmall (&item);
   UpdateTail (written);
   NS_ASSERT (IsStateOk ());
@@ -760,6 +882,11 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_isCompact)
+    {
+      RemoveCompact (uid >> 1, size, false);
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_tail, &item, &extraItem);
@@ -807,6 +934,14 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       m_metadataSkipped = true;
       return;
     }
+  if (m_isCompact && m_head == m_tail)
+    {
+      *this = o;
+      return;
+    }
+  // The items of two packets are merged in the linked list.
+  Materialize ();
+  o.Materialize ();
   if (m_tail == 0xffff)
     {
       // We have no items so 'AddAtEnd' is 
@@ -895,6 +1030,21 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       m_metadataSkipped = true;
       return;
     }
+  if (m_isCompact)
+    {
+      while (start > 0 && m_head != m_tail &&
+             GetCompactItems ()[m_head].size <= start)
+        {
+          start -= GetCompactItems ()[m_head].size;
+          m_head++;
+        }
+      if (start == 0)
+        {
+          return;
+        }
+      // The first item is fragmented.
+      DoMaterialize ();
+    }
   NS_ASSERT (m_data != 0);
   uint32_t leftToRemove = start;
   uint16_t current = m_head;
@@ -922,6 +1072,7 @@ PacketMetadata::RemoveAtStart (uint32_t start)
         {
           // fragment the list item.
           PacketMetadata fragment (m_packetUid, 0);
+          fragment.Materialize ();
           extraItem.fragmentStart += leftToRemove;
           leftToRemove = 0;
           uint16_t written = fragment.AddBig (0xffff, fragment.m_tail,
@@ -958,6 +1109,21 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       m_metadataSkipped = true;
       return;
     }
+  if (m_isCompact)
+    {
+      while (end > 0 && m_head != m_tail &&
+             GetCompactItems ()[m_tail - 1].size <= end)
+        {
+          end -= GetCompactItems ()[m_tail - 1].size;
+          m_tail--;
+        }
+      if (end == 0)
+        {
+          return;
+        }
+      // The last item is fragmented.
+      DoMaterialize ();
+    }
   NS_ASSERT (m_data != 0);
 
   uint32_t leftToRemove = end;
@@ -986,6 +1152,7 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
         {
           // fragment the list item.
           PacketMetadata fragment (m_packetUid, 0);
+          fragment.Materialize ();
           NS_ASSERT (extraItem.fragmentEnd > leftToRemove);
           extraItem.fragmentEnd -= leftToRemove;
           leftToRemove = 0;
@@ -1017,6 +1184,7 @@ uint32_t
 PacketMetadata::GetTotalSize (void) const
 {
   NS_LOG_FUNCTION (this);
+  Materialize ();
   uint32_t totalSize = 0;
   uint16_t current = m_head;
   uint16_t tail = m_tail;
@@ -1046,6 +1214,7 @@ PacketMetadata::ItemIterator
 PacketMetadata::BeginItem (Buffer buffer) const
 {
   NS_LOG_FUNCTION (this << &buffer);
+  Materialize ();
   return ItemIterator (this, buffer);
 }
 PacketMetadata::ItemIterator::ItemIterator (const PacketMetadata *metadata, Buffer buffer)
@@ -1145,6 +1314,7 @@ PacketMetadata::GetSerializedSize (void) const
     {
       return totalSize;
     }
+  Materialize ();
 
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
@@ -1178,6 +1348,7 @@ uint32_t
 PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
+  Materialize ();
   uint8_t* start = buffer;
 
   buffer = AddToRawU64 (m_packetUid, start, buffer, maxSize);
@@ -1279,6 +1450,7 @@ uint32_t
 PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
+  Materialize ();
   const uint8_t* start = buffer;
   uint32_t desSize = size - 4;
 
@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include <vector>
 #include <limits>
+#include <atomic>
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
@@ -74,6 +75,16 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * When enabled with EnableCompact, a new packet only records the
+ * type, chunk uid and size of its headers, payload and trailers in a
+ * small array of CompactItem, stored in the m_data buffer instead of the
+ * linked list and shared by the copies of the packet in the same way:
+ * adding and removing whole headers and trailers then neither encodes
+ * nor copies the linked list above.  The linked list is built from this
+ * array, in place, when an operation needs it: when the array is full,
+ * when a header is fragmented, when packets are concatenated, and when
+ * the items are iterated over or serialized.
  */
 class PacketMetadata 
 {
@@ -160,6 +171,16 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the packet metadata, recorded in the compact
+   * representation until the full list is needed.
+   */
+  static void EnableCompact (void);
+  /**
+   * \brief Record the metadata of the new packets in the linked list
+   * again, after EnableCompact.
+   */
+  static void DisableCompact (void);
 
   /**
    * \brief Constructor
@@ -217,6 +238,18 @@ private:
    * and then, RemoveAtEnd (end).
    */
   PacketMetadata CreateFragment (uint32_t start, uint32_t end) const;
+  /**
+   * \return a copy of this metadata which shares no data with it.
+   *
+   * Unlike the copy constructor, the copy can be used by another
+   * thread than this metadata and its copies.
+   */
+  PacketMetadata CreateDeepCopy (void) const;
+  /**
+   * \param o another metadata
+   * \return true if this metadata and o reference the same data.
+   */
+  bool IsSharedWith (PacketMetadata const &o) const;
 
   /**
    * \brief Add a metadata at the metadata start
@@ -494,16 +527,6 @@ private:
     uint64_t packetUid;
   };
 
-  /**
-   * \brief Class to hold all the metadata
-   */
-  class DataFreeList : public std::vector<struct Data *>
-  {
-public:
-    ~DataFreeList ();
-  };
-
-  friend DataFreeList::~DataFreeList ();
   /// Friend class
   friend class ItemIterator;
 
@@ -614,6 +637,54 @@ public:
   uint32_t ReadItems (uint16_t current, 
                       struct PacketMetadata::SmallItem *item,
                       struct PacketMetadata::ExtraItem *extraItem) const;
+
+/// The number of items of the compact representation.
+#define PACKET_METADATA_COMPACT_ITEMS 8
+
+  /**
+   * \brief An item of the compact representation: a whole header,
+   * trailer or payload, added to this packet.
+   */
+  struct CompactItem
+  {
+    uint16_t typeUid;  //!< The TypeId uid of the chunk, zero for payload
+    uint16_t chunkUid; //!< The chunk uid, as in SmallItem
+    uint32_t size;     //!< The size of the chunk
+  };
+  /**
+   * \brief Add an item to the compact representation
+   * \param uid the TypeId uid of the chunk, zero for payload
+   * \param size the chunk size
+   * \param atStart true to add a header, false to add a trailer
+   * \returns false if the compact representation is full: the linked
+   *          list has then been built, and the item must be added to it.
+   */
+  bool AddCompact (uint16_t uid, uint32_t size, bool atStart);
+  /**
+   * \brief Remove a whole header or trailer from the compact
+   * representation
+   * \param uid the TypeId uid of the chunk
+   * \param size the chunk size
+   * \param atStart true to remove a header, false to remove a trailer
+   */
+  void RemoveCompact (uint16_t uid, uint32_t size, bool atStart);
+  /**
+   * \brief Get the items of the compact representation
+   * \returns the array of PACKET_METADATA_COMPACT_ITEMS items in m_data
+   */
+  struct CompactItem *GetCompactItems (void) const;
+  /**
+   * \brief Build the linked list from the compact representation,
+   * if this object still uses it.
+   *
+   * This only changes the representation of the items, which is why
+   * it can be called on constant objects.
+   */
+  void Materialize (void) const;
+  /**
+   * \brief Build the linked list from the compact representation.
+   */
+  void DoMaterialize (void);
   /**
    * \brief Add an header
    * \param uid header's uid to add
@@ -639,31 +710,20 @@ public:
   bool IsSharedPointerOk (uint16_t pointer) const;
 
   /**
-   * \brief Recycle the buffer memory
+   * \brief Recycle the buffer memory in the PacketMemoryPool
    * \param data the buffer data storage
    */
   static void Recycle (struct PacketMetadata::Data *data);
   /**
-   * \brief Create a buffer data storage
+   * \brief Create a buffer data storage from the PacketMemoryPool
    * \param size the storage size to create
    * \returns a pointer to the created buffer storage
    */
   static struct PacketMetadata::Data *Create (uint32_t size);
-  /**
-   * \brief Allocate a buffer data storage
-   * \param n the storage size to create
-   * \returns a pointer to the allocated buffer storage
-   */
-  static struct PacketMetadata::Data *Allocate (uint32_t n);
-  /**
-   * \brief Deallocate the buffer memory
-   * \param data the buffer data storage
-   */
-  static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
+  static bool m_enableCompact; //!< Record new packets in the compact representation
 
   /**
    * Set to true when adding metadata to a packet is skipped because
@@ -672,18 +732,26 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  static std::atomic<uint16_t> m_chunkUid; //!< Chunk Uid, shared by the partition threads
 
   struct Data *m_data; //!< Metadata storage
   /*
      head -(next)-> tail
        ^             |
         \---(prev)---|
+
+     While m_isCompact, the items of this packet are the CompactItem
+     [m_head, m_tail) of m_data, from the first header to the last
+     trailer.
    */
-  uint16_t m_head; //!< list head
-  uint16_t m_tail; //!< list tail
+  uint16_t m_head; //!< list head, or first compact item
+  uint16_t m_tail; //!< list tail, or past the last compact item
   uint16_t m_used; //!< used portion
+  /**
+   * True while m_data holds the compact representation instead of
+   * the linked list.
+   */
+  bool m_isCompact;
   uint64_t m_packetUid; //!< packet Uid
 };
 
@@ -692,12 +760,26 @@ public:
 namespace ns3 {
 
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : m_data (0),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
+    m_isCompact (m_enableCompact),
     m_packetUid (uid)
 {
+  if (m_isCompact)
+    {
+      m_data = PacketMetadata::Create (PACKET_METADATA_COMPACT_ITEMS * sizeof (struct CompactItem));
+      // leave most of the room for the headers
+      m_head = PACKET_METADATA_COMPACT_ITEMS - 2;
+      m_tail = m_head;
+      if (size > 0)
+        {
+          AddCompact (0, size, false);
+        }
+      return;
+    }
+  m_data = PacketMetadata::Create (10);
   memset (m_data->m_data, 0xff, 4);
   if (size > 0)
     {
@@ -709,6 +791,7 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
+    m_isCompact (o.m_isCompact),
     m_packetUid (o.m_packetUid)
 {
   NS_ASSERT (m_data != 0);
@@ -735,6 +818,7 @@ PacketMetadata::operator = (PacketMetadata const& o)
   m_tail = o.m_tail;
   m_used = o.m_used;
   m_packetUid = o.m_packetUid;
+  m_isCompact = o.m_isCompact;
   return *this;
 }
 PacketMetadata::~PacketMetadata ()
@@ -43,8 +43,9 @@ PacketTagList::CreateTagData (size_t dataSize)
                  << " exceeds maximum "
                  << std::numeric_limits<decltype(TagData::size)>::max () );
 
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
+  uint32_t size = sizeof (TagData) + dataSize - 1;
+  void * p = PacketMemoryPool::Allocate (PacketMemoryPool::PACKET_TAG, size);
+  // The matching deallocations are in RemoveAll and RemoveWriter
 
   TagData * tag = new (p) TagData;
   tag->size = dataSize;
@@ -195,7 +196,7 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
     {
       // found tid before first merge, so delete cur
       cur->~TagData ();
-      std::free (cur);
+      PacketMemoryPool::Deallocate (PacketMemoryPool::PACKET_TAG, cur);
     }
   else
     {
@@ -300,5 +301,41 @@ PacketTagList::Head (void) const
   return m_next;
 }
 
+PacketTagList
+PacketTagList::CreateDeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  PacketTagList copy;
+  struct TagData **prevNext = &copy.m_next;
+  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+    {
+      struct TagData *tag = CreateTagData (cur->size);
+      tag->count = 1;
+      tag->next = 0;
+      tag->tid = cur->tid;
+      std::memcpy (tag->data, cur->data, cur->size);
+      *prevNext = tag;
+      prevNext = &tag->next;
+    }
+  return copy;
+}
+
+bool
+PacketTagList::IsSharedWith (const PacketTagList &o) const
+{
+  // The lists only share their tails: compare the last TagData.
+  struct TagData *last = m_next;
+  struct TagData *otherLast = o.m_next;
+  while (last != 0 && last->next != 0)
+    {
+      last = last->next;
+    }
+  while (otherLast != 0 && otherLast->next != 0)
+    {
+      otherLast = otherLast->next;
+    }
+  return last != 0 && last == otherLast;
+}
+
 } /* namespace ns3 */
 
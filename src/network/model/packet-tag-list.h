@@ -28,6 +28,7 @@
 #include <stdint.h>
 #include <ostream>
 #include "ns3/type-id.h"
+#include "packet-memory-pool.h"
 
 namespace ns3 {
 
@@ -217,6 +218,18 @@ public:
    * \returns pointer to head of tag list
    */
   const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \returns a copy of this list which shares no TagData with it.
+   *
+   * Unlike the copy constructor, the copy can be used by another
+   * thread than this list and its copies.
+   */
+  PacketTagList CreateDeepCopy (void) const;
+  /**
+   * \param [in] o Another list.
+   * \returns True if this list and \pname{o} share some TagData.
+   */
+  bool IsSharedWith (const PacketTagList &o) const;
 
 private:
   /**
@@ -342,14 +355,14 @@ PacketTagList::RemoveAll (void)
       if (prev != 0) 
         {
           prev->~TagData ();
-          std::free (prev);
+          PacketMemoryPool::Deallocate (PacketMemoryPool::PACKET_TAG, prev);
         }
       prev = cur;
     }
   if (prev != 0) 
     {
       prev->~TagData ();
-      std::free (prev);
+      PacketMemoryPool::Deallocate (PacketMemoryPool::PACKET_TAG, prev);
     }
   m_next = 0;
 }
@@ -18,9 +18,11 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "packet.h"
+#include "packet-memory-pool.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include <algorithm>
 #include <string>
 #include <cstdarg>
 
@@ -28,7 +30,20 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+std::atomic<uint32_t> Packet::m_globalUid[Packet::UID_PARTITIONS];
+bool Packet::m_payloadSegments = false;
+
+uint64_t
+Packet::AllocateUid (void)
+{
+  // Partitions beyond the last counter share it: their uids stay
+  // unique, but depend on the timing of the threads.
+  uint32_t partition = std::min (Simulator::GetPartitionId (), UID_PARTITIONS - 1);
+  uint32_t uid = m_globalUid[partition].fetch_add (1, std::memory_order_relaxed);
+  return static_cast<uint64_t> (partition) << 48
+    | static_cast<uint64_t> (Simulator::GetSystemId ()) << 32
+    | uid;
+}
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -126,20 +141,48 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+Ptr<Packet>
+Packet::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Packet> copy = Ptr<Packet> (new Packet (m_buffer.CreateDeepCopy (),
+                                              m_byteTagList.CreateDeepCopy (),
+                                              m_packetTagList.CreateDeepCopy (),
+                                              m_metadata.CreateDeepCopy ()), false);
+  if (m_nixVector)
+    {
+      copy->m_nixVector = m_nixVector->Copy ();
+    }
+  return copy;
+}
+
+Ptr<Packet>
+Packet::CopyForContext (uint32_t context) const
+{
+  if (Simulator::GetContextPartitionId (context) == Simulator::GetPartitionId ())
+    {
+      return Copy ();
+    }
+  return DeepCopy ();
+}
+
+bool
+Packet::IsSharedWith (Ptr<const Packet> other) const
+{
+  NS_LOG_FUNCTION (this << other);
+  return m_buffer.IsSharedWith (other->m_buffer)
+         || m_byteTagList.IsSharedWith (other->m_byteTagList)
+         || m_packetTagList.IsSharedWith (other->m_packetTagList)
+         || m_metadata.IsSharedWith (other->m_metadata);
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (AllocateUid (), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
@@ -172,16 +215,9 @@ Packet::Packet (uint32_t size)
   : m_buffer (size),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -198,21 +234,33 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
   : m_buffer (),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
+  if (m_payloadSegments)
+    {
+      m_buffer = Buffer (buffer, size);
+      return;
+    }
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
 }
 
+void *
+Packet::operator new (size_t size)
+{
+  // Do not add function logging here: this is called for every packet.
+  uint32_t blockSize = size;
+  return PacketMemoryPool::Allocate (PacketMemoryPool::PACKET, blockSize);
+}
+
+void
+Packet::operator delete (void *p)
+{
+  PacketMemoryPool::Deallocate (PacketMemoryPool::PACKET, p);
+}
+
 Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList, 
                 const PacketTagList &packetTagList, const PacketMetadata &metadata)
   : m_buffer (buffer),
@@ -582,6 +630,20 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+void
+Packet::EnableCompactPrinting (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  PacketMetadata::EnableCompact ();
+}
+
+void
+Packet::EnablePayloadSegments (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_payloadSegments = true;
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
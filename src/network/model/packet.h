@@ -21,6 +21,7 @@
 #define PACKET_H
 
 #include <stdint.h>
+#include <atomic>
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -278,12 +279,29 @@ public:
    * of this buffer.
    *
    * The input data is copied: the input
-   * buffer is untouched.
+   * buffer is untouched.  If EnablePayloadSegments was called, the
+   * data is copied in a payload segment shared by the copies and the
+   * fragments of the packet.
    *
    * \param buffer the data to store in the packet.
    * \param size the size of the input buffer.
    */
   Packet (uint8_t const*buffer, uint32_t size);
+  /**
+   * \brief Allocate a packet from the PacketMemoryPool of the
+   * calling thread.
+   *
+   * \param size the size of the object.
+   * \returns the memory of the object.
+   */
+  static void *operator new (size_t size);
+  /**
+   * \brief Release a packet to the PacketMemoryPool of the calling
+   * thread.
+   *
+   * \param p the memory of the object.
+   */
+  static void operator delete (void *p);
   /**
    * \brief Create a new packet which contains a fragment of the original
    * packet.
@@ -453,6 +471,37 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \brief performs a deep copy of the packet.
+   *
+   * \returns a copy of the packet which shares no data with it.
+   *
+   * A Copy and the original packet update their shared datasets, and
+   * must thus be used by the same thread.  A deep copy can be used by
+   * another thread, for example by another partition of a
+   * MultithreadedSimulatorImpl.
+   */
+  Ptr<Packet> DeepCopy (void) const;
+
+  /**
+   * \brief copies the packet to hand it to the events of a context.
+   *
+   * \param context the context of the events which use the copy.
+   * \returns a Copy of the packet if the events of the context run in
+   * the current partition (see Simulator::GetContextPartitionId), and a
+   * DeepCopy otherwise.
+   *
+   * The channels use it to deliver the packets to the receiving nodes.
+   */
+  Ptr<Packet> CopyForContext (uint32_t context) const;
+
+  /**
+   * \param other another packet.
+   * \returns true if this packet and other share some of their
+   * datasets, and must thus be used by the same thread.
+   */
+  bool IsSharedWith (Ptr<const Packet> other) const;
+
   /**
    * \brief Returns the packet's Uid.
    *
@@ -530,6 +579,33 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable printing packets metadata, in a compact form.
+   *
+   * Like EnablePrinting, but each packet only records the type and
+   * size of its whole headers, payload and trailers, in a small array
+   * of the packet metadata, as long as they fit and are not
+   * fragmented.  The full metadata is built when the packet is
+   * printed, iterated over, serialized, fragmented or concatenated, so
+   * that adding and removing headers is cheaper.
+   *
+   * \sa PacketMetadata::EnableCompact
+   */
+  static void EnableCompactPrinting (void);
+  /**
+   * \brief Keep the payload of packets created from a byte buffer
+   * in shared payload segments.
+   *
+   * The payload of the packets created afterwards with
+   * Packet (uint8_t const*, uint32_t) is kept in a read-only segment
+   * of their Buffer, shared by all their copies and fragments, so that
+   * adding headers to a copy, or to a fragment, does not copy the
+   * payload.  Reading the headers of these packets is slightly slower,
+   * since the payload bytes are no longer contiguous with the headers.
+   *
+   * \sa Buffer::Buffer (uint8_t const*, uint32_t)
+   */
+  static void EnablePayloadSegments (void);
 
   /**
    * \brief Returns number of bytes required for packet
@@ -779,6 +855,24 @@ private:
    */
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /**
+   * \brief Allocate the uid of a new packet.
+   *
+   * The lower 32 bits are a counter of the packets created by the
+   * current partition (see Simulator::GetPartitionId), bits 32 to 47
+   * are the system id, and the upper 16 bits are the partition.  Each
+   * partition counts its own packets, so that the uids of a
+   * multithreaded simulation do not depend on the timing of the
+   * threads.  Outside of partition threads, the uids are the system id
+   * and a global counter, as in sequential simulations.
+   *
+   * \returns The uid.
+   */
+  static uint64_t AllocateUid (void);
+
+  /** The number of partitions with their own uid counter. */
+  static const uint32_t UID_PARTITIONS = 256;
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
@@ -787,7 +881,8 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  static std::atomic<uint32_t> m_globalUid[UID_PARTITIONS]; //!< Counters of packets Uid, per partition
+  static bool m_payloadSegments; //!< Whether payloads are kept in segments
 };
 
 /**
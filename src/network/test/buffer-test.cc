@@ -389,6 +389,132 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer payload segment tests.
+ */
+class BufferPayloadSegmentTest : public TestCase {
+private:
+  /**
+   * Checks the buffer content, with CopyData and with an iterator
+   * \param b The buffer to check
+   * \param expected The bytes that should be in the buffer
+   * \param msg The message to report
+   */
+  void CheckBytes (const Buffer &b, const std::vector<uint8_t> &expected, std::string msg);
+public:
+  virtual void DoRun (void);
+  BufferPayloadSegmentTest ();
+};
+
+BufferPayloadSegmentTest::BufferPayloadSegmentTest ()
+  : TestCase ("Buffer payload segments") {
+}
+
+void
+BufferPayloadSegmentTest::CheckBytes (const Buffer &b, const std::vector<uint8_t> &expected, std::string msg)
+{
+  NS_TEST_ASSERT_MSG_EQ (b.GetSize (), expected.size (), msg << ": wrong size");
+  std::vector<uint8_t> copied (b.GetSize () + 1, 0xff);
+  NS_TEST_EXPECT_MSG_EQ (b.CopyData (&copied[0], b.GetSize ()), b.GetSize (), msg << ": wrong CopyData size");
+  std::ostringstream os;
+  b.CopyData (&os, b.GetSize ());
+  std::string streamed = os.str ();
+  Buffer::Iterator i = b.Begin ();
+  for (uint32_t j = 0; j < expected.size (); j++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((uint16_t)copied[j], (uint16_t)expected[j], msg << ": wrong CopyData byte " << j);
+      NS_TEST_ASSERT_MSG_EQ ((uint16_t)(uint8_t)streamed[j], (uint16_t)expected[j], msg << ": wrong streamed byte " << j);
+      NS_TEST_ASSERT_MSG_EQ ((uint16_t)i.ReadU8 (), (uint16_t)expected[j], msg << ": wrong read byte " << j);
+    }
+  NS_TEST_EXPECT_MSG_EQ ((uint16_t)copied[expected.size ()], 0xff, msg << ": CopyData overflow");
+}
+
+void
+BufferPayloadSegmentTest::DoRun (void)
+{
+  std::vector<uint8_t> payload (1000);
+  for (uint32_t j = 0; j < payload.size (); j++)
+    {
+      payload[j] = (j * 7 + 3) & 0xff;
+    }
+  Buffer b (&payload[0], payload.size ());
+  NS_TEST_EXPECT_MSG_EQ (b.HasPayloadSegment (), true, "No payload segment");
+  CheckBytes (b, payload, "payload");
+
+  // Headers added to copies which share the segment.
+  Buffer c = b;
+  b.AddAtStart (2);
+  b.Begin ().WriteHtonU16 (0x0102);
+  c.AddAtStart (4);
+  c.Begin ().WriteHtonU32 (0x0a0b0c0d);
+  NS_TEST_EXPECT_MSG_EQ (c.HasPayloadSegment (), true, "Header copied the payload");
+  std::vector<uint8_t> expectedB (payload);
+  expectedB.insert (expectedB.begin (), 2, 0);
+  expectedB[0] = 0x01;
+  expectedB[1] = 0x02;
+  CheckBytes (b, expectedB, "header");
+  std::vector<uint8_t> expectedC (payload);
+  const uint8_t headerC[] = { 0x0a, 0x0b, 0x0c, 0x0d };
+  expectedC.insert (expectedC.begin (), headerC, headerC + 4);
+  CheckBytes (c, expectedC, "copy with header");
+
+  // Reads which straddle the header and the segment.
+  Buffer::Iterator i = c.Begin ();
+  i.Next (3);
+  NS_TEST_EXPECT_MSG_EQ (i.ReadNtohU16 (), ((0x0d << 8) | payload[0]), "Bad ReadNtohU16 across the segment");
+  i = c.Begin ();
+  i.Next (2);
+  NS_TEST_EXPECT_MSG_EQ (i.ReadNtohU32 (), ((0x0c0du << 16) | (payload[0] << 8) | payload[1]),
+                         "Bad ReadNtohU32 across the segment");
+
+  // Fragments slice the segment, and take their own headers and trailers.
+  Buffer f = b.CreateFragment (102, 300);
+  NS_TEST_EXPECT_MSG_EQ (f.HasPayloadSegment (), true, "Fragment copied the payload");
+  f.AddAtStart (1);
+  f.Begin ().WriteU8 (0xaa);
+  f.AddAtEnd (1);
+  i = f.End ();
+  i.Prev ();
+  i.WriteU8 (0xbb);
+  std::vector<uint8_t> expectedF (payload.begin () + 100, payload.begin () + 400);
+  expectedF.insert (expectedF.begin (), 0xaa);
+  expectedF.push_back (0xbb);
+  CheckBytes (f, expectedF, "fragment");
+
+  // Fragments concatenated in order share the segment again.
+  Buffer f1 = b.CreateFragment (0, 502);
+  Buffer f2 = b.CreateFragment (502, 500);
+  Buffer out = f2;
+  f1.AddAtEnd (f2);
+  NS_TEST_EXPECT_MSG_EQ (f1.HasPayloadSegment (), true, "Reassembly copied the payload");
+  CheckBytes (f1, expectedB, "reassembly");
+  // Out of order, they are copied.
+  out.AddAtEnd (b.CreateFragment (0, 502));
+  std::vector<uint8_t> expectedOut (expectedB.begin () + 502, expectedB.end ());
+  expectedOut.insert (expectedOut.end (), expectedB.begin (), expectedB.begin () + 502);
+  CheckBytes (out, expectedOut, "out of order reassembly");
+
+  // Serialization carries the payload bytes.
+  std::vector<uint8_t> serialized (c.GetSerializedSize ());
+  NS_TEST_EXPECT_MSG_EQ (c.Serialize (&serialized[0], serialized.size ()), 1, "Serialize failed");
+  Buffer d (0, false);
+  // As in Packet::Deserialize, the size includes a 4-byte length field.
+  d.Deserialize (&serialized[0], serialized.size () + 4);
+  NS_TEST_EXPECT_MSG_EQ (d.HasPayloadSegment (), false, "Deserialized a payload segment");
+  CheckBytes (d, expectedC, "deserialized");
+
+  // PeekData and removing the payload release the segment.
+  uint8_t const *data = c.PeekData ();
+  NS_TEST_EXPECT_MSG_EQ (c.HasPayloadSegment (), false, "PeekData kept the segment");
+  NS_TEST_EXPECT_MSG_EQ ((uint16_t)data[4], (uint16_t)payload[0], "Bad PeekData");
+  b.RemoveAtEnd (1000);
+  NS_TEST_EXPECT_MSG_EQ (b.HasPayloadSegment (), false, "Removed payload kept the segment");
+  CheckBytes (b, std::vector<uint8_t> (expectedB.begin (), expectedB.begin () + 2), "header only");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -405,6 +531,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferPayloadSegmentTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/columnar-trace-file.h"
+#include "ns3/trace-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/error-model.h"
+#include "ns3/mac48-address.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Write records in a ColumnarTraceFile and read them back.
+ */
+class ColumnarTraceFileTestCase : public TestCase
+{
+public:
+  ColumnarTraceFileTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ColumnarTraceFileTestCase::ColumnarTraceFileTestCase ()
+  : TestCase ("Write and read back a columnar trace")
+{
+}
+
+void
+ColumnarTraceFileTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("columnar-trace-file.ns3c");
+
+  // Three blocks, the last one partial, with columns suited to each
+  // encoding.
+  const uint32_t records = 2 * ColumnarTraceFile::BLOCK_RECORDS + 123;
+  const uint8_t events[] = { ColumnarTraceFile::ENQUEUE, ColumnarTraceFile::DEQUEUE,
+                             ColumnarTraceFile::RECEIVE, ColumnarTraceFile::DROP };
+  std::vector<ColumnarTraceRecord> written;
+  uint32_t state = 12345;
+  int64_t time = 1000000000;
+  for (uint32_t i = 0; i < records; ++i)
+    {
+      state = state * 1103515245 + 12345;
+      ColumnarTraceRecord record;
+      time += (state >> 16) % 5000;
+      record.time = time;
+      record.event = events[(i / 3) % 4];
+      record.node = (state >> 8) % 2000;
+      record.device = i < 5000 ? 1 : 2;
+      record.uid = i / 2 + ((i % 2) ? 1000000 : 0);
+      record.size = (i % 100) ? 1500 : 0xffffffff;
+      written.push_back (record);
+    }
+
+  Ptr<ColumnarTraceFile> file = Create<ColumnarTraceFile> ();
+  file->Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (file->Fail (), false, "Could not open " << filename);
+  for (uint32_t i = 0; i < records; ++i)
+    {
+      file->Write (written[i]);
+    }
+  NS_TEST_ASSERT_MSG_EQ (file->GetRecordCount (), records, "Wrong number of records written");
+  file->Close ();
+
+  std::ifstream stream (filename.c_str (), std::ios::binary | std::ios::ate);
+  uint64_t size = stream.tellg ();
+  stream.close ();
+  NS_TEST_EXPECT_MSG_LT (size, 8 * records, "Columnar trace larger than expected");
+
+  Ptr<ColumnarTraceFile> reader = Create<ColumnarTraceFile> ();
+  reader->Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (reader->Fail (), false, "Could not read " << filename);
+  NS_TEST_EXPECT_MSG_EQ (reader->GetResolution (), Time::GetResolution (), "Wrong resolution");
+  ColumnarTraceRecord record;
+  for (uint32_t i = 0; i < records; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (reader->Read (record), true, "Record " << i << " missing");
+      NS_TEST_ASSERT_MSG_EQ (record.time, written[i].time, "Wrong time in record " << i);
+      NS_TEST_ASSERT_MSG_EQ (record.event, written[i].event, "Wrong event in record " << i);
+      NS_TEST_ASSERT_MSG_EQ (record.node, written[i].node, "Wrong node in record " << i);
+      NS_TEST_ASSERT_MSG_EQ (record.device, written[i].device, "Wrong device in record " << i);
+      NS_TEST_ASSERT_MSG_EQ (record.uid, written[i].uid, "Wrong uid in record " << i);
+      NS_TEST_ASSERT_MSG_EQ (record.size, written[i].size, "Wrong size in record " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (reader->Read (record), false, "Record beyond the end");
+  NS_TEST_EXPECT_MSG_EQ (reader->Fail (), false, "Valid file reported corrupt");
+  reader->Close ();
+
+  // A truncated file reads up to the damaged block.
+  std::vector<char> bytes (size);
+  stream.open (filename.c_str (), std::ios::binary);
+  stream.read (&bytes[0], size);
+  stream.close ();
+  std::ofstream truncated (filename.c_str (), std::ios::binary | std::ios::trunc);
+  truncated.write (&bytes[0], size - 10);
+  truncated.close ();
+  reader->Open (filename, std::ios::in);
+  uint32_t count = 0;
+  while (reader->Read (record))
+    {
+      count++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (count, 2 * ColumnarTraceFile::BLOCK_RECORDS, "Wrong records before the damage");
+  NS_TEST_EXPECT_MSG_EQ (reader->Fail (), true, "Truncated file not reported corrupt");
+  reader->Close ();
+
+  // Other files are rejected.
+  std::ofstream text (filename.c_str (), std::ios::trunc);
+  text << "+ 0.1 /NodeList/0/DeviceList/0/$ns3::PointToPointNetDevice/TxQueue/Enqueue" << std::endl;
+  text.close ();
+  reader->Open (filename, std::ios::in);
+  NS_TEST_EXPECT_MSG_EQ (reader->Fail (), true, "Text file accepted");
+  NS_TEST_EXPECT_MSG_EQ (reader->Read (record), false, "Record read from a text file");
+  reader->Close ();
+
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Record the packet events of devices with ColumnarTraceHelper.
+ */
+class ColumnarTraceHelperTestCase : public TestCase
+{
+public:
+  ColumnarTraceHelperTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Send packets.
+   * \param device The sending device.
+   * \param to The destination.
+   * \param count The number of packets.
+   */
+  void Send (Ptr<NetDevice> device, Address to, uint32_t count);
+  /**
+   * Receive a packet.
+   * \return true.
+   */
+  bool Receive (Ptr<NetDevice>, Ptr<const Packet>, uint16_t, const Address &);
+
+  uint32_t m_received;    //!< Packets received
+};
+
+ColumnarTraceHelperTestCase::ColumnarTraceHelperTestCase ()
+  : TestCase ("Record device packet events with ColumnarTraceHelper")
+{
+}
+
+void
+ColumnarTraceHelperTestCase::Send (Ptr<NetDevice> device, Address to, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      device->Send (Create<Packet> (1000), to, 0x800);
+    }
+}
+
+bool
+ColumnarTraceHelperTestCase::Receive (Ptr<NetDevice>, Ptr<const Packet>, uint16_t, const Address &)
+{
+  m_received++;
+  return true;
+}
+
+void
+ColumnarTraceHelperTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("columnar-trace-helper.ns3c");
+
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<SimpleNetDevice> input = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> output = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  a->AddDevice (input);
+  b->AddDevice (output);
+  input->SetAddress (Mac48Address::Allocate ());
+  input->SetChannel (channel);
+  input->SetNode (a);
+  output->SetAddress (Mac48Address::Allocate ());
+  output->SetChannel (channel);
+  output->SetNode (b);
+  output->SetReceiveCallback (MakeCallback (&ColumnarTraceHelperTestCase::Receive, this));
+
+  // Drop the fourth packet.
+  Ptr<ReceiveListErrorModel> em = CreateObject<ReceiveListErrorModel> ();
+  std::list<uint32_t> drops;
+  drops.push_back (3);
+  em->SetList (drops);
+  output->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+
+  ColumnarTraceHelper helper;
+  Ptr<ColumnarTraceFile> file = helper.EnableColumnarAll (filename);
+  NS_TEST_ASSERT_MSG_EQ (file->Fail (), false, "Could not open " << filename);
+
+  m_received = 0;
+  Simulator::Schedule (Seconds (1), &ColumnarTraceHelperTestCase::Send, this,
+                       input, output->GetAddress (), 10);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_received, 9, "Wrong number of packets received");
+
+  Ptr<ColumnarTraceFile> reader = Create<ColumnarTraceFile> ();
+  reader->Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (reader->Fail (), false, "Could not read " << filename);
+  uint32_t enqueued = 0;
+  uint32_t dequeued = 0;
+  uint32_t dropped = 0;
+  ColumnarTraceRecord record;
+  while (reader->Read (record))
+    {
+      NS_TEST_EXPECT_MSG_EQ (record.time, Seconds (1).GetTimeStep (), "Wrong time");
+      NS_TEST_EXPECT_MSG_EQ (record.size, 1000, "Wrong size");
+      switch (record.event)
+        {
+        case ColumnarTraceFile::ENQUEUE:
+          enqueued++;
+          NS_TEST_EXPECT_MSG_EQ (record.node, a->GetId (), "Wrong enqueue node");
+          break;
+        case ColumnarTraceFile::DEQUEUE:
+          dequeued++;
+          NS_TEST_EXPECT_MSG_EQ (record.node, a->GetId (), "Wrong dequeue node");
+          break;
+        case ColumnarTraceFile::DROP:
+          dropped++;
+          NS_TEST_EXPECT_MSG_EQ (record.node, b->GetId (), "Wrong drop node");
+          NS_TEST_EXPECT_MSG_EQ (record.device, output->GetIfIndex (), "Wrong drop device");
+          break;
+        default:
+          NS_TEST_EXPECT_MSG_EQ (record.event, 0, "Unexpected event");
+          break;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (enqueued, 10, "Wrong number of enqueue records");
+  NS_TEST_EXPECT_MSG_EQ (dequeued, 10, "Wrong number of dequeue records");
+  NS_TEST_EXPECT_MSG_EQ (dropped, 1, "Wrong number of drop records");
+  reader->Close ();
+
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * ColumnarTraceFile and ColumnarTraceHelper test suite.
+ */
+class ColumnarTraceTestSuite : public TestSuite
+{
+public:
+  ColumnarTraceTestSuite ();
+};
+
+ColumnarTraceTestSuite::ColumnarTraceTestSuite ()
+  : TestSuite ("columnar-trace", UNIT)
+{
+  AddTestCase (new ColumnarTraceFileTestCase, TestCase::QUICK);
+  AddTestCase (new ColumnarTraceHelperTestCase, TestCase::QUICK);
+}
+
+static ColumnarTraceTestSuite g_columnarTraceTestSuite; //!< Static variable for test initialization
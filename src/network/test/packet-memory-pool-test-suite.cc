@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <thread>
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/packet-memory-pool.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Allocate and release blocks in the cache of a new thread.
+ */
+class PacketMemoryPoolCacheTestCase : public TestCase
+{
+public:
+  PacketMemoryPoolCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /** The allocations of the thread, and the cache activity after each. */
+  struct Step
+  {
+    void *block;                            //!< The block
+    uint32_t size;                          //!< The size of the block
+    PacketMemoryPool::Statistics stats;     //!< The activity after the step
+  };
+  /**
+   * Allocate and release blocks, in a thread with an empty cache.
+   * \param [out] steps The allocations.
+   */
+  static void Run (std::vector<Step> *steps);
+};
+
+PacketMemoryPoolCacheTestCase::PacketMemoryPoolCacheTestCase ()
+  : TestCase ("Allocate and release blocks in a thread cache")
+{
+}
+
+void
+PacketMemoryPoolCacheTestCase::Run (std::vector<Step> *steps)
+{
+  const PacketMemoryPool::Kind kind = PacketMemoryPool::BYTE_TAG;
+  Step step;
+
+  // A miss, then a release in the cache.
+  step.size = 100;
+  step.block = PacketMemoryPool::Allocate (kind, step.size);
+  step.stats = PacketMemoryPool::GetStatistics (kind);
+  steps->push_back (step);
+  PacketMemoryPool::Deallocate (kind, step.block);
+
+  // A hit, with the larger cached block.
+  step.size = 50;
+  step.block = PacketMemoryPool::Allocate (kind, step.size);
+  step.stats = PacketMemoryPool::GetStatistics (kind);
+  steps->push_back (step);
+  PacketMemoryPool::Deallocate (kind, step.block);
+
+  // The cached block is too small: it is freed.
+  step.size = 200;
+  step.block = PacketMemoryPool::Allocate (kind, step.size);
+  step.stats = PacketMemoryPool::GetStatistics (kind);
+  steps->push_back (step);
+  PacketMemoryPool::Deallocate (kind, step.block);
+}
+
+void
+PacketMemoryPoolCacheTestCase::DoRun (void)
+{
+  std::vector<Step> steps;
+  std::thread thread (&PacketMemoryPoolCacheTestCase::Run, &steps);
+  thread.join ();
+
+  NS_TEST_ASSERT_MSG_EQ (steps.size (), 3, "Missing steps");
+  NS_TEST_EXPECT_MSG_EQ (steps[0].size, 100, "Wrong size of the first block");
+  NS_TEST_EXPECT_MSG_EQ (steps[0].stats.misses, 1, "First allocation not a miss");
+  NS_TEST_EXPECT_MSG_EQ (steps[0].stats.hits, 0, "First allocation a hit");
+
+  NS_TEST_EXPECT_MSG_EQ (steps[1].block, steps[0].block, "Cached block not reused");
+  NS_TEST_EXPECT_MSG_EQ (steps[1].size, 100, "Wrong size of the reused block");
+  NS_TEST_EXPECT_MSG_EQ (steps[1].stats.hits, 1, "Second allocation not a hit");
+  NS_TEST_EXPECT_MSG_EQ (steps[1].stats.releases, 1, "Block not released to the cache");
+  NS_TEST_EXPECT_MSG_EQ (steps[1].stats.cached, 0, "Reused block still cached");
+
+  NS_TEST_EXPECT_MSG_EQ (steps[2].size, 200, "Wrong size of the last block");
+  NS_TEST_EXPECT_MSG_EQ (steps[2].stats.misses, 2, "Last allocation not a miss");
+  NS_TEST_EXPECT_MSG_EQ (steps[2].stats.frees, 1, "Small cached block not freed");
+
+  // This thread did not see the activity of the other.
+  PacketMemoryPool::ResetStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (PacketMemoryPool::GetStatistics (PacketMemoryPool::BYTE_TAG).hits, 0,
+                         "Statistics not reset");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packets reuse the blocks of released packets, unless the cache is
+ * disabled.
+ */
+class PacketMemoryPoolPacketTestCase : public TestCase
+{
+public:
+  PacketMemoryPoolPacketTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PacketMemoryPoolPacketTestCase::PacketMemoryPoolPacketTestCase ()
+  : TestCase ("Reuse the blocks of packets")
+{
+}
+
+void
+PacketMemoryPoolPacketTestCase::DoRun (void)
+{
+  const uint8_t payload[] = "payload";
+  {
+    // Leave at least two packets in the cache.
+    Ptr<Packet> p = Create<Packet> (payload, sizeof (payload));
+    Ptr<Packet> copy = p->Copy ();
+  }
+  PacketMemoryPool::ResetStatistics ();
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (payload, sizeof (payload));
+      Ptr<Packet> copy = p->Copy ();
+      copy->RemoveAtStart (1);
+    }
+  PacketMemoryPool::Statistics packets = PacketMemoryPool::GetStatistics (PacketMemoryPool::PACKET);
+  PacketMemoryPool::Statistics buffers = PacketMemoryPool::GetStatistics (PacketMemoryPool::BUFFER);
+  NS_TEST_EXPECT_MSG_EQ (packets.misses, 0, "Packets not reused");
+  NS_TEST_EXPECT_MSG_EQ (packets.hits, 20, "Wrong number of packets allocated");
+  NS_TEST_EXPECT_MSG_EQ (packets.releases, 20, "Wrong number of packets released");
+  NS_TEST_EXPECT_MSG_GT (buffers.hits, 0, "Buffer data not reused");
+
+  uint32_t maxCached = PacketMemoryPool::GetMaxCachedBlocks (PacketMemoryPool::PACKET);
+  PacketMemoryPool::SetMaxCachedBlocks (PacketMemoryPool::PACKET, 0);
+  PacketMemoryPool::ResetStatistics ();
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Create<Packet> (payload, sizeof (payload));
+    }
+  PacketMemoryPool::SetMaxCachedBlocks (PacketMemoryPool::PACKET, maxCached);
+  packets = PacketMemoryPool::GetStatistics (PacketMemoryPool::PACKET);
+  NS_TEST_EXPECT_MSG_EQ (packets.releases, 0, "Packet cached with the cache disabled");
+  NS_TEST_EXPECT_MSG_EQ (packets.frees, 10, "Packets not freed with the cache disabled");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * PacketMemoryPool test suite.
+ */
+class PacketMemoryPoolTestSuite : public TestSuite
+{
+public:
+  PacketMemoryPoolTestSuite ();
+};
+
+PacketMemoryPoolTestSuite::PacketMemoryPoolTestSuite ()
+  : TestSuite ("packet-memory-pool", UNIT)
+{
+  AddTestCase (new PacketMemoryPoolCacheTestCase, TestCase::QUICK);
+  AddTestCase (new PacketMemoryPoolPacketTestCase, TestCase::QUICK);
+}
+
+static PacketMemoryPoolTestSuite g_packetMemoryPoolTestSuite; //!< Static variable for test initialization
@@ -330,6 +330,12 @@ public:
    */
   void CheckHistory (Ptr<Packet> p, const char *file, int line, uint32_t n, ...);
   virtual void DoRun (void);
+protected:
+  /**
+   * Constructor
+   * \param name The test case name.
+   */
+  PacketMetadataTest (std::string name);
 private:
   /**
    * Adds an header to the packet
@@ -344,6 +350,11 @@ PacketMetadataTest::PacketMetadataTest ()
 {
 }
 
+PacketMetadataTest::PacketMetadataTest (std::string name)
+  : TestCase (name)
+{
+}
+
 PacketMetadataTest::~PacketMetadataTest ()
 {
 }
@@ -902,6 +913,99 @@ PacketMetadataTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet Metadata unit tests, with the compact representation.
+ */
+class PacketMetadataCompactTest : public PacketMetadataTest {
+public:
+  PacketMetadataCompactTest ();
+  virtual void DoRun (void);
+};
+
+PacketMetadataCompactTest::PacketMetadataCompactTest ()
+  : PacketMetadataTest ("Packet metadata, compact representation")
+{
+}
+
+void
+PacketMetadataCompactTest::DoRun (void)
+{
+  PacketMetadata::EnableCompact ();
+
+  // More items than the compact representation holds.
+  Ptr<Packet> p = Create<Packet> (10);
+  ADD_TRAILER (p, 2);
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p, 2);
+  ADD_HEADER (p, 3);
+  ADD_HEADER (p, 4);
+  ADD_HEADER (p, 5);
+  ADD_HEADER (p, 6);
+  ADD_HEADER (p, 7);
+  ADD_HEADER (p, 8);
+  ADD_HEADER (p, 9);
+  REM_HEADER (p, 9);
+  REM_TRAILER (p, 2);
+  CHECK_HISTORY (p, 9,
+                 8, 7, 6, 5, 4, 3, 2, 1, 10);
+
+  // The fragments of a header, materialized separately, are merged.
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 3);
+  ADD_HEADER (p, 4);
+  ADD_TRAILER (p, 5);
+  ADD_TRAILER (p, 6);
+  REM_TRAILER (p, 6);
+  Ptr<Packet> p1 = p->CreateFragment (0, 5);
+  Ptr<Packet> p2 = p->CreateFragment (5, 2 + 10 + 5);
+  CHECK_HISTORY (p1, 2, 4, 1);
+  p1->AddAtEnd (p2);
+  CHECK_HISTORY (p1, 4, 4, 3, 10, 5);
+
+  // Whole items removed from both ends, then a fragment.
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 3);
+  ADD_TRAILER (p, 5);
+  p->RemoveAtStart (3);
+  p->RemoveAtEnd (5);
+  p->RemoveAtStart (4);
+  CHECK_HISTORY (p, 1, 6);
+
+  // The items are moved to the end of the array to add a header.
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p, 2);
+  ADD_HEADER (p, 3);
+  ADD_HEADER (p, 4);
+  ADD_HEADER (p, 5);
+  ADD_HEADER (p, 6);
+  ADD_HEADER (p, 7);
+  CHECK_HISTORY (p, 8,
+                 7, 6, 5, 4, 3, 2, 1, 10);
+
+  // The items are moved to the start of the array to add a trailer.
+  p = Create<Packet> (10);
+  ADD_TRAILER (p, 1);
+  ADD_TRAILER (p, 2);
+  ADD_HEADER (p, 3);
+  CHECK_HISTORY (p, 4, 3, 10, 1, 2);
+
+  // The items shared with a copy are copied before being written.
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  p1 = p->Copy ();
+  REM_HEADER (p, 1);
+  ADD_HEADER (p, 3);
+  ADD_HEADER (p1, 2);
+  CHECK_HISTORY (p, 2, 3, 10);
+  CHECK_HISTORY (p1, 3, 2, 1, 10);
+
+  PacketMetadataTest::DoRun ();
+  PacketMetadata::DisableCompact ();
+}
 
 /**
  * \ingroup network-test
@@ -919,6 +1023,7 @@ PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
   AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataCompactTest, TestCase::QUICK);
 }
 
 static PacketMetadataTestSuite g_packetMetadataTest; //!< Static variable for test initialization
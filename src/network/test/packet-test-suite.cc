@@ -21,12 +21,18 @@
 #include "ns3/packet-tag-list.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
 #include <limits>     // std:numeric_limits
 #include <string>
 #include <cstdarg>
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <vector>
 
 using namespace ns3;
 
@@ -1035,6 +1041,68 @@ PacketTagListTest::DoRun (void)
     
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packets created by the events of a partition of a multithreaded
+ * simulation count their uids per partition.
+ */
+class PacketUidTest : public TestCase
+{
+public:
+  PacketUidTest ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /** Create two packets, and record their uids. */
+  void CreatePackets (void);
+
+  std::vector<uint64_t> m_uids; //!< The uids of the packets created
+};
+
+PacketUidTest::PacketUidTest ()
+  : TestCase ("Packet uids are counted per partition")
+{
+}
+
+void
+PacketUidTest::CreatePackets (void)
+{
+  m_uids.push_back (Create<Packet> ()->GetUid ());
+  m_uids.push_back (Create<Packet> (10)->GetUid ());
+}
+
+void
+PacketUidTest::DoRun (void)
+{
+  uint64_t uid = Create<Packet> ()->GetUid ();
+  NS_TEST_EXPECT_MSG_EQ ((uid >> 48), 0, "Partition set outside of a partition thread");
+
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::ThreadCount", UintegerValue (1));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::Lookahead", TimeValue (MilliSeconds (1)));
+  Simulator::ScheduleWithContext (3, MilliSeconds (1), &PacketUidTest::CreatePackets, this);
+  Simulator::Schedule (MilliSeconds (2), &PacketUidTest::CreatePackets, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_uids.size (), 4, "Events not run");
+  NS_TEST_EXPECT_MSG_EQ ((m_uids[0] >> 48), 1, "Wrong partition of the uid");
+  NS_TEST_EXPECT_MSG_EQ (m_uids[1], m_uids[0] + 1, "Partition uids not consecutive");
+  NS_TEST_EXPECT_MSG_EQ ((m_uids[2] >> 48), 0, "Global events have a partition");
+  NS_TEST_EXPECT_MSG_EQ (m_uids[2], uid + 1, "Global uids not consecutive");
+}
+
+void
+PacketUidTest::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::Reset ();
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1052,6 +1120,7 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketUidTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
@@ -21,9 +21,12 @@
 #include <cstdlib>
 #include <sstream>
 #include <cstring>
+#include <fstream>
+#include <iterator>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
+#include "ns3/packet.h"
 #include "ns3/pcap-file.h"
 
 using namespace ns3;
@@ -1144,6 +1147,195 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \brief Read a whole file.
+ * \param filename The file name.
+ * \returns The bytes of the file.
+ */
+static std::string
+ReadFileBytes (std::string filename)
+{
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  return std::string (std::istreambuf_iterator<char> (file),
+                      std::istreambuf_iterator<char> ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that a file written asynchronously is
+ * identical to the same file written synchronously.
+ */
+class AsyncWriteTestCase : public TestCase
+{
+public:
+  AsyncWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Write the same records to each file, with a snaplen of 100 bytes,
+   * interleaving the files.
+   * \param files The files, opened for writing.
+   * \param n The number of files.
+   */
+  void WriteRecords (PcapFile *files, uint32_t n);
+};
+
+AsyncWriteTestCase::AsyncWriteTestCase ()
+  : TestCase ("Check that PcapFile::SetAsyncWrite writes the same files")
+{
+}
+
+void
+AsyncWriteTestCase::WriteRecords (PcapFile *files, uint32_t n)
+{
+  for (uint32_t j = 0; j < n; j++)
+    {
+      files[j].Init (1, 100);
+    }
+  uint8_t data[150];
+  for (uint32_t i = 0; i < sizeof (data); i++)
+    {
+      data[i] = i;
+    }
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      for (uint32_t j = 0; j < n; j++)
+        {
+          files[j].Write (i, 10 * i, data, 10 + 3 * i);
+          files[j].Write (i, 10 * i + 1, Create<Packet> (data, 20 + 4 * i));
+        }
+    }
+}
+
+void
+AsyncWriteTestCase::DoRun (void)
+{
+  std::string syncFilename = CreateTempDirFilename ("sync.pcap");
+  std::string asyncFilename = CreateTempDirFilename ("async.pcap");
+
+  PcapFile f;
+  f.Open (syncFilename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << syncFilename << ", \"std::ios::out\") returns error");
+  WriteRecords (&f, 1);
+  f.Close ();
+
+  // Batches smaller than most records, to hand many of them to the writer.
+  f.SetAsyncWrite (64);
+  f.Open (asyncFilename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << asyncFilename << ", \"std::ios::out\") returns error");
+  WriteRecords (&f, 1);
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Asynchronous writes fail");
+  f.Close ();
+
+  std::string syncBytes = ReadFileBytes (syncFilename);
+  NS_TEST_EXPECT_MSG_GT (syncBytes.size (), 24, "Records not written");
+  NS_TEST_EXPECT_MSG_EQ ((ReadFileBytes (asyncFilename) == syncBytes), true,
+                         "Asynchronous file differs from the synchronous one");
+
+  // The files share the writer thread: interleave their batches.
+  const uint32_t nFiles = 3;
+  PcapFile files[nFiles];
+  std::string filenames[nFiles];
+  for (uint32_t j = 0; j < nFiles; j++)
+    {
+      std::ostringstream name;
+      name << "async-" << j << ".pcap";
+      filenames[j] = CreateTempDirFilename (name.str ());
+      files[j].SetAsyncWrite (64);
+      files[j].Open (filenames[j], std::ios::out);
+      NS_TEST_ASSERT_MSG_EQ (files[j].Fail (), false, "Open (" << filenames[j] << ", \"std::ios::out\") returns error");
+    }
+  WriteRecords (files, nFiles);
+  // Close the files in another order than they were opened.
+  for (uint32_t j = nFiles; j-- > 0; )
+    {
+      NS_TEST_EXPECT_MSG_EQ (files[j].Fail (), false, "Asynchronous writes fail");
+      files[j].Close ();
+      NS_TEST_EXPECT_MSG_EQ ((ReadFileBytes (filenames[j]) == syncBytes), true,
+                             "Shared writer file " << j << " differs from the synchronous one");
+      remove (filenames[j].c_str ());
+    }
+
+  // The packets are truncated to the snaplen.
+  f.SetAsyncWrite (0);
+  f.Open (asyncFilename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << asyncFilename << ", \"std::ios::in\") returns error");
+  uint8_t data[150];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  uint32_t truncated = 0;
+  for (uint32_t i = 0; i < 80; i++)
+    {
+      f.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Read record " << i << " fails");
+      NS_TEST_EXPECT_MSG_EQ (inclLen, std::min (origLen, 100U), "Record " << i << " not truncated");
+      if (origLen > 100)
+        {
+          truncated++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_GT (truncated, 0, "No record truncated");
+  f.Close ();
+
+  remove (syncFilename.c_str ());
+  remove (asyncFilename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that PcapFile writes gzip files.
+ */
+class GzipWriteTestCase : public TestCase
+{
+public:
+  GzipWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+GzipWriteTestCase::GzipWriteTestCase ()
+  : TestCase ("Check that PcapFile writes gzip files")
+{
+}
+
+void
+GzipWriteTestCase::DoRun (void)
+{
+  if (!PcapFile::IsCompressionSupported (PcapFile::GZIP_COMPRESSION))
+    {
+      return;
+    }
+  std::string filename = CreateTempDirFilename ("compressed.pcap.gz");
+
+  PcapFile f;
+  f.SetAsyncWrite (0, PcapFile::GZIP_COMPRESSION);
+  f.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  f.Init (1);
+  uint8_t data[1000];
+  memset (data, 0, sizeof (data));
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      f.Write (i, 0, data, sizeof (data));
+    }
+  f.Close ();
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Compressed writes fail");
+
+  std::string bytes = ReadFileBytes (filename);
+  NS_TEST_ASSERT_MSG_GT (bytes.size (), 2, "Compressed file empty");
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint8_t> (bytes[0]), 0x1f, "No gzip magic number");
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint8_t> (bytes[1]), 0x8b, "No gzip magic number");
+  NS_TEST_EXPECT_MSG_LT (bytes.size (), 100 * sizeof (data) / 10, "Records not compressed");
+
+  remove (filename.c_str ());
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1167,6 +1359,8 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new AsyncWriteTestCase, TestCase::QUICK);
+  AddTestCase (new GzipWriteTestCase, TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
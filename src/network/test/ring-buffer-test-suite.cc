@@ -0,0 +1,313 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ring-buffer.h"
+#include "ns3/packet.h"
+#include "ns3/queue.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Add and remove items at both ends of a RingBuffer, across the end of
+ * its array and while it grows.
+ */
+class RingBufferOrderTestCase : public TestCase
+{
+public:
+  RingBufferOrderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RingBufferOrderTestCase::RingBufferOrderTestCase ()
+  : TestCase ("Keep the order of the items of a ring buffer")
+{
+}
+
+void
+RingBufferOrderTestCase::DoRun (void)
+{
+  RingBuffer<uint32_t> ring;
+  NS_TEST_EXPECT_MSG_EQ (ring.capacity (), 0, "Empty ring buffer allocated");
+
+  uint32_t next = 0;
+  uint32_t first = 0;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      // Two items in, one out: the array wraps around, and grows.
+      ring.push_back (next++);
+      ring.push_back (next++);
+      NS_TEST_ASSERT_MSG_EQ (ring.front (), first, "Wrong first item");
+      ring.pop_front ();
+      first++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (ring.size (), 1000, "Wrong size");
+  NS_TEST_EXPECT_MSG_EQ (ring.capacity (), 1024, "Wrong capacity");
+  NS_TEST_EXPECT_MSG_EQ (ring.back (), next - 1, "Wrong last item");
+  for (uint32_t i = 0; i < ring.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (ring[i], first + i, "Wrong indexed item");
+    }
+  uint32_t expected = first;
+  for (RingBuffer<uint32_t>::const_iterator i = ring.begin (); i != ring.end (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (*i, expected++, "Wrong iterated item");
+    }
+  NS_TEST_EXPECT_MSG_EQ (ring.end () - ring.begin (), 1000, "Wrong iterator distance");
+
+  ring.push_front (7);
+  ring.push_front (8);
+  NS_TEST_EXPECT_MSG_EQ (ring[0], 8, "Wrong item pushed at the front");
+  NS_TEST_EXPECT_MSG_EQ (ring[1], 7, "Wrong item pushed at the front");
+  NS_TEST_EXPECT_MSG_EQ (ring[2], first, "Wrong item after the front");
+  ring.pop_back ();
+  NS_TEST_EXPECT_MSG_EQ (ring.back (), next - 2, "Wrong last item after pop_back");
+
+  ring.clear ();
+  NS_TEST_EXPECT_MSG_EQ (ring.empty (), true, "Ring buffer not cleared");
+  NS_TEST_EXPECT_MSG_EQ (ring.capacity (), 1024, "Array not kept");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Insert and erase items in the middle of a RingBuffer, and check the
+ * iterators which remain valid.
+ */
+class RingBufferMiddleTestCase : public TestCase
+{
+public:
+  RingBufferMiddleTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RingBufferMiddleTestCase::RingBufferMiddleTestCase ()
+  : TestCase ("Insert and erase items in the middle of a ring buffer")
+{
+}
+
+void
+RingBufferMiddleTestCase::DoRun (void)
+{
+  RingBuffer<uint32_t> ring;
+  for (uint32_t i = 0; i < 16; i++)
+    {
+      ring.push_back (i);
+    }
+  RingBuffer<uint32_t>::iterator ten = ring.begin () + 10;
+  RingBuffer<uint32_t>::const_iterator end = ring.end ();
+
+  // The array is full: inserting grows it.
+  RingBuffer<uint32_t>::iterator inserted = ring.insert (ten, 100);
+  NS_TEST_EXPECT_MSG_EQ (ring.capacity (), 32, "Array not grown");
+  NS_TEST_EXPECT_MSG_EQ (*inserted, 100, "Wrong inserted item");
+  NS_TEST_EXPECT_MSG_EQ (*ten, 10, "Iterator after the insertion invalidated");
+  NS_TEST_EXPECT_MSG_EQ ((ring.end () == end), true, "End iterator invalidated");
+  NS_TEST_EXPECT_MSG_EQ (ring[10], 100, "Item not inserted at its index");
+  NS_TEST_EXPECT_MSG_EQ (ring[9], 9, "Wrong item before the insertion");
+  NS_TEST_EXPECT_MSG_EQ (ring[0], 0, "Wrong first item");
+  NS_TEST_EXPECT_MSG_EQ (ring.size (), 17, "Wrong size");
+
+  // Erase items before the iterator while iterating, as queues do.
+  for (RingBuffer<uint32_t>::iterator i = ring.begin (); i != ten; )
+    {
+      if (*i % 2 == 1)
+        {
+          i = ring.erase (i);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (ring.size (), 12, "Wrong size after erasing");
+  NS_TEST_EXPECT_MSG_EQ (*ten, 10, "Iterator after the erased items invalidated");
+  NS_TEST_EXPECT_MSG_EQ ((ring.end () == end), true, "End iterator invalidated");
+  const uint32_t expected[] = {0, 2, 4, 6, 8, 100, 10, 11, 12, 13, 14, 15};
+  for (uint32_t i = 0; i < ring.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (ring[i], expected[i], "Wrong item after erasing");
+    }
+
+  ring.erase (ring.end () - 1);
+  NS_TEST_EXPECT_MSG_EQ (ring.back (), 14, "Wrong last item after erasing it");
+  ring.insert (ring.end (), 16);
+  NS_TEST_EXPECT_MSG_EQ (ring.back (), 16, "Wrong item inserted at the end");
+  ring.insert (ring.begin (), 200);
+  NS_TEST_EXPECT_MSG_EQ (ring.front (), 200, "Wrong item inserted at the front");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Erasing an item of a RingBuffer releases it.
+ */
+class RingBufferReleaseTestCase : public TestCase
+{
+public:
+  RingBufferReleaseTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RingBufferReleaseTestCase::RingBufferReleaseTestCase ()
+  : TestCase ("Release the items removed from a ring buffer")
+{
+}
+
+void
+RingBufferReleaseTestCase::DoRun (void)
+{
+  Ptr<Packet> p1 = Create<Packet> ();
+  Ptr<Packet> p2 = Create<Packet> ();
+  Ptr<Packet> p3 = Create<Packet> ();
+  RingBuffer<Ptr<Packet> > ring;
+  ring.push_back (p1);
+  ring.push_back (p2);
+  ring.push_back (p3);
+  NS_TEST_EXPECT_MSG_EQ (p1->GetReferenceCount (), 2, "Item not referenced");
+
+  ring.erase (ring.begin () + 1);
+  NS_TEST_EXPECT_MSG_EQ (p2->GetReferenceCount (), 1, "Erased item not released");
+  NS_TEST_EXPECT_MSG_EQ (p1->GetReferenceCount (), 2, "Moved item not referenced once");
+  ring.pop_front ();
+  NS_TEST_EXPECT_MSG_EQ (p1->GetReferenceCount (), 1, "Popped item not released");
+  ring.pop_back ();
+  NS_TEST_EXPECT_MSG_EQ (p3->GetReferenceCount (), 1, "Popped item not released");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * A queue which removes the item in its middle.
+ */
+class MiddleRemovalQueue : public Queue<Packet>
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual bool Enqueue (Ptr<Packet> item)
+  {
+    return DoEnqueue (end (), item);
+  }
+  virtual Ptr<Packet> Dequeue (void)
+  {
+    return DoDequeue (begin ());
+  }
+  virtual Ptr<Packet> Remove (void)
+  {
+    return DoRemove (begin () + GetNPackets () / 2);
+  }
+  virtual Ptr<const Packet> Peek (void) const
+  {
+    return DoPeek (begin ());
+  }
+};
+
+TypeId
+MiddleRemovalQueue::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MiddleRemovalQueue")
+    .SetParent<Queue<Packet> > ()
+    .SetGroupName ("Network")
+    .AddConstructor<MiddleRemovalQueue> ()
+  ;
+  return tid;
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * A Queue subclass removes items from the middle of its RingBuffer.
+ */
+class RingBufferQueueTestCase : public TestCase
+{
+public:
+  RingBufferQueueTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RingBufferQueueTestCase::RingBufferQueueTestCase ()
+  : TestCase ("Remove items from the middle of a queue")
+{
+}
+
+void
+RingBufferQueueTestCase::DoRun (void)
+{
+  Ptr<MiddleRemovalQueue> queue = CreateObject<MiddleRemovalQueue> ();
+  std::vector<Ptr<Packet> > packets;
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      packets.push_back (Create<Packet> (i + 1));
+      queue->Enqueue (packets.back ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 15, "Wrong number of bytes");
+
+  Ptr<Packet> removed = queue->Remove ();
+  NS_TEST_EXPECT_MSG_EQ (removed, packets[2], "Middle item not removed");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 4, "Wrong number of packets");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 12, "Wrong number of bytes");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 1, "Removed item not dropped");
+
+  const uint32_t expected[] = {0, 1, 3, 4};
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (queue->Dequeue (), packets[expected[i]], "Wrong dequeued item");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty (), true, "Queue not empty");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * RingBuffer test suite.
+ */
+class RingBufferTestSuite : public TestSuite
+{
+public:
+  RingBufferTestSuite ();
+};
+
+RingBufferTestSuite::RingBufferTestSuite ()
+  : TestSuite ("ring-buffer", UNIT)
+{
+  AddTestCase (new RingBufferOrderTestCase, TestCase::QUICK);
+  AddTestCase (new RingBufferMiddleTestCase, TestCase::QUICK);
+  AddTestCase (new RingBufferReleaseTestCase, TestCase::QUICK);
+  AddTestCase (new RingBufferQueueTestCase, TestCase::QUICK);
+}
+
+static RingBufferTestSuite g_ringBufferTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,426 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include "ns3/assert.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "columnar-trace-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarTraceFile");
+
+const char COLUMNAR_MAGIC[4] = { 'n', 's', '3', 'c' };  /**< Magic identifying a columnar trace */
+const uint8_t COLUMNAR_VERSION = 1;                       /**< Version of the columnar trace format */
+/** Bound of the records in a block read, to reject corrupt files. */
+const uint64_t COLUMNAR_MAX_RECORDS = 1 << 24;
+
+ColumnarTraceFile::ColumnarTraceFile ()
+  : m_file (),
+    m_writing (false),
+    m_corrupt (false),
+    m_resolution (Time::NS),
+    m_records (0),
+    m_next (0)
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::RegisterStream (&m_file);
+}
+
+ColumnarTraceFile::~ColumnarTraceFile ()
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::UnregisterStream (&m_file);
+  Close ();
+}
+
+bool
+ColumnarTraceFile::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  // Reading up to the end of the file sets both eof and fail.
+  return m_corrupt || (m_file.fail () && !m_file.eof ());
+}
+
+void
+ColumnarTraceFile::Open (std::string const &filename, std::ios::openmode mode)
+{
+  NS_LOG_FUNCTION (this << filename << mode);
+  NS_ASSERT ((mode & std::ios::app) == 0);
+  NS_ASSERT_MSG (((mode & std::ios::in) != 0) != ((mode & std::ios::out) != 0),
+                 "ColumnarTraceFile::Open(): open for either reading or writing");
+
+  Close ();
+  m_filename = filename;
+  m_writing = (mode & std::ios::out) != 0;
+  m_corrupt = false;
+  m_records = 0;
+  m_next = 0;
+  for (uint32_t c = 0; c < COLUMNS; ++c)
+    {
+      m_columns[c].clear ();
+    }
+  m_file.clear ();
+  m_file.open (filename.c_str (), mode | std::ios::binary);
+  if (m_file.fail ())
+    {
+      return;
+    }
+
+  if (m_writing)
+    {
+      m_resolution = Time::GetResolution ();
+      m_file.write (COLUMNAR_MAGIC, sizeof (COLUMNAR_MAGIC));
+      m_file.put (COLUMNAR_VERSION);
+      m_file.put (static_cast<char> (m_resolution));
+      for (uint32_t c = 0; c < COLUMNS; ++c)
+        {
+          m_columns[c].reserve (BLOCK_RECORDS);
+        }
+    }
+  else
+    {
+      char magic[sizeof (COLUMNAR_MAGIC)];
+      m_file.read (magic, sizeof (magic));
+      int version = m_file.get ();
+      int resolution = m_file.get ();
+      if (m_file.fail () || std::memcmp (magic, COLUMNAR_MAGIC, sizeof (magic)) != 0
+          || version != COLUMNAR_VERSION || resolution < 0 || resolution >= Time::LAST)
+        {
+          NS_LOG_LOGIC ("not a columnar trace: " << filename);
+          m_corrupt = true;
+          return;
+        }
+      m_resolution = static_cast<Time::Unit> (resolution);
+    }
+}
+
+void
+ColumnarTraceFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+  if (m_writing)
+    {
+      Flush ();
+    }
+  m_file.close ();
+}
+
+void
+ColumnarTraceFile::PutVarint (std::vector<uint8_t> &buffer, uint64_t value)
+{
+  while (value >= 0x80)
+    {
+      buffer.push_back (static_cast<uint8_t> (value | 0x80));
+      value >>= 7;
+    }
+  buffer.push_back (static_cast<uint8_t> (value));
+}
+
+bool
+ColumnarTraceFile::GetVarint (const uint8_t *&p, const uint8_t *end, uint64_t &value)
+{
+  value = 0;
+  for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+      if (p == end)
+        {
+          return false;
+        }
+      uint8_t byte = *p++;
+      value |= static_cast<uint64_t> (byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+ColumnarTraceFile::Encode (const std::vector<uint64_t> &values, Encoding encoding,
+                           std::vector<uint8_t> &buffer)
+{
+  buffer.clear ();
+  switch (encoding)
+    {
+    case PLAIN:
+      for (std::size_t i = 0; i < values.size (); ++i)
+        {
+          PutVarint (buffer, values[i]);
+        }
+      break;
+    case DELTA:
+      {
+        uint64_t previous = 0;
+        for (std::size_t i = 0; i < values.size (); ++i)
+          {
+            int64_t delta = static_cast<int64_t> (values[i] - previous);
+            // Zigzag, so that small negative deltas are small varints.
+            PutVarint (buffer, (static_cast<uint64_t> (delta) << 1) ^ static_cast<uint64_t> (delta >> 63));
+            previous = values[i];
+          }
+      }
+      break;
+    case RUNS:
+      for (std::size_t i = 0; i < values.size (); /* empty */)
+        {
+          std::size_t j = i + 1;
+          while (j < values.size () && values[j] == values[i])
+            {
+              ++j;
+            }
+          PutVarint (buffer, values[i]);
+          PutVarint (buffer, j - i);
+          i = j;
+        }
+      break;
+    default:
+      NS_ASSERT_MSG (false, "ColumnarTraceFile::Encode(): unknown encoding");
+      break;
+    }
+}
+
+bool
+ColumnarTraceFile::Decode (const std::vector<uint8_t> &buffer, uint8_t encoding,
+                           uint64_t count, std::vector<uint64_t> &values)
+{
+  values.clear ();
+  const uint8_t *p = buffer.empty () ? 0 : &buffer[0];
+  const uint8_t *end = p + buffer.size ();
+  uint64_t value;
+  switch (encoding)
+    {
+    case PLAIN:
+      while (values.size () < count)
+        {
+          if (!GetVarint (p, end, value))
+            {
+              return false;
+            }
+          values.push_back (value);
+        }
+      break;
+    case DELTA:
+      {
+        uint64_t previous = 0;
+        while (values.size () < count)
+          {
+            if (!GetVarint (p, end, value))
+              {
+                return false;
+              }
+            uint64_t delta = (value >> 1) ^ (~(value & 1) + 1);
+            previous += delta;
+            values.push_back (previous);
+          }
+      }
+      break;
+    case RUNS:
+      while (values.size () < count)
+        {
+          uint64_t run;
+          if (!GetVarint (p, end, value) || !GetVarint (p, end, run)
+              || run == 0 || run > count - values.size ())
+            {
+              return false;
+            }
+          values.insert (values.end (), run, value);
+        }
+      break;
+    default:
+      return false;
+    }
+  return p == end;
+}
+
+void
+ColumnarTraceFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_writing, "ColumnarTraceFile::Flush(): file not open for writing");
+  uint64_t count = m_columns[TIME].size ();
+  if (count == 0)
+    {
+      m_file.flush ();
+      return;
+    }
+
+  std::vector<uint8_t> block;
+  PutVarint (block, count);
+  std::vector<uint8_t> best;
+  std::vector<uint8_t> candidate;
+  for (uint32_t c = 0; c < COLUMNS; ++c)
+    {
+      Encoding chosen = PLAIN;
+      Encode (m_columns[c], PLAIN, best);
+      const Encoding others[] = { DELTA, RUNS };
+      for (uint32_t e = 0; e < sizeof (others) / sizeof (others[0]); ++e)
+        {
+          Encode (m_columns[c], others[e], candidate);
+          if (candidate.size () < best.size ())
+            {
+              best.swap (candidate);
+              chosen = others[e];
+            }
+        }
+      NS_LOG_LOGIC ("column " << c << " encoding " << chosen << " " << best.size ()
+                    << " bytes for " << count << " records");
+      block.push_back (static_cast<uint8_t> (chosen));
+      PutVarint (block, best.size ());
+      block.insert (block.end (), best.begin (), best.end ());
+      m_columns[c].clear ();
+    }
+  m_file.write (reinterpret_cast<const char *> (&block[0]), block.size ());
+  m_file.flush ();
+}
+
+void
+ColumnarTraceFile::Write (const ColumnarTraceRecord &record)
+{
+  NS_ASSERT_MSG (m_writing, "ColumnarTraceFile::Write(): file not open for writing");
+  m_columns[TIME].push_back (static_cast<uint64_t> (record.time));
+  m_columns[EVENT].push_back (record.event);
+  m_columns[NODE].push_back (record.node);
+  m_columns[DEVICE].push_back (record.device);
+  m_columns[UID].push_back (record.uid);
+  m_columns[SIZE].push_back (record.size);
+  ++m_records;
+  if (m_columns[TIME].size () == BLOCK_RECORDS)
+    {
+      Flush ();
+    }
+}
+
+void
+ColumnarTraceFile::Write (uint8_t event, uint32_t node, uint32_t device, Ptr<const Packet> p)
+{
+  ColumnarTraceRecord record;
+  record.time = Simulator::Now ().GetTimeStep ();
+  record.event = event;
+  record.node = node;
+  record.device = device;
+  record.uid = p->GetUid ();
+  record.size = p->GetSize ();
+  Write (record);
+}
+
+bool
+ColumnarTraceFile::ReadVarint (uint64_t &value)
+{
+  value = 0;
+  for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+      int byte = m_file.get ();
+      if (byte == std::char_traits<char>::eof ())
+        {
+          return false;
+        }
+      value |= static_cast<uint64_t> (byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+ColumnarTraceFile::ReadBlock (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t count;
+  if (!ReadVarint (count))
+    {
+      // The end of the file.
+      return false;
+    }
+  if (count == 0 || count > COLUMNAR_MAX_RECORDS)
+    {
+      m_corrupt = true;
+      return false;
+    }
+  std::vector<uint8_t> buffer;
+  for (uint32_t c = 0; c < COLUMNS; ++c)
+    {
+      int encoding = m_file.get ();
+      uint64_t length;
+      // A varint takes at most 10 bytes, and runs take two.
+      if (encoding == std::char_traits<char>::eof () || !ReadVarint (length)
+          || length > 20 * count)
+        {
+          m_corrupt = true;
+          return false;
+        }
+      buffer.resize (length);
+      if (length != 0)
+        {
+          m_file.read (reinterpret_cast<char *> (&buffer[0]), length);
+        }
+      if (m_file.fail () || !Decode (buffer, static_cast<uint8_t> (encoding), count, m_columns[c]))
+        {
+          NS_LOG_LOGIC ("corrupt column " << c);
+          m_corrupt = true;
+          return false;
+        }
+    }
+  m_next = 0;
+  return true;
+}
+
+bool
+ColumnarTraceFile::Read (ColumnarTraceRecord &record)
+{
+  NS_ASSERT_MSG (!m_writing, "ColumnarTraceFile::Read(): file not open for reading");
+  if (m_corrupt || !m_file.is_open ())
+    {
+      return false;
+    }
+  if (m_next >= m_columns[TIME].size () && !ReadBlock ())
+    {
+      return false;
+    }
+  record.time = static_cast<int64_t> (m_columns[TIME][m_next]);
+  record.event = static_cast<uint8_t> (m_columns[EVENT][m_next]);
+  record.node = static_cast<uint32_t> (m_columns[NODE][m_next]);
+  record.device = static_cast<uint32_t> (m_columns[DEVICE][m_next]);
+  record.uid = m_columns[UID][m_next];
+  record.size = static_cast<uint32_t> (m_columns[SIZE][m_next]);
+  ++m_next;
+  ++m_records;
+  return true;
+}
+
+Time::Unit
+ColumnarTraceFile::GetResolution (void) const
+{
+  return m_resolution;
+}
+
+uint64_t
+ColumnarTraceFile::GetRecordCount (void) const
+{
+  return m_records;
+}
+
+} // namespace ns3
@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COLUMNAR_TRACE_FILE_H
+#define COLUMNAR_TRACE_FILE_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \brief A packet event read from or written to a ColumnarTraceFile.
+ */
+struct ColumnarTraceRecord
+{
+  int64_t time;         //!< Time of the event, in steps of the file resolution
+  uint8_t event;        //!< The event, as in the ascii traces ('+', '-', 'd', 'r')
+  uint32_t node;        //!< Id of the node
+  uint32_t device;      //!< Index of the device in the node
+  uint64_t uid;         //!< Unique id of the packet
+  uint32_t size;        //!< Size of the packet, in bytes
+};
+
+/**
+ * \brief A binary, column oriented packet trace file.
+ *
+ * A ColumnarTraceFile records the packet events of the ascii traces
+ * (enqueue, dequeue, drop and receive) as fixed records of time, event,
+ * node, device, packet uid and packet size, rather than as text.
+ *
+ * Records are gathered in blocks of BLOCK_RECORDS.  Each block is
+ * written one column after the other, and each column is encoded with
+ * whichever of plain varints, zigzag varints of the deltas, or runs of
+ * varints is the smallest for this block.  A record usually takes 4 to
+ * 8 bytes, against more than 100 in an ascii trace.
+ *
+ * The file starts with a header:
+ * \verbatim
+ *   "ns3c"        4 bytes
+ *   version       1 byte (1)
+ *   resolution    1 byte (the Time::Unit of the time column)
+ * \endverbatim
+ * followed by blocks:
+ * \verbatim
+ *   records       varint
+ *   6 columns:    encoding (1 byte), length (varint), bytes
+ * \endverbatim
+ *
+ * Analysis tools read the file with Read, or with utils/print-columnar-trace,
+ * which prints it as comma separated values.
+ *
+ * This class uses a basic ns-3 reference counting base class, like
+ * OutputStreamWrapper, so that trace sinks can hold it.
+ */
+class ColumnarTraceFile : public SimpleRefCount<ColumnarTraceFile>
+{
+public:
+  /** The packet events, with the characters of the ascii traces. */
+  enum Event
+  {
+    ENQUEUE = '+',    //!< Packet enqueued in a device queue
+    DEQUEUE = '-',    //!< Packet dequeued from a device queue
+    DROP = 'd',       //!< Packet dropped by a device queue or PHY
+    RECEIVE = 'r'     //!< Packet received by a device
+  };
+
+  /** The number of records in a block. */
+  static const uint32_t BLOCK_RECORDS = 4096;
+
+  ColumnarTraceFile ();
+  ~ColumnarTraceFile ();
+
+  /**
+   * \return true if the underlying iostream failed other than by
+   * reaching the end of the file, or the file is not a valid columnar
+   * trace, false otherwise.
+   */
+  bool Fail (void) const;
+
+  /**
+   * Create a new file, or open an existing file for reading.
+   *
+   * A file opened for writing records the current Time resolution.
+   *
+   * \param filename String containing the name of the file.
+   * \param mode std::ios::in or std::ios::out; binary is added.
+   */
+  void Open (std::string const &filename, std::ios::openmode mode);
+
+  /**
+   * Write the pending block, if any, and close the file.
+   */
+  void Close (void);
+
+  /**
+   * Write the pending block, if any.
+   */
+  void Flush (void);
+
+  /**
+   * Add a record to the file.
+   *
+   * \param record The record.
+   */
+  void Write (const ColumnarTraceRecord &record);
+
+  /**
+   * Add a record for a packet event to the file, at the current time.
+   *
+   * \param event The event.
+   * \param node The node id.
+   * \param device The device index.
+   * \param p The packet.
+   */
+  void Write (uint8_t event, uint32_t node, uint32_t device, Ptr<const Packet> p);
+
+  /**
+   * Read the next record from the file.
+   *
+   * \param [out] record The record.
+   * \return false at the end of the file, or if it is corrupt.
+   */
+  bool Read (ColumnarTraceRecord &record);
+
+  /**
+   * \return The Time::Unit of the time column.
+   */
+  Time::Unit GetResolution (void) const;
+
+  /**
+   * \return The number of records written or read so far.
+   */
+  uint64_t GetRecordCount (void) const;
+
+private:
+  /** The encodings of a column in a block. */
+  enum Encoding
+  {
+    PLAIN = 0,        //!< A varint per value
+    DELTA = 1,        //!< A zigzag varint of the difference with the previous value
+    RUNS = 2          //!< A varint value and a varint count per run of equal values
+  };
+
+  /** The columns of a block, in file order. */
+  enum Column
+  {
+    TIME = 0,
+    EVENT,
+    NODE,
+    DEVICE,
+    UID,
+    SIZE,
+    COLUMNS
+  };
+
+  /**
+   * Append a varint to a buffer.
+   * \param [in,out] buffer The buffer.
+   * \param [in] value The value.
+   */
+  static void PutVarint (std::vector<uint8_t> &buffer, uint64_t value);
+  /**
+   * Decode a varint.
+   * \param [in,out] p The position in the buffer.
+   * \param [in] end The end of the buffer.
+   * \param [out] value The value.
+   * \return false if the buffer ends before the varint.
+   */
+  static bool GetVarint (const uint8_t *&p, const uint8_t *end, uint64_t &value);
+  /**
+   * Encode a column, with one encoding.
+   * \param [in] values The column.
+   * \param [in] encoding The encoding.
+   * \param [out] buffer The encoded column.
+   */
+  static void Encode (const std::vector<uint64_t> &values, Encoding encoding,
+                      std::vector<uint8_t> &buffer);
+  /**
+   * Decode a column.
+   * \param [in] buffer The encoded column.
+   * \param [in] encoding The encoding.
+   * \param [in] count The number of values.
+   * \param [out] values The column.
+   * \return false if the column is corrupt.
+   */
+  static bool Decode (const std::vector<uint8_t> &buffer, uint8_t encoding,
+                      uint64_t count, std::vector<uint64_t> &values);
+  /**
+   * Read a varint from the file.
+   * \param [out] value The value.
+   * \return false at the end of the file.
+   */
+  bool ReadVarint (uint64_t &value);
+  /**
+   * Read and decode the next block.
+   * \return false at the end of the file, or if the block is corrupt.
+   */
+  bool ReadBlock (void);
+
+  std::string m_filename;                       //!< The name of the file
+  std::fstream m_file;                          //!< The file
+  bool m_writing;                               //!< Whether the file is open for writing
+  bool m_corrupt;                               //!< Whether the file is not a valid trace
+  Time::Unit m_resolution;                      //!< The unit of the time column
+  uint64_t m_records;                           //!< Records written or read so far
+  std::vector<uint64_t> m_columns[COLUMNS];     //!< The current block
+  uint32_t m_next;                              //!< Next record of the block to read
+};
+
+} // namespace ns3
+
+#endif /* COLUMNAR_TRACE_FILE_H */
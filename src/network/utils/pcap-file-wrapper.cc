@@ -18,6 +18,7 @@
 
 #include "ns3/log.h"
 #include "ns3/boolean.h"
+#include "ns3/enum.h"
 #include "ns3/uinteger.h"
 #include "ns3/buffer.h"
 #include "ns3/header.h"
@@ -46,6 +47,19 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("WriteBatchSize",
+                   "Size in bytes of the batches of records handed to a writer "
+                   "thread, or 0 to write each record synchronously.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_batchSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Compression",
+                   "Compression of the files written.  Compressed files are "
+                   "written by a writer thread, and get a .gz suffix.",
+                   EnumValue (PcapFile::NO_COMPRESSION),
+                   MakeEnumAccessor (&PcapFileWrapper::m_compression),
+                   MakeEnumChecker (PcapFile::NO_COMPRESSION, "None",
+                                    PcapFile::GZIP_COMPRESSION, "Gzip"))
   ;
   return tid;
 }
@@ -93,6 +107,12 @@ void
 PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
   NS_LOG_FUNCTION (this << filename << mode);
+  m_file.SetAsyncWrite (m_batchSize, m_compression);
+  if (m_compression == PcapFile::GZIP_COMPRESSION && !(mode & std::ios::in))
+    {
+      m_file.Open (filename + ".gz", mode);
+      return;
+    }
   m_file.Open (filename, mode);
 }
 
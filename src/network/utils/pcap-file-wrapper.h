@@ -70,6 +70,10 @@ public:
    * selected as a binary file (fstream::binary is automatically ored with the mode
    * field).
    *
+   * The files opened for writing are written as set by the WriteBatchSize
+   * and Compression attributes; with a compression, ".gz" is appended to
+   * the file name.
+   *
    * \param filename String containing the name of the file.
    *
    * \param mode String containing the access mode for the file.
@@ -224,6 +228,8 @@ private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  uint32_t m_batchSize; //!< size of the asynchronous write batches, or 0
+  PcapFile::Compression m_compression; //!< compression of the files written
 };
 
 } // namespace ns3
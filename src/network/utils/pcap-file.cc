@@ -20,6 +20,10 @@
 
 #include <iostream>
 #include <cstring>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include "ns3/assert.h"
 #include "ns3/packet.h"
 #include "ns3/fatal-error.h"
@@ -29,6 +33,16 @@
 #include "pcap-file.h"
 #include "ns3/log.h"
 #include "ns3/build-profile.h"
+#include "ns3/core-config.h"
+
+#ifdef HAVE_PTHREAD_H
+#include <thread>
+#endif
+
+#ifdef NS3_ZLIB
+#include <zlib.h>
+#endif
+
 //
 // This file is used as part of the ns-3 test framework, so please refrain from 
 // adding any ns-3 specific constructs such as Packet to this file.
@@ -47,10 +61,276 @@ const uint32_t NS_SWAPPED_MAGIC = 0x4d3cb2a1; /**< Looks this way if byte swappi
 const uint16_t VERSION_MAJOR = 2;             /**< Major version of supported pcap file format */
 const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pcap file format */
 
+/**
+ * Write the batches of records of an asynchronous PcapFile.
+ *
+ * When threads are available, one writer thread, shared by all the open
+ * files, writes the batches in the order they are submitted, so that the
+ * batches of each file are written in order.  The thread is started with
+ * the first open file, and stopped once the last one is closed.  Without
+ * threads, the batches are written as soon as they are submitted.
+ */
+class PcapFileWriter
+{
+public:
+  /**
+   * Create the file, and start the shared thread if it is not running.
+   * \param [in] filename The file name.
+   * \param [in] compression The compression of the file.
+   */
+  PcapFileWriter (std::string const &filename, PcapFile::Compression compression);
+  ~PcapFileWriter ();
+
+  /** \returns True if the file could not be created or written. */
+  bool Fail (void) const;
+  /**
+   * Queue a batch, once fewer than MAX_PENDING batches of this file wait.
+   * \param [in,out] batch The batch, replaced by an empty one.
+   */
+  void Submit (std::vector<uint8_t> &batch);
+  /**
+   * Wait for the queued batches to be written and close the file,
+   * stopping the shared thread if no other file is open.
+   */
+  void Close (void);
+
+private:
+  /** The state of the writer thread, shared by all the files. */
+  struct Shared
+  {
+    Shared ();
+
+    std::mutex mutex;                         //!< Protects the queues
+    std::condition_variable wakeup;           //!< Signals batches, or stop
+    std::condition_variable written;          //!< Signals written batches
+    std::deque<PcapFileWriter *> queue;       //!< The file of each batch to write, in order
+    bool stop;                                //!< Stop once written
+    std::mutex lifecycle;                     //!< Serializes starting and stopping the thread
+    uint32_t files;                           //!< The number of open files
+#ifdef HAVE_PTHREAD_H
+    std::thread thread;                       //!< The writer thread
+#endif
+  };
+
+  /**
+   * \returns The shared state.  It is never destroyed, so that a file
+   * left open at exit does not destroy a running thread.
+   */
+  static Shared & GetShared (void);
+  /** The thread: write the batches, in order, until the last file closes. */
+  static void Run (void);
+  /**
+   * Write a batch to the file.
+   * \param [in] batch The batch.
+   */
+  void WriteBatch (std::vector<uint8_t> const &batch);
+
+  /** The number of batches of a file which can wait for the thread. */
+  static const uint32_t MAX_PENDING = 4;
+
+  PcapFile::Compression m_compression;          //!< The compression
+  std::ofstream m_file;                         //!< The plain file
+#ifdef NS3_ZLIB
+  gzFile m_gzFile;                              //!< The gzip file
+#endif
+  std::atomic<bool> m_fail;                     //!< A write failed
+  bool m_closed;                                //!< Close was called
+  std::deque<std::vector<uint8_t> > m_pending;  //!< The batches to write
+  std::vector<std::vector<uint8_t> > m_free;    //!< Written batches, for reuse
+};
+
+PcapFileWriter::Shared::Shared ()
+  : stop (false),
+    files (0)
+{
+}
+
+PcapFileWriter::Shared &
+PcapFileWriter::GetShared (void)
+{
+  static Shared *shared = new Shared ();
+  return *shared;
+}
+
+PcapFileWriter::PcapFileWriter (std::string const &filename, PcapFile::Compression compression)
+  : m_compression (compression),
+    m_fail (false),
+    m_closed (false)
+{
+  NS_LOG_FUNCTION (this << filename << compression);
+  if (m_compression == PcapFile::GZIP_COMPRESSION)
+    {
+#ifdef NS3_ZLIB
+      // Favor speed: the writer must keep up with the simulation.
+      m_gzFile = gzopen (filename.c_str (), "wb1");
+      m_fail = (m_gzFile == 0);
+#endif
+    }
+  else
+    {
+      m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+      m_fail = !m_file.is_open ();
+    }
+#ifdef HAVE_PTHREAD_H
+  Shared &shared = GetShared ();
+  std::lock_guard<std::mutex> lock (shared.lifecycle);
+  if (shared.files++ == 0)
+    {
+      shared.thread = std::thread (&PcapFileWriter::Run);
+    }
+#endif
+}
+
+PcapFileWriter::~PcapFileWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+PcapFileWriter::Fail (void) const
+{
+  return m_fail;
+}
+
+void
+PcapFileWriter::Submit (std::vector<uint8_t> &batch)
+{
+  NS_LOG_FUNCTION (this << batch.size ());
+#ifdef HAVE_PTHREAD_H
+  Shared &shared = GetShared ();
+  {
+    std::unique_lock<std::mutex> lock (shared.mutex);
+    shared.written.wait (lock, [this] { return m_pending.size () < MAX_PENDING; });
+    m_pending.push_back (std::vector<uint8_t> ());
+    m_pending.back ().swap (batch);
+    shared.queue.push_back (this);
+    if (!m_free.empty ())
+      {
+        batch.swap (m_free.back ());
+        m_free.pop_back ();
+      }
+  }
+  shared.wakeup.notify_one ();
+#else
+  WriteBatch (batch);
+#endif
+  batch.clear ();
+}
+
+void
+PcapFileWriter::Run (void)
+{
+  Shared &shared = GetShared ();
+  std::unique_lock<std::mutex> lock (shared.mutex);
+  while (true)
+    {
+      shared.wakeup.wait (lock, [&shared] { return shared.stop || !shared.queue.empty (); });
+      if (shared.queue.empty ())
+        {
+          break;
+        }
+      // The file waits in Close until its batches are written.
+      PcapFileWriter *writer = shared.queue.front ();
+      shared.queue.pop_front ();
+      std::vector<uint8_t> batch;
+      batch.swap (writer->m_pending.front ());
+      lock.unlock ();
+      writer->WriteBatch (batch);
+      batch.clear ();
+      lock.lock ();
+      // The batch counts as pending until written, to bound the memory.
+      writer->m_pending.pop_front ();
+      if (writer->m_free.size () < MAX_PENDING)
+        {
+          writer->m_free.push_back (std::vector<uint8_t> ());
+          writer->m_free.back ().swap (batch);
+        }
+      shared.written.notify_all ();
+    }
+}
+
+void
+PcapFileWriter::WriteBatch (std::vector<uint8_t> const &batch)
+{
+  if (m_fail || batch.empty ())
+    {
+      return;
+    }
+  if (m_compression == PcapFile::GZIP_COMPRESSION)
+    {
+#ifdef NS3_ZLIB
+      if (gzwrite (m_gzFile, batch.data (), batch.size ()) != static_cast<int> (batch.size ()))
+        {
+          m_fail = true;
+        }
+#endif
+    }
+  else
+    {
+      m_file.write (reinterpret_cast<const char *> (batch.data ()), batch.size ());
+      if (m_file.fail ())
+        {
+          m_fail = true;
+        }
+    }
+}
+
+void
+PcapFileWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_closed)
+    {
+      return;
+    }
+  m_closed = true;
+#ifdef HAVE_PTHREAD_H
+  Shared &shared = GetShared ();
+  {
+    std::unique_lock<std::mutex> lock (shared.mutex);
+    shared.written.wait (lock, [this] { return m_pending.empty (); });
+  }
+  {
+    std::lock_guard<std::mutex> lifecycle (shared.lifecycle);
+    if (--shared.files == 0)
+      {
+        {
+          std::lock_guard<std::mutex> lock (shared.mutex);
+          shared.stop = true;
+        }
+        shared.wakeup.notify_one ();
+        shared.thread.join ();
+        shared.stop = false;
+      }
+  }
+#endif
+  if (m_compression == PcapFile::GZIP_COMPRESSION)
+    {
+#ifdef NS3_ZLIB
+      if (m_gzFile != 0 && gzclose (m_gzFile) != Z_OK)
+        {
+          m_fail = true;
+        }
+#endif
+    }
+  else if (m_file.is_open ())
+    {
+      m_file.close ();
+      if (m_file.fail ())
+        {
+          m_fail = true;
+        }
+    }
+}
+
 PcapFile::PcapFile ()
   : m_file (),
     m_swapMode (false),
-    m_nanosecMode (false)
+    m_nanosecMode (false),
+    m_batchSize (0),
+    m_compression (NO_COMPRESSION),
+    m_writer (0)
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::RegisterStream (&m_file); 
@@ -64,16 +344,52 @@ PcapFile::~PcapFile ()
 }
 
 
+bool
+PcapFile::IsCompressionSupported (Compression compression)
+{
+  NS_LOG_FUNCTION (compression);
+#ifdef NS3_ZLIB
+  return true;
+#else
+  return compression == NO_COMPRESSION;
+#endif
+}
+
+void
+PcapFile::SetAsyncWrite (uint32_t batchSize, Compression compression)
+{
+  NS_LOG_FUNCTION (this << batchSize << compression);
+  if (!IsCompressionSupported (compression))
+    {
+      NS_FATAL_ERROR ("PcapFile::SetAsyncWrite(): gzip compression requires zlib");
+    }
+  // Compressed files are always written by the writer.
+  if (batchSize == 0 && compression != NO_COMPRESSION)
+    {
+      batchSize = BATCH_SIZE_DEFAULT;
+    }
+  m_batchSize = batchSize;
+  m_compression = compression;
+}
+
 bool 
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      return m_writer->Fail ();
+    }
   return m_file.fail ();
 }
 bool 
 PcapFile::Eof (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      return false;
+    }
   return m_file.eof ();
 }
 void 
@@ -88,6 +404,22 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      if (!m_batch.empty ())
+        {
+          m_writer->Submit (m_batch);
+        }
+      m_writer->Close ();
+      if (m_writer->Fail ())
+        {
+          m_file.setstate (std::ios::failbit);
+        }
+      delete m_writer;
+      m_writer = 0;
+      std::vector<uint8_t> ().swap (m_batch);
+      return;
+    }
   m_file.close ();
 }
 
@@ -206,7 +538,10 @@ PcapFile::WriteFileHeader (void)
   // If we're initializing the file, we need to write the pcap file header
   // at the start of the file.
   //
-  m_file.seekp (0, std::ios::beg);
+  if (m_writer == 0)
+    {
+      m_file.seekp (0, std::ios::beg);
+    }
  
   //
   // We have the ability to write out the pcap file header in a foreign endian
@@ -234,13 +569,14 @@ PcapFile::WriteFileHeader (void)
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
   //
-  m_file.write ((const char *)&headerOut->m_magicNumber, sizeof(headerOut->m_magicNumber));
-  m_file.write ((const char *)&headerOut->m_versionMajor, sizeof(headerOut->m_versionMajor));
-  m_file.write ((const char *)&headerOut->m_versionMinor, sizeof(headerOut->m_versionMinor));
-  m_file.write ((const char *)&headerOut->m_zone, sizeof(headerOut->m_zone));
-  m_file.write ((const char *)&headerOut->m_sigFigs, sizeof(headerOut->m_sigFigs));
-  m_file.write ((const char *)&headerOut->m_snapLen, sizeof(headerOut->m_snapLen));
-  m_file.write ((const char *)&headerOut->m_type, sizeof(headerOut->m_type));
+  WriteBytes (&headerOut->m_magicNumber, sizeof(headerOut->m_magicNumber));
+  WriteBytes (&headerOut->m_versionMajor, sizeof(headerOut->m_versionMajor));
+  WriteBytes (&headerOut->m_versionMinor, sizeof(headerOut->m_versionMinor));
+  WriteBytes (&headerOut->m_zone, sizeof(headerOut->m_zone));
+  WriteBytes (&headerOut->m_sigFigs, sizeof(headerOut->m_sigFigs));
+  WriteBytes (&headerOut->m_snapLen, sizeof(headerOut->m_snapLen));
+  WriteBytes (&headerOut->m_type, sizeof(headerOut->m_type));
+  EndRecord ();
 }
 
 void
@@ -327,12 +663,19 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
   NS_LOG_FUNCTION (this << filename << mode);
   NS_ASSERT ((mode & std::ios::app) == 0);
   NS_ASSERT (!m_file.fail ());
+  NS_ASSERT (m_writer == 0);
   //
   // All pcap files are binary files, so we just do this automatically.
   //
   mode |= std::ios::binary;
 
   m_filename=filename;
+  if (m_batchSize > 0 && (mode & std::ios::out) && !(mode & std::ios::in))
+    {
+      m_writer = new PcapFileWriter (filename, m_compression);
+      m_batch.reserve (m_batchSize);
+      return;
+    }
   m_file.open (filename.c_str (), mode);
   if (mode & std::ios::in)
     {
@@ -403,7 +746,7 @@ uint32_t
 PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
-  NS_ASSERT (m_file.good ());
+  NS_ASSERT (m_writer != 0 || m_file.good ());
 
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
 
@@ -422,21 +765,58 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
   //
-  m_file.write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
-  m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
-  m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
-  m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
-  NS_BUILD_DEBUG(m_file.flush());
+  WriteBytes (&header.m_tsSec, sizeof(header.m_tsSec));
+  WriteBytes (&header.m_tsUsec, sizeof(header.m_tsUsec));
+  WriteBytes (&header.m_inclLen, sizeof(header.m_inclLen));
+  WriteBytes (&header.m_origLen, sizeof(header.m_origLen));
   return inclLen;
 }
 
+void
+PcapFile::WriteBytes (const void *data, uint32_t size)
+{
+  if (m_writer != 0)
+    {
+      const uint8_t *bytes = static_cast<const uint8_t *> (data);
+      m_batch.insert (m_batch.end (), bytes, bytes + size);
+    }
+  else
+    {
+      m_file.write (static_cast<const char *> (data), size);
+    }
+}
+
+uint8_t *
+PcapFile::ReserveBytes (uint32_t size)
+{
+  std::size_t start = m_batch.size ();
+  m_batch.resize (start + size);
+  return m_batch.data () + start;
+}
+
+void
+PcapFile::EndRecord (void)
+{
+  if (m_writer != 0)
+    {
+      if (m_batch.size () >= m_batchSize)
+        {
+          m_writer->Submit (m_batch);
+        }
+    }
+  else
+    {
+      NS_BUILD_DEBUG(m_file.flush());
+    }
+}
+
 void
 PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
-  m_file.write ((const char *)data, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  WriteBytes (data, inclLen);
+  EndRecord ();
 }
 
 void 
@@ -444,8 +824,16 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
-  p->CopyData (&m_file, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  // Only the bytes within the snaplen are copied.
+  if (m_writer != 0)
+    {
+      p->CopyData (ReserveBytes (inclLen), inclLen);
+    }
+  else
+    {
+      p->CopyData (&m_file, inclLen);
+    }
+  EndRecord ();
 }
 
 void 
@@ -460,9 +848,18 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
-  headerBuffer.CopyData (&m_file, toCopy);
-  inclLen -= toCopy;
-  p->CopyData (&m_file, inclLen);
+  if (m_writer != 0)
+    {
+      uint8_t *record = ReserveBytes (inclLen);
+      headerBuffer.CopyData (record, toCopy);
+      p->CopyData (record + toCopy, inclLen - toCopy);
+    }
+  else
+    {
+      headerBuffer.CopyData (&m_file, toCopy);
+      p->CopyData (&m_file, inclLen - toCopy);
+    }
+  EndRecord ();
 }
 
 void
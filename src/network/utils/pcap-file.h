@@ -23,6 +23,7 @@
 
 #include <string>
 #include <fstream>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ptr.h"
 
@@ -30,6 +31,7 @@ namespace ns3 {
 
 class Packet;
 class Header;
+class PcapFileWriter;
 
 
 /**
@@ -44,11 +46,47 @@ class PcapFile
 public:
   static const int32_t  ZONE_DEFAULT    = 0;           /**< Time zone offset for current location */
   static const uint32_t SNAPLEN_DEFAULT = 65535;       /**< Default value for maximum octets to save per packet */
+  static const uint32_t BATCH_SIZE_DEFAULT = 65536;    /**< Default size of the batches of asynchronous writes */
+
+  /**
+   * The compression of the files written asynchronously.
+   */
+  enum Compression
+  {
+    NO_COMPRESSION,      //!< A plain pcap file
+    GZIP_COMPRESSION     //!< A gzip stream, which tcpdump and wireshark read
+  };
 
 public:
   PcapFile ();
   ~PcapFile ();
 
+  /**
+   * \param [in] compression A compression.
+   * \returns True if the files can be written with this compression.  The
+   * gzip compression requires ns-3 to be configured with zlib.
+   */
+  static bool IsCompressionSupported (Compression compression);
+
+  /**
+   * Write the next files opened with mode std::ios::out asynchronously.
+   *
+   * The records are appended to a batch in memory, and each full batch is
+   * handed to a writer thread shared by all the asynchronous files, which
+   * writes it, compressed if requested, while the simulation goes on.  At
+   * most a few batches of each file wait for the writer: when it falls
+   * behind, Write waits for it.  Close writes the last batch, and waits for
+   * the writer to finish it.  The thread stops once the last asynchronous
+   * file is closed.
+   *
+   * The files opened for reading, and the files opened after calling this
+   * method with a batch size of 0, are written synchronously.
+   *
+   * \param [in] batchSize The size of the batches, in bytes, or 0.
+   * \param [in] compression The compression of the files.
+   */
+  void SetAsyncWrite (uint32_t batchSize, Compression compression = NO_COMPRESSION);
+
   /**
    * \return true if the 'fail' bit is set in the underlying iostream, false otherwise.
    */
@@ -366,11 +404,32 @@ private:
    */
   void ReadAndVerifyFileHeader (void);
 
+  /**
+   * \brief Write bytes to the file, or to the batch of an asynchronous file
+   * \param data The bytes
+   * \param size The number of bytes
+   */
+  void WriteBytes (const void *data, uint32_t size);
+  /**
+   * \brief Reserve room for bytes at the end of the batch
+   * \param size The number of bytes
+   * \returns The room, which the caller fills
+   */
+  uint8_t *ReserveBytes (uint32_t size);
+  /**
+   * \brief Hand the batch to the writer if it is full, at the end of a record
+   */
+  void EndRecord (void);
+
   std::string    m_filename;    //!< file name
   std::fstream   m_file;        //!< file stream
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
+  uint32_t m_batchSize;         //!< size of the asynchronous batches, or 0
+  Compression m_compression;    //!< compression of the asynchronous files
+  PcapFileWriter *m_writer;     //!< writer of the open asynchronous file
+  std::vector<uint8_t> m_batch; //!< records not yet handed to the writer
 };
 
 } // namespace ns3
@@ -31,6 +31,7 @@
 #include "ns3/log.h"
 #include "ns3/queue-size.h"
 #include "ns3/queue-item.h"
+#include "ns3/ring-buffer.h"
 #include <string>
 #include <sstream>
 #include <list>
@@ -223,6 +224,35 @@ private:
 };
 
 
+/**
+ * \ingroup queue
+ * \brief The container of the items of a Queue.
+ *
+ * The items of a Queue are stored in a RingBuffer, so that enqueuing
+ * and dequeuing do not allocate memory, and the items are contiguous.
+ * The iterators of a RingBuffer remain valid when the items after them
+ * are inserted or erased, but not when the items before them are (see
+ * RingBuffer).  A queue whose subclass relies on the iterator validity
+ * of std::list selects it by specializing this template, before any use
+ * of the Queue of its item type:
+ *
+ * \code
+ *   template <>
+ *   struct QueueContainer<MyItem>
+ *   {
+ *     typedef std::list<Ptr<MyItem> > Type;
+ *   };
+ * \endcode
+ *
+ * \tparam Item \explicit The type of the queued items.
+ */
+template <typename Item>
+struct QueueContainer
+{
+  typedef RingBuffer<Ptr<Item> > Type; //!< The container type
+};
+
+
 /**
  * \ingroup queue
  * \brief Template class for packet Queues
@@ -301,9 +331,9 @@ public:
 protected:
 
   /// Const iterator.
-  typedef typename std::list<Ptr<Item> >::const_iterator ConstIterator;
+  typedef typename QueueContainer<Item>::Type::const_iterator ConstIterator;
   /// Iterator.
-  typedef typename std::list<Ptr<Item> >::iterator Iterator;
+  typedef typename QueueContainer<Item>::Type::iterator Iterator;
 
   /**
    * \brief Get a const iterator which refers to the first item in the queue.
@@ -419,7 +449,7 @@ protected:
   void DropAfterDequeue (Ptr<Item> item);
 
 private:
-  std::list<Ptr<Item> > m_packets;          //!< the items in the queue
+  typename QueueContainer<Item>::Type m_packets; //!< the items in the queue
   NS_LOG_TEMPLATE_DECLARE;                  //!< the log component
 
   /// Traced callback: fired when a packet is enqueued
@@ -0,0 +1,630 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include "ns3/assert.h"
+
+/**
+ * \file
+ * \ingroup queue
+ * ns3::RingBuffer declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ * \brief A double-ended sequence of items stored in a contiguous,
+ * circular array which grows on demand.
+ *
+ * This is the container of the items of a Queue: adding an item at
+ * either end, and removing the first or last item, does not allocate
+ * memory once the array is large enough, and the i-th item is accessed
+ * in constant time.
+ *
+ * The interface follows the subset of std::list used by the queues,
+ * with the following differences in the validity of the iterators,
+ * which refer to an item by its position in the sequence:
+ *   - growing the array does not invalidate any iterator;
+ *   - inserting an item before a position moves the items before this
+ *     position towards the front of the sequence, and erasing an item
+ *     moves the items before it towards the back of the sequence: the
+ *     iterators to the items after the position, and end (), remain
+ *     valid, while the iterators to the items before it are
+ *     invalidated.  Inserting or erasing an item at the front, as queues
+ *     usually do, is done in constant time; otherwise, in time
+ *     proportional to the distance from the front.
+ *
+ * \tparam T \explicit The type of the items.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+  /**
+   * \brief An iterator over the items of a RingBuffer.
+   *
+   * \tparam U \explicit The type of the items, T or const T.
+   */
+  template <typename U>
+  class IteratorImpl
+  {
+public:
+    typedef std::random_access_iterator_tag iterator_category; //!< Iterator category
+    typedef T value_type;            //!< Item type
+    typedef std::ptrdiff_t difference_type; //!< Distance type
+    typedef U *pointer;              //!< Pointer type
+    typedef U &reference;            //!< Reference type
+
+    /** Create a singular iterator. */
+    IteratorImpl ()
+      : m_ring (0),
+        m_position (0)
+    {
+    }
+    /**
+     * Create an iterator.
+     * \param [in] ring The container.
+     * \param [in] position The absolute position of the item.
+     */
+    IteratorImpl (const RingBuffer<T> *ring, uint32_t position)
+      : m_ring (const_cast<RingBuffer<T> *> (ring)),
+        m_position (position)
+    {
+    }
+    /**
+     * Convert an iterator to a const iterator.
+     * \param [in] o The iterator.
+     */
+    IteratorImpl (const IteratorImpl<T> &o)
+      : m_ring (o.m_ring),
+        m_position (o.m_position)
+    {
+    }
+
+    /** \returns The item. */
+    reference operator* (void) const
+    {
+      return m_ring->Slot (m_position);
+    }
+    /** \returns A pointer to the item. */
+    pointer operator-> (void) const
+    {
+      return &m_ring->Slot (m_position);
+    }
+    /**
+     * \param [in] n The distance from this item.
+     * \returns The item n positions after this one.
+     */
+    reference operator[] (difference_type n) const
+    {
+      return m_ring->Slot (m_position + n);
+    }
+    /** \returns This iterator, on the next item. */
+    IteratorImpl &operator++ (void)
+    {
+      m_position++;
+      return *this;
+    }
+    /** \returns This iterator, before moving to the next item. */
+    IteratorImpl operator++ (int)
+    {
+      IteratorImpl tmp = *this;
+      m_position++;
+      return tmp;
+    }
+    /** \returns This iterator, on the previous item. */
+    IteratorImpl &operator-- (void)
+    {
+      m_position--;
+      return *this;
+    }
+    /** \returns This iterator, before moving to the previous item. */
+    IteratorImpl operator-- (int)
+    {
+      IteratorImpl tmp = *this;
+      m_position--;
+      return tmp;
+    }
+    /**
+     * \param [in] n The distance to move.
+     * \returns This iterator, moved n items forward.
+     */
+    IteratorImpl &operator+= (difference_type n)
+    {
+      m_position += n;
+      return *this;
+    }
+    /**
+     * \param [in] n The distance to move.
+     * \returns This iterator, moved n items backward.
+     */
+    IteratorImpl &operator-= (difference_type n)
+    {
+      m_position -= n;
+      return *this;
+    }
+    /**
+     * \param [in] n The distance.
+     * \returns An iterator n items after this one.
+     */
+    IteratorImpl operator+ (difference_type n) const
+    {
+      return IteratorImpl (m_ring, m_position + n);
+    }
+    /**
+     * \param [in] n The distance.
+     * \returns An iterator n items before this one.
+     */
+    IteratorImpl operator- (difference_type n) const
+    {
+      return IteratorImpl (m_ring, m_position - n);
+    }
+    /**
+     * \tparam V \deduced The item type of o, const or not.
+     * \param [in] o Another iterator on the same container.
+     * \returns The number of items from o to this iterator.
+     */
+    template <typename V>
+    difference_type operator- (const IteratorImpl<V> &o) const
+    {
+      return static_cast<int32_t> (m_position - o.m_position);
+    }
+    /**
+     * \tparam V \deduced The item type of o, const or not.
+     * \param [in] o Another iterator.
+     * \returns True if both iterators refer to the same item.
+     */
+    template <typename V>
+    bool operator== (const IteratorImpl<V> &o) const
+    {
+      return m_ring == o.m_ring && m_position == o.m_position;
+    }
+    /**
+     * \tparam V \deduced The item type of o, const or not.
+     * \param [in] o Another iterator.
+     * \returns True if the iterators refer to different items.
+     */
+    template <typename V>
+    bool operator!= (const IteratorImpl<V> &o) const
+    {
+      return !(*this == o);
+    }
+    /**
+     * \tparam V \deduced The item type of o, const or not.
+     * \param [in] o Another iterator on the same container.
+     * \returns True if this item is before the item of o.
+     */
+    template <typename V>
+    bool operator< (const IteratorImpl<V> &o) const
+    {
+      return (*this - o) < 0;
+    }
+    /**
+     * \tparam V \deduced The item type of o, const or not.
+     * \param [in] o Another iterator on the same container.
+     * \returns True if this item is after the item of o.
+     */
+    template <typename V>
+    bool operator> (const IteratorImpl<V> &o) const
+    {
+      return o < *this;
+    }
+    /**
+     * \tparam V \deduced The item type of o, const or not.
+     * \param [in] o Another iterator on the same container.
+     * \returns True if this item is not after the item of o.
+     */
+    template <typename V>
+    bool operator<= (const IteratorImpl<V> &o) const
+    {
+      return !(o < *this);
+    }
+    /**
+     * \tparam V \deduced The item type of o, const or not.
+     * \param [in] o Another iterator on the same container.
+     * \returns True if this item is not before the item of o.
+     */
+    template <typename V>
+    bool operator>= (const IteratorImpl<V> &o) const
+    {
+      return !(*this < o);
+    }
+
+private:
+    friend class RingBuffer<T>;
+    template <typename V>
+    friend class IteratorImpl;
+    RingBuffer<T> *m_ring;  //!< The container
+    uint32_t m_position;    //!< The absolute position of the item
+  };
+
+  typedef IteratorImpl<T> iterator;               //!< Iterator
+  typedef IteratorImpl<const T> const_iterator;   //!< Const iterator
+  typedef T value_type;                           //!< Item type
+  typedef uint32_t size_type;                     //!< Size type
+
+  /** Create an empty container, which allocates no memory. */
+  RingBuffer ();
+  /**
+   * Copy a container.
+   * \param [in] o The container to copy.
+   */
+  RingBuffer (const RingBuffer &o);
+  /**
+   * Copy a container.
+   * \param [in] o The container to copy.
+   * \returns This container.
+   */
+  RingBuffer &operator= (const RingBuffer &o);
+
+  /** \returns The number of items. */
+  uint32_t size (void) const;
+  /** \returns True if there is no item. */
+  bool empty (void) const;
+  /** \returns The number of items which fit in the allocated array. */
+  uint32_t capacity (void) const;
+
+  /**
+   * \param [in] i The index of the item, from the front.
+   * \returns The item.
+   */
+  T &operator[] (uint32_t i);
+  /**
+   * \param [in] i The index of the item, from the front.
+   * \returns The item.
+   */
+  const T &operator[] (uint32_t i) const;
+  /** \returns The first item. */
+  T &front (void);
+  /** \returns The first item. */
+  const T &front (void) const;
+  /** \returns The last item. */
+  T &back (void);
+  /** \returns The last item. */
+  const T &back (void) const;
+
+  /** \returns An iterator to the first item. */
+  iterator begin (void);
+  /** \returns A const iterator to the first item. */
+  const_iterator begin (void) const;
+  /** \returns A const iterator to the first item. */
+  const_iterator cbegin (void) const;
+  /** \returns An iterator past the last item. */
+  iterator end (void);
+  /** \returns A const iterator past the last item. */
+  const_iterator end (void) const;
+  /** \returns A const iterator past the last item. */
+  const_iterator cend (void) const;
+
+  /**
+   * Add an item after the last one.
+   * \param [in] item The item.
+   */
+  void push_back (const T &item);
+  /**
+   * Add an item before the first one.
+   * \param [in] item The item.
+   */
+  void push_front (const T &item);
+  /** Remove the first item. */
+  void pop_front (void);
+  /** Remove the last item. */
+  void pop_back (void);
+  /**
+   * Insert an item.
+   * \param [in] pos The position of the item before which to insert.
+   * \param [in] item The item.
+   * \returns An iterator to the inserted item.
+   */
+  iterator insert (const_iterator pos, const T &item);
+  /**
+   * Erase an item.
+   * \param [in] pos The position of the item.
+   * \returns An iterator to the item which followed the erased item.
+   */
+  iterator erase (const_iterator pos);
+  /** Remove all the items, keeping the allocated array. */
+  void clear (void);
+
+private:
+  /**
+   * \param [in] position An absolute position.
+   * \returns The slot of the array holding the item at this position.
+   */
+  T &Slot (uint32_t position);
+  /** Double the size of the array. */
+  void Grow (void);
+
+  /**
+   * The array of items, whose size is zero or a power of two.  The
+   * item at the absolute position p is stored in m_items[p & m_mask].
+   */
+  std::vector<T> m_items;
+  uint32_t m_mask;  //!< The size of the array minus one
+  uint32_t m_head;  //!< The absolute position of the first item
+  uint32_t m_tail;  //!< The absolute position past the last item
+};
+
+
+/**
+ * Implementation of the templates declared above.
+ */
+
+template <typename T>
+RingBuffer<T>::RingBuffer ()
+  : m_mask (0),
+    m_head (0),
+    m_tail (0)
+{
+}
+
+template <typename T>
+RingBuffer<T>::RingBuffer (const RingBuffer &o)
+  : m_items (o.m_items),
+    m_mask (o.m_mask),
+    m_head (o.m_head),
+    m_tail (o.m_tail)
+{
+}
+
+template <typename T>
+RingBuffer<T> &
+RingBuffer<T>::operator= (const RingBuffer &o)
+{
+  m_items = o.m_items;
+  m_mask = o.m_mask;
+  m_head = o.m_head;
+  m_tail = o.m_tail;
+  return *this;
+}
+
+template <typename T>
+uint32_t
+RingBuffer<T>::size (void) const
+{
+  return m_tail - m_head;
+}
+
+template <typename T>
+bool
+RingBuffer<T>::empty (void) const
+{
+  return m_tail == m_head;
+}
+
+template <typename T>
+uint32_t
+RingBuffer<T>::capacity (void) const
+{
+  return m_items.size ();
+}
+
+template <typename T>
+T &
+RingBuffer<T>::Slot (uint32_t position)
+{
+  return m_items[position & m_mask];
+}
+
+template <typename T>
+T &
+RingBuffer<T>::operator[] (uint32_t i)
+{
+  NS_ASSERT (i < size ());
+  return Slot (m_head + i);
+}
+
+template <typename T>
+const T &
+RingBuffer<T>::operator[] (uint32_t i) const
+{
+  NS_ASSERT (i < size ());
+  return m_items[(m_head + i) & m_mask];
+}
+
+template <typename T>
+T &
+RingBuffer<T>::front (void)
+{
+  return (*this)[0];
+}
+
+template <typename T>
+const T &
+RingBuffer<T>::front (void) const
+{
+  return (*this)[0];
+}
+
+template <typename T>
+T &
+RingBuffer<T>::back (void)
+{
+  return (*this)[size () - 1];
+}
+
+template <typename T>
+const T &
+RingBuffer<T>::back (void) const
+{
+  return (*this)[size () - 1];
+}
+
+template <typename T>
+typename RingBuffer<T>::iterator
+RingBuffer<T>::begin (void)
+{
+  return iterator (this, m_head);
+}
+
+template <typename T>
+typename RingBuffer<T>::const_iterator
+RingBuffer<T>::begin (void) const
+{
+  return const_iterator (this, m_head);
+}
+
+template <typename T>
+typename RingBuffer<T>::const_iterator
+RingBuffer<T>::cbegin (void) const
+{
+  return const_iterator (this, m_head);
+}
+
+template <typename T>
+typename RingBuffer<T>::iterator
+RingBuffer<T>::end (void)
+{
+  return iterator (this, m_tail);
+}
+
+template <typename T>
+typename RingBuffer<T>::const_iterator
+RingBuffer<T>::end (void) const
+{
+  return const_iterator (this, m_tail);
+}
+
+template <typename T>
+typename RingBuffer<T>::const_iterator
+RingBuffer<T>::cend (void) const
+{
+  return const_iterator (this, m_tail);
+}
+
+template <typename T>
+void
+RingBuffer<T>::Grow (void)
+{
+  uint32_t capacity = m_items.empty () ? 16 : 2 * m_items.size ();
+  NS_ASSERT_MSG (capacity > m_items.size (), "RingBuffer too large");
+  std::vector<T> items (capacity);
+  uint32_t mask = capacity - 1;
+  // The items keep their absolute positions, so that the iterators
+  // remain valid.
+  for (uint32_t position = m_head; position != m_tail; position++)
+    {
+      items[position & mask] = Slot (position);
+    }
+  m_items.swap (items);
+  m_mask = mask;
+}
+
+template <typename T>
+void
+RingBuffer<T>::push_back (const T &item)
+{
+  if (size () == m_items.size ())
+    {
+      Grow ();
+    }
+  Slot (m_tail) = item;
+  m_tail++;
+}
+
+template <typename T>
+void
+RingBuffer<T>::push_front (const T &item)
+{
+  if (size () == m_items.size ())
+    {
+      Grow ();
+    }
+  m_head--;
+  Slot (m_head) = item;
+}
+
+template <typename T>
+void
+RingBuffer<T>::pop_front (void)
+{
+  NS_ASSERT (!empty ());
+  // Release the item now, as std::list would.
+  Slot (m_head) = T ();
+  m_head++;
+}
+
+template <typename T>
+void
+RingBuffer<T>::pop_back (void)
+{
+  NS_ASSERT (!empty ());
+  m_tail--;
+  Slot (m_tail) = T ();
+}
+
+template <typename T>
+typename RingBuffer<T>::iterator
+RingBuffer<T>::insert (const_iterator pos, const T &item)
+{
+  NS_ASSERT (pos.m_ring == this);
+  uint32_t position = pos.m_position;
+  NS_ASSERT (position - m_head <= size ());
+  if (position == m_tail)
+    {
+      push_back (item);
+      return iterator (this, position);
+    }
+  if (size () == m_items.size ())
+    {
+      Grow ();
+    }
+  // Move the items before the position towards the front.
+  m_head--;
+  for (uint32_t i = m_head; i != position - 1; i++)
+    {
+      Slot (i) = Slot (i + 1);
+    }
+  Slot (position - 1) = item;
+  return iterator (this, position - 1);
+}
+
+template <typename T>
+typename RingBuffer<T>::iterator
+RingBuffer<T>::erase (const_iterator pos)
+{
+  NS_ASSERT (pos.m_ring == this);
+  uint32_t position = pos.m_position;
+  NS_ASSERT (position - m_head < size ());
+  // Move the items before the position towards the back.
+  for (uint32_t i = position; i != m_head; i--)
+    {
+      Slot (i) = Slot (i - 1);
+    }
+  pop_front ();
+  return iterator (this, position + 1);
+}
+
+template <typename T>
+void
+RingBuffer<T>::clear (void)
+{
+  while (!empty ())
+    {
+      pop_front ();
+    }
+}
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_H */
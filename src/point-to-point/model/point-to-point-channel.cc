@@ -97,9 +97,11 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
-  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
+  // The receiver may run in another partition, in parallel with the sender.
+  uint32_t context = m_link[wire].m_dst->GetNode ()->GetId ();
+  Simulator::ScheduleWithContext (context,
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p->Copy ());
+                                  m_link[wire].m_dst, p->CopyForContext (context));
 
   // Call the tx anim callback on the net device
   m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
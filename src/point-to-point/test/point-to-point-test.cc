@@ -24,6 +24,11 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
 
 using namespace ns3;
 
@@ -94,6 +99,167 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test class for PointToPoint model with two partitions
+ *
+ * It sends packets from one NetDevice to another, over a
+ * PointToPointChannel, with the two nodes in different partitions of
+ * the MultithreadedSimulatorImpl, and checks that the packets received
+ * share no data with the packets sent.
+ */
+class PointToPointPartitionTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointPartitionTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+  /**
+   * \brief Restore the default simulator
+   */
+  virtual void DoTeardown (void);
+
+private:
+  /**
+   * \brief Send one packet to the device specified
+   *
+   * \param device NetDevice to send to
+   */
+  void SendOnePacket (Ptr<PointToPointNetDevice> device);
+  /**
+   * \brief Record a packet starting its transmission
+   *
+   * \param p the packet
+   */
+  void TxBegin (Ptr<const Packet> p);
+  /**
+   * \brief Record a packet received
+   *
+   * \param device the receiving NetDevice
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
+                uint16_t protocol, const Address &from);
+
+  std::vector<Ptr<const Packet> > m_tx;  //!< The packets sent
+  std::vector<Ptr<const Packet> > m_rx;  //!< The packets received
+  uint32_t m_txPartition;                //!< The partition of the sender
+  uint32_t m_rxPartition;                //!< The partition of the receiver
+};
+
+PointToPointPartitionTest::PointToPointPartitionTest ()
+  : TestCase ("PointToPoint across two partitions"),
+    m_txPartition (0),
+    m_rxPartition (0)
+{
+}
+
+void
+PointToPointPartitionTest::SendOnePacket (Ptr<PointToPointNetDevice> device)
+{
+  uint8_t data[100];
+  for (uint32_t i = 0; i < sizeof (data); i++)
+    {
+      data[i] = i;
+    }
+  Ptr<Packet> p = Create<Packet> (data, sizeof (data));
+  device->Send (p, device->GetBroadcast (), 0x800);
+}
+
+void
+PointToPointPartitionTest::TxBegin (Ptr<const Packet> p)
+{
+  m_txPartition = Simulator::GetPartitionId ();
+  m_tx.push_back (p);
+}
+
+bool
+PointToPointPartitionTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
+                                    uint16_t protocol, const Address &from)
+{
+  m_rxPartition = Simulator::GetPartitionId ();
+  m_rx.push_back (p);
+  return true;
+}
+
+void
+PointToPointPartitionTest::DoRun (void)
+{
+  // The packets are sent 10 ms apart and arrive 2 ms after the end of
+  // their transmission, so the two partitions never use the same object
+  // in the same round, and the test runs without atomic reference counts.
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::ThreadCount", UintegerValue (2));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::RequireAtomicRefCount", BooleanValue (false));
+
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (2)));
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devA->SetDataRate (DataRate ("5Mbps"));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->SetDataRate (DataRate ("5Mbps"));
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devA->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&PointToPointPartitionTest::TxBegin, this));
+  devB->SetReceiveCallback (MakeCallback (&PointToPointPartitionTest::Receive, this));
+
+  for (uint32_t i = 1; i <= 3; i++)
+    {
+      Simulator::ScheduleWithContext (a->GetId (), MilliSeconds (10 * i),
+                                      &PointToPointPartitionTest::SendOnePacket, this, devA);
+    }
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_tx.size (), 3, "Packets not sent");
+  NS_TEST_ASSERT_MSG_EQ (m_rx.size (), 3, "Packets not received");
+  NS_TEST_EXPECT_MSG_NE (m_txPartition, 0, "Sender not run in a partition");
+  NS_TEST_EXPECT_MSG_NE (m_rxPartition, 0, "Receiver not run in a partition");
+  NS_TEST_EXPECT_MSG_NE (m_txPartition, m_rxPartition, "Sender and receiver in the same partition");
+  for (uint32_t i = 0; i < m_rx.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_rx[i]->IsSharedWith (m_tx[i]), false, "Packet data shared across partitions");
+      NS_TEST_EXPECT_MSG_EQ (m_rx[i]->GetUid (), m_tx[i]->GetUid (), "Packet uid not kept");
+      NS_TEST_ASSERT_MSG_EQ (m_rx[i]->GetSize (), 100, "Packet size not kept");
+      uint8_t data[100];
+      m_rx[i]->CopyData (data, sizeof (data));
+      for (uint32_t j = 0; j < sizeof (data); j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (data[j]), j, "Packet content not kept");
+        }
+    }
+
+  Simulator::Destroy ();
+  m_tx.clear ();
+  m_rx.clear ();
+}
+
+void
+PointToPointPartitionTest::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::Reset ();
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -110,6 +276,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointPartitionTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
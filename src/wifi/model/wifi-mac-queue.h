@@ -31,6 +31,19 @@ namespace ns3 {
 
 class QosBlockedDestinations;
 
+/**
+ * \ingroup wifi
+ *
+ * The WifiMacQueue browses its items, and removes and inserts items
+ * while holding iterators to the items before them, so they are stored
+ * in a std::list rather than in the default RingBuffer.
+ */
+template <>
+struct QueueContainer<WifiMacQueueItem>
+{
+  typedef std::list<Ptr<WifiMacQueueItem> > Type; //!< The container type
+};
+
 // The following explicit template instantiation declaration prevents modules
 // including this header file from implicitly instantiating Queue<WifiMacQueueItem>.
 // This would cause python examples using wifi to crash at runtime with the
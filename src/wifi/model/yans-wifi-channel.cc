@@ -87,6 +87,8 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << duration.GetSeconds ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
+  Simulator::ContextEvents receptions;
+  receptions.reserve (m_phyList.size ());
   for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
     {
       if (sender != (*i))
@@ -114,11 +116,14 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
               dstNode = dstNetDevice->GetNode ()->GetId ();
             }
 
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm, duration);
+          Simulator::ContextEvent reception;
+          reception.context = dstNode;
+          reception.delay = delay;
+          reception.event = MakeEvent (&YansWifiChannel::Receive, (*i), copy, rxPowerDbm, duration);
+          receptions.push_back (reception);
         }
     }
+  Simulator::ScheduleWithContextBatch (receptions);
 }
 
 void
@@ -32,6 +32,7 @@
 #include <stdlib.h> // for exit ()
 #include <limits>
 #include <algorithm>
+#include <vector>
 
 using namespace ns3;
 
@@ -328,6 +329,49 @@ benchByteTags (uint32_t n)
     }
 }
 
+/// Jumbo frame payload, with real bytes, kept contiguous with the headers
+static Ptr<Packet> g_jumboContiguous;
+/// Jumbo frame payload, with real bytes, kept in a payload segment
+static Ptr<Packet> g_jumboSegmented;
+
+/**
+ * Forward copies of a jumbo frame with a real payload: add headers to
+ * each copy, then fragment it and add a header to each fragment.
+ *
+ * \param jumbo The jumbo frame.
+ * \param n The number of copies.
+ */
+static void
+benchJumbo (Ptr<const Packet> jumbo, uint32_t n)
+{
+  BenchHeader<25> ipv4;
+  BenchHeader<8> udp;
+
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<Packet> p = jumbo->Copy ();
+    p->AddHeader (udp);
+    p->AddHeader (ipv4);
+    for (uint32_t offset = 0; offset < p->GetSize (); offset += 1500)
+      {
+        uint32_t length = std::min<uint32_t> (1500, p->GetSize () - offset);
+        Ptr<Packet> fragment = p->CreateFragment (offset, length);
+        fragment->AddHeader (ipv4);
+      }
+  }
+}
+
+static void
+benchJumboContiguous (uint32_t n)
+{
+  benchJumbo (g_jumboContiguous, n);
+}
+
+static void
+benchJumboSegmented (uint32_t n)
+{
+  benchJumbo (g_jumboSegmented, n);
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -362,12 +406,16 @@ int main (int argc, char *argv[])
   uint32_t n = 0;
   uint32_t minIterations = 1;
   bool enablePrinting = false;
+  bool compactPrinting = false;
+  uint32_t jumboSize = 9000;
 
   CommandLine cmd;
   cmd.Usage ("Benchmark Packet class");
   cmd.AddValue ("n", "number of iterations", n);
   cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
   cmd.AddValue ("enable-printing", "enable packet printing", enablePrinting);
+  cmd.AddValue ("compact-printing", "enable packet printing, with the compact metadata", compactPrinting);
+  cmd.AddValue ("jumbo-size", "payload size of the jumbo frames", jumboSize);
   cmd.Parse (argc, argv);
 
   if (n == 0)
@@ -376,6 +424,14 @@ int main (int argc, char *argv[])
         "by command-line argument --n=(number of packets)" << std::endl;
       exit (1);
     }
+  if (compactPrinting)
+    {
+      Packet::EnableCompactPrinting ();
+    }
+  else if (enablePrinting)
+    {
+      Packet::EnablePrinting ();
+    }
   std::cout << "Running bench-packets with n=" << n << std::endl;
   std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
 
@@ -386,5 +442,12 @@ int main (int argc, char *argv[])
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
 
+  std::vector<uint8_t> payload (jumboSize, 0x55);
+  g_jumboContiguous = Create<Packet> (&payload[0], payload.size ());
+  Packet::EnablePayloadSegments ();
+  g_jumboSegmented = Create<Packet> (&payload[0], payload.size ());
+  runBench (&benchJumboContiguous, n, minIterations, "Jumbo payload, copy and fragment, contiguous buffer");
+  runBench (&benchJumboSegmented, n, minIterations, "Jumbo payload, copy and fragment, payload segment");
+
   return 0;
 }
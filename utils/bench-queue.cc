@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+/**
+ * \file
+ * \ingroup queue
+ * Measure the enqueue and dequeue rate of a DropTailQueue whose items
+ * are stored in the default RingBuffer, and in a std::list.
+ *
+ * \verbatim
+   $ ./waf --run "bench-queue --n=10000000 --backlog=100" \endverbatim
+ */
+
+using namespace ns3;
+
+/** An item stored in a RingBuffer. */
+class RingItem : public SimpleRefCount<RingItem>
+{
+public:
+  /** \returns The size of the item. */
+  uint32_t GetSize (void) const
+  {
+    return 1000;
+  }
+};
+
+/** An item stored in a std::list. */
+class ListItem : public SimpleRefCount<ListItem>
+{
+public:
+  /** \returns The size of the item. */
+  uint32_t GetSize (void) const
+  {
+    return 1000;
+  }
+};
+
+namespace ns3 {
+
+/** Store the ListItem objects in a std::list, as queues used to. */
+template <>
+struct QueueContainer<ListItem>
+{
+  typedef std::list<Ptr<ListItem> > Type; //!< The container type
+};
+
+NS_OBJECT_TEMPLATE_CLASS_DEFINE (Queue, RingItem);
+NS_OBJECT_TEMPLATE_CLASS_DEFINE (Queue, ListItem);
+NS_OBJECT_TEMPLATE_CLASS_DEFINE (DropTailQueue, RingItem);
+NS_OBJECT_TEMPLATE_CLASS_DEFINE (DropTailQueue, ListItem);
+
+} // namespace ns3
+
+/**
+ * Enqueue and dequeue an item, in a queue holding a backlog of items.
+ *
+ * \tparam Item \deduced The item type.
+ * \param [in] items The items, one more than the backlog.
+ * \param [in] n The number of enqueue and dequeue pairs.
+ * \returns The seconds taken.
+ */
+template <typename Item>
+double
+Steady (const std::vector<Ptr<Item> > &items, uint64_t n)
+{
+  Ptr<DropTailQueue<Item> > queue = CreateObject<DropTailQueue<Item> > ();
+  queue->SetMaxSize (QueueSize (QueueSizeUnit::PACKETS, items.size ()));
+  for (uint32_t i = 0; i + 1 < items.size (); i++)
+    {
+      queue->Enqueue (items[i]);
+    }
+  SystemWallClockMs time;
+  time.Start ();
+  uint32_t next = items.size () - 1;
+  for (uint64_t i = 0; i < n; i++)
+    {
+      queue->Enqueue (items[next]);
+      next = (next + 1 == items.size ()) ? 0 : next + 1;
+      queue->Dequeue ();
+    }
+  return time.End () / 1000.0;
+}
+
+/**
+ * Fill a queue with all the items, then empty it, repeatedly.
+ *
+ * \tparam Item \deduced The item type.
+ * \param [in] items The items.
+ * \param [in] n The number of enqueue and dequeue pairs.
+ * \returns The seconds taken.
+ */
+template <typename Item>
+double
+Burst (const std::vector<Ptr<Item> > &items, uint64_t n)
+{
+  Ptr<DropTailQueue<Item> > queue = CreateObject<DropTailQueue<Item> > ();
+  queue->SetMaxSize (QueueSize (QueueSizeUnit::PACKETS, items.size ()));
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint64_t i = 0; i < n; i += items.size ())
+    {
+      for (uint32_t j = 0; j < items.size (); j++)
+        {
+          queue->Enqueue (items[j]);
+        }
+      for (uint32_t j = 0; j < items.size (); j++)
+        {
+          queue->Dequeue ();
+        }
+    }
+  return time.End () / 1000.0;
+}
+
+/**
+ * Print a measurement.
+ *
+ * \param [in] name The measurement.
+ * \param [in] seconds The seconds taken.
+ * \param [in] n The number of enqueue and dequeue pairs.
+ */
+void
+Report (std::string name, double seconds, uint64_t n)
+{
+  std::cout << std::left << std::setw (24) << name << std::right
+            << std::setw (10) << seconds
+            << std::setw (14) << (n / seconds)
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint64_t n = 10000000;
+  uint32_t backlog = 100;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the enqueue and dequeue rate of DropTailQueue,\n"
+             "with its items stored in a RingBuffer and in a std::list.\n"
+             "\n"
+             "For each case, print the seconds taken and the enqueue and\n"
+             "dequeue pairs per second.");
+  cmd.AddValue ("n", "number of enqueue and dequeue pairs (default 1E7)", n);
+  cmd.AddValue ("backlog", "number of items in the queue (default 100)", backlog);
+  cmd.Parse (argc, argv);
+
+  std::vector<Ptr<RingItem> > ringItems;
+  std::vector<Ptr<ListItem> > listItems;
+  for (uint32_t i = 0; i <= backlog; i++)
+    {
+      ringItems.push_back (Create<RingItem> ());
+      listItems.push_back (Create<ListItem> ());
+    }
+
+  std::cout << std::left << std::setw (24) << "case" << std::right
+            << std::setw (10) << "seconds"
+            << std::setw (14) << "pairs/s"
+            << std::endl;
+  Report ("steady, ring buffer", Steady (ringItems, n), n);
+  Report ("steady, list", Steady (listItems, n), n);
+  Report ("burst, ring buffer", Burst (ringItems, n), n);
+  Report ("burst, list", Burst (listItems, n), n);
+
+  return 0;
+}
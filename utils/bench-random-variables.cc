@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+/**
+ * \file
+ * \ingroup randomvariable
+ * Compare drawing random variates one at a time, with
+ * RandomVariableStream::GetValue, and in bulk, with
+ * RandomVariableStream::GetValues.
+ *
+ * \verbatim
+   $ ./waf --run "bench-random-variables --total=10000000 --batch=1024" \endverbatim
+ */
+
+using namespace ns3;
+
+
+/**
+ * Benchmark a random variable.
+ *
+ * \param [in] name The name of the distribution.
+ * \param [in] factory The factory of the random variable.
+ * \param [in] total The number of values to draw.
+ * \param [in] batch The number of values drawn by each GetValues call.
+ */
+void
+Bench (std::string name, ObjectFactory factory, uint64_t total, uint32_t batch)
+{
+  Ptr<RandomVariableStream> scalar = factory.Create<RandomVariableStream> ();
+  Ptr<RandomVariableStream> bulk = factory.Create<RandomVariableStream> ();
+  scalar->SetStream (1);
+  bulk->SetStream (1);
+  std::vector<double> values (batch);
+  SystemWallClockMs time;
+
+  // Sum the values, so that they are used, and compared.
+  double scalarSum = 0;
+  time.Start ();
+  for (uint64_t i = 0; i < total; ++i)
+    {
+      scalarSum += scalar->GetValue ();
+    }
+  double scalarTime = time.End () / 1000.0;
+
+  double bulkSum = 0;
+  time.Start ();
+  for (uint64_t i = 0; i < total; i += batch)
+    {
+      uint32_t n = static_cast<uint32_t> (std::min<uint64_t> (batch, total - i));
+      bulk->GetValues (&values[0], n);
+      for (uint32_t j = 0; j < n; ++j)
+        {
+          bulkSum += values[j];
+        }
+    }
+  double bulkTime = time.End () / 1000.0;
+
+  std::cout << std::left << std::setw (14) << name << std::right
+            << std::setw (10) << scalarTime
+            << std::setw (10) << bulkTime
+            << std::setw (10) << (bulkTime > 0 ? scalarTime / bulkTime : 0)
+            << (scalarSum == bulkSum ? "" : "  values differ!")
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint64_t total = 10000000;
+  uint32_t batch = 1024;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark drawing random variates with GetValue and GetValues.\n"
+             "\n"
+             "For each distribution, print the seconds taken by GetValue,\n"
+             "by GetValues, and the speedup.");
+  cmd.AddValue ("total", "number of values to draw (default 1E7)", total);
+  cmd.AddValue ("batch", "number of values drawn by each GetValues call (default 1024)", batch);
+  cmd.Parse (argc, argv);
+  if (batch == 0)
+    {
+      batch = 1;
+    }
+
+  std::cout << std::left << std::setw (14) << "distribution" << std::right
+            << std::setw (10) << "GetValue"
+            << std::setw (10) << "GetValues"
+            << std::setw (10) << "speedup"
+            << std::endl;
+
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::UniformRandomVariable");
+  Bench ("uniform", factory, total, batch);
+  factory.SetTypeId ("ns3::ExponentialRandomVariable");
+  Bench ("exponential", factory, total, batch);
+  factory.Set ("Bound", DoubleValue (2.0));
+  Bench ("exp bounded", factory, total, batch);
+  factory = ObjectFactory ();
+  factory.SetTypeId ("ns3::NormalRandomVariable");
+  Bench ("normal", factory, total, batch);
+
+  return 0;
+}
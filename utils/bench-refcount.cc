@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+/**
+ * \file
+ * \ingroup ptr
+ * Measure the throughput of copying and releasing Ptr, with the
+ * non-atomic and atomic reference count policies of SimpleRefCount.
+ *
+ * Ptr<Packet> uses the policy chosen at configure time
+ * (\c --enable-atomic-refcount); the other rows use each policy
+ * explicitly, so that both can be compared in one build.
+ *
+ * \verbatim
+   $ ./waf --run "bench-refcount --copies=100000000 --threads=4" \endverbatim
+ */
+
+using namespace ns3;
+
+
+/**
+ * An object counted with a reference count policy.
+ *
+ * \tparam POLICY \explicit The reference count policy.
+ */
+template <typename POLICY>
+class Counted
+  : public SimpleRefCount<Counted<POLICY>, empty, DefaultDeleter<Counted<POLICY> >, POLICY>
+{
+};
+
+/**
+ * Copy Ptr into a ring of slots, as when packets are queued and
+ * dequeued: each copy references one object and releases another.
+ *
+ * \tparam T \deduced The object type.
+ * \param [in] objects The objects.
+ * \param [in] copies The number of copies.
+ * \returns The seconds taken.
+ */
+template <typename T>
+double
+CopyRing (const std::vector<Ptr<T> > &objects, uint64_t copies)
+{
+  std::vector<Ptr<T> > slots (64);
+  const uint32_t mask = objects.size () - 1;
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint64_t i = 0; i < copies; ++i)
+    {
+      slots[i & 63] = objects[i & mask];
+    }
+  return time.End () / 1000.0;
+}
+
+/**
+ * Copy Ptr to shared objects from several threads.
+ *
+ * \tparam T \deduced The object type.
+ * \param [in] objects The objects, shared by the threads.
+ * \param [in] copies The number of copies per thread.
+ * \param [in] threads The number of threads.
+ * \returns The seconds taken.
+ */
+template <typename T>
+double
+CopyThreads (const std::vector<Ptr<T> > &objects, uint64_t copies, uint32_t threads)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  std::vector<std::thread> workers;
+  for (uint32_t i = 0; i < threads; ++i)
+    {
+      workers.push_back (std::thread (&CopyRing<T>, std::cref (objects), copies));
+    }
+  for (uint32_t i = 0; i < threads; ++i)
+    {
+      workers[i].join ();
+    }
+  return time.End () / 1000.0;
+}
+
+/**
+ * Print a measurement.
+ *
+ * \param [in] name The measurement.
+ * \param [in] seconds The seconds taken.
+ * \param [in] copies The number of copies.
+ */
+void
+Report (std::string name, double seconds, uint64_t copies)
+{
+  std::cout << std::left << std::setw (32) << name << std::right
+            << std::setw (10) << seconds
+            << std::setw (12) << (seconds * 1e9 / copies)
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint64_t copies = 100000000;
+  uint32_t threads = 4;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark copying and releasing Ptr with the non-atomic and\n"
+             "atomic reference count policies.\n"
+             "\n"
+             "For each case, print the seconds taken and the nanoseconds per copy.");
+  cmd.AddValue ("copies", "number of Ptr copies (default 1E8)", copies);
+  cmd.AddValue ("threads", "number of threads sharing objects (default 4)", threads);
+  cmd.Parse (argc, argv);
+
+  std::cout << "Default policy: "
+#ifdef NS3_ATOMIC_REFCOUNT
+            << "atomic"
+#else
+            << "non-atomic"
+#endif
+            << std::endl;
+  std::cout << std::left << std::setw (32) << "case" << std::right
+            << std::setw (10) << "seconds"
+            << std::setw (12) << "ns/copy"
+            << std::endl;
+
+  std::vector<Ptr<Packet> > packets;
+  std::vector<Ptr<Counted<NonAtomicRefCountPolicy> > > nonAtomic;
+  std::vector<Ptr<Counted<AtomicRefCountPolicy> > > atomic;
+  for (uint32_t i = 0; i < 1024; ++i)
+    {
+      packets.push_back (Create<Packet> (100));
+      nonAtomic.push_back (Create<Counted<NonAtomicRefCountPolicy> > ());
+      atomic.push_back (Create<Counted<AtomicRefCountPolicy> > ());
+    }
+
+  Report ("Ptr<Packet>", CopyRing (packets, copies), copies);
+  Report ("non-atomic", CopyRing (nonAtomic, copies), copies);
+  Report ("atomic", CopyRing (atomic, copies), copies);
+  if (threads > 0)
+    {
+      std::ostringstream name;
+      name << "atomic, " << threads << " threads";
+      Report (name.str (), CopyThreads (atomic, copies / threads, threads), copies);
+    }
+
+  return 0;
+}
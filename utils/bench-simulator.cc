@@ -145,18 +145,69 @@ Bench::Cb (void)
 }
 
 
+/**
+ * Create a random stream of event intervals following a named
+ * distribution, all with a mean of about 100 ns.
+ *
+ * \param dist the distribution name: "exp", "uniform", "bimodal"
+ *        or "pareto"
+ * \return the random stream
+ */
 Ptr<RandomVariableStream>
-GetRandomStream (std::string filename)
+GetDistributionStream (std::string dist)
 {
   Ptr<RandomVariableStream> stream = 0;
 
-  if (filename == "")
+  if (dist == "exp")
     {
-      LOGME ("using default exponential distribution");
       Ptr<ExponentialRandomVariable> erv = CreateObject<ExponentialRandomVariable> ();
       erv->SetAttribute ("Mean", DoubleValue (100));
       stream = erv;
     }
+  else if (dist == "uniform")
+    {
+      Ptr<UniformRandomVariable> urv = CreateObject<UniformRandomVariable> ();
+      urv->SetAttribute ("Min", DoubleValue (0));
+      urv->SetAttribute ("Max", DoubleValue (200));
+      stream = urv;
+    }
+  else if (dist == "bimodal")
+    {
+      // Half of the intervals in [0, 20], half in [180, 200]
+      Ptr<EmpiricalRandomVariable> brv = CreateObject<EmpiricalRandomVariable> ();
+      brv->CDF (0, 0.0);
+      brv->CDF (20, 0.5);
+      brv->CDF (180, 0.5);
+      brv->CDF (200, 1.0);
+      stream = brv;
+    }
+  else if (dist == "pareto")
+    {
+      // Heavy tail: shape 1.5 has a finite mean but an infinite variance
+      Ptr<ParetoRandomVariable> prv = CreateObject<ParetoRandomVariable> ();
+      prv->SetAttribute ("Shape", DoubleValue (1.5));
+      prv->SetAttribute ("Scale", DoubleValue (100.0 / 3));
+      prv->SetAttribute ("Bound", DoubleValue (1e9));
+      stream = prv;
+    }
+  else
+    {
+      NS_FATAL_ERROR ("unknown distribution " << dist);
+    }
+
+  return stream;
+}
+
+Ptr<RandomVariableStream>
+GetRandomStream (std::string filename, std::string dist)
+{
+  Ptr<RandomVariableStream> stream = 0;
+
+  if (filename == "")
+    {
+      LOGME ("using " << dist << " distribution, mean 100 ns");
+      stream = GetDistributionStream (dist);
+    }
   else
     {
       std::istream *input;
@@ -198,6 +249,67 @@ GetRandomStream (std::string filename)
   return stream;
 }
 
+/**
+ * Benchmark one scheduler with one event interval distribution.
+ *
+ * \param factory the scheduler factory
+ * \param filename file of relative event times, or "" to use \p dist
+ * \param dist the event interval distribution
+ * \param pop the event population size
+ * \param total the total number of events to run
+ * \param runs the number of runs
+ */
+void
+RunScenario (ObjectFactory factory, std::string filename, std::string dist,
+             uint32_t pop, uint32_t total, uint32_t runs)
+{
+  Simulator::SetScheduler (factory);
+
+  LOG ("");
+  LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
+  Bench *bench = new Bench (pop, total);
+  bench->SetRandomStream (GetRandomStream (filename, dist));
+
+  // table header
+  LOG ("");
+  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+       std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
+       std::left << std::setw (3 * g_fwidth) << "Simulation:");
+  LOG (std::left << std::setw (g_fwidth) << "" <<
+       std::left << std::setw (g_fwidth) << "Time (s)" <<
+       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+       std::left << std::setw (g_fwidth) << "Time (s)" <<
+       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+  LOG (std::setfill ('-') <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::setfill (' ')
+       );
+
+  // prime
+  DEB ("priming");
+  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
+  bench->RunBench ();
+
+  bench->SetPopulation (pop);
+  bench->SetTotal (total);
+  for (uint32_t i = 0; i < runs; i++)
+    {
+      std::cout << std::setw (g_fwidth) << i;
+
+      bench->RunBench ();
+    }
+
+  Simulator::Destroy ();
+  delete bench;
+}
 
 
 int main (int argc, char *argv[])
@@ -207,100 +319,104 @@ int main (int argc, char *argv[])
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedPair = false;
+  bool schedAll  = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
   uint32_t runs  =       1;
   std::string filename = "";
+  std::string dist = "exp";
 
   CommandLine cmd;
   cmd.Usage ("Benchmark the simulator scheduler.\n"
              "\n"
+             "Each event schedules a single new event (the hold model).\n"
              "Event intervals are taken from one of:\n"
-             "  an exponential distribution, with mean 100 ns,\n"
+             "  a distribution with mean 100 ns, given by the --dist argument:\n"
+             "    exponential (exp, the default), uniform in [0, 200] ns,\n"
+             "    bimodal (half in [0, 20] ns, half in [180, 200] ns),\n"
+             "    heavy-tailed Pareto with shape 1.5 (pareto), or all of them,\n"
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "With --all, every scheduler is benchmarked in turn.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("pair",  "use PairingHeapScheduler",      schedPair);
+  cmd.AddValue ("all",   "compare all the schedulers",    schedAll);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
+  cmd.AddValue ("dist",  "event interval distribution: exp, uniform, bimodal, pareto or all", dist);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
 
-  ObjectFactory factory ("ns3::MapScheduler");
-  if (schedCal)
+  std::vector<std::string> schedulers;
+  if (schedAll)
     {
-      factory.SetTypeId ("ns3::CalendarScheduler");
+      schedulers.push_back ("ns3::ListScheduler");
+      schedulers.push_back ("ns3::MapScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::CalendarScheduler");
+      schedulers.push_back ("ns3::PairingHeapScheduler");
     }
-  if (schedHeap)
+  else if (schedCal)
     {
-      factory.SetTypeId ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::CalendarScheduler");
     }
-  if (schedList)
+  else if (schedHeap)
     {
-      factory.SetTypeId ("ns3::ListScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
+    }
+  else if (schedList)
+    {
+      schedulers.push_back ("ns3::ListScheduler");
+    }
+  else if (schedPair)
+    {
+      schedulers.push_back ("ns3::PairingHeapScheduler");
+    }
+  else
+    {
+      schedulers.push_back ("ns3::MapScheduler");
+    }
+
+  std::vector<std::string> dists;
+  if (dist == "all" && filename == "")
+    {
+      dists.push_back ("exp");
+      dists.push_back ("uniform");
+      dists.push_back ("bimodal");
+      dists.push_back ("pareto");
+    }
+  else
+    {
+      dists.push_back (dist);
     }
-  Simulator::SetScheduler (factory);
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
 
-  LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
 
-  Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
-
-  // table header
-  LOG ("");
-  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
-       std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
-       std::left << std::setw (3 * g_fwidth) << "Simulation:");
-  LOG (std::left << std::setw (g_fwidth) << "" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
-  LOG (std::setfill ('-') <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::setfill (' ')
-       );
-
-  // prime
-  DEB ("priming");
-  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
-  bench->RunBench ();
-
-  bench->SetPopulation (pop);
-  bench->SetTotal (total);
-  for (uint32_t i = 0; i < runs; i++)
+  for (std::vector<std::string>::const_iterator d = dists.begin (); d != dists.end (); ++d)
     {
-      std::cout << std::setw (g_fwidth) << i;
-
-      bench->RunBench ();
+      for (std::vector<std::string>::const_iterator s = schedulers.begin (); s != schedulers.end (); ++s)
+        {
+          RunScenario (ObjectFactory (*s), filename, *d, pop, total, runs);
+        }
     }
 
   LOG ("");
-  Simulator::Destroy ();
-  delete bench;
   return 0;
 }
@@ -0,0 +1,76 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+#include <fstream>
+
+#include "ns3/core-module.h"
+
+/**
+ * \file
+ * \ingroup logbinary
+ * Render a binary log (see LogBinaryEnable) as text.
+ *
+ * \verbatim
+   $ ./waf --run "decode-binary-log --input=run.blog --output=run.log" \endverbatim
+ */
+
+using namespace ns3;
+
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd;
+  cmd.Usage ("Render a binary log file, recorded with NS_LOG_BINARY or\n"
+             "LogBinaryEnable, in the text format of NS_LOG.");
+  cmd.AddValue ("input", "the binary log file", input);
+  cmd.AddValue ("output", "the text file to write, instead of standard output", output);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "decode-binary-log: missing --input" << std::endl;
+      return 1;
+    }
+  std::ifstream is (input.c_str (), std::ios::in | std::ios::binary);
+  if (!is.is_open ())
+    {
+      std::cerr << "decode-binary-log: can not open " << input << std::endl;
+      return 1;
+    }
+  std::ofstream file;
+  if (!output.empty ())
+    {
+      file.open (output.c_str ());
+      if (!file.is_open ())
+        {
+          std::cerr << "decode-binary-log: can not open " << output << std::endl;
+          return 1;
+        }
+    }
+  std::ostream &os = output.empty () ? std::cout : file;
+
+  if (!LogBinaryDecode (is, os))
+    {
+      std::cerr << "decode-binary-log: " << input
+                << " is not a valid binary log, or is truncated" << std::endl;
+      return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+
+#include "ns3/core-module.h"
+#include "ns3/columnar-trace-file.h"
+
+/**
+ * \file
+ * Print a columnar trace (see ColumnarTraceHelper) as comma separated
+ * values, one line per record:
+ *
+ * \verbatim
+   $ ./waf --run "print-columnar-trace --input=run.ns3c --output=run.csv"
+   time,event,node,device,uid,size
+   1.000000000,+,0,1,0,1054
+   ... \endverbatim
+ */
+
+using namespace ns3;
+
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd;
+  cmd.Usage ("Print a columnar trace file, recorded with ColumnarTraceHelper,\n"
+             "as comma separated values.");
+  cmd.AddValue ("input", "the columnar trace file", input);
+  cmd.AddValue ("output", "the csv file to write, instead of standard output", output);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "print-columnar-trace: missing --input" << std::endl;
+      return 1;
+    }
+  ColumnarTraceFile file;
+  file.Open (input, std::ios::in);
+  if (file.Fail ())
+    {
+      std::cerr << "print-columnar-trace: " << input
+                << " can not be opened, or is not a columnar trace" << std::endl;
+      return 1;
+    }
+  std::ofstream csv;
+  if (!output.empty ())
+    {
+      csv.open (output.c_str ());
+      if (!csv.is_open ())
+        {
+          std::cerr << "print-columnar-trace: can not open " << output << std::endl;
+          return 1;
+        }
+    }
+  std::ostream &os = output.empty () ? std::cout : csv;
+
+  // Print the times with the digits of the resolution they were recorded at.
+  Time::SetResolution (file.GetResolution ());
+  int digits = 0;
+  for (Time step = Time::FromInteger (1, file.GetResolution ()); step < Seconds (1); step = step * 10)
+    {
+      digits++;
+    }
+  os << std::fixed << std::setprecision (digits);
+
+  os << "time,event,node,device,uid,size" << std::endl;
+  ColumnarTraceRecord record;
+  while (file.Read (record))
+    {
+      os << TimeStep (record.time).GetSeconds () << ","
+         << record.event << ","
+         << record.node << ","
+         << record.device << ","
+         << record.uid << ","
+         << record.size << std::endl;
+    }
+  if (file.Fail ())
+    {
+      std::cerr << "print-columnar-trace: " << input << " is truncated after "
+                << file.GetRecordCount () << " records" << std::endl;
+      return 1;
+    }
+  return 0;
+}